@@ -0,0 +1,109 @@
+#!/usr/bin/env python
+#
+#      Copyright (C) 2012 Team XBMC
+#      http://www.xbmc.org
+#
+#  This Program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This Program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with XBMC; see the file COPYING.  If not, write to
+#  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+#  http://www.gnu.org/copyleft/gpl.html
+#
+#
+# Load test for the JSON-RPC TCP server.
+#
+# Opens a number of idle clients that only listen for notifications, then
+# has one more client send JSONRPC.NotifyAll a number of times and measures
+# how long it takes each notification to reach every listener.
+#
+# usage: JSONRPCLoadTest.py [host] [port] [clients] [notifications]
+
+import json, select, socket, sys, time
+
+host          = len(sys.argv) > 1 and sys.argv[1] or "127.0.0.1"
+port          = len(sys.argv) > 2 and int(sys.argv[2]) or 9090
+clients       = len(sys.argv) > 3 and int(sys.argv[3]) or 100
+notifications = len(sys.argv) > 4 and int(sys.argv[4]) or 20
+
+decoder = json.JSONDecoder()
+
+class Client:
+  def __init__(self):
+    self.sock = socket.create_connection((host, port))
+    self.sock.setblocking(0)
+    self.buffer = ""
+
+  # returns the complete json objects received so far
+  def read(self):
+    objects = []
+    data = self.sock.recv(65536)
+    if not data:
+      raise Exception("connection closed by server")
+    self.buffer += data.decode("utf-8")
+    while True:
+      self.buffer = self.buffer.lstrip()
+      if not self.buffer:
+        break
+      try:
+        obj, end = decoder.raw_decode(self.buffer)
+      except ValueError:
+        break
+      objects.append(obj)
+      self.buffer = self.buffer[end:]
+    return objects
+
+def percentile(values, p):
+  if not values:
+    return 0.0
+  return values[min(len(values) - 1, int(len(values) * p))]
+
+def main():
+  print("opening %d clients to %s:%d" % (clients, host, port))
+  start = time.time()
+  listeners = [Client() for i in range(clients)]
+  print("connected in %.1f ms" % ((time.time() - start) * 1000))
+
+  sender = socket.create_connection((host, port))
+  bysocket = dict((c.sock.fileno(), c) for c in listeners)
+  poller = select.poll()
+  for c in listeners:
+    poller.register(c.sock, select.POLLIN)
+
+  latencies = []
+  missing = 0
+  for n in range(notifications):
+    request = { "jsonrpc": "2.0", "method": "JSONRPC.NotifyAll", "id": n,
+                "params": { "sender": "loadtest", "message": "ping", "data": { "seq": n } } }
+    pending = set(bysocket.keys())
+    sent = time.time()
+    sender.sendall(json.dumps(request).encode("utf-8"))
+
+    # wait until every listener got this notification, or give up after 5 seconds
+    while pending and time.time() - sent < 5.0:
+      for fd, event in poller.poll(100):
+        for obj in bysocket[fd].read():
+          params = obj.get("params", {})
+          if obj.get("method") == "Other.ping" and params.get("data", {}).get("seq") == n:
+            latencies.append((time.time() - sent) * 1000)
+            pending.discard(fd)
+    missing += len(pending)
+    sender.recv(4096)
+
+  latencies.sort()
+  print("%d notifications to %d clients, %d not delivered" % (notifications, clients, missing))
+  if latencies:
+    print("latency ms: min %.2f avg %.2f p50 %.2f p95 %.2f max %.2f" % (
+      latencies[0], sum(latencies) / len(latencies),
+      percentile(latencies, 0.5), percentile(latencies, 0.95), latencies[-1]))
+
+if __name__ == "__main__":
+  main()
@@ -92,6 +92,8 @@
 #include "utils/TimeUtils.h"
 #include "GUILargeTextureManager.h"
 #include "TextureCache.h"
+#include "TexturePrecacher.h"
+#include "ThumbExtractorService.h"
 #include "music/LastFmManager.h"
 #include "playlists/SmartPlayList.h"
 #ifdef HAS_FILESYSTEM_RAR
@@ -1686,6 +1688,9 @@ void CApplication::DimLCDOnPlayback(bool dim)
 
 void CApplication::StartServices()
 {
+  CAnnouncementManager::Start();
+  CTexturePrecacher::Get().Start();
+
 #if !defined(_WIN32) && defined(HAS_DVD_DRIVE)
   // Start Thread for DVD Mediatype detection
   CLog::Log(LOGNOTICE, "start dvd mediatype detection");
@@ -1711,6 +1716,9 @@ void CApplication::StartServices()
 
 void CApplication::StopServices()
 {
+  CTexturePrecacher::Get().Stop();
+  CAnnouncementManager::Stop();
+
   m_network.NetworkMessage(CNetwork::SERVICES_DOWN, 0);
 
 #if !defined(_WIN32) && defined(HAS_DVD_DRIVE)
@@ -3399,6 +3407,7 @@ void CApplication::Stop(int exitCode)
 
     // cancel any jobs from the jobmanager
     CJobManager::GetInstance().CancelJobs();
+    CThumbExtractorService::Get().Stop();
 
     g_alarmClock.StopThread();
 
@@ -34,6 +34,7 @@
 #include "filesystem/MusicDatabaseDirectory.h"
 #include "filesystem/VideoDatabaseDirectory.h"
 #include "filesystem/DirectoryFactory.h"
+#include "filesystem/PluginDirectory.h"
 #include "music/tags/MusicInfoTagLoaderFactory.h"
 #include "CueDocument.h"
 #include "video/VideoDatabase.h"
@@ -62,6 +63,9 @@
 #include "music/karaoke/karaokelyricsfactory.h"
 #include "ThumbnailCache.h"
 #include "utils/Mime.h"
+#include "FileItemListCache.h"
+#include "utils/MemoryUsage.h"
+#include "threads/SystemClock.h"
 
 using namespace std;
 using namespace XFILE;
@@ -70,6 +74,8 @@ using namespace MUSIC_INFO;
 using namespace PVR;
 using namespace EPG;
 
+CCriticalSection CFileItem::m_lazyTagsSection;
+
 CFileItem::CFileItem(const CSong& song)
 {
   m_musicInfoTag = NULL;
@@ -79,6 +85,7 @@ CFileItem::CFileItem(const CSong& song)
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
   Reset();
   SetLabel(song.strTitle);
   m_strPath = song.strFileName;
@@ -97,6 +104,7 @@ CFileItem::CFileItem(const CStdString &path, const CAlbum& album)
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
   Reset();
   SetLabel(album.strAlbum);
   m_strPath = path;
@@ -117,6 +125,7 @@ CFileItem::CFileItem(const CMusicInfoTag& music)
   m_musicInfoTag = NULL;
   m_videoInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
   Reset();
   SetLabel(music.GetTitle());
   m_strPath = music.GetURL();
@@ -135,6 +144,7 @@ CFileItem::CFileItem(const CVideoInfoTag& movie)
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
   Reset();
   SetLabel(movie.m_strTitle);
   if (movie.m_strFileNameAndPath.IsEmpty())
@@ -162,6 +172,7 @@ CFileItem::CFileItem(const CEpgInfoTag& tag)
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
 
   Reset();
 
@@ -188,6 +199,7 @@ CFileItem::CFileItem(const CPVRChannel& channel)
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
 
   Reset();
   CEpgInfoTag epgNow;
@@ -236,6 +248,7 @@ CFileItem::CFileItem(const CPVRRecording& record)
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
 
   Reset();
 
@@ -255,6 +268,7 @@ CFileItem::CFileItem(const CPVRTimerInfoTag& timer)
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
 
   Reset();
 
@@ -281,6 +295,7 @@ CFileItem::CFileItem(const CArtist& artist)
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
   Reset();
   SetLabel(artist.strArtist);
   m_strPath = artist.strArtist;
@@ -298,6 +313,7 @@ CFileItem::CFileItem(const CGenre& genre)
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
   Reset();
   SetLabel(genre.strGenre);
   m_strPath = genre.strGenre;
@@ -315,6 +331,7 @@ CFileItem::CFileItem(const CFileItem& item): CGUIListItem()
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
   *this = item;
 }
 
@@ -327,6 +344,7 @@ CFileItem::CFileItem(const CGUIListItem& item)
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
   Reset();
   // not particularly pretty, but it gets around the issue of Reset() defaulting
   // parameters in the CGUIListItem base class.
@@ -342,6 +360,7 @@ CFileItem::CFileItem(void)
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
   Reset();
 }
 
@@ -355,6 +374,7 @@ CFileItem::CFileItem(const CStdString& strLabel)
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
   Reset();
   SetLabel(strLabel);
 }
@@ -368,6 +388,7 @@ CFileItem::CFileItem(const CStdString& strPath, bool bIsFolder)
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
   Reset();
   m_strPath = strPath;
   m_bIsFolder = bIsFolder;
@@ -385,6 +406,7 @@ CFileItem::CFileItem(const CMediaSource& share)
   m_pvrRecordingInfoTag = NULL;
   m_pvrTimerInfoTag = NULL;
   m_pictureInfoTag = NULL;
+  m_bLazyTags = false;
   Reset();
   m_bIsFolder = true;
   m_bIsShareOrDrive = true;
@@ -436,7 +458,13 @@ const CFileItem& CFileItem::operator=(const CFileItem& item)
   m_bIsShareOrDrive = item.m_bIsShareOrDrive;
   m_dateTime = item.m_dateTime;
   m_dwSize = item.m_dwSize;
-  if (item.HasMusicInfoTag())
+  // tags that aren't decoded yet are shared rather than copied, another thread may decode them meanwhile
+  CSingleLock lazyLock(m_lazyTagsSection);
+  if (!item.m_bLazyTags)
+    lazyLock.Leave();
+  m_lazyTags = item.m_lazyTags;
+  m_bLazyTags = item.m_bLazyTags;
+  if (item.m_musicInfoTag)
   {
     m_musicInfoTag = GetMusicInfoTag();
     if (m_musicInfoTag)
@@ -448,7 +476,7 @@ const CFileItem& CFileItem::operator=(const CFileItem& item)
     m_musicInfoTag = NULL;
   }
 
-  if (item.HasVideoInfoTag())
+  if (item.m_videoInfoTag)
   {
     m_videoInfoTag = GetVideoInfoTag();
     if (m_videoInfoTag)
@@ -516,7 +544,7 @@ const CFileItem& CFileItem::operator=(const CFileItem& item)
     m_pvrTimerInfoTag = NULL;
   }
 
-  if (item.HasPictureInfoTag())
+  if (item.m_pictureInfoTag)
   {
     m_pictureInfoTag = GetPictureInfoTag();
     if (m_pictureInfoTag)
@@ -527,6 +555,7 @@ const CFileItem& CFileItem::operator=(const CFileItem& item)
     delete m_pictureInfoTag;
     m_pictureInfoTag = NULL;
   }
+  lazyLock.Leave();
 
   m_lStartOffset = item.m_lStartOffset;
   m_lEndOffset = item.m_lEndOffset;
@@ -588,6 +617,8 @@ void CFileItem::Reset()
   m_pvrTimerInfoTag=NULL;
   delete m_pictureInfoTag;
   m_pictureInfoTag=NULL;
+  m_lazyTags.reset();
+  m_bLazyTags = false;
   m_extrainfo.Empty();
   m_specialSort = SORT_NORMALLY;
   SetInvalid();
@@ -621,6 +652,8 @@ void CFileItem::Archive(CArchive& ar)
     ar << m_extrainfo;
     ar << m_specialSort;
 
+    if (m_bLazyTags)
+      DecodeLazyTags();
     if (m_musicInfoTag)
     {
       ar << 1;
@@ -697,6 +730,8 @@ void CFileItem::Serialize(CVariant& value)
   value["mimetype"] = GetMimeType();
   value["extrainfo"] = m_extrainfo;
 
+  if (m_bLazyTags)
+    DecodeLazyTags();
   if (m_musicInfoTag)
     (*m_musicInfoTag).Serialize(value["musicInfoTag"]);
 
@@ -707,6 +742,33 @@ void CFileItem::Serialize(CVariant& value)
     (*m_pictureInfoTag).Serialize(value["pictureInfoTag"]);
 }
 
+void CFileItem::GetMemoryUsage(CMemoryUsage &usage, size_t &propertyBytes, size_t &tagBytes) const
+{
+  usage.Add(sizeof(CFileItem));
+  CGUIListItem::GetMemoryUsage(usage, propertyBytes);
+  usage.Add(m_strPath);
+  usage.Add(m_strDVDLabel);
+  usage.Add(m_strTitle);
+  usage.Add(m_strLockCode);
+  usage.Add(m_mimetype);
+  usage.Add(m_extrainfo);
+
+  // tags that aren't decoded yet live in the cache file
+  size_t start = usage.GetBytes();
+  CSingleLock lazyLock(m_lazyTagsSection);
+  if (!m_bLazyTags)
+    lazyLock.Leave();
+  if (m_lazyTags)
+    usage.Add(sizeof(CFileItemLazyTags));
+  if (m_videoInfoTag)
+    m_videoInfoTag->GetMemoryUsage(usage);
+  if (m_musicInfoTag)
+    usage.Add(sizeof(MUSIC_INFO::CMusicInfoTag));
+  if (m_pictureInfoTag)
+    usage.Add(sizeof(CPictureInfoTag));
+  tagBytes += usage.GetBytes() - start;
+}
+
 bool CFileItem::Exists(bool bUseCache /* = true */) const
 {
   if (m_strPath.IsEmpty()
@@ -1420,25 +1482,25 @@ bool CFileItem::IsSamePath(const CFileItem *item) const
   if (item->GetPath() == m_strPath && item->m_lStartOffset == m_lStartOffset) return true;
   if (IsMusicDb() && HasMusicInfoTag())
   {
-    CFileItem dbItem(m_musicInfoTag->GetURL(), false);
+    CFileItem dbItem(GetMusicInfoTag()->GetURL(), false);
     dbItem.m_lStartOffset = m_lStartOffset;
     return dbItem.IsSamePath(item);
   }
   if (IsVideoDb() && HasVideoInfoTag())
   {
-    CFileItem dbItem(m_videoInfoTag->m_strFileNameAndPath, false);
+    CFileItem dbItem(GetVideoInfoTag()->m_strFileNameAndPath, false);
     dbItem.m_lStartOffset = m_lStartOffset;
     return dbItem.IsSamePath(item);
   }
   if (item->IsMusicDb() && item->HasMusicInfoTag())
   {
-    CFileItem dbItem(item->m_musicInfoTag->GetURL(), false);
+    CFileItem dbItem(item->GetMusicInfoTag()->GetURL(), false);
     dbItem.m_lStartOffset = item->m_lStartOffset;
     return IsSamePath(&dbItem);
   }
   if (item->IsVideoDb() && item->HasVideoInfoTag())
   {
-    CFileItem dbItem(item->m_videoInfoTag->m_strFileNameAndPath, false);
+    CFileItem dbItem(item->GetVideoInfoTag()->m_strFileNameAndPath, false);
     dbItem.m_lStartOffset = item->m_lStartOffset;
     return IsSamePath(&dbItem);
   }
@@ -1963,24 +2025,7 @@ void CFileItemList::Archive(CArchive& ar)
 
     ar << m_fastLookup;
 
-    ar << (int)m_sortMethod;
-    ar << (int)m_sortOrder;
-    ar << m_sortIgnoreFolders;
-    ar << (int)m_cacheToDisc;
-
-    ar << (int)m_sortDetails.size();
-    for (unsigned int j = 0; j < m_sortDetails.size(); ++j)
-    {
-      const SORT_METHOD_DETAILS &details = m_sortDetails[j];
-      ar << (int)details.m_sortMethod;
-      ar << details.m_buttonLabel;
-      ar << details.m_labelMasks.m_strLabelFile;
-      ar << details.m_labelMasks.m_strLabelFolder;
-      ar << details.m_labelMasks.m_strLabel2File;
-      ar << details.m_labelMasks.m_strLabel2Folder;
-    }
-
-    ar << m_content;
+    ArchiveListState(ar);
 
     for (; i < (int)m_items.size(); ++i)
     {
@@ -2020,6 +2065,44 @@ void CFileItemList::Archive(CArchive& ar)
     bool fastLookup=false;
     ar >> fastLookup;
 
+    ArchiveListState(ar);
+
+    for (int i = 0; i < iSize; ++i)
+    {
+      CFileItemPtr pItem(new CFileItem);
+      ar >> *pItem;
+      Add(pItem);
+    }
+
+    SetFastLookup(fastLookup);
+  }
+}
+
+void CFileItemList::ArchiveListState(CArchive& ar)
+{
+  if (ar.IsStoring())
+  {
+    ar << (int)m_sortMethod;
+    ar << (int)m_sortOrder;
+    ar << m_sortIgnoreFolders;
+    ar << (int)m_cacheToDisc;
+
+    ar << (int)m_sortDetails.size();
+    for (unsigned int j = 0; j < m_sortDetails.size(); ++j)
+    {
+      const SORT_METHOD_DETAILS &details = m_sortDetails[j];
+      ar << (int)details.m_sortMethod;
+      ar << details.m_buttonLabel;
+      ar << details.m_labelMasks.m_strLabelFile;
+      ar << details.m_labelMasks.m_strLabelFolder;
+      ar << details.m_labelMasks.m_strLabel2File;
+      ar << details.m_labelMasks.m_strLabel2Folder;
+    }
+
+    ar << m_content;
+  }
+  else
+  {
     int tempint;
     ar >> (int&)tempint;
     m_sortMethod = SORT_METHOD(tempint);
@@ -2045,15 +2128,6 @@ void CFileItemList::Archive(CArchive& ar)
     }
 
     ar >> m_content;
-
-    for (int i = 0; i < iSize; ++i)
-    {
-      CFileItemPtr pItem(new CFileItem);
-      ar >> *pItem;
-      Add(pItem);
-    }
-
-    SetFastLookup(fastLookup);
   }
 }
 
@@ -2596,15 +2670,9 @@ void CFileItemList::StackFiles()
 
 bool CFileItemList::Load(int windowID)
 {
-  CFile file;
-  if (file.Open(GetDiscFileCache(windowID)))
+  if (CFileItemListCache::Load(*this, GetDiscFileCache(windowID)))
   {
-    CLog::Log(LOGDEBUG,"Loading fileitems [%s]",GetPath().c_str());
-    CArchive ar(&file, CArchive::load);
-    ar >> *this;
     CLog::Log(LOGDEBUG,"  -- items: %i, directory: %s sort method: %i, ascending: %s",Size(),GetPath().c_str(), m_sortMethod, m_sortOrder ? "true" : "false");
-    ar.Close();
-    file.Close();
     return true;
   }
 
@@ -2619,14 +2687,9 @@ bool CFileItemList::Save(int windowID)
 
   CLog::Log(LOGDEBUG,"Saving fileitems [%s]",GetPath().c_str());
 
-  CFile file;
-  if (file.OpenForWrite(GetDiscFileCache(windowID), true)) // overwrite always
+  if (CFileItemListCache::Save(*this, GetDiscFileCache(windowID)))
   {
-    CArchive ar(&file, CArchive::store);
-    ar << *this;
     CLog::Log(LOGDEBUG,"  -- items: %i, sort method: %i, ascending: %s",iSize,m_sortMethod, m_sortOrder ? "true" : "false");
-    ar.Close();
-    file.Close();
     return true;
   }
 
@@ -2641,6 +2704,9 @@ void CFileItemList::RemoveDiscCache(int windowID) const
     CLog::Log(LOGDEBUG,"Clearing cached fileitems [%s]",GetPath().c_str());
     CFile::Delete(cacheFile);
   }
+  // plugins keep their listings in memory too
+  if (IsPlugin())
+    XFILE::CPluginDirectory::ClearCachedResult(GetPath());
 }
 
 CStdString CFileItemList::GetDiscFileCache(int windowID) const
@@ -2667,6 +2733,34 @@ CStdString CFileItemList::GetDiscFileCache(int windowID) const
   return cacheFile;
 }
 
+// the memory usage is logged once a minute at most, it walks every item of the list
+#define MEMORY_USAGE_LOG_INTERVAL 60000
+
+void CFileItemList::LogMemoryUsage() const
+{
+  static CCriticalSection logSection;
+  static XbmcThreads::EndTime nextLog;
+  {
+    CSingleLock logLock(logSection);
+    if (!nextLog.IsTimePast())
+      return;
+    nextLog.Set(MEMORY_USAGE_LOG_INTERVAL);
+  }
+
+  CSingleLock lock(m_lock);
+
+  CMemoryUsage usage;
+  size_t properties = 0, tags = 0;
+  usage.Add(m_items.capacity() * sizeof(CFileItemPtr));
+  for (unsigned int i = 0; i < m_items.size(); i++)
+    m_items[i]->GetMemoryUsage(usage, properties, tags);
+
+  CLog::Log(LOGDEBUG, "%s - %s: %u items use %u kB, %u bytes per item, of which %u kB properties and %u kB info tags, %u kB saved by shared strings",
+            __FUNCTION__, GetPath().c_str(), (unsigned int)m_items.size(), (unsigned int)(usage.GetBytes() / 1024),
+            m_items.empty() ? 0 : (unsigned int)(usage.GetBytes() / m_items.size()),
+            (unsigned int)(properties / 1024), (unsigned int)(tags / 1024), (unsigned int)(usage.GetSharedBytes() / 1024));
+}
+
 bool CFileItemList::AlwaysCache() const
 {
   // some database folders are always cached
@@ -2716,7 +2810,7 @@ CStdString CFileItem::GetPreviouslyCachedMusicThumb() const
   // could be any file with tags loaded or
   // a directory in album window
   CStdString strAlbum, strArtist;
-  if (HasMusicInfoTag() && m_musicInfoTag->Loaded())
+  if (HasMusicInfoTag() && GetMusicInfoTag()->Loaded())
   {
     strAlbum = m_musicInfoTag->GetAlbum();
     if (!m_musicInfoTag->GetAlbumArtist().empty())
@@ -3190,7 +3284,7 @@ bool CFileItem::LoadMusicTag()
   if (!IsAudio())
     return false;
   // already loaded?
-  if (HasMusicInfoTag() && m_musicInfoTag->Loaded())
+  if (HasMusicInfoTag() && GetMusicInfoTag()->Loaded())
     return true;
   // check db
   CMusicDatabase musicDatabase;
@@ -3294,6 +3388,8 @@ void CFileItemList::ClearSortState()
 
 CVideoInfoTag* CFileItem::GetVideoInfoTag()
 {
+  if (m_bLazyTags)
+    DecodeLazyTags();
   if (!m_videoInfoTag)
     m_videoInfoTag = new CVideoInfoTag;
 
@@ -3334,6 +3430,8 @@ CPVRTimerInfoTag* CFileItem::GetPVRTimerInfoTag()
 
 CPictureInfoTag* CFileItem::GetPictureInfoTag()
 {
+  if (m_bLazyTags)
+    DecodeLazyTags();
   if (!m_pictureInfoTag)
     m_pictureInfoTag = new CPictureInfoTag;
 
@@ -3342,12 +3440,58 @@ CPictureInfoTag* CFileItem::GetPictureInfoTag()
 
 MUSIC_INFO::CMusicInfoTag* CFileItem::GetMusicInfoTag()
 {
+  if (m_bLazyTags)
+    DecodeLazyTags();
   if (!m_musicInfoTag)
     m_musicInfoTag = new MUSIC_INFO::CMusicInfoTag;
 
   return m_musicInfoTag;
 }
 
+bool CFileItem::HasLazyTag(unsigned int type) const
+{
+  CSingleLock lock(m_lazyTagsSection);
+  if (m_lazyTags && (m_lazyTags->types & type))
+    return true;
+  switch (type)
+  {
+  case MUSIC_TAG:   return m_musicInfoTag != NULL;
+  case VIDEO_TAG:   return m_videoInfoTag != NULL;
+  case PICTURE_TAG: return m_pictureInfoTag != NULL;
+  }
+  return false;
+}
+
+void CFileItem::DecodeLazyTags() const
+{
+  // tags are decoded at most once, readers wait here rather than seeing half decoded tags
+  CSingleLock lock(m_lazyTagsSection);
+  boost::shared_ptr<CFileItemLazyTags> tags;
+  tags.swap(m_lazyTags);
+  if (!tags)
+    return;
+
+  CArchive ar(tags->data->GetData() + tags->offset, tags->length);
+  if (tags->types & MUSIC_TAG)
+  {
+    if (!m_musicInfoTag)
+      m_musicInfoTag = new MUSIC_INFO::CMusicInfoTag;
+    ar >> *m_musicInfoTag;
+  }
+  if (tags->types & VIDEO_TAG)
+  {
+    if (!m_videoInfoTag)
+      m_videoInfoTag = new CVideoInfoTag;
+    ar >> *m_videoInfoTag;
+  }
+  if (tags->types & PICTURE_TAG)
+  {
+    if (!m_pictureInfoTag)
+      m_pictureInfoTag = new CPictureInfoTag;
+    ar >> *m_pictureInfoTag;
+  }
+}
+
 CStdString CFileItem::FindTrailer() const
 {
   CStdString strFile2;
@@ -53,6 +53,8 @@ namespace PVR
   class CPVRTimerInfoTag;
 }
 class CPictureInfoTag;
+class CFileItemLazyTags;
+class CMemoryUsage;
 
 class CAlbum;
 class CArtist;
@@ -102,6 +104,13 @@ public:
   virtual void Serialize(CVariant& value);
   virtual bool IsFileItem() const { return true; };
 
+  /*! \brief Account for the heap memory used by the item
+   \param usage the memory used so far
+   \param propertyBytes increased by the part of it used by properties
+   \param tagBytes increased by the part of it used by info tags
+   */
+  void GetMemoryUsage(CMemoryUsage &usage, size_t &propertyBytes, size_t &tagBytes) const;
+
   bool Exists(bool bUseCache = true) const;
   bool IsVideo() const;
   bool IsDiscStub() const;
@@ -184,6 +193,8 @@ public:
 
   inline bool HasMusicInfoTag() const
   {
+    if (m_bLazyTags)
+      return HasLazyTag(MUSIC_TAG);
     return m_musicInfoTag != NULL;
   }
 
@@ -191,11 +202,15 @@ public:
 
   inline const MUSIC_INFO::CMusicInfoTag* GetMusicInfoTag() const
   {
+    if (m_bLazyTags)
+      DecodeLazyTags();
     return m_musicInfoTag;
   }
 
   inline bool HasVideoInfoTag() const
   {
+    if (m_bLazyTags)
+      return HasLazyTag(VIDEO_TAG);
     return m_videoInfoTag != NULL;
   }
 
@@ -203,6 +218,8 @@ public:
 
   inline const CVideoInfoTag* GetVideoInfoTag() const
   {
+    if (m_bLazyTags)
+      DecodeLazyTags();
     return m_videoInfoTag;
   }
 
@@ -256,11 +273,15 @@ public:
 
   inline bool HasPictureInfoTag() const
   {
+    if (m_bLazyTags)
+      return HasLazyTag(PICTURE_TAG);
     return m_pictureInfoTag != NULL;
   }
 
   inline const CPictureInfoTag* GetPictureInfoTag() const
   {
+    if (m_bLazyTags)
+      DecodeLazyTags();
     return m_pictureInfoTag;
   }
 
@@ -391,14 +412,29 @@ private:
   bool m_bLabelPreformated;
   CStdString m_mimetype;
   CStdString m_extrainfo;
-  MUSIC_INFO::CMusicInfoTag* m_musicInfoTag;
-  CVideoInfoTag* m_videoInfoTag;
+  mutable MUSIC_INFO::CMusicInfoTag* m_musicInfoTag;
+  mutable CVideoInfoTag* m_videoInfoTag;
   EPG::CEpgInfoTag* m_epgInfoTag;
   PVR::CPVRChannel* m_pvrChannelInfoTag;
   PVR::CPVRRecording* m_pvrRecordingInfoTag;
   PVR::CPVRTimerInfoTag * m_pvrTimerInfoTag;
-  CPictureInfoTag* m_pictureInfoTag;
+  mutable CPictureInfoTag* m_pictureInfoTag;
   bool m_bIsAlbum;
+
+  /*! \brief Music, video and picture tags of an item loaded from the disc cache, decoded on first access.
+   Shared by copies of the item, and only set while all three tag pointers are NULL.
+   The item may be read by the thumb and info loaders while the GUI reads it too, so
+   m_lazyTags and the tag pointers it's decoded into are only touched under m_lazyTagsSection
+   while m_bLazyTags is set. m_bLazyTags itself only changes when the item is written.
+   */
+  mutable boost::shared_ptr<CFileItemLazyTags> m_lazyTags;
+  bool m_bLazyTags;
+  static CCriticalSection m_lazyTagsSection;
+  enum { MUSIC_TAG = 1, VIDEO_TAG = 2, PICTURE_TAG = 4 };
+  bool HasLazyTag(unsigned int type) const;
+  void DecodeLazyTags() const;
+
+  friend class CFileItemListCache;
 };
 
 /*!
@@ -534,6 +570,9 @@ public:
   void RemoveDiscCache(int windowID = 0) const;
   bool AlwaysCache() const;
 
+  /*! \brief Log how much memory the items of the list use, and how it is spent, once a minute at most */
+  void LogMemoryUsage() const;
+
   void SetCachedMusicThumbs();
 
   void Swap(unsigned int item1, unsigned int item2);
@@ -566,6 +605,9 @@ private:
   void FillSortFields(FILEITEMFILLFUNC func);
   CStdString GetDiscFileCache(int windowID) const;
 
+  /*! \brief Archive the sort state and content of the list, without the items */
+  void ArchiveListState(CArchive& ar);
+
   /*!
    \brief stack files in a CFileItemList
    \sa Stack
@@ -591,4 +633,6 @@ private:
   std::vector<SORT_METHOD_DETAILS> m_sortDetails;
 
   CCriticalSection m_lock;
+
+  friend class CFileItemListCache;
 };
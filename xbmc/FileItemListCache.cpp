@@ -0,0 +1,587 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "FileItemListCache.h"
+#include "FileItem.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "music/tags/MusicInfoTag.h"
+#include "pictures/PictureInfoTag.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "utils/Archive.h"
+#include "utils/CharsetConverter.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
+#include "utils/log.h"
+#include "video/VideoInfoTag.h"
+#include <map>
+#include <vector>
+
+#if defined(TARGET_POSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace XFILE;
+
+#define CACHE_MAGIC   "XBFI"
+#define CACHE_VERSION 1
+
+namespace
+{
+  struct CacheHeader
+  {
+    char     magic[4];
+    uint32_t version;
+    uint32_t items;
+    uint32_t listOffset;    // archived fields of the list itself
+    uint32_t listLength;
+    uint32_t stringsOffset; // offsets of the strings into the characters, one more than there are strings
+    uint32_t strings;
+    uint32_t charsOffset;
+    uint32_t charsLength;
+    uint32_t recordsOffset; // a CacheRecord per item
+    uint32_t blobOffset;    // archived remaining fields and info tags of the items
+    uint32_t blobLength;
+  };
+
+  struct CacheRecord
+  {
+    uint32_t path;          // indices into the string table
+    uint32_t label;
+    uint32_t label2;
+    uint32_t thumb;
+    uint32_t icon;
+    uint32_t flags;
+    int64_t  size;
+    uint32_t fieldsOffset;  // offsets into the blob
+    uint32_t fieldsLength;
+    uint32_t tagsOffset;
+    uint32_t tagsLength;
+    uint32_t tagTypes;
+    uint32_t reserved;
+  };
+
+  enum RecordFlags
+  {
+    FLAG_FOLDER             = 1 << 0,
+    FLAG_PARENT_FOLDER      = 1 << 1,
+    FLAG_LABEL_PREFORMATTED = 1 << 2,
+    FLAG_SHARE_OR_DRIVE     = 1 << 3,
+    FLAG_SELECTED           = 1 << 4,
+    FLAG_CAN_QUEUE          = 1 << 5,
+    FLAG_ALBUM              = 1 << 6,
+    FLAG_SORT_LABEL         = 1 << 7  // sort label differs from the label, and is archived
+  };
+
+  class CStringTableWriter
+  {
+  public:
+    CStringTableWriter()
+    {
+      Add("");
+    }
+
+    uint32_t Add(const string &str)
+    {
+      map<string, uint32_t>::const_iterator it = m_index.find(str);
+      if (it != m_index.end())
+        return it->second;
+
+      uint32_t index = m_offsets.size();
+      m_offsets.push_back(m_chars.size());
+      m_chars += str;
+      m_index.insert(make_pair(str, index));
+      return index;
+    }
+
+    uint32_t Size() const { return m_offsets.size(); }
+
+    void WriteOffsets(string &out) const
+    {
+      out.append((const char *)&m_offsets[0], m_offsets.size() * sizeof(uint32_t));
+      uint32_t end = m_chars.size();
+      out.append((const char *)&end, sizeof(end));
+    }
+
+    const string &GetChars() const { return m_chars; }
+
+  private:
+    map<string, uint32_t> m_index;
+    vector<uint32_t>      m_offsets;
+    string                m_chars;
+  };
+
+  class CStringTableReader
+  {
+  public:
+    CStringTableReader(const uint8_t *offsets, uint32_t strings, const uint8_t *chars, uint32_t length)
+      : m_offsets(offsets), m_strings(strings), m_chars((const char *)chars), m_length(length) {}
+
+    bool Get(uint32_t index, CStdString &str) const
+    {
+      if (index >= m_strings)
+        return false;
+
+      uint32_t range[2];
+      memcpy(range, m_offsets + index * sizeof(uint32_t), sizeof(range));
+      if (range[0] > range[1] || range[1] > m_length)
+        return false;
+
+      str.assign(m_chars + range[0], range[1] - range[0]);
+      return true;
+    }
+
+  private:
+    const uint8_t *m_offsets;
+    uint32_t       m_strings;
+    const char    *m_chars;
+    uint32_t       m_length;
+  };
+
+  bool InRange(uint64_t offset, uint64_t length, uint64_t size)
+  {
+    return offset + length <= size;
+  }
+
+  void Align(string &out)
+  {
+    out.append((8 - out.size() % 8) % 8, '\0');
+  }
+
+  bool WriteFile(const CStdString &file, const void *data, unsigned int size)
+  {
+    // the current file may be mapped by items that are still around, so
+    // never write to it in place but swap a new one in
+    CStdString temp = file + ".tmp";
+    CFile out;
+    if (!out.OpenForWrite(temp, true))
+      return false;
+
+    bool written = out.Write(data, size) == (int)size;
+    out.Close();
+
+    if (written)
+    {
+      CFile::Delete(file);
+      written = CFile::Rename(temp, file);
+    }
+    if (!written)
+      CFile::Delete(temp);
+    return written;
+  }
+}
+
+CFileItemListCacheData::CFileItemListCacheData()
+{
+  m_data   = NULL;
+  m_size   = 0;
+  m_mapped = false;
+}
+
+CFileItemListCacheData::~CFileItemListCacheData()
+{
+#if defined(TARGET_POSIX)
+  if (m_mapped)
+  {
+    munmap(m_data, m_size);
+    return;
+  }
+#endif
+  delete[] m_data;
+}
+
+CFileItemListCacheDataPtr CFileItemListCacheData::Open(const CStdString &file)
+{
+  CFileItemListCacheDataPtr data(new CFileItemListCacheData);
+
+#if defined(TARGET_POSIX)
+  int fd = open(CSpecialProtocol::TranslatePath(file).c_str(), O_RDONLY);
+  if (fd >= 0)
+  {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0 && st.st_size < 0x7fffffff)
+    {
+      void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map != MAP_FAILED)
+      {
+        data->m_data   = (uint8_t *)map;
+        data->m_size   = (unsigned int)st.st_size;
+        data->m_mapped = true;
+      }
+    }
+    close(fd);
+    if (data->m_mapped)
+      return data;
+  }
+#endif
+
+  CFile in;
+  if (!in.Open(file))
+    return CFileItemListCacheDataPtr();
+
+  int64_t length = in.GetLength();
+  if (length <= 0 || length >= 0x7fffffff)
+    return CFileItemListCacheDataPtr();
+
+  data->m_data = new uint8_t[(size_t)length];
+  data->m_size = (unsigned int)length;
+  if (in.Read(data->m_data, length) != length)
+    return CFileItemListCacheDataPtr();
+
+  return data;
+}
+
+bool CFileItemListCache::Save(CFileItemList &items, const CStdString &file)
+{
+  CSingleLock lock(items.m_lock);
+
+  if (!g_advancedSettings.m_compactFileItemCache)
+  {
+    string archived;
+    CArchive ar(archived);
+    ar << items;
+    ar.Close();
+    return WriteFile(file, archived.c_str(), archived.size());
+  }
+
+  string list;
+  {
+    CArchive ar(list);
+    items.CFileItem::Archive(ar);
+    ar << items.m_fastLookup;
+    items.ArchiveListState(ar);
+  }
+
+  // the parent folder item is never stored, the list keeps its own on load
+  unsigned int first = 0;
+  if (!items.m_items.empty() && items.m_items[0]->IsParentFolder())
+    first = 1;
+
+  CStringTableWriter strings;
+  vector<CacheRecord> records;
+  records.reserve(items.m_items.size() - first);
+  string blob;
+  CArchive ar(blob);
+
+  for (unsigned int i = first; i < items.m_items.size(); ++i)
+  {
+    CFileItem &item = *items.m_items[i];
+
+    CacheRecord record;
+    memset(&record, 0, sizeof(record));
+    record.path   = strings.Add(item.m_strPath);
+    record.label  = strings.Add(item.GetLabel());
+    record.label2 = strings.Add(item.m_strLabel2);
+    record.thumb  = strings.Add(item.m_strThumbnailImage);
+    record.icon   = strings.Add(item.m_strIcon);
+    record.size   = item.m_dwSize;
+
+    if (item.m_bIsFolder)         record.flags |= FLAG_FOLDER;
+    if (item.m_bIsParentFolder)   record.flags |= FLAG_PARENT_FOLDER;
+    if (item.m_bLabelPreformated) record.flags |= FLAG_LABEL_PREFORMATTED;
+    if (item.m_bIsShareOrDrive)   record.flags |= FLAG_SHARE_OR_DRIVE;
+    if (item.m_bSelected)         record.flags |= FLAG_SELECTED;
+    if (item.m_bCanQueue)         record.flags |= FLAG_CAN_QUEUE;
+    if (item.m_bIsAlbum)          record.flags |= FLAG_ALBUM;
+
+    CStdString sortLabel;
+    g_charsetConverter.wToUTF8(item.GetSortLabel(), sortLabel);
+    if (sortLabel != item.GetLabel())
+      record.flags |= FLAG_SORT_LABEL;
+
+    record.fieldsOffset = blob.size();
+    if (record.flags & FLAG_SORT_LABEL)
+      ar << sortLabel;
+    ar << (int)item.m_overlayIcon;
+    ar << item.m_iDriveType;
+    ar << item.m_dateTime;
+    ar << item.m_strDVDLabel;
+    ar << item.m_strTitle;
+    ar << item.m_iprogramCount;
+    ar << item.m_idepth;
+    ar << item.m_lStartOffset;
+    ar << item.m_lEndOffset;
+    ar << (int)item.m_iLockMode;
+    ar << item.m_strLockCode;
+    ar << item.m_iBadPwdCount;
+    ar << item.m_mimetype;
+    ar << item.m_extrainfo;
+    ar << (int)item.m_specialSort;
+    ar << (int)item.m_mapProperties.size();
+    for (CGUIListItem::PropertyMap::const_iterator it = item.m_mapProperties.begin(); it != item.m_mapProperties.end(); ++it)
+    {
+      ar << it->first;
+      ar << it->second;
+    }
+    ar.Close();
+    record.fieldsLength = blob.size() - record.fieldsOffset;
+
+    record.tagsOffset = blob.size();
+    CSingleLock lazyLock(CFileItem::m_lazyTagsSection);
+    if (!item.m_bLazyTags)
+      lazyLock.Leave();
+    if (item.m_lazyTags)
+    {
+      // still as they were loaded, no need to decode them
+      const CFileItemLazyTags &tags = *item.m_lazyTags;
+      blob.append((const char *)tags.data->GetData() + tags.offset, tags.length);
+      record.tagTypes = tags.types;
+    }
+    else
+    {
+      if (item.m_musicInfoTag)
+      {
+        ar << *item.m_musicInfoTag;
+        record.tagTypes |= CFileItem::MUSIC_TAG;
+      }
+      if (item.m_videoInfoTag)
+      {
+        ar << *item.m_videoInfoTag;
+        record.tagTypes |= CFileItem::VIDEO_TAG;
+      }
+      if (item.m_pictureInfoTag)
+      {
+        ar << *item.m_pictureInfoTag;
+        record.tagTypes |= CFileItem::PICTURE_TAG;
+      }
+      ar.Close();
+    }
+    lazyLock.Leave();
+    record.tagsLength = blob.size() - record.tagsOffset;
+
+    records.push_back(record);
+  }
+
+  CacheHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+  header.version = CACHE_VERSION;
+  header.items   = records.size();
+  header.strings = strings.Size();
+
+  string out((const char *)&header, sizeof(header));
+  header.listOffset = out.size();
+  header.listLength = list.size();
+  out += list;
+  Align(out);
+  header.stringsOffset = out.size();
+  strings.WriteOffsets(out);
+  header.charsOffset = out.size();
+  header.charsLength = strings.GetChars().size();
+  out += strings.GetChars();
+  Align(out);
+  header.recordsOffset = out.size();
+  if (!records.empty())
+    out.append((const char *)&records[0], records.size() * sizeof(CacheRecord));
+  header.blobOffset = out.size();
+  header.blobLength = blob.size();
+  out += blob;
+  out.replace(0, sizeof(header), (const char *)&header, sizeof(header));
+
+  return WriteFile(file, out.c_str(), out.size());
+}
+
+bool CFileItemListCache::Load(CFileItemList &items, const CStdString &file)
+{
+  int64_t start = CurrentHostCounter();
+
+  CFile in;
+  if (!in.Open(file))
+    return false;
+
+  CLog::Log(LOGDEBUG,"Loading fileitems [%s]",items.GetPath().c_str());
+
+  char magic[4];
+  bool compact = in.Read(magic, sizeof(magic)) == sizeof(magic) && memcmp(magic, CACHE_MAGIC, sizeof(magic)) == 0;
+
+  bool loaded = false;
+  bool mapped = false;
+  if (compact)
+  {
+    in.Close();
+    CFileItemListCacheDataPtr data = CFileItemListCacheData::Open(file);
+    if (data)
+    {
+      mapped = data->IsMapped();
+      loaded = LoadCompact(items, data);
+    }
+  }
+  else
+  {
+    in.Seek(0, SEEK_SET);
+    CArchive ar(&in, CArchive::load);
+    ar >> items;
+    ar.Close();
+    in.Close();
+    loaded = true;
+  }
+
+  int64_t elapsed = (CurrentHostCounter() - start) * 1000000 / CurrentHostFrequency();
+  CLog::Log(LOGDEBUG, "%s - %s %i items from %s in %s format in %"PRId64" us", __FUNCTION__,
+            loaded ? "loaded" : "failed to load", items.Size(), file.c_str(),
+            compact ? (mapped ? "mapped compact" : "compact") : "archive", elapsed);
+  return loaded;
+}
+
+bool CFileItemListCache::LoadCompact(CFileItemList &items, const CFileItemListCacheDataPtr &data)
+{
+  const uint8_t *base = data->GetData();
+  uint64_t size = data->GetSize();
+
+  CacheHeader header;
+  if (size < sizeof(header))
+    return false;
+  memcpy(&header, base, sizeof(header));
+
+  if (header.version != CACHE_VERSION)
+  {
+    CLog::Log(LOGDEBUG, "%s - ignoring cache of version %u", __FUNCTION__, header.version);
+    return false;
+  }
+
+  if (header.strings == 0 ||
+      !InRange(header.listOffset, header.listLength, size) ||
+      !InRange(header.stringsOffset, ((uint64_t)header.strings + 1) * sizeof(uint32_t), size) ||
+      !InRange(header.charsOffset, header.charsLength, size) ||
+      !InRange(header.recordsOffset, (uint64_t)header.items * sizeof(CacheRecord), size) ||
+      !InRange(header.blobOffset, header.blobLength, size))
+  {
+    CLog::Log(LOGERROR, "%s - corrupt cache for %s", __FUNCTION__, items.GetPath().c_str());
+    return false;
+  }
+
+  CStringTableReader strings(base + header.stringsOffset, header.strings, base + header.charsOffset, header.charsLength);
+  const uint8_t *blob = base + header.blobOffset;
+
+  CSingleLock lock(items.m_lock);
+
+  CFileItemPtr parent;
+  if (!items.IsEmpty() && items.m_items[0]->IsParentFolder())
+    parent.reset(new CFileItem(*items.m_items[0]));
+
+  items.SetFastLookup(false);
+  items.Clear();
+
+  bool fastLookup = false;
+  {
+    CArchive ar(base + header.listOffset, header.listLength);
+    items.CFileItem::Archive(ar);
+    ar >> fastLookup;
+    items.ArchiveListState(ar);
+  }
+
+  items.m_items.reserve(header.items + (parent ? 1 : 0));
+  if (parent)
+    items.m_items.push_back(parent);
+
+  for (uint32_t i = 0; i < header.items; ++i)
+  {
+    CacheRecord record;
+    memcpy(&record, base + header.recordsOffset + i * sizeof(CacheRecord), sizeof(record));
+
+    CFileItemPtr item(new CFileItem);
+    CStdString label;
+    if (!InRange(record.fieldsOffset, record.fieldsLength, header.blobLength) ||
+        !InRange(record.tagsOffset, record.tagsLength, header.blobLength) ||
+        !strings.Get(record.path, item->m_strPath) ||
+        !strings.Get(record.label, label) ||
+        !strings.Get(record.label2, item->m_strLabel2) ||
+        !strings.Get(record.thumb, item->m_strThumbnailImage) ||
+        !strings.Get(record.icon, item->m_strIcon))
+    {
+      CLog::Log(LOGERROR, "%s - corrupt item %u in cache for %s", __FUNCTION__, i, items.GetPath().c_str());
+      items.Clear();
+      return false;
+    }
+
+    item->SetLabel(label);
+    item->m_dwSize            = record.size;
+    item->m_bIsFolder         = (record.flags & FLAG_FOLDER) != 0;
+    item->m_bIsParentFolder   = (record.flags & FLAG_PARENT_FOLDER) != 0;
+    item->m_bLabelPreformated = (record.flags & FLAG_LABEL_PREFORMATTED) != 0;
+    item->m_bIsShareOrDrive   = (record.flags & FLAG_SHARE_OR_DRIVE) != 0;
+    item->m_bSelected         = (record.flags & FLAG_SELECTED) != 0;
+    item->m_bCanQueue         = (record.flags & FLAG_CAN_QUEUE) != 0;
+    item->m_bIsAlbum          = (record.flags & FLAG_ALBUM) != 0;
+
+    CArchive ar(blob + record.fieldsOffset, record.fieldsLength);
+    if (record.flags & FLAG_SORT_LABEL)
+    {
+      CStdString sortLabel;
+      ar >> sortLabel;
+      item->SetSortLabel(sortLabel);
+    }
+    int temp;
+    ar >> temp;
+    item->m_overlayIcon = CGUIListItem::GUIIconOverlay(temp);
+    ar >> item->m_iDriveType;
+    ar >> item->m_dateTime;
+    ar >> item->m_strDVDLabel;
+    ar >> item->m_strTitle;
+    ar >> item->m_iprogramCount;
+    ar >> item->m_idepth;
+    ar >> item->m_lStartOffset;
+    ar >> item->m_lEndOffset;
+    ar >> temp;
+    item->m_iLockMode = (LockType)temp;
+    ar >> item->m_strLockCode;
+    ar >> item->m_iBadPwdCount;
+    ar >> item->m_mimetype;
+    ar >> item->m_extrainfo;
+    ar >> temp;
+    item->m_specialSort = (SPECIAL_SORT)temp;
+
+    int properties = 0;
+    ar >> properties;
+    if (properties < 0 || (uint32_t)properties > record.fieldsLength)
+      properties = 0;
+    for (int j = 0; j < properties; j++)
+    {
+      CStdString key;
+      CVariant value;
+      ar >> key;
+      ar >> value;
+      item->SetProperty(key, value);
+    }
+
+    if (record.tagTypes)
+    {
+      CFileItemLazyTags *tags = new CFileItemLazyTags;
+      tags->data   = data;
+      tags->offset = header.blobOffset + record.tagsOffset;
+      tags->length = record.tagsLength;
+      tags->types  = record.tagTypes;
+      item->m_lazyTags.reset(tags);
+      item->m_bLazyTags = true;
+    }
+
+    item->SetInvalid();
+    items.m_items.push_back(item);
+  }
+
+  items.SetFastLookup(fastLookup);
+  return true;
+}
@@ -0,0 +1,99 @@
+#pragma once
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/StdString.h"
+#include "boost/shared_ptr.hpp"
+
+class CFileItem;
+class CFileItemList;
+
+/*!
+ \brief Contents of a disc cache file, either memory mapped or read in one go
+ */
+class CFileItemListCacheData
+{
+public:
+  ~CFileItemListCacheData();
+
+  static boost::shared_ptr<CFileItemListCacheData> Open(const CStdString &file);
+
+  const uint8_t *GetData() const { return m_data; }
+  unsigned int GetSize() const { return m_size; }
+  bool IsMapped() const { return m_mapped; }
+
+private:
+  CFileItemListCacheData();
+
+  uint8_t     *m_data;
+  unsigned int m_size;
+  bool         m_mapped;
+};
+
+typedef boost::shared_ptr<CFileItemListCacheData> CFileItemListCacheDataPtr;
+
+/*!
+ \brief Info tags of an item loaded from a disc cache file, not decoded yet
+ \sa CFileItem::DecodeLazyTags
+ */
+class CFileItemLazyTags
+{
+public:
+  CFileItemListCacheDataPtr data;
+  unsigned int offset;
+  unsigned int length;
+  unsigned int types; ///< CFileItem::MUSIC_TAG, VIDEO_TAG and PICTURE_TAG flags
+};
+
+/*!
+ \brief Compact on-disc format of CFileItemList
+
+ A versioned file made of a string table shared by all items, a fixed width
+ record per item with its most used fields, and a blob with the remaining
+ fields and info tags of the items. The file is memory mapped where possible
+ and the info tags are only decoded when an item's tags are first accessed,
+ which most items of a long listing never are.
+
+ Files that don't start with the compact header are loaded through the
+ CArchive serialization of CFileItemList instead.
+ */
+class CFileItemListCache
+{
+public:
+  /*!
+   \brief Store a list in the compact format
+   \param items the list to store
+   \param file the cache file to write, it is replaced atomically
+   \return true if the file was written
+   */
+  static bool Save(CFileItemList &items, const CStdString &file);
+
+  /*!
+   \brief Load a list from a cache file in either format
+   \param items the list to fill
+   \param file the cache file to read
+   \return true if the list was loaded
+   */
+  static bool Load(CFileItemList &items, const CStdString &file);
+
+private:
+  static bool LoadCompact(CFileItemList &items, const CFileItemListCacheDataPtr &data);
+};
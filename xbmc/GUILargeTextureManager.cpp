@@ -32,13 +32,17 @@
 #include "utils/log.h"
 #include "TextureCache.h"
 #include "TextureCacheJob.h"
+#include "utils/URIUtils.h"
 
 using namespace std;
 
 
-CImageLoader::CImageLoader(const CStdString &path)
+CImageLoader::CImageLoader(const CStdString &path, unsigned int width, unsigned int height)
 {
   m_path = path;
+  m_width = width;
+  m_height = height;
+  m_tier = false;
   m_texture = NULL;
 }
 
@@ -52,7 +56,7 @@ bool CImageLoader::DoWork()
   bool needsChecking = false;
 
   CStdString texturePath = g_TextureManager.GetTexturePath(m_path);
-  CStdString loadPath = CTextureCache::Get().CheckCachedImage(texturePath, true, needsChecking); 
+  CStdString loadPath = CTextureCache::Get().CheckCachedImage(texturePath, true, needsChecking, m_width, m_height, &m_tier);
 
   if (loadPath.IsEmpty())
   {
@@ -63,10 +67,23 @@ bool CImageLoader::DoWork()
   }
   if (!loadPath.IsEmpty())
   {
+    // the image may have been released while waiting, don't decode it for nothing
+    if (ShouldCancel(0, 1))
+      return false;
+
     // direct route - load the image
     m_texture = new CTexture();
     unsigned int start = XbmcThreads::SystemClockMillis();
-    if (!m_texture->LoadFromFile(loadPath, g_graphicsContext.GetWidth(), g_graphicsContext.GetHeight(), g_guiSettings.GetBool("pictures.useexifrotation")))
+    // jpegs are scaled while decoding to the smallest size that covers the one asked for,
+    // other formats only fit within it so get the screen size as before
+    unsigned int width = g_graphicsContext.GetWidth();
+    unsigned int height = g_graphicsContext.GetHeight();
+    if (m_width && m_height && URIUtils::GetExtension(loadPath).Equals(".jpg"))
+    {
+      width = m_width;
+      height = m_height;
+    }
+    if (!m_texture->LoadFromFile(loadPath, width, height, g_guiSettings.GetBool("pictures.useexifrotation")))
     {
       delete m_texture;
       m_texture = NULL;
@@ -81,9 +98,11 @@ bool CImageLoader::DoWork()
   return true;
 }
 
-CGUILargeTextureManager::CLargeTexture::CLargeTexture(const CStdString &path)
+CGUILargeTextureManager::CLargeTexture::CLargeTexture(const CStdString &path, unsigned int width, unsigned int height)
 {
   m_path = path;
+  m_width = width;
+  m_height = height;
   m_refCount = 1;
   m_timeToDelete = 0;
 }
@@ -133,6 +152,16 @@ void CGUILargeTextureManager::CLargeTexture::SetTexture(CBaseTexture* texture)
 
 CGUILargeTextureManager::CGUILargeTextureManager()
 {
+  m_statsTime = 0;
+  m_statsImages = 0;
+  m_statsTiers = 0;
+  m_statsBytes = 0;
+  m_statsFrame = 0;
+  m_statsFrameBytes = 0;
+  m_statsPeakBytes = 0;
+  m_statsLatency = 0;
+  m_statsMaxLatency = 0;
+  m_statsCancelled = 0;
 }
 
 CGUILargeTextureManager::~CGUILargeTextureManager()
@@ -156,13 +185,15 @@ void CGUILargeTextureManager::CleanupUnusedImages(bool immediately)
 
 // if available, increment reference count, and return the image.
 // else, add to the queue list if appropriate.
-bool CGUILargeTextureManager::GetImage(const CStdString &path, CTextureArray &texture, bool firstRequest)
+bool CGUILargeTextureManager::GetImage(const CStdString &path, CTextureArray &texture, bool firstRequest, unsigned int width, unsigned int height)
 {
+  width = RoundSize(width);
+  height = RoundSize(height);
   CSingleLock lock(m_listSection);
   for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
   {
     CLargeTexture *image = *it;
-    if (image->GetPath() == path)
+    if (image->Matches(path, width, height))
     {
       if (firstRequest)
         image->AddRef();
@@ -172,18 +203,26 @@ bool CGUILargeTextureManager::GetImage(const CStdString &path, CTextureArray &te
   }
 
   if (firstRequest)
-    QueueImage(path);
+    QueueImage(path, width, height);
+  else
+  { // still waiting, a control on screen wants it now
+    QueueMap::iterator it = m_queued.find(GetKey(path, width, height));
+    if (it != m_queued.end())
+      it->second.lastWanted = CTimeUtils::GetFrameTime();
+  }
 
   return true;
 }
 
-void CGUILargeTextureManager::ReleaseImage(const CStdString &path, bool immediately)
+void CGUILargeTextureManager::ReleaseImage(const CStdString &path, bool immediately, unsigned int width, unsigned int height)
 {
+  width = RoundSize(width);
+  height = RoundSize(height);
   CSingleLock lock(m_listSection);
   for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
   {
     CLargeTexture *image = *it;
-    if (image->GetPath() == path)
+    if (image->Matches(path, width, height))
     {
       if (image->DecrRef(immediately) && immediately)
         m_allocated.erase(it);
@@ -193,61 +232,142 @@ void CGUILargeTextureManager::ReleaseImage(const CStdString &path, bool immediat
   assert(false);
 }
 
-void CGUILargeTextureManager::ReleaseQueuedImage(const CStdString &path)
+void CGUILargeTextureManager::ReleaseQueuedImage(const CStdString &path, unsigned int width, unsigned int height)
 {
+  width = RoundSize(width);
+  height = RoundSize(height);
   CSingleLock lock(m_listSection);
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
-  {
-    unsigned int id = it->first;
-    CLargeTexture *image = it->second;
-    if (image->GetPath() == path && image->DecrRef(true))
-    {
-      // cancel this job
-      CJobManager::GetInstance().CancelJob(id);
-      m_queued.erase(it);
-      return;
-    }
+  QueueMap::iterator it = m_queued.find(GetKey(path, width, height));
+  if (it == m_queued.end() || !it->second.image->DecrRef(true))
+    return;
+
+  if (it->second.decoding)
+  { // cancel this job
+    CJobManager::GetInstance().CancelJob(it->second.jobID);
+    m_decoding.erase(it->second.jobID);
   }
+  m_queued.erase(it);
+  m_statsCancelled++;
+  DecodeNextImages();
 }
 
 // queue the image, and start the background loader if necessary
-void CGUILargeTextureManager::QueueImage(const CStdString &path)
+void CGUILargeTextureManager::QueueImage(const CStdString &path, unsigned int width, unsigned int height)
 {
   CSingleLock lock(m_listSection);
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+  unsigned int now = CTimeUtils::GetFrameTime();
+  std::string key = GetKey(path, width, height);
+  QueueMap::iterator it = m_queued.find(key);
+  if (it != m_queued.end())
   {
-    CLargeTexture *image = it->second;
-    if (image->GetPath() == path)
-    {
-      image->AddRef();
-      return; // already queued
-    }
+    it->second.image->AddRef();
+    it->second.lastWanted = now;
+    return; // already queued
   }
 
   // queue the item
-  CLargeTexture *image = new CLargeTexture(path);
-  unsigned int jobID = CJobManager::GetInstance().AddJob(new CImageLoader(path), this, CJob::PRIORITY_NORMAL);
-  m_queued.push_back(make_pair(jobID, image));
+  CQueuedImage &queued = m_queued[key];
+  queued.image = new CLargeTexture(path, width, height);
+  queued.queued = XbmcThreads::SystemClockMillis();
+  queued.lastWanted = now;
+  queued.decoding = false;
+  queued.jobID = 0;
+  DecodeNextImages();
+}
+
+void CGUILargeTextureManager::DecodeNextImages()
+{
+  while (m_decoding.size() < MAX_DECODERS)
+  {
+    // the image wanted on screen most recently, or the one waiting longest of those
+    QueueMap::iterator next = m_queued.end();
+    for (QueueMap::iterator it = m_queued.begin(); it != m_queued.end(); ++it)
+    {
+      const CQueuedImage &queued = it->second;
+      if (queued.decoding)
+        continue;
+      if (next == m_queued.end() || queued.lastWanted > next->second.lastWanted ||
+          (queued.lastWanted == next->second.lastWanted && queued.queued < next->second.queued))
+        next = it;
+    }
+    if (next == m_queued.end())
+      return;
+
+    CQueuedImage &queued = next->second;
+    CLargeTexture *image = queued.image;
+    queued.decoding = true;
+    queued.jobID = CJobManager::GetInstance().AddJob(new CImageLoader(image->GetPath(), image->GetWidth(), image->GetHeight()), this, CJob::PRIORITY_NORMAL);
+    m_decoding[queued.jobID] = next->first;
+  }
 }
 
 void CGUILargeTextureManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
 {
   // see if we still have this job id
   CSingleLock lock(m_listSection);
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
-  {
-    if (it->first == jobID)
-    { // found our job
-      CImageLoader *loader = (CImageLoader *)job;
-      CLargeTexture *image = it->second;
-      image->SetTexture(loader->m_texture);
-      loader->m_texture = NULL; // we want to keep the texture, and jobs are auto-deleted.
-      m_queued.erase(it);
-      m_allocated.push_back(image);
-      return;
-    }
+  std::map<unsigned int, std::string>::iterator decoding = m_decoding.find(jobID);
+  if (decoding == m_decoding.end())
+    return;
+
+  QueueMap::iterator it = m_queued.find(decoding->second);
+  m_decoding.erase(decoding);
+  if (it != m_queued.end())
+  { // found our job
+    CImageLoader *loader = (CImageLoader *)job;
+    CLargeTexture *image = it->second.image;
+    UpdateStats(loader, XbmcThreads::SystemClockMillis() - it->second.queued);
+    image->SetTexture(loader->m_texture);
+    loader->m_texture = NULL; // we want to keep the texture, and jobs are auto-deleted.
+    m_queued.erase(it);
+    m_allocated.push_back(image);
   }
+  DecodeNextImages();
+}
+
+std::string CGUILargeTextureManager::GetKey(const CStdString &path, unsigned int width, unsigned int height)
+{
+  CStdString key;
+  key.Format("%ux%u|%s", width, height, path.c_str());
+  return key;
 }
 
+unsigned int CGUILargeTextureManager::RoundSize(unsigned int size)
+{
+  return (size + 63) & ~63;
+}
 
+void CGUILargeTextureManager::UpdateStats(const CImageLoader *loader, unsigned int latency)
+{
+  if (!loader->m_texture)
+    return;
 
+  unsigned int bytes = loader->m_texture->GetWidth() * loader->m_texture->GetHeight() * 4;
+  unsigned int frame = CTimeUtils::GetFrameTime();
+  if (frame != m_statsFrame)
+  {
+    m_statsFrame = frame;
+    m_statsFrameBytes = 0;
+  }
+  m_statsFrameBytes += bytes;
+  m_statsPeakBytes = std::max(m_statsPeakBytes, m_statsFrameBytes);
+  m_statsBytes += bytes;
+  m_statsImages++;
+  if (loader->m_tier)
+    m_statsTiers++;
+  m_statsLatency += latency;
+  m_statsMaxLatency = std::max(m_statsMaxLatency, latency);
+
+  if (frame - m_statsTime >= 60000)
+  {
+    CLog::Log(LOGDEBUG, "%s - decoded %u images (%u of them smaller versions), %u KB, at most %u KB in a frame",
+              __FUNCTION__, m_statsImages, m_statsTiers, (unsigned int)(m_statsBytes / 1024), m_statsPeakBytes / 1024);
+    CLog::Log(LOGDEBUG, "%s - images took %u ms on average and at most %u ms to load, %u were released before they loaded",
+              __FUNCTION__, m_statsLatency / m_statsImages, m_statsMaxLatency, m_statsCancelled);
+    m_statsTime = frame;
+    m_statsImages = m_statsTiers = 0;
+    m_statsBytes = 0;
+    m_statsPeakBytes = 0;
+    m_statsLatency = m_statsMaxLatency = 0;
+    m_statsCancelled = 0;
+  }
+}
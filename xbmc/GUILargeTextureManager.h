@@ -24,6 +24,9 @@
 #include "threads/CriticalSection.h"
 #include "utils/Job.h"
 #include "guilib/TextureManager.h"
+#include <boost/unordered_map.hpp>
+#include <map>
+#include <string>
 
 /*!
  \ingroup textures,jobs
@@ -36,7 +39,7 @@
 class CImageLoader : public CJob
 {
 public:
-  CImageLoader(const CStdString &path);
+  CImageLoader(const CStdString &path, unsigned int width = 0, unsigned int height = 0);
   virtual ~CImageLoader();
 
   /*!
@@ -45,6 +48,9 @@ public:
   virtual bool DoWork();
 
   CStdString    m_path; ///< path of image to load
+  unsigned int  m_width; ///< size the image is shown at, 0 for full size
+  unsigned int  m_height;
+  bool          m_tier; ///< whether a smaller version of the image was loaded
   CBaseTexture *m_texture; ///< Texture object to load the image into \sa CBaseTexture.
 };
 
@@ -55,6 +61,11 @@ public:
  Used to load textures for the user interface asynchronously, allowing fluid framerates
  while background loading textures.
 
+ Images are decoded a few at a time. Of the images waiting, the ones most recently asked for
+ by a control on screen go first, so that while scrolling through a list the images shown
+ now are loaded before those scrolled past. Images released before they are decoded are
+ dropped from the queue.
+
  \sa IJobCallback, CGUITexture
  */
 class CGUILargeTextureManager : public IJobCallback
@@ -79,14 +90,19 @@ public:
    object filled if the texture has been previously loaded, else will return with an empty texture
    object if it is being loaded.
 
+   The width and height the image is shown at let a smaller version of the image be loaded. The
+   same image requested at different sizes may be loaded more than once.
+
    \param path path of the image to load.
    \param texture texture object to hold the resulting texture
    \param orientation orientation of resulting texture
    \param firstRequest true if this is the first time we are requesting this texture
+   \param width width in pixels the image is shown at, 0 for the full image
+   \param height height in pixels the image is shown at, 0 for the full image
    \return true if the image exists, else false.
    \sa CGUITextureArray and CGUITexture
    */
-  bool GetImage(const CStdString &path, CTextureArray &texture, bool firstRequest);
+  bool GetImage(const CStdString &path, CTextureArray &texture, bool firstRequest, unsigned int width = 0, unsigned int height = 0);
 
   /*!
    \brief Request a texture to be unloaded.
@@ -98,9 +114,11 @@ public:
    \param path path of the image to release.
    \param immediately if set true the image is immediately unloaded once its reference count reaches zero
                       rather than being unloaded after a delay.
+   \param width width the image was requested at
+   \param height height the image was requested at
    */
-  void ReleaseImage(const CStdString &path, bool immediately = false);
-  void ReleaseQueuedImage(const CStdString &path);
+  void ReleaseImage(const CStdString &path, bool immediately = false, unsigned int width = 0, unsigned int height = 0);
+  void ReleaseQueuedImage(const CStdString &path, unsigned int width = 0, unsigned int height = 0);
 
   /*!
    \brief Cleanup images that are no longer in use.
@@ -117,7 +135,7 @@ private:
   class CLargeTexture
   {
   public:
-    CLargeTexture(const CStdString &path);
+    CLargeTexture(const CStdString &path, unsigned int width, unsigned int height);
     virtual ~CLargeTexture();
 
     void AddRef();
@@ -126,25 +144,75 @@ private:
     void SetTexture(CBaseTexture* texture);
 
     const CStdString &GetPath() const { return m_path; };
+    unsigned int GetWidth() const { return m_width; };
+    unsigned int GetHeight() const { return m_height; };
     const CTextureArray &GetTexture() const { return m_texture; };
+    bool Matches(const CStdString &path, unsigned int width, unsigned int height) const
+    {
+      return m_width == width && m_height == height && m_path == path;
+    };
 
   private:
     static const unsigned int TIME_TO_DELETE = 2000;
 
     unsigned int m_refCount;
     CStdString m_path;
+    unsigned int m_width;
+    unsigned int m_height;
     CTextureArray m_texture;
     unsigned int m_timeToDelete;
   };
 
-  void QueueImage(const CStdString &path);
+  class CQueuedImage
+  {
+  public:
+    CLargeTexture *image;
+    unsigned int   queued;     ///< when the image was first asked for
+    unsigned int   lastWanted; ///< frame time a control on screen last asked for the image
+    bool           decoding;   ///< whether the image was handed to a decoder
+    unsigned int   jobID;      ///< the decoding job, if decoding
+  };
+  typedef boost::unordered_map<std::string, CQueuedImage> QueueMap;
+
+  void QueueImage(const CStdString &path, unsigned int width, unsigned int height);
+
+  /*!
+   \brief Hand the waiting images most recently wanted on screen to the decoders that are free
+   */
+  void DecodeNextImages();
+
+  static std::string GetKey(const CStdString &path, unsigned int width, unsigned int height);
 
-  std::vector< std::pair<unsigned int, CLargeTexture *> > m_queued;
+  /*!
+   \brief Round a requested size up, so that images shown at about the same size are loaded once
+   */
+  static unsigned int RoundSize(unsigned int size);
+
+  /*!
+   \brief Count a loaded image in the decoding statistics, and log them every so often
+   */
+  void UpdateStats(const CImageLoader *loader, unsigned int latency);
+
+  static const unsigned int MAX_DECODERS = 2;
+
+  QueueMap m_queued;
+  std::map<unsigned int, std::string> m_decoding; ///< keys of the queued images by decoding job
   std::vector<CLargeTexture *> m_allocated;
   typedef std::vector<CLargeTexture *>::iterator listIterator;
-  typedef std::vector< std::pair<unsigned int, CLargeTexture *> >::iterator queueIterator;
 
   CCriticalSection m_listSection;
+
+  // decoding statistics since they were last logged
+  unsigned int m_statsTime;
+  unsigned int m_statsImages;
+  unsigned int m_statsTiers;       ///< images loaded from a smaller version
+  uint64_t     m_statsBytes;
+  unsigned int m_statsFrame;       ///< frame time of the frame bytes are counted for
+  unsigned int m_statsFrameBytes;
+  unsigned int m_statsPeakBytes;   ///< most bytes decoded for one frame
+  unsigned int m_statsLatency;     ///< total time from asking for images until they were loaded
+  unsigned int m_statsMaxLatency;
+  unsigned int m_statsCancelled;   ///< images released before they were decoded
 };
 
 extern CGUILargeTextureManager g_largeTextureManager;
@@ -21,6 +21,7 @@
 
 #include "threads/SystemClock.h"
 #include "PartyModeManager.h"
+#include "Application.h"
 #include "PlayListPlayer.h"
 #include "music/MusicDatabase.h"
 #include "music/windows/GUIWindowMusicPlaylist.h"
@@ -35,6 +36,8 @@
 #include "utils/TimeUtils.h"
 #include "utils/log.h"
 
+#include <algorithm>
+
 using namespace std;
 using namespace PLAYLIST;
 
@@ -104,8 +107,13 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
   pDialog->StartModal();
 
   ClearState();
+  // other clients of the same databases may be in party mode too, so our history is kept
+  // under our host name. It goes into where clauses as is, so it mustn't carry quotes.
+  m_historyClient = g_application.getNetwork().GetHostName();
+  m_historyClient.Replace("'", "");
+  m_historyClient = m_historyClient.Left(64);
   unsigned int time = XbmcThreads::SystemClockMillis();
-  vector< pair<int,int> > songIDs;
+  int songCount = 0, videoCount = 0;
   if (m_type.Equals("songs") || m_type.Equals("mixed"))
   {
     CMusicDatabase db;
@@ -116,11 +124,13 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
       {
         m_strCurrentFilterMusic = playlist.GetWhereClause(db, playlists);
         if (!m_strCurrentFilterMusic.empty())
-          m_strCurrentFilterMusic = "WHERE " + m_strCurrentFilterMusic;
+          m_strCurrentFilterMusic = "WHERE (" + m_strCurrentFilterMusic + ")";
       }
 
       CLog::Log(LOGINFO, "PARTY MODE MANAGER: Registering filter:[%s]", m_strCurrentFilterMusic.c_str());
-      m_iMatchingSongs = (int)db.GetSongIDs(m_strCurrentFilterMusic, songIDs);
+      db.ClearPartyModeHistory(m_historyClient);
+      songCount = db.GetSongsCount(m_strCurrentFilterMusic);
+      m_iMatchingSongs = songCount;
       if (m_iMatchingSongs < 1 && m_type.Equals("songs"))
       {
         pDialog->Close();
@@ -140,7 +150,6 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
 
   if (m_type.Equals("musicvideos") || m_type.Equals("mixed"))
   {
-    vector< pair<int,int> > songIDs2;
     CVideoDatabase db;
     if (db.Open())
     {
@@ -149,11 +158,13 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
       {
         m_strCurrentFilterVideo = playlist.GetWhereClause(db, playlists);
         if (!m_strCurrentFilterVideo.empty())
-          m_strCurrentFilterVideo = "WHERE " + m_strCurrentFilterVideo;
+          m_strCurrentFilterVideo = "WHERE (" + m_strCurrentFilterVideo + ")";
       }
 
       CLog::Log(LOGINFO, "PARTY MODE MANAGER: Registering filter:[%s]", m_strCurrentFilterVideo.c_str());
-      m_iMatchingSongs += (int)db.GetMusicVideoIDs(m_strCurrentFilterVideo, songIDs2);
+      db.ClearPartyModeHistory(m_historyClient);
+      videoCount = db.GetMusicVideoCount(m_strCurrentFilterVideo);
+      m_iMatchingSongs += videoCount;
       if (m_iMatchingSongs < 1)
       {
         pDialog->Close();
@@ -169,7 +180,6 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
       return false;
     }
     db.Close();
-    songIDs.insert(songIDs.end(),songIDs2.begin(),songIDs2.end());
   }
 
   // calculate history size
@@ -192,7 +202,7 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
   pDialog->SetLine(0, (m_bIsVideo ? 20252 : 20124));
   pDialog->Progress();
   // add initial songs
-  if (!AddInitialSongs(songIDs))
+  if (!AddInitialSongs(songCount, videoCount))
   {
     pDialog->Close();
     return false;
@@ -333,101 +343,55 @@ bool CPartyModeManager::AddRandomSongs(int iSongs /* = 0 */)
     }
   }
 
-  // add songs to fill queue
-  if (m_type.Equals("songs") || m_type.Equals("mixed"))
+  // pick all songs of this refill in one go, the history is left out by the queries themselves
+  int64_t start = CurrentHostCounter();
+  if (iSongsToAdd > 0 && (m_type.Equals("songs") || m_type.Equals("mixed")))
   {
     CMusicDatabase database;
     if (database.Open())
     {
-      // Method:
-      // 1. Grab a random entry from the database using a where clause
-      // 2. Iterate on iSongs.
-
-      // Note: At present, this method is faster than the alternative, which is to grab
-      // all valid songids, then select a random number of them (as done in AddInitialSongs()).
-      // The reason for this is simply the number of songs we are requesting - we generally
-      // only want one here.  Any more than about 3 songs and it is more efficient
-      // to use the technique in AddInitialSongs.  As it's unlikely that we'll require
-      // more than 1 song at a time here, this method is faster.
-      bool error(false);
-      for (int i = 0; i < iSongsToAdd; i++)
-      {
-        pair<CStdString,CStdString> whereClause = GetWhereClauseWithHistory();
-        CFileItemPtr item(new CFileItem);
-        int songID;
-        if (database.GetRandomSong(item.get(), songID, whereClause.first))
-        { // success
-          Add(item);
-          AddToHistory(1,songID);
-        }
-        else
-        {
-          error = true;
-          break;
-        }
-      }
-
-      if (error)
+      vector< pair<int,int> > songIDs;
+      if (!database.GetRandomSongIDs(GetWhereClauseWithHistory().first, iSongsToAdd, songIDs) || songIDs.empty())
       {
         database.Close();
         OnError(16034, (CStdString)"Cannot get songs from database. Aborting.");
         return false;
       }
+      database.Close();
+      AddToHistory(songIDs);
+      AddSongsByID(songIDs);
     }
     else
     {
       OnError(16033, (CStdString)"Party mode could not open database. Aborting.");
       return false;
     }
-    database.Close();
   }
-  if (m_type.Equals("musicvideos") || m_type.Equals("mixed"))
+  if (iVidsToAdd > 0 && (m_type.Equals("musicvideos") || m_type.Equals("mixed")))
   {
     CVideoDatabase database;
     if (database.Open())
     {
-      // Method:
-      // 1. Grab a random entry from the database using a where clause
-      // 2. Iterate on iSongs.
-
-      // Note: At present, this method is faster than the alternative, which is to grab
-      // all valid songids, then select a random number of them (as done in AddInitialSongs()).
-      // The reason for this is simply the number of songs we are requesting - we generally
-      // only want one here.  Any more than about 3 songs and it is more efficient
-      // to use the technique in AddInitialSongs.  As it's unlikely that we'll require
-      // more than 1 song at a time here, this method is faster.
-      bool error(false);
-      for (int i = 0; i < iVidsToAdd; i++)
-      {
-        pair<CStdString,CStdString> whereClause = GetWhereClauseWithHistory();
-        CFileItemPtr item(new CFileItem);
-        int songID;
-        if (database.GetRandomMusicVideo(item.get(), songID, whereClause.second))
-        { // success
-          Add(item);
-          AddToHistory(2,songID);
-        }
-        else
-        {
-          error = true;
-          break;
-        }
-      }
-
-      if (error)
+      vector< pair<int,int> > songIDs;
+      if (!database.GetRandomMusicVideoIDs(GetWhereClauseWithHistory().second, iVidsToAdd, songIDs) || songIDs.empty())
       {
         database.Close();
         OnError(16034, (CStdString)"Cannot get songs from database. Aborting.");
         return false;
       }
+      database.Close();
+      AddToHistory(songIDs);
+      AddSongsByID(songIDs);
     }
     else
     {
       OnError(16033, (CStdString)"Party mode could not open database. Aborting.");
       return false;
     }
-    database.Close();
   }
+  if (iSongs > 0)
+    CLog::Log(LOGDEBUG, "%s - refilled %i songs in %.1f ms", __FUNCTION__, iSongs,
+              (CurrentHostCounter() - start) * 1000.0 / CurrentHostFrequency());
   return true;
 }
 
@@ -580,7 +544,7 @@ void CPartyModeManager::UpdateStats()
   m_iRelaxedSongs = 0;  // unsupported at this stage
 }
 
-bool CPartyModeManager::AddInitialSongs(vector<pair<int,int> > &songIDs)
+bool CPartyModeManager::AddInitialSongs(int songCount, int videoCount)
 {
   int iPlaylist = m_bIsVideo ? PLAYLIST_VIDEO : PLAYLIST_MUSIC;
 
@@ -588,102 +552,123 @@ bool CPartyModeManager::AddInitialSongs(vector<pair<int,int> > &songIDs)
   int iMissingSongs = QUEUE_DEPTH - playlist.size();
   if (iMissingSongs > 0)
   {
-    // generate iMissingSongs random ids from songIDs
-    if (iMissingSongs > (int)songIDs.size())
+    if (iMissingSongs > songCount + videoCount)
       return false; // can't do it if we have less songs than we need
 
-    vector<pair<int,int> > chosenSongIDs;
-    GetRandomSelection(songIDs, iMissingSongs, chosenSongIDs);
-    CStdString sqlWhereMusic = "where songview.idSong in (";
-    CStdString sqlWhereVideo = "idMVideo in (";
-
-    for (vector< pair<int,int> >::iterator it = chosenSongIDs.begin(); it != chosenSongIDs.end(); it++)
+    // split the picks between songs and music videos by how many of each match
+    int songsToAdd = 0;
+    for (int i = 0; i < iMissingSongs; i++)
     {
-      CStdString song;
-      song.Format("%i,", it->second);
-      if (it->first == 1)
-        sqlWhereMusic += song;
-      if (it->first == 2)
-        sqlWhereVideo += song;
+      if ((double)rand() / ((double)RAND_MAX + 1) * (songCount + videoCount) < songCount)
+        songsToAdd++;
     }
-    // add songs to fill queue
-    CFileItemList items;
+    songsToAdd = std::max(std::min(songsToAdd, songCount), iMissingSongs - videoCount);
 
-    if (sqlWhereMusic.size() > 26)
+    vector<pair<int,int> > chosenSongIDs;
+    if (songsToAdd > 0)
     {
-      sqlWhereMusic[sqlWhereMusic.size() - 1] = ')'; // replace the last comma with closing bracket
       CMusicDatabase database;
-      database.Open();
-      database.GetSongsByWhere("", sqlWhereMusic, items);
+      if (database.Open())
+        database.GetRandomSongIDs(m_strCurrentFilterMusic, songsToAdd, chosenSongIDs);
     }
-    if (sqlWhereVideo.size() > 19)
+    if (iMissingSongs - songsToAdd > 0)
     {
-      sqlWhereVideo[sqlWhereVideo.size() - 1] = ')'; // replace the last comma with closing bracket
       CVideoDatabase database;
-      database.Open();
-      database.GetMusicVideosByWhere("videodb://3/2/", sqlWhereVideo, items);
+      if (database.Open())
+        database.GetRandomMusicVideoIDs(m_strCurrentFilterVideo, iMissingSongs - songsToAdd, chosenSongIDs);
     }
 
-    m_history = chosenSongIDs;
-    items.Randomize(); //randomizing the initial list or they will be in database order
-    for (int i = 0; i < items.Size(); i++)
-    {
-      CFileItemPtr item(items[i]);
-      Add(item);
-      // TODO: Allow "relaxed restrictions" later?
-    }
+    AddToHistory(chosenSongIDs);
+    AddSongsByID(chosenSongIDs);
   }
   return true;
 }
 
-pair<CStdString,CStdString> CPartyModeManager::GetWhereClauseWithHistory() const
+bool CPartyModeManager::AddSongsByID(const vector<pair<int,int> > &songIDs)
 {
-  CStdString historyWhereMusic;
-  CStdString historyWhereVideo;
-  // now add this on to the normal where clause
-  if (m_history.size())
+  CStdString sqlWhereMusic = "where songview.idSong in (";
+  CStdString sqlWhereVideo = "idMVideo in (";
+
+  for (vector< pair<int,int> >::const_iterator it = songIDs.begin(); it != songIDs.end(); it++)
   {
-    if (m_strCurrentFilterMusic.IsEmpty())
-      historyWhereMusic = "where songview.idSong not in (";
-    else
-      historyWhereMusic = m_strCurrentFilterMusic + " and songview.idSong not in (";
-    if (m_strCurrentFilterVideo.IsEmpty())
-      historyWhereVideo = "idMVideo not in (";
-    else
-      historyWhereVideo = m_strCurrentFilterVideo + " and idMVideo not in (";
+    CStdString song;
+    song.Format("%i,", it->second);
+    if (it->first == 1)
+      sqlWhereMusic += song;
+    if (it->first == 2)
+      sqlWhereVideo += song;
+  }
+  // add songs to fill queue
+  CFileItemList items;
 
-    for (unsigned int i = 0; i < m_history.size(); i++)
-    {
-      CStdString number;
-      number.Format("%i,", m_history[i].second);
-      if (m_history[i].first == 1)
-        historyWhereMusic += number;
-      if (m_history[i].first == 2)
-        historyWhereVideo += number;
-    }
-    historyWhereMusic.TrimRight(",");
-    historyWhereMusic += ")";
-    historyWhereVideo.TrimRight(",");
-    historyWhereVideo += ")";
+  if (sqlWhereMusic.size() > 26)
+  {
+    sqlWhereMusic[sqlWhereMusic.size() - 1] = ')'; // replace the last comma with closing bracket
+    CMusicDatabase database;
+    database.Open();
+    database.GetSongsByWhere("", sqlWhereMusic, items);
   }
-  return make_pair(historyWhereMusic,historyWhereVideo);
+  if (sqlWhereVideo.size() > 19)
+  {
+    sqlWhereVideo[sqlWhereVideo.size() - 1] = ')'; // replace the last comma with closing bracket
+    CVideoDatabase database;
+    database.Open();
+    database.GetMusicVideosByWhere("videodb://3/2/", sqlWhereVideo, items);
+  }
+
+  items.Randomize(); // randomizing the list or they will be in database order
+  for (int i = 0; i < items.Size(); i++)
+  {
+    CFileItemPtr item(items[i]);
+    Add(item);
+    // TODO: Allow "relaxed restrictions" later?
+  }
+  return !items.IsEmpty();
 }
 
-void CPartyModeManager::AddToHistory(int type, int songID)
+pair<CStdString,CStdString> CPartyModeManager::GetWhereClauseWithHistory() const
 {
-  while (m_history.size() >= m_songsInHistory && m_songsInHistory)
-    m_history.erase(m_history.begin());
-  m_history.push_back(make_pair<int,int>(type,songID));
+  CStdString historyWhereMusic = m_strCurrentFilterMusic;
+  CStdString historyWhereVideo = m_strCurrentFilterVideo;
+  // the history is kept in the partymodehistory table of each database, see AddToHistory()
+  if (m_history.size())
+  {
+    historyWhereMusic += historyWhereMusic.IsEmpty() ? "where " : " and ";
+    historyWhereMusic.AppendFormat("songview.idSong not in (select idSong from partymodehistory where client='%s')", m_historyClient.c_str());
+    historyWhereVideo += historyWhereVideo.IsEmpty() ? "where " : " and ";
+    historyWhereVideo.AppendFormat("idMVideo not in (select idMVideo from partymodehistory where client='%s')", m_historyClient.c_str());
+  }
+  return make_pair(historyWhereMusic,historyWhereVideo);
 }
 
-void CPartyModeManager::GetRandomSelection(vector< pair<int,int> >& in, unsigned int number, vector< pair<int,int> >& out)
+void CPartyModeManager::AddToHistory(const vector<pair<int,int> > &songIDs)
 {
-  // only works if we have < 32768 in the in vector
-  for (unsigned int i = 0; i < number; i++)
+  if (!m_songsInHistory)
+    return;
+
+  vector<int> added[2], removed[2]; // songs, music videos
+  for (vector< pair<int,int> >::const_iterator it = songIDs.begin(); it != songIDs.end(); ++it)
+  {
+    while (m_history.size() >= m_songsInHistory)
+    {
+      removed[m_history.front().first == 2 ? 1 : 0].push_back(m_history.front().second);
+      m_history.erase(m_history.begin());
+    }
+    m_history.push_back(*it);
+    added[it->first == 2 ? 1 : 0].push_back(it->second);
+  }
+
+  if (!added[0].empty() || !removed[0].empty())
   {
-    int num = rand() % in.size();
-    out.push_back(in[num]);
-    in.erase(in.begin() + num);
+    CMusicDatabase database;
+    if (database.Open())
+      database.UpdatePartyModeHistory(m_historyClient, added[0], removed[0]);
+  }
+  if (!added[1].empty() || !removed[1].empty())
+  {
+    CVideoDatabase database;
+    if (database.Open())
+      database.UpdatePartyModeHistory(m_historyClient, added[1], removed[1]);
   }
 }
 
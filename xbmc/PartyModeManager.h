@@ -61,7 +61,7 @@ public:
 private:
   void Process();
   bool AddRandomSongs(int iSongs = 0);
-  bool AddInitialSongs(std::vector< std::pair<int,int> > &songIDs);
+  bool AddInitialSongs(int songCount, int videoCount);
   void Add(CFileItemPtr &pItem);
   bool ReapSongs();
   bool MovePlaying();
@@ -70,8 +70,8 @@ private:
   void ClearState();
   void UpdateStats();
   std::pair<CStdString,CStdString> GetWhereClauseWithHistory() const;
-  void AddToHistory(int type, int songID);
-  void GetRandomSelection(std::vector< std::pair<int,int> > &in, unsigned int number, std::vector< std::pair<int, int> > &out);
+  void AddToHistory(const std::vector< std::pair<int,int> > &songIDs);
+  bool AddSongsByID(const std::vector< std::pair<int,int> > &songIDs);
 
   // state
   bool m_bEnabled;
@@ -92,6 +92,7 @@ private:
   // history
   unsigned int m_songsInHistory;
   std::vector< std::pair<int,int> > m_history;
+  CStdString m_historyClient; ///< our rows of the partymodehistory tables, as the databases may be shared
 };
 
 extern CPartyModeManager g_partyModeManager;
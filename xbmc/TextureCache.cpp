@@ -22,15 +22,21 @@
 #include "TextureCache.h"
 #include "TextureCacheJob.h"
 #include "filesystem/File.h"
+#include "threads/Atomics.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/Crc32.h"
 #include "settings/Settings.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
+#include "utils/TimeUtils.h"
+#include "Util.h"
 
 using namespace XFILE;
 
+const unsigned int CTextureCache::TierSizes[TEXTURE_TIER_COUNT] = { 256, 512, 1024 };
+
 CTextureCache &CTextureCache::Get()
 {
   static CTextureCache s_cache;
@@ -39,6 +45,10 @@ CTextureCache &CTextureCache::Get()
 
 CTextureCache::CTextureCache()
 {
+  m_indexLoaded = false;
+  m_lookups = 0;
+  m_lookupTime = 0;
+  m_useCountsTime = 0;
 }
 
 CTextureCache::~CTextureCache()
@@ -50,11 +60,36 @@ void CTextureCache::Initialize()
   CSingleLock lock(m_databaseSection);
   if (!m_database.IsOpen())
     m_database.Open();
+
+  CExclusiveLock indexLock(m_indexSection);
+  if (!m_indexLoaded)
+  {
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    m_index.clear();
+    m_indexLoaded = m_database.GetCachedTextures(m_index);
+    if (m_indexLoaded)
+      CLog::Log(LOGDEBUG, "%s - indexed %u textures in %u ms", __FUNCTION__, (unsigned int)m_index.size(), XbmcThreads::SystemClockMillis() - start);
+    else
+      m_index.clear();
+  }
 }
 
 void CTextureCache::Deinitialize()
 {
   CancelJobs();
+  FlushUseCounts(true);
+
+  {
+    CExclusiveLock indexLock(m_indexSection);
+    if (m_lookups)
+      CLog::Log(LOGDEBUG, "%s - %ld texture lookups, %ld us on average", __FUNCTION__,
+                m_lookups, m_lookupTime / m_lookups);
+    m_index.clear();
+    m_indexLoaded = false;
+    m_lookups = 0;
+    m_lookupTime = 0;
+  }
+
   CSingleLock lock(m_databaseSection);
   m_database.Close();
 }
@@ -75,9 +110,12 @@ bool CTextureCache::HasCachedImage(const CStdString &url)
   return !GetCachedImage(url, cachedHash).IsEmpty();
 }
 
-CStdString CTextureCache::GetCachedImage(const CStdString &image, CStdString &cachedHash, bool trackUsage)
+CStdString CTextureCache::GetCachedImage(const CStdString &image, CStdString &cachedHash, bool trackUsage,
+                                         unsigned int width, unsigned int height, bool *tier)
 {
   cachedHash.clear();
+  if (tier)
+    *tier = false;
   CStdString url = UnwrapImageURL(image);
 
   if (IsCachedImage(url))
@@ -89,6 +127,20 @@ CStdString CTextureCache::GetCachedImage(const CStdString &image, CStdString &ca
   {
     if (trackUsage)
       IncrementUseCount(details);
+
+    // the smallest version that still covers the size it's shown at
+    if (width && height)
+    {
+      for (std::vector<CTextureTier>::const_iterator i = details.tiers.begin(); i != details.tiers.end(); ++i)
+      {
+        if (i->width >= width && i->height >= height)
+        {
+          if (tier)
+            *tier = true;
+          return GetCachedPath(GetTierFile(details.file, i->size));
+        }
+      }
+    }
     return GetCachedPath(details.file);
   }
   return "";
@@ -130,14 +182,18 @@ CStdString CTextureCache::UnwrapImageURL(const CStdString &image)
   return image;
 }
 
-CStdString CTextureCache::CheckCachedImage(const CStdString &url, bool returnDDS, bool &needsRecaching)
+CStdString CTextureCache::CheckCachedImage(const CStdString &url, bool returnDDS, bool &needsRecaching,
+                                           unsigned int width, unsigned int height, bool *tier)
 {
   CStdString cachedHash;
-  CStdString path(GetCachedImage(url, cachedHash, true));
+  bool isTier;
+  CStdString path(GetCachedImage(url, cachedHash, true, width, height, &isTier));
   needsRecaching = !cachedHash.IsEmpty();
+  if (tier)
+    *tier = isTier;
   if (!path.IsEmpty())
   {
-    if (!needsRecaching && returnDDS && !URIUtils::IsInPath(url, "special://skin/")) // TODO: should skin images be .dds'd (currently they're not necessarily writeable)
+    if (!needsRecaching && returnDDS && !isTier && !URIUtils::IsInPath(url, "special://skin/")) // TODO: should skin images be .dds'd (currently they're not necessarily writeable)
     { // check for dds version
       CStdString ddsPath = URIUtils::ReplaceExtension(path, ".dds");
       if (CFile::Exists(ddsPath))
@@ -196,8 +252,16 @@ void CTextureCache::ClearCachedImage(const CStdString &url, bool deleteSource /*
   // TODO: This can be removed when the texture cache covers everything.
   CStdString path = deleteSource ? url : "";
   CStdString cachedFile;
-  if (ClearCachedTexture(url, cachedFile))
+  if (ClearCachedTexture(url, cachedFile) && !cachedFile.IsEmpty())
+  {
     path = GetCachedPath(cachedFile);
+    for (unsigned int i = 0; i < TEXTURE_TIER_COUNT; i++)
+    {
+      CStdString tierPath = GetCachedPath(GetTierFile(cachedFile, TierSizes[i]));
+      if (CFile::Exists(tierPath))
+        CFile::Delete(tierPath);
+    }
+  }
   if (CFile::Exists(path))
     CFile::Delete(path);
   path = URIUtils::ReplaceExtension(path, ".dds");
@@ -207,39 +271,182 @@ void CTextureCache::ClearCachedImage(const CStdString &url, bool deleteSource /*
 
 bool CTextureCache::GetCachedTexture(const CStdString &url, CTextureDetails &details)
 {
+  int64_t start = CurrentHostCounter();
+  {
+    CSharedLock indexLock(m_indexSection);
+    if (m_indexLoaded)
+    {
+      bool found = false;
+      CTextureIndex::const_iterator i = m_index.find(url);
+      if (i != m_index.end())
+      {
+        details = i->second.details;
+        // the hash is only handed out when the image is due for checking
+        const CDateTime &lastCheck = i->second.lastHashCheck;
+        if (!lastCheck.IsValid() || lastCheck + CDateTimeSpan(1,0,0,0) >= CDateTime::GetCurrentDateTime())
+          details.hash.clear();
+        found = true;
+      }
+      AtomicIncrement(&m_lookups);
+      AtomicAdd(&m_lookupTime, (long)((CurrentHostCounter() - start) * 1000000 / CurrentHostFrequency()));
+      return found;
+    }
+  }
+
   CSingleLock lock(m_databaseSection);
   return m_database.GetCachedTexture(url, details);
 }
 
 bool CTextureCache::AddCachedTexture(const CStdString &url, const CTextureDetails &details)
+{
+  CTextureDetails added(details);
+  CSingleLock lock(m_databaseSection);
+  bool success = m_database.AddCachedTexture(url, added);
+
+  CExclusiveLock indexLock(m_indexSection);
+  if (m_indexLoaded)
+  {
+    if (added.id >= 0)
+    {
+      CTextureIndexEntry &entry = m_index[url];
+      entry.details = added;
+      entry.lastHashCheck = added.updateable ? CDateTime::GetCurrentDateTime() : CDateTime();
+    }
+    else
+      m_index.erase(url);
+  }
+  return success;
+}
+
+bool CTextureCache::InvalidateCachedImage(const CStdString &url)
 {
   CSingleLock lock(m_databaseSection);
-  return m_database.AddCachedTexture(url, details);
+  bool success = m_database.InvalidateCachedTexture(url);
+
+  CExclusiveLock indexLock(m_indexSection);
+  CTextureIndex::iterator i = m_index.find(url);
+  if (i != m_index.end())
+    i->second.lastHashCheck = CDateTime::GetCurrentDateTime() - CDateTimeSpan(2, 0, 0, 0);
+  return success;
+}
+
+bool CTextureCache::ShareCachedImage(const CStdString &image, uint64_t &saved)
+{
+  saved = 0;
+  CStdString url = UnwrapImageURL(image);
+  CTextureDetails details;
+  if (!GetCachedTexture(url, details) || details.file.empty())
+    return false;
+
+  CStdString hash = CUtil::GetFileMD5(GetCachedPath(details.file));
+  if (hash.IsEmpty())
+    return false;
+  hash.ToLower();
+  CStdString shared;
+  shared.Format("%c/%s%s", hash[0], hash.c_str(), URIUtils::GetExtension(details.file).c_str());
+  if (shared == details.file)
+    return true;
+
+  std::vector< std::pair<CStdString, CStdString> > files;
+  files.push_back(std::make_pair(details.file, shared));
+  for (std::vector<CTextureTier>::const_iterator i = details.tiers.begin(); i != details.tiers.end(); ++i)
+    files.push_back(std::make_pair(GetTierFile(details.file, i->size), GetTierFile(shared, i->size)));
+
+  if (CFile::Exists(GetCachedPath(shared)))
+  { // an identical image is stored already, use that and drop ours
+    if (!SetCachedFile(url, shared))
+      return false;
+    for (std::vector< std::pair<CStdString, CStdString> >::const_iterator i = files.begin(); i != files.end(); ++i)
+    {
+      struct __stat64 st;
+      CStdString path = GetCachedPath(i->first);
+      if (CFile::Stat(path, &st) == 0 && CFile::Delete(path))
+        saved += st.st_size;
+    }
+    return true;
+  }
+
+  // copy rather than rename, the old files may be loaded until the database points at the new ones
+  for (std::vector< std::pair<CStdString, CStdString> >::const_iterator i = files.begin(); i != files.end(); ++i)
+  {
+    if (!CFile::Cache(GetCachedPath(i->first), GetCachedPath(i->second)))
+    {
+      CLog::Log(LOGWARNING, "%s - unable to copy %s", __FUNCTION__, i->first.c_str());
+      for (std::vector< std::pair<CStdString, CStdString> >::const_iterator j = files.begin(); j != i; ++j)
+        CFile::Delete(GetCachedPath(j->second));
+      return false;
+    }
+  }
+  if (!SetCachedFile(url, shared))
+    return false;
+  for (std::vector< std::pair<CStdString, CStdString> >::const_iterator i = files.begin(); i != files.end(); ++i)
+    CFile::Delete(GetCachedPath(i->first));
+  return true;
 }
 
 void CTextureCache::IncrementUseCount(const CTextureDetails &details)
 {
-  static const size_t count_before_update = 100;
+  static const size_t count_before_update = 500;
+  static const unsigned int time_before_update = 30000;
   CSingleLock lock(m_useCountSection);
-  m_useCounts.reserve(count_before_update);
+  if (m_useCounts.empty())
+  {
+    m_useCounts.reserve(count_before_update);
+    m_useCountsTime = XbmcThreads::SystemClockMillis();
+  }
   m_useCounts.push_back(details);
-  if (m_useCounts.size() >= count_before_update)
+  if (m_useCounts.size() >= count_before_update || XbmcThreads::SystemClockMillis() - m_useCountsTime >= time_before_update)
+    FlushUseCounts(false);
+}
+
+void CTextureCache::FlushUseCounts(bool wait)
+{
+  CSingleLock lock(m_useCountSection);
+  if (m_useCounts.empty())
+    return;
+
+  if (wait)
   {
-    AddJob(new CTextureUseCountJob(m_useCounts));
-    m_useCounts.clear();
+    CTextureUseCountJob job(m_useCounts);
+    job.DoWork();
   }
+  else
+    AddJob(new CTextureUseCountJob(m_useCounts));
+  m_useCounts.clear();
 }
 
 bool CTextureCache::SetCachedTextureValid(const CStdString &url, bool updateable)
 {
   CSingleLock lock(m_databaseSection);
-  return m_database.SetCachedTextureValid(url, updateable);
+  bool success = m_database.SetCachedTextureValid(url, updateable);
+
+  CExclusiveLock indexLock(m_indexSection);
+  CTextureIndex::iterator i = m_index.find(url);
+  if (i != m_index.end())
+    i->second.lastHashCheck = updateable ? CDateTime::GetCurrentDateTime() : CDateTime();
+  return success;
 }
 
 bool CTextureCache::ClearCachedTexture(const CStdString &url, CStdString &cachedURL)
 {
   CSingleLock lock(m_databaseSection);
-  return m_database.ClearCachedTexture(url, cachedURL);
+  bool success = m_database.ClearCachedTexture(url, cachedURL);
+
+  CExclusiveLock indexLock(m_indexSection);
+  m_index.erase(url);
+  return success;
+}
+
+bool CTextureCache::SetCachedFile(const CStdString &url, const CStdString &cacheFile)
+{
+  CSingleLock lock(m_databaseSection);
+  bool success = m_database.SetCachedFile(url, cacheFile);
+
+  CExclusiveLock indexLock(m_indexSection);
+  CTextureIndex::iterator i = m_index.find(url);
+  if (i != m_index.end())
+    i->second.details.file = cacheFile;
+  return success;
 }
 
 CStdString CTextureCache::GetCacheFile(const CStdString &url)
@@ -258,6 +465,13 @@ CStdString CTextureCache::GetCachedPath(const CStdString &file)
   return URIUtils::AddFileToFolder(g_settings.GetThumbnailsFolder(), file);
 }
 
+CStdString CTextureCache::GetTierFile(const CStdString &file, unsigned int size)
+{
+  CStdString suffix;
+  suffix.Format("-%u%s", size, URIUtils::GetExtension(file).c_str());
+  return URIUtils::ReplaceExtension(file, suffix);
+}
+
 void CTextureCache::OnCachingComplete(bool success, CTextureCacheJob *job)
 {
   if (success)
@@ -26,9 +26,12 @@
 #include "utils/JobManager.h"
 #include "TextureDatabase.h"
 #include "threads/Event.h"
+#include "threads/SharedSection.h"
 
 class CBaseTexture;
 
+#define TEXTURE_TIER_COUNT 3
+
 /*!
  \ingroup textures
  \brief Texture cache class for handling the caching of images.
@@ -38,6 +41,13 @@ class CBaseTexture;
  may be periodically checked for updates and may be purged from the cache if
  unused for a set period of time.
 
+ The texture table of the database is loaded into memory on initialization and
+ images are looked up there, all changes go through this class to keep both in
+ step. Use counts are gathered in memory and written to the database in batches.
+
+ Large images are also cached in smaller versions, which controls that show
+ them at a smaller size load instead of the full cached image.
+
  */
 class CTextureCache : public CJobQueue
 {
@@ -65,10 +75,14 @@ public:
    \param image url of the image to check
    \param returnDDS if we're allowed to return a DDS version, defaults to true
    \param needsRecaching [out] whether the image needs recaching.
-   \return cached url of this image
+   \param width the width the image is shown at, 0 for the full image
+   \param height the height the image is shown at, 0 for the full image
+   \param tier [out] set to whether a smaller version was returned
+   \return cached url of this image, or of the smallest version at least as large as width and height
    \sa GetCachedImage
    */ 
-  CStdString CheckCachedImage(const CStdString &image, bool returnDDS, bool &needsRecaching);
+  CStdString CheckCachedImage(const CStdString &image, bool returnDDS, bool &needsRecaching,
+                              unsigned int width = 0, unsigned int height = 0, bool *tier = NULL);
 
   /*! \brief Cache image (if required) using a background job
 
@@ -118,6 +132,15 @@ public:
    */
   static CStdString GetCachedPath(const CStdString &file);
 
+  /*! \brief retrieve the cache file of a smaller version of a cached image
+   \param file the cache file of the full image, relative to the cache path
+   \param size the size of the smaller version, one of TierSizes
+   \return the cache file of the smaller version, relative to the cache path
+   */
+  static CStdString GetTierFile(const CStdString &file, unsigned int size);
+
+  static const unsigned int TierSizes[TEXTURE_TIER_COUNT]; ///< largest width or height of the smaller versions, smallest first
+
   /*! \brief retrieve a wrapped URL for a image file
    \param image name of the file
    \param type signifies a special type of image (eg embedded video thumb, picture folder thumb)
@@ -135,6 +158,24 @@ public:
    */
   bool AddCachedTexture(const CStdString &image, const CTextureDetails &details);
 
+  /*! \brief Have an image checked for updates the next time it is loaded
+   Thread-safe wrapper of CTextureDatabase::InvalidateCachedTexture
+   \param image url of the original image
+   \return true if successful, false otherwise.
+   */
+  bool InvalidateCachedImage(const CStdString &image);
+
+  /*! \brief Store the cached image once for all identical images
+   Moves the cached file of the image and its smaller versions to names after the MD5 of their content,
+   or if a file of that content is stored already, deletes them and uses that one instead. The old
+   files are only deleted once the database points at the new ones.
+   Files shared this way are deleted with the last texture using them.
+   \param image url of the original image
+   \param saved [out] bytes of the files deleted as duplicates
+   \return true if the image is stored under the name of its content, false otherwise.
+   */
+  bool ShareCachedImage(const CStdString &image, uint64_t &saved);
+
   /*! \brief Export a (possibly) cached image to a file
    \param image url of the original image
    \param destination url of the destination image
@@ -165,10 +206,14 @@ private:
    \param image url of the image
    \param cacheHash [out] set to the hash of the cached image if it needs checking
    \param trackUsage whether this call should track usage of the image (defaults to false)
+   \param width the width the image is shown at, 0 for the full image
+   \param height the height the image is shown at, 0 for the full image
+   \param tier [out] set to whether a smaller version was returned
    \return cached url of this image, empty if none exists
    \sa ClearCachedImage
    */
-  CStdString GetCachedImage(const CStdString &image, CStdString &cacheHash, bool trackUsage = false);
+  CStdString GetCachedImage(const CStdString &image, CStdString &cacheHash, bool trackUsage = false,
+                            unsigned int width = 0, unsigned int height = 0, bool *tier = NULL);
 
   /*! \brief Get an image from the database
    Thread-safe wrapper of CTextureDatabase::GetCachedTexture
@@ -186,12 +231,25 @@ private:
    */
   bool ClearCachedTexture(const CStdString &url, CStdString &cacheFile);
 
+  /*! \brief Point an image at another cached file
+   Thread-safe wrapper of CTextureDatabase::SetCachedFile
+   \param url url of the original image
+   \param cacheFile the cached file to use
+   \return true if successful, false otherwise.
+   */
+  bool SetCachedFile(const CStdString &url, const CStdString &cacheFile);
+
   /*! \brief Increment the use count of a texture
    Stores locally before calling CTextureDatabase::IncrementUseCount via a CUseCountJob
    \sa CUseCountJob, CTextureDatabase::IncrementUseCount
    */
   void IncrementUseCount(const CTextureDetails &details);
 
+  /*! \brief Write the use counts gathered so far to the database
+   \param wait whether to write them right away rather than in a job
+   */
+  void FlushUseCounts(bool wait);
+
   /*! \brief Set a previously cached texture as valid in the database
    Thread-safe wrapper of CTextureDatabase::SetCachedTextureValid
    \param image url of the original image
@@ -213,10 +271,16 @@ private:
 
   CCriticalSection m_databaseSection;
   CTextureDatabase m_database;
+  CSharedSection   m_indexSection;
+  CTextureIndex    m_index;        ///< the texture table, keyed on the original url
+  bool             m_indexLoaded;
+  volatile long    m_lookups;      ///< lookups since initialization, with the us they took. Atomic, as
+  volatile long    m_lookupTime;   ///< they're counted by all threads holding the shared index lock
   std::set<CStdString> m_processing; ///< currently processing list to avoid 2 jobs being processed at once
   CCriticalSection     m_processingSection;
   CEvent               m_completeEvent; ///< Set whenever a job has finished
   std::vector<CTextureDetails> m_useCounts; ///< Use count tracking
+  unsigned int                 m_useCountsTime; ///< when the oldest use count was gathered
   CCriticalSection             m_useCountSection;
 };
 
@@ -33,6 +33,7 @@
 #include "utils/StringUtils.h"
 #include "URL.h"
 #include "FileItem.h"
+#include <algorithm>
 
 CTextureCacheJob::CTextureCacheJob(const CStdString &url, const CStdString &oldHash)
 {
@@ -56,6 +57,11 @@ bool CTextureCacheJob::operator==(const CJob* job) const
   return false;
 }
 
+std::string CTextureCacheJob::GetKey() const
+{
+  return std::string(GetType()) + "|" + m_cachePath;
+}
+
 bool CTextureCacheJob::DoWork()
 {
   if (ShouldCancel(0, 0))
@@ -106,6 +112,7 @@ bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
     {
       m_details.width = width;
       m_details.height = height;
+      CacheTiers(texture, width, height);
       if (out_texture) // caller wants the texture
         *out_texture = texture;
       else
@@ -190,6 +197,24 @@ CBaseTexture *CTextureCacheJob::LoadImage(const CStdString &image, unsigned int
   return texture;
 }
 
+void CTextureCacheJob::CacheTiers(CBaseTexture *texture, unsigned int width, unsigned int height)
+{
+  m_details.tiers.clear();
+  for (unsigned int i = 0; i < TEXTURE_TIER_COUNT; i++)
+  {
+    // only worth it if the tier is a lot smaller than the image
+    unsigned int size = CTextureCache::TierSizes[i];
+    if (std::max(width, height) < size * 3 / 2)
+      break;
+
+    CTextureTier tier;
+    tier.size = tier.width = tier.height = size;
+    if (!CPicture::CacheTexture(texture, tier.width, tier.height, CTextureCache::GetCachedPath(CTextureCache::GetTierFile(m_details.file, size))))
+      break;
+    m_details.tiers.push_back(tier);
+  }
+}
+
 bool CTextureCacheJob::UpdateableURL(const CStdString &url) const
 {
   // we don't constantly check online images
@@ -234,6 +259,11 @@ bool CTextureDDSJob::operator==(const CJob* job) const
   return false;
 }
 
+std::string CTextureDDSJob::GetKey() const
+{
+  return std::string(GetType()) + "|" + m_original;
+}
+
 bool CTextureDDSJob::DoWork()
 {
   CTexture texture;
@@ -268,9 +298,24 @@ bool CTextureUseCountJob::DoWork()
   CTextureDatabase db;
   if (db.Open())
   {
-    db.BeginTransaction();
+    // the same texture is usually used many times in a batch, update it once
+    std::vector<CTextureDetails> textures;
+    std::vector<unsigned int> counts;
     for (std::vector<CTextureDetails>::const_iterator i = m_textures.begin(); i != m_textures.end(); ++i)
-      db.IncrementUseCount(*i);
+    {
+      std::vector<CTextureDetails>::const_iterator j = std::find(textures.begin(), textures.end(), *i);
+      if (j == textures.end())
+      {
+        textures.push_back(*i);
+        counts.push_back(1);
+      }
+      else
+        counts[j - textures.begin()]++;
+    }
+
+    db.BeginTransaction();
+    for (unsigned int i = 0; i < textures.size(); i++)
+      db.IncrementUseCount(textures[i], counts[i]);
     db.CommitTransaction();
   }
   return true;
@@ -23,9 +23,23 @@
 
 #include "utils/StdString.h"
 #include "utils/Job.h"
+#include <vector>
 
 class CBaseTexture;
 
+/*!
+ \ingroup textures
+ \brief A smaller version of a cached image, for controls that don't need the full size
+ \sa CTextureCache::GetTierFile
+ */
+class CTextureTier
+{
+public:
+  unsigned int size;   ///< the largest width or height the image was scaled to fit
+  unsigned int width;
+  unsigned int height;
+};
+
 /*!
  \ingroup textures
  \brief Simple class for passing texture detail around
@@ -51,6 +65,7 @@ public:
   unsigned int width;
   unsigned int height;
   bool         updateable;
+  std::vector<CTextureTier> tiers; ///< smaller versions, smallest first
 };
 
 /*!
@@ -67,6 +82,7 @@ public:
 
   virtual const char* GetType() const { return "cacheimage"; };
   virtual bool operator==(const CJob *job) const;
+  virtual std::string GetKey() const;
   virtual bool DoWork();
 
   /*! \brief retrieve a hash for the given image
@@ -118,6 +134,13 @@ private:
    */
   static CBaseTexture *LoadImage(const CStdString &image, unsigned int width, unsigned int height, bool flipped);
 
+  /*! \brief Cache the smaller versions of an image
+   \param texture the image as loaded
+   \param width width the image was cached at
+   \param height height the image was cached at
+   */
+  void CacheTiers(CBaseTexture *texture, unsigned int width, unsigned int height);
+
   CStdString    m_cachePath;
 };
 
@@ -130,6 +153,7 @@ public:
 
   virtual const char* GetType() const { return "ddscompress"; };
   virtual bool operator==(const CJob *job) const;
+  virtual std::string GetKey() const;
   virtual bool DoWork();
 
   CStdString m_original;
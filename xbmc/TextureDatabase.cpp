@@ -25,6 +25,8 @@
 #include "dbwrappers/dataset.h"
 #include "URL.h"
 
+#include <map>
+
 CTextureDatabase::CTextureDatabase()
 {
 }
@@ -152,9 +154,9 @@ bool CTextureDatabase::UpdateOldVersion(int version)
   return true;
 }
 
-bool CTextureDatabase::IncrementUseCount(const CTextureDetails &details)
+bool CTextureDatabase::IncrementUseCount(const CTextureDetails &details, unsigned int count)
 {
-  CStdString sql = PrepareSQL("UPDATE sizes SET usecount=usecount+1, lastusetime=CURRENT_TIMESTAMP WHERE idtexture=%u AND width=%u AND height=%u", details.id, details.width, details.height);
+  CStdString sql = PrepareSQL("UPDATE sizes SET usecount=usecount+%u, lastusetime=CURRENT_TIMESTAMP WHERE idtexture=%u AND width=%u AND height=%u", count, details.id, details.width, details.height);
   return ExecuteQuery(sql);
 }
 
@@ -178,6 +180,20 @@ bool CTextureDatabase::GetCachedTexture(const CStdString &url, CTextureDetails &
       details.width = m_pDS->fv(4).get_asInt();
       details.height = m_pDS->fv(5).get_asInt();
       m_pDS->close();
+
+      details.tiers.clear();
+      sql = PrepareSQL("SELECT size, width, height FROM sizes WHERE idtexture=%u AND size>1 ORDER BY size", details.id);
+      m_pDS->query(sql.c_str());
+      while (!m_pDS->eof())
+      {
+        CTextureTier tier;
+        tier.size = m_pDS->fv(0).get_asInt();
+        tier.width = m_pDS->fv(1).get_asInt();
+        tier.height = m_pDS->fv(2).get_asInt();
+        details.tiers.push_back(tier);
+        m_pDS->next();
+      }
+      m_pDS->close();
       return true;
     }
     m_pDS->close();
@@ -189,6 +205,53 @@ bool CTextureDatabase::GetCachedTexture(const CStdString &url, CTextureDetails &
   return false;
 }
 
+bool CTextureDatabase::GetCachedTextures(CTextureIndex &textures)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    std::map<int, CTextureIndexEntry *> ids;
+    m_pDS->query("SELECT url, id, cachedurl, lasthashcheck, imagehash, width, height FROM texture JOIN sizes ON (texture.id=sizes.idtexture AND sizes.size=1)");
+    while (!m_pDS->eof())
+    {
+      CTextureIndexEntry &entry = textures[m_pDS->fv(0).get_asString()];
+      entry.details.id = m_pDS->fv(1).get_asInt();
+      entry.details.file = m_pDS->fv(2).get_asString();
+      entry.lastHashCheck.SetFromDBDateTime(m_pDS->fv(3).get_asString());
+      entry.details.hash = m_pDS->fv(4).get_asString();
+      entry.details.width = m_pDS->fv(5).get_asInt();
+      entry.details.height = m_pDS->fv(6).get_asInt();
+      ids[entry.details.id] = &entry;
+      m_pDS->next();
+    }
+    m_pDS->close();
+
+    m_pDS->query("SELECT idtexture, size, width, height FROM sizes WHERE size>1 ORDER BY idtexture, size");
+    while (!m_pDS->eof())
+    {
+      std::map<int, CTextureIndexEntry *>::iterator i = ids.find(m_pDS->fv(0).get_asInt());
+      if (i != ids.end())
+      {
+        CTextureTier tier;
+        tier.size = m_pDS->fv(1).get_asInt();
+        tier.width = m_pDS->fv(2).get_asInt();
+        tier.height = m_pDS->fv(3).get_asInt();
+        i->second->details.tiers.push_back(tier);
+      }
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
 bool CTextureDatabase::SetCachedTextureValid(const CStdString &url, bool updateable)
 {
   CStdString date = updateable ? CDateTime::GetCurrentDateTime().GetAsDBDateTime() : "";
@@ -196,7 +259,7 @@ bool CTextureDatabase::SetCachedTextureValid(const CStdString &url, bool updatea
   return ExecuteQuery(sql);
 }
 
-bool CTextureDatabase::AddCachedTexture(const CStdString &url, const CTextureDetails &details)
+bool CTextureDatabase::AddCachedTexture(const CStdString &url, CTextureDetails &details)
 {
   try
   {
@@ -214,6 +277,14 @@ bool CTextureDatabase::AddCachedTexture(const CStdString &url, const CTextureDet
     // set the size information
     sql = PrepareSQL("INSERT INTO sizes (idtexture, size, usecount, lastusetime, width, height) VALUES(%u, 1, 1, CURRENT_TIMESTAMP, %u, %u)", textureID, details.width, details.height);
     m_pDS->exec(sql.c_str());
+    details.id = textureID;
+
+    // and that of the smaller versions
+    for (std::vector<CTextureTier>::const_iterator i = details.tiers.begin(); i != details.tiers.end(); ++i)
+    {
+      sql = PrepareSQL("INSERT INTO sizes (idtexture, size, usecount, lastusetime, width, height) VALUES(%u, %u, 0, CURRENT_TIMESTAMP, %u, %u)", textureID, i->size, i->width, i->height);
+      m_pDS->exec(sql.c_str());
+    }
   }
   catch (...)
   {
@@ -240,6 +311,12 @@ bool CTextureDatabase::ClearCachedTexture(const CStdString &url, CStdString &cac
       // remove it
       sql = PrepareSQL("delete from texture where id=%u", textureID);
       m_pDS->exec(sql.c_str());
+      // the file may be shared with textures of identical images, it's kept for them then
+      sql = PrepareSQL("select id from texture where cachedurl='%s' limit 1", cacheFile.c_str());
+      m_pDS->query(sql.c_str());
+      if (!m_pDS->eof())
+        cacheFile.clear();
+      m_pDS->close();
       return true;
     }
     m_pDS->close();
@@ -258,6 +335,12 @@ bool CTextureDatabase::InvalidateCachedTexture(const CStdString &url)
   return ExecuteQuery(sql);
 }
 
+bool CTextureDatabase::SetCachedFile(const CStdString &url, const CStdString &cacheFile)
+{
+  CStdString sql = PrepareSQL("UPDATE texture SET cachedurl='%s' WHERE url='%s'", cacheFile.c_str(), url.c_str());
+  return ExecuteQuery(sql);
+}
+
 CStdString CTextureDatabase::GetTextureForPath(const CStdString &url, const CStdString &type)
 {
   try
@@ -23,6 +23,20 @@
 
 #include "dbwrappers/Database.h"
 #include "TextureCacheJob.h"
+#include "XBDateTime.h"
+#include <boost/unordered_map.hpp>
+
+/*!
+ \brief A row of the texture table as kept in memory by CTextureCache
+ */
+class CTextureIndexEntry
+{
+public:
+  CTextureDetails details;       ///< with the image hash, whether or not it is due for checking
+  CDateTime       lastHashCheck; ///< invalid if the image isn't checked for updates
+};
+
+typedef boost::unordered_map<std::string, CTextureIndexEntry> CTextureIndex;
 
 class CTextureDatabase : public CDatabase
 {
@@ -32,10 +46,17 @@ public:
   virtual bool Open();
 
   bool GetCachedTexture(const CStdString &originalURL, CTextureDetails &details);
-  bool AddCachedTexture(const CStdString &originalURL, const CTextureDetails &details);
+  bool AddCachedTexture(const CStdString &originalURL, CTextureDetails &details);
   bool SetCachedTextureValid(const CStdString &originalURL, bool updateable);
   bool ClearCachedTexture(const CStdString &originalURL, CStdString &cacheFile);
-  bool IncrementUseCount(const CTextureDetails &details);
+  bool IncrementUseCount(const CTextureDetails &details, unsigned int count = 1);
+
+  /*! \brief Get all cached textures at once
+   Used to build the index CTextureCache looks images up in.
+   \param textures [out] the textures keyed on their original url
+   \return true if the textures were read, false otherwise.
+   */
+  bool GetCachedTextures(CTextureIndex &textures);
 
   /*! \brief Invalidate a previously cached texture
    Invalidates the texture hash, and sets the texture update time to the current time so that
@@ -44,6 +65,13 @@ public:
    */
   bool InvalidateCachedTexture(const CStdString &originalURL);
 
+  /*! \brief Point a cached texture at another cached file
+   Used to share one cached file between textures of identical images.
+   \param url texture path
+   \param cacheFile the cached file to use, relative to the thumbnails folder
+   */
+  bool SetCachedFile(const CStdString &originalURL, const CStdString &cacheFile);
+
   /*! \brief Get a texture associated with the given path
    Used for retrieval of previously discovered images to save
    stat() on the filesystem all the time
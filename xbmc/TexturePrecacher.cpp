@@ -0,0 +1,237 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "system.h"
+#include "TexturePrecacher.h"
+#include "Application.h"
+#include "TextureCache.h"
+#include "interfaces/AnnouncementManager.h"
+#include "music/MusicDatabase.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/CPUInfo.h"
+#include "utils/JobManager.h"
+#include "utils/log.h"
+#include "video/VideoDatabase.h"
+
+using namespace std;
+using namespace ANNOUNCEMENT;
+
+class CTexturePrecacheJob : public CJob
+{
+public:
+  CTexturePrecacheJob(int lastVideoArt, int lastMusicThumb)
+    : m_lastVideoArt(lastVideoArt), m_lastMusicThumb(lastMusicThumb),
+      m_total(0), m_cached(0), m_failed(0), m_shared(0), m_saved(0), m_busy(0)
+  {
+  }
+
+  virtual const char *GetType() const { return "precache"; }
+
+  virtual bool DoWork()
+  {
+    vector< pair<int, string> > videoArt, musicThumbs;
+    CVideoDatabase videodb;
+    if (videodb.Open())
+    {
+      videodb.GetArtURLs(m_lastVideoArt, videoArt);
+      videodb.Close();
+    }
+    CMusicDatabase musicdb;
+    if (musicdb.Open())
+    {
+      musicdb.GetThumbURLs(m_lastMusicThumb, musicThumbs);
+      musicdb.Close();
+    }
+
+    vector<string> urls;
+    for (vector< pair<int, string> >::const_iterator i = videoArt.begin(); i != videoArt.end(); ++i)
+      urls.push_back(i->second);
+    for (vector< pair<int, string> >::const_iterator i = musicThumbs.begin(); i != musicThumbs.end(); ++i)
+      urls.push_back(i->second);
+    m_total = urls.size();
+
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    unsigned int idle = 0;
+    for (unsigned int i = 0; i < urls.size(); i++)
+    {
+      idle += WaitUntilIdle(i);
+      if (ShouldCancel(i, m_total))
+        return false;
+      if (i && i % 100 == 0)
+        CLog::Log(LOGDEBUG, "%s - checked %u of %u images, cached %u", __FUNCTION__, i, m_total, m_cached);
+
+      const string &url = urls[i];
+      // don't count the check as a use of the image, that would keep it from being pruned
+      if (url.empty() || CTextureCache::Get().HasCachedImage(url))
+        continue;
+
+      if (CTextureCache::Get().CacheImage(url).IsEmpty())
+      {
+        m_failed++;
+        continue;
+      }
+      m_cached++;
+
+      uint64_t saved = 0;
+      if (CTextureCache::Get().ShareCachedImage(url, saved) && saved)
+      {
+        m_shared++;
+        m_saved += saved;
+      }
+    }
+    m_busy = XbmcThreads::SystemClockMillis() - start - idle;
+
+    if (!videoArt.empty())
+      m_lastVideoArt = videoArt.back().first;
+    if (!musicThumbs.empty())
+      m_lastMusicThumb = musicThumbs.back().first;
+    return true;
+  }
+
+  int          m_lastVideoArt;
+  int          m_lastMusicThumb;
+  unsigned int m_total;
+  unsigned int m_cached;
+  unsigned int m_failed;
+  unsigned int m_shared;  ///< images cached that were identical to one stored already
+  uint64_t     m_saved;   ///< bytes of the files of those
+  unsigned int m_busy;    ///< ms spent checking and caching, not waiting
+
+private:
+  /*!
+   \brief Wait while anything plays or the CPU is busy, or until the job is cancelled
+   \return the time waited in ms
+   */
+  unsigned int WaitUntilIdle(unsigned int progress)
+  {
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    while (!ShouldCancel(progress, m_total))
+    {
+      if (!g_application.IsPlaying() && g_cpuInfo.getUsedPercentage() <= g_advancedSettings.m_precacheMaxCPU)
+        break;
+      Sleep(500);
+    }
+    return XbmcThreads::SystemClockMillis() - start;
+  }
+};
+
+CTexturePrecacher &CTexturePrecacher::Get()
+{
+  static CTexturePrecacher s_precacher;
+  return s_precacher;
+}
+
+CTexturePrecacher::CTexturePrecacher()
+{
+  m_listening = false;
+  m_running = false;
+  m_pending = false;
+  m_jobID = 0;
+  m_lastVideoArt = 0;
+  m_lastMusicThumb = 0;
+}
+
+CTexturePrecacher::~CTexturePrecacher()
+{
+}
+
+void CTexturePrecacher::Start()
+{
+  if (g_advancedSettings.m_precacheMaxCPU <= 0)
+    return;
+
+  // only the application gets here before we listen, so this needn't be locked. Holding our
+  // lock while adding would risk a deadlock with finished scans being announced.
+  if (!m_listening)
+  {
+    m_listening = true;
+    CAnnouncementManager::AddAnnouncer(this);
+  }
+
+  CSingleLock lock(m_section);
+  if (m_running)
+  {
+    m_pending = true;
+    return;
+  }
+  m_running = true;
+  m_pending = false;
+  m_jobID = CJobManager::GetInstance().AddJob(new CTexturePrecacheJob(m_lastVideoArt, m_lastMusicThumb), this, CJob::PRIORITY_LOW);
+}
+
+void CTexturePrecacher::Stop()
+{
+  if (m_listening)
+  {
+    CAnnouncementManager::RemoveAnnouncer(this);
+    m_listening = false;
+  }
+
+  CSingleLock lock(m_section);
+  if (m_running)
+    CJobManager::GetInstance().CancelJob(m_jobID);
+  m_running = false;
+  m_pending = false;
+}
+
+void CTexturePrecacher::Restart()
+{
+  bool started = m_listening;
+  Stop();
+  {
+    CSingleLock lock(m_section);
+    m_lastVideoArt = 0;
+    m_lastMusicThumb = 0;
+  }
+  if (started)
+    Start();
+}
+
+void CTexturePrecacher::Announce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+{
+  if ((flag == VideoLibrary || flag == AudioLibrary) &&
+      strcmp(sender, "xbmc") == 0 &&
+      (strcmp(message, "OnScanFinished") == 0 || strcmp(message, "OnChanged") == 0))
+    Start();
+}
+
+void CTexturePrecacher::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CTexturePrecacheJob *precache = (CTexturePrecacheJob *)job;
+  if (success)
+    CLog::Log(LOGDEBUG, "%s - checked %u images in %u ms, cached %u (%u failed), %u of them identical to ones stored already, saving %u KB",
+              __FUNCTION__, precache->m_total, precache->m_busy, precache->m_cached, precache->m_failed,
+              precache->m_shared, (unsigned int)(precache->m_saved / 1024));
+
+  CSingleLock lock(m_section);
+  if (jobID != m_jobID || !m_running)
+    return;
+  if (success)
+  {
+    m_lastVideoArt = precache->m_lastVideoArt;
+    m_lastMusicThumb = precache->m_lastMusicThumb;
+  }
+  m_running = false;
+  if (m_pending)
+    Start();
+}
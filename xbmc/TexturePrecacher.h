@@ -0,0 +1,80 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "interfaces/IAnnouncer.h"
+#include "threads/CriticalSection.h"
+#include "utils/Job.h"
+
+/*!
+ \ingroup textures,jobs
+ \brief Caches the art of the library ahead of it being shown
+
+ Walks the art of the video library and the thumbs of the music library that were
+ added since the last walk, and caches the images not cached yet, so that browsing
+ newly scanned items doesn't wait on full size images being decoded. Runs on start
+ and whenever a library scan finishes. Art changed for an item gets a new
+ art_id, so it's walked again too. Identical images are stored once, see
+ CTextureCache::ShareCachedImage.
+
+ Caching waits while anything plays, and while the CPU is busier than
+ <precachemaxcpu> percent in advancedsettings.xml. Setting it to 0 turns this off.
+
+ \sa CTextureCache
+ */
+class CTexturePrecacher : public ANNOUNCEMENT::IAnnouncer, public IJobCallback
+{
+public:
+  static CTexturePrecacher &Get();
+
+  /*!
+   \brief Start caching the art added since the last run
+   If a run is going on already, another one follows it.
+   */
+  void Start();
+
+  /*!
+   \brief Stop caching, and stop listening for finished scans
+   */
+  void Stop();
+
+  /*!
+   \brief Forget the art walked so far and start over if started
+   Called when a profile is loaded, as each profile has a library of its own.
+   */
+  void Restart();
+
+  virtual void Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+private:
+  CTexturePrecacher();
+  virtual ~CTexturePrecacher();
+
+  CCriticalSection m_section;
+  bool             m_listening;
+  bool             m_running;
+  bool             m_pending;        ///< start another run once this one is done
+  unsigned int     m_jobID;
+  int              m_lastVideoArt;   ///< art_id of the last art of the video library walked
+  int              m_lastMusicThumb; ///< idThumb of the last thumb of the music library walked
+};
@@ -0,0 +1,152 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "ThumbExtractorService.h"
+#include "ThumbLoader.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/CPUInfo.h"
+#include "utils/log.h"
+
+CThumbExtractorStats::CThumbExtractorStats()
+{
+  files  = 0;
+  failed = 0;
+  busy   = 0;
+}
+
+float CThumbExtractorStats::FilesPerMinute() const
+{
+  if (!busy)
+    return 0.0f;
+  return files * 60000.0f / busy;
+}
+
+CThumbExtractorService &CThumbExtractorService::Get()
+{
+  static CThumbExtractorService s_service(GetWorkers());
+  return s_service;
+}
+
+unsigned int CThumbExtractorService::GetWorkers()
+{
+  if (g_advancedSettings.m_videoExtractionThreads > 0)
+    return g_advancedSettings.m_videoExtractionThreads;
+
+  // leave a core for the gui and playback
+  int workers = g_cpuInfo.getCPUCount() - 1;
+  return std::min(std::max(workers, 1), 3);
+}
+
+CThumbExtractorService::CThumbExtractorService(unsigned int workers)
+  : CJobQueue(true, workers, CJob::PRIORITY_LOW), m_codecs(workers + 1)
+{
+  m_pending   = 0;
+  m_busySince = 0;
+  CLog::Log(LOGDEBUG, "%s - extracting with %u workers", __FUNCTION__, workers);
+}
+
+CThumbExtractorService::~CThumbExtractorService()
+{
+  CancelJobs();
+}
+
+void CThumbExtractorService::AddJob(CThumbExtractor *job, IJobCallback *owner)
+{
+  {
+    CSingleLock lock(m_ownerSection);
+    m_owners.insert(owner);
+  }
+  job->m_owner = owner;
+  CJobQueue::AddJob(job);
+}
+
+void CThumbExtractorService::Detach(const IJobCallback *owner)
+{
+  CSingleLock lock(m_ownerSection);
+  m_owners.erase(owner);
+}
+
+bool CThumbExtractorService::IsAttached(const IJobCallback *owner)
+{
+  CSingleLock lock(m_ownerSection);
+  return m_owners.find(owner) != m_owners.end();
+}
+
+void CThumbExtractorService::Stop()
+{
+  CancelJobs();
+  m_codecs.Close();
+}
+
+void CThumbExtractorService::JobStarted()
+{
+  CSingleLock lock(m_statsSection);
+  if (m_pending++ == 0)
+    m_busySince = XbmcThreads::SystemClockMillis();
+}
+
+void CThumbExtractorService::AddTimings(const DVDFileInfoTimings &timings, bool success)
+{
+  CSingleLock lock(m_statsSection);
+  m_stats.files++;
+  if (!success)
+    m_stats.failed++;
+  m_stats.total.open    += timings.open;
+  m_stats.total.details += timings.details;
+  m_stats.total.seek    += timings.seek;
+  m_stats.total.decode  += timings.decode;
+  m_stats.total.scale   += timings.scale;
+}
+
+CThumbExtractorStats CThumbExtractorService::GetStats()
+{
+  CSingleLock lock(m_statsSection);
+  CThumbExtractorStats stats = m_stats;
+  if (m_pending)
+    stats.busy += XbmcThreads::SystemClockMillis() - m_busySince;
+  return stats;
+}
+
+void CThumbExtractorService::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  {
+    // held while reporting, so Detach() waits for us before the owner goes away
+    CSingleLock lock(m_ownerSection);
+    IJobCallback *owner = ((CThumbExtractor*)job)->m_owner;
+    if (m_owners.find(owner) != m_owners.end())
+      owner->OnJobComplete(jobID, success, job);
+  }
+
+  {
+    CSingleLock lock(m_statsSection);
+    if (m_pending && --m_pending == 0)
+    {
+      m_stats.busy += XbmcThreads::SystemClockMillis() - m_busySince;
+      CLog::Log(LOGDEBUG, "%s - %u files (%u failed) at %.1f files/min, open %u ms, details %u ms, seek %u ms, decode %u ms, scale %u ms",
+                __FUNCTION__, m_stats.files, m_stats.failed, m_stats.FilesPerMinute(),
+                m_stats.total.open, m_stats.total.details, m_stats.total.seek, m_stats.total.decode, m_stats.total.scale);
+    }
+  }
+
+  CJobQueue::OnJobComplete(jobID, success, job);
+}
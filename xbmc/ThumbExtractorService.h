@@ -0,0 +1,115 @@
+#pragma once
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <set>
+#include "utils/JobManager.h"
+#include "cores/dvdplayer/DVDFileInfo.h"
+
+class CThumbExtractor;
+
+/*!
+ \ingroup thumbs,jobs
+ \brief Running totals of the thumb and stream details extraction service
+ */
+class CThumbExtractorStats
+{
+public:
+  CThumbExtractorStats();
+
+  /*! \brief files processed per minute the service was busy */
+  float FilesPerMinute() const;
+
+  unsigned int files;      ///< files processed
+  unsigned int failed;     ///< files we couldn't get anything out of
+  unsigned int busy;       ///< ms the service was processing files
+  DVDFileInfoTimings total;///< ms spent in each stage, summed over all files
+};
+
+/*!
+ \ingroup thumbs,jobs
+ \brief Shared service extracting thumbs and stream details from video files
+
+ All thumb loaders queue their CThumbExtractor jobs here, so the number of files
+ opened at once is bounded over the whole application rather than per loader.
+ Decoders are kept around between files of the same format, and completed jobs
+ are handed back to the loader that queued them.
+
+ \sa CThumbExtractor, CVideoThumbLoader
+ */
+class CThumbExtractorService : public CJobQueue
+{
+public:
+  static CThumbExtractorService &Get();
+
+  /*!
+   \brief Queue an extraction job
+   \param job the job to queue, owned by the service from here on.
+   \param owner callback to receive the completed job, must call Detach() before it is destroyed.
+   */
+  void AddJob(CThumbExtractor *job, IJobCallback *owner);
+
+  /*!
+   \brief Stop reporting jobs to the given owner
+   Queued jobs of the owner are skipped once they come up. Waits for a job of the
+   owner being reported, so the owner may be destroyed once this returns.
+   \param owner the callback previously given to AddJob()
+   */
+  void Detach(const IJobCallback *owner);
+
+  /*! \brief Check whether results of jobs of the given owner are still wanted */
+  bool IsAttached(const IJobCallback *owner);
+
+  /*!
+   \brief Cancel the queued jobs and free the cached decoders
+   Called on application stop, before the codec libraries are unloaded. Decoders
+   released by jobs still running are freed rather than cached from here on.
+   */
+  void Stop();
+
+  CDVDVideoCodecCache &GetCodecCache() { return m_codecs; };
+
+  /*! \brief Called by a job as it starts processing, for the busy time */
+  void JobStarted();
+
+  /*! \brief Account a processed file in the statistics */
+  void AddTimings(const DVDFileInfoTimings &timings, bool success);
+
+  CThumbExtractorStats GetStats();
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+private:
+  CThumbExtractorService(unsigned int workers);
+  virtual ~CThumbExtractorService();
+
+  static unsigned int GetWorkers();
+
+  CCriticalSection              m_ownerSection;
+  std::set<const IJobCallback*> m_owners;
+
+  CCriticalSection     m_statsSection;
+  CThumbExtractorStats m_stats;
+  unsigned int         m_pending;  ///< jobs being processed
+  unsigned int         m_busySince;
+
+  CDVDVideoCodecCache  m_codecs;
+};
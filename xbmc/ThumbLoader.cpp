@@ -37,6 +37,7 @@
 #include "video/VideoDatabase.h"
 #include "cores/dvdplayer/DVDFileInfo.h"
 #include "video/VideoInfoScanner.h"
+#include "ThumbExtractorService.h"
 
 using namespace XFILE;
 using namespace std;
@@ -72,6 +73,7 @@ CThumbExtractor::CThumbExtractor(const CFileItem& item, const CStdString& listpa
   m_target = target;
   m_thumb = thumb;
   m_item = item;
+  m_owner = NULL;
 
   m_path = item.GetPath();
 
@@ -91,14 +93,28 @@ bool CThumbExtractor::operator==(const CJob* job) const
   if (strcmp(job->GetType(),GetType()) == 0)
   {
     const CThumbExtractor* jobExtract = dynamic_cast<const CThumbExtractor*>(job);
-    if (jobExtract && jobExtract->m_listpath == m_listpath)
+    if (jobExtract && jobExtract->m_listpath == m_listpath && jobExtract->m_owner == m_owner)
       return true;
   }
   return false;
 }
 
+std::string CThumbExtractor::GetKey() const
+{
+  CStdString key;
+  key.Format("%s|%p|%s", GetType(), m_owner, m_listpath.c_str());
+  return key;
+}
+
 bool CThumbExtractor::DoWork()
 {
+  CThumbExtractorService &service = CThumbExtractorService::Get();
+  service.JobStarted();
+
+  // nobody is waiting for this one anymore
+  if (!service.IsAttached(m_owner))
+    return false;
+
   if (URIUtils::IsLiveTV(m_path)
   ||  URIUtils::IsUPnP(m_path)
   ||  URIUtils::IsDAAP(m_path)
@@ -113,13 +129,14 @@ bool CThumbExtractor::DoWork()
     return false;
 
   bool result=false;
+  DVDFileInfoTimings timings;
   if (m_thumb)
   {
     CLog::Log(LOGDEBUG,"%s - trying to extract thumb from video file %s", __FUNCTION__, m_path.c_str());
     // construct the thumb cache file
     CTextureDetails details;
     details.file = CTextureCache::GetCacheFile(m_target) + ".jpg";
-    result = CDVDFileInfo::ExtractThumb(m_path, details, &m_item.GetVideoInfoTag()->m_streamDetails);
+    result = CDVDFileInfo::ExtractThumb(m_path, details, &m_item.GetVideoInfoTag()->m_streamDetails, &service.GetCodecCache(), &timings);
     if(result)
     {
       CTextureCache::Get().AddCachedTexture(m_target, details);
@@ -131,14 +148,17 @@ bool CThumbExtractor::DoWork()
   else if (m_item.HasVideoInfoTag() && !m_item.GetVideoInfoTag()->HasStreamDetails())
   {
     CLog::Log(LOGDEBUG,"%s - trying to extract filestream details from video file %s", __FUNCTION__, m_path.c_str());
-    result = CDVDFileInfo::GetFileStreamDetails(&m_item);
+    result = CDVDFileInfo::GetFileStreamDetails(&m_item, &timings);
   }
+  else
+    return false;
 
+  service.AddTimings(timings, result);
   return result;
 }
 
 CVideoThumbLoader::CVideoThumbLoader() :
-  CThumbLoader(1), CJobQueue(true), m_pStreamDetailsObs(NULL)
+  CThumbLoader(1), m_pStreamDetailsObs(NULL)
 {
   m_database = new CVideoDatabase();
 }
@@ -146,6 +166,7 @@ CVideoThumbLoader::CVideoThumbLoader() :
 CVideoThumbLoader::~CVideoThumbLoader()
 {
   StopThread();
+  CThumbExtractorService::Get().Detach(this);
   delete m_database;
 }
 
@@ -259,7 +280,7 @@ bool CVideoThumbLoader::LoadItem(CFileItem* pItem)
           SetupRarOptions(item,path);
 
         CThumbExtractor* extract = new CThumbExtractor(item, path, true, thumbURL);
-        AddJob(extract);
+        CThumbExtractorService::Get().AddJob(extract, this);
 
         m_database->Close();
         return true;
@@ -279,7 +300,7 @@ bool CVideoThumbLoader::LoadItem(CFileItem* pItem)
     if (URIUtils::IsInRAR(item.GetPath()))
       SetupRarOptions(item,path);
     CThumbExtractor* extract = new CThumbExtractor(item,path,false);
-    AddJob(extract);
+    CThumbExtractorService::Get().AddJob(extract, this);
   }
 
   m_database->Close();
@@ -410,7 +431,6 @@ void CVideoThumbLoader::OnJobComplete(unsigned int jobID, bool success, CJob* jo
     CGUIMessage msg(GUI_MSG_NOTIFY_ALL, 0, 0, GUI_MSG_UPDATE_ITEM, 0, pItem);
     g_windowManager.SendThreadMessage(msg);
   }
-  CJobQueue::OnJobComplete(jobID, success, job);
 }
 
 CProgramThumbLoader::CProgramThumbLoader()
@@ -54,12 +54,14 @@ public:
   }
 
   virtual bool operator==(const CJob* job) const;
+  virtual std::string GetKey() const;
 
   CStdString m_path; ///< path of video to extract thumb from
   CStdString m_target; ///< thumbpath
   CStdString m_listpath; ///< path used in fileitem list
   CFileItem  m_item;
   bool       m_thumb; ///< extract thumb?
+  IJobCallback *m_owner; ///< loader that queued us, set by CThumbExtractorService
 };
 
 class CThumbLoader : public CBackgroundInfoLoader
@@ -83,7 +85,7 @@ public:
   static void SetCachedImage(const CFileItem &item, const CStdString &type, const CStdString &image);
 };
 
-class CVideoThumbLoader : public CThumbLoader, public CJobQueue
+class CVideoThumbLoader : public CThumbLoader, public IJobCallback
 {
 public:
   CVideoThumbLoader();
@@ -116,7 +118,7 @@ public:
 
    Performs the callbacks and updates the GUI.
 
-   \sa CImageLoader, IJobCallback
+   \sa CImageLoader, IJobCallback, CThumbExtractorService
    */
   virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
 
@@ -26,6 +26,9 @@
 #include "XBDateTime.h"
 #include "addons/Service.h"
 #include "dbwrappers/dataset.h"
+#include "utils/md5.h"
+#include "utils/TimeUtils.h"
+#include <map>
 
 using namespace ADDON;
 using namespace std;
@@ -54,7 +57,7 @@ bool CAddonDatabase::CreateTables()
                 "name text, summary text, description text, stars integer,"
                 "path text, addonID text, icon text, version text, "
                 "changelog text, fanart text, author text, disclaimer text,"
-                "minversion text)\n");
+                "minversion text, digest text)\n");
 
     CLog::Log(LOGINFO, "create addon index");
     m_pDS->exec("CREATE INDEX idxAddon ON addon(addonID)");
@@ -119,6 +122,11 @@ bool CAddonDatabase::UpdateOldVersion(int version)
       m_pDS->exec("CREATE TABLE blacklist (id integer primary key, addonID text, version text)\n");
       m_pDS->exec("CREATE UNIQUE INDEX idxBlack ON blacklist(addonID)");
     }
+    if (version < 16)
+    {
+      // rows without a digest are rewritten on the next update of their repository
+      m_pDS->exec("ALTER TABLE addon add digest text");
+    }
   }
   catch (...)
   {
@@ -140,9 +148,9 @@ int CAddonDatabase::AddAddon(const AddonPtr& addon,
 
     CStdString sql = PrepareSQL("insert into addon (id, type, name, summary,"
                                "description, stars, path, icon, changelog, "
-                               "fanart, addonID, version, author, disclaimer, minversion)"
+                               "fanart, addonID, version, author, disclaimer, minversion, digest)"
                                " values(NULL, '%s', '%s', '%s', '%s', %i,"
-                               "'%s', '%s', '%s', '%s', '%s','%s','%s','%s','%s')",
+                               "'%s', '%s', '%s', '%s', '%s','%s','%s','%s','%s','%s')",
                                TranslateType(addon->Type(),false).c_str(),
                                addon->Name().c_str(), addon->Summary().c_str(),
                                addon->Description().c_str(),addon->Stars(),
@@ -150,7 +158,8 @@ int CAddonDatabase::AddAddon(const AddonPtr& addon,
                                addon->ChangeLog().c_str(),addon->FanArt().c_str(),
                                addon->ID().c_str(), addon->Version().c_str(),
                                addon->Author().c_str(),addon->Disclaimer().c_str(),
-                               addon->MinVersion().c_str());
+                               addon->MinVersion().c_str(),
+                               GetAddonDigest(addon).c_str());
     m_pDS->exec(sql.c_str());
     int idAddon = (int)m_pDS->lastinsertid();
 
@@ -374,21 +383,67 @@ int CAddonDatabase::AddRepository(const CStdString& id, const VECADDONS& addons,
     if (NULL == m_pDB.get()) return -1;
     if (NULL == m_pDS.get()) return -1;
 
+    int64_t start = CurrentHostCounter();
+
     CStdString sql;
     int idRepo = GetRepoChecksum(id,sql);
-    if (idRepo > -1)
-      DeleteRepository(idRepo);
 
     BeginTransaction();
 
     CDateTime time = CDateTime::GetCurrentDateTime();
-    sql = PrepareSQL("insert into repo (id,addonID,checksum,lastcheck) values (NULL,'%s','%s','%s')",id.c_str(),checksum.c_str(),time.GetAsDBDateTime().c_str());
-    m_pDS->exec(sql.c_str());
-    idRepo = (int)m_pDS->lastinsertid();
+    typedef multimap<string, pair<int, string> > STOREDADDONS;
+    STOREDADDONS stored;
+    if (idRepo > -1)
+    {
+      sql = PrepareSQL("update repo set checksum='%s',lastcheck='%s' where id=%i",checksum.c_str(),time.GetAsDBDateTime().c_str(),idRepo);
+      m_pDS->exec(sql.c_str());
+
+      sql = PrepareSQL("select addon.id,addon.addonID,addon.digest from addon join addonlinkrepo on addon.id=addonlinkrepo.idAddon where addonlinkrepo.idRepo=%i",idRepo);
+      m_pDS->query(sql.c_str());
+      while (!m_pDS->eof())
+      {
+        stored.insert(make_pair(m_pDS->fv(1).get_asString(), make_pair(m_pDS->fv(0).get_asInt(), m_pDS->fv(2).get_asString())));
+        m_pDS->next();
+      }
+      m_pDS->close();
+    }
+    else
+    {
+      sql = PrepareSQL("insert into repo (id,addonID,checksum,lastcheck) values (NULL,'%s','%s','%s')",id.c_str(),checksum.c_str(),time.GetAsDBDateTime().c_str());
+      m_pDS->exec(sql.c_str());
+      idRepo = (int)m_pDS->lastinsertid();
+    }
+
+    // keep the addons that are stored exactly as listed, write the rest
+    unsigned int unchanged = 0, written = 0;
     for (unsigned int i=0;i<addons.size();++i)
-      AddAddon(addons[i],idRepo);
+    {
+      CStdString digest = GetAddonDigest(addons[i]);
+      pair<STOREDADDONS::iterator, STOREDADDONS::iterator> range = stored.equal_range(addons[i]->ID());
+      STOREDADDONS::iterator match = range.first;
+      while (match != range.second && match->second.second != digest)
+        ++match;
+      if (match != range.second)
+      {
+        stored.erase(match);
+        unchanged++;
+      }
+      else
+      {
+        AddAddon(addons[i],idRepo);
+        written++;
+      }
+    }
+
+    // whatever is left was changed or is no longer listed
+    for (STOREDADDONS::const_iterator i = stored.begin(); i != stored.end(); ++i)
+      DeleteAddon(i->second.first);
 
     CommitTransaction();
+
+    CLog::Log(LOGDEBUG, "%s - repository %s: %u addons unchanged, %u written, %u removed in %.1f ms", __FUNCTION__,
+              id.c_str(), unchanged, written, (unsigned int)stored.size(),
+              (CurrentHostCounter() - start) * 1000.0 / CurrentHostFrequency());
     return idRepo;
   }
   catch (...)
@@ -399,6 +454,51 @@ int CAddonDatabase::AddRepository(const CStdString& id, const VECADDONS& addons,
   return -1;
 }
 
+void CAddonDatabase::DeleteAddon(int idAddon)
+{
+  CStdString sql = PrepareSQL("delete from addon where id=%i",idAddon);
+  m_pDS->exec(sql.c_str());
+  sql = PrepareSQL("delete from addonextra where id=%i",idAddon);
+  m_pDS->exec(sql.c_str());
+  sql = PrepareSQL("delete from dependencies where id=%i",idAddon);
+  m_pDS->exec(sql.c_str());
+  sql = PrepareSQL("delete from addonlinkrepo where idAddon=%i",idAddon);
+  m_pDS->exec(sql.c_str());
+}
+
+CStdString CAddonDatabase::GetAddonDigest(const AddonPtr& addon)
+{
+  XBMC::XBMC_MD5 md5;
+  CStdString fields;
+  fields.Format("%s\n%s\n%s\n%s\n%i\n%s\n%s\n%s\n%s\n%s\n%s\n%s\n%s\n%s\n",
+                TranslateType(addon->Type(),false).c_str(),
+                addon->Name().c_str(), addon->Summary().c_str(),
+                addon->Description().c_str(), addon->Stars(),
+                addon->Path().c_str(), addon->Props().icon.c_str(),
+                addon->ChangeLog().c_str(), addon->FanArt().c_str(),
+                addon->ID().c_str(), addon->Version().c_str(),
+                addon->Author().c_str(), addon->Disclaimer().c_str(),
+                addon->MinVersion().c_str());
+  md5.append(fields);
+
+  const InfoMap &info = addon->ExtraInfo();
+  for (InfoMap::const_iterator i = info.begin(); i != info.end(); ++i)
+  {
+    fields.Format("extra %s=%s\n", i->first.c_str(), i->second.c_str());
+    md5.append(fields);
+  }
+  const ADDONDEPS &deps = addon->GetDeps();
+  for (ADDONDEPS::const_iterator i = deps.begin(); i != deps.end(); ++i)
+  {
+    fields.Format("requires %s %s %i\n", i->first.c_str(), i->second.first.c_str(), i->second.second ? 1 : 0);
+    md5.append(fields);
+  }
+
+  CStdString digest;
+  md5.getDigest(digest);
+  return digest;
+}
+
 int CAddonDatabase::GetRepoChecksum(const CStdString& id, CStdString& checksum)
 {
   try
@@ -580,6 +680,7 @@ bool CAddonDatabase::DisableAddon(const CStdString &addonID, bool disable /* = t
         m_pDS->close();
         sql = PrepareSQL("insert into disabled(id, addonID) values(NULL, '%s')", addonID.c_str());
         m_pDS->exec(sql);
+        CAddonMgr::Get().InvalidateRegistry();
 
         AddonPtr addon;
         // If the addon is a service, stop it
@@ -598,6 +699,7 @@ bool CAddonDatabase::DisableAddon(const CStdString &addonID, bool disable /* = t
     {
       CStdString sql = PrepareSQL("delete from disabled where addonID='%s'", addonID.c_str());
       m_pDS->exec(sql);
+      CAddonMgr::Get().InvalidateRegistry();
 
       AddonPtr addon;
       // If the addon is a service, start it
@@ -662,6 +764,29 @@ bool CAddonDatabase::IsAddonDisabled(const CStdString &addonID)
   return false;
 }
 
+bool CAddonDatabase::GetDisabled(std::set<std::string> &addons)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    m_pDS->query("select addonID from disabled");
+    while (!m_pDS->eof())
+    {
+      addons.insert(m_pDS->fv(0).get_asString());
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
 bool CAddonDatabase::IsSystemPVRAddonEnabled(const CStdString &addonID)
 {
   CStdString strWhereClause = PrepareSQL("addonID = '%s'", addonID.c_str());
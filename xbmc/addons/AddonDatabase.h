@@ -24,6 +24,7 @@
 #include "addons/Addon.h"
 #include "utils/StdString.h"
 #include "FileItem.h"
+#include <set>
 
 class CAddonDatabase : public CDatabase
 {
@@ -43,6 +44,15 @@ public:
    \return true if a repo was found, false otherwise.
    */
   bool GetRepoForAddon(const CStdString& addonID, CStdString& repo);
+
+  /*! \brief Store the addons listed by a repository
+   Addons already stored for the repository are compared with the listing and
+   only those that were added, changed or removed are written, all in one transaction.
+   \param id id of the repository
+   \param addons the addons the repository lists
+   \param checksum checksum of the listing
+   \return the database id of the repository, -1 on failure
+   */
   int AddRepository(const CStdString& id, const ADDON::VECADDONS& addons, const CStdString& checksum);
   void DeleteRepository(const CStdString& id);
   void DeleteRepository(int id);
@@ -74,6 +84,12 @@ public:
    \sa DisableAddon, HasDisabledAddons */
   bool IsAddonDisabled(const CStdString &addonID);
 
+  /*! \brief Get the ids of all disabled addons.
+   \param addons [out] the ids of the disabled addons
+   \return true on success, false on failure
+   \sa DisableAddon, IsAddonDisabled */
+  bool GetDisabled(std::set<std::string> &addons);
+
   /*! \brief Check whether we have disabled addons.
    \return true if we have disabled addons, false otherwise
    \sa DisableAddon, IsAddonDisabled */
@@ -105,7 +121,17 @@ public:
 protected:
   virtual bool CreateTables();
   virtual bool UpdateOldVersion(int version);
-  virtual int GetMinVersion() const { return 15; }
+  virtual int GetMinVersion() const { return 16; }
   const char *GetBaseDBName() const { return "Addons"; }
+
+private:
+  /*! \brief Remove an addon stored for a repository along with its extra info and dependencies
+   \param idAddon database id of the addon */
+  void DeleteAddon(int idAddon);
+
+  /*! \brief Digest of everything stored of an addon, used to spot addons changed in a repository listing
+   \param addon the addon
+   \return md5 of the addon's fields */
+  static CStdString GetAddonDigest(const ADDON::AddonPtr& addon);
 };
 
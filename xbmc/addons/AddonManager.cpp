@@ -30,7 +30,9 @@
 #include "settings/GUISettings.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/log.h"
+#include "utils/TimeUtils.h"
 #include "utils/XBMCTinyXML.h"
+#include "filesystem/File.h"
 #include "dialogs/GUIDialogYesNo.h"
 #ifdef HAS_VISUALISATION
 #include "Visualisation.h"
@@ -197,6 +199,10 @@ bool CAddonMgr::CheckUserDirs(const cp_cfg_element_t *settings)
 CAddonMgr::CAddonMgr()
 {
   m_cpluff = NULL;
+  m_registryVersion = 0;
+  m_lookups = 0;
+  m_lookupTime = 0;
+  m_maxLookupTime = 0;
 }
 
 CAddonMgr::~CAddonMgr()
@@ -284,6 +290,7 @@ bool CAddonMgr::Init()
 
 void CAddonMgr::DeInit()
 {
+  InvalidateRegistry();
   if (m_cpluff)
     m_cpluff->destroy();
   delete m_cpluff;
@@ -387,69 +394,152 @@ bool CAddonMgr::HasOutdatedAddons(bool enabled /*= true*/)
 
 bool CAddonMgr::GetAddons(const TYPE &type, VECADDONS &addons, bool enabled /* = true */, bool bGetDisabledPVRAddons /* = true */)
 {
-  CStdString xbmcPath = CSpecialProtocol::TranslatePath("special://xbmc/addons");
-  CSingleLock lock(m_critSection);
+  int64_t start;
+  RegistryPtr registry = GetRegistry(start);
   addons.clear();
-  cp_status_t status;
-  int num;
-  CStdString ext_point(TranslateType(type));
-  cp_extension_t **exts = m_cpluff->get_extensions_info(m_cp_context, ext_point.c_str(), &status, &num);
-  for(int i=0; i <num; i++)
+  map<string, vector<const cp_extension_t *> >::const_iterator exts = registry->extensions.find(TranslateType(type));
+  if (exts != registry->extensions.end())
   {
-    const cp_extension_t *props = exts[i];
-    bool bIsPVRAddon(TranslateType(props->ext_point_id) == ADDON_PVRDLL);
-
-    if (((bGetDisabledPVRAddons && bIsPVRAddon) || m_database.IsAddonDisabled(props->plugin->identifier) != enabled))
+    for (vector<const cp_extension_t *>::const_iterator i = exts->second.begin(); i != exts->second.end(); ++i)
     {
-      if (bIsPVRAddon && g_PVRManager.IsStarted())
+      const cp_extension_t *props = *i;
+      bool bIsPVRAddon(TranslateType(props->ext_point_id) == ADDON_PVRDLL);
+
+      if (((bGetDisabledPVRAddons && bIsPVRAddon) || registry->IsDisabled(props->plugin->identifier) != enabled))
       {
-        AddonPtr pvrAddon;
-        if (g_PVRClients->GetClient(props->plugin->identifier, pvrAddon))
+        if (bIsPVRAddon && g_PVRManager.IsStarted())
         {
-          addons.push_back(pvrAddon);
-          continue;
+          AddonPtr pvrAddon;
+          if (g_PVRClients->GetClient(props->plugin->identifier, pvrAddon))
+          {
+            addons.push_back(pvrAddon);
+            continue;
+          }
         }
-      }
 
-      AddonPtr addon(Factory(props));
-      if (addon)
-        addons.push_back(addon);
+        AddonPtr addon(Factory(props));
+        if (addon)
+          addons.push_back(addon);
+      }
     }
   }
-  m_cpluff->release_info(m_cp_context, exts);
+  EndLookup(start);
   return addons.size() > 0;
 }
 
 bool CAddonMgr::GetAddon(const CStdString &str, AddonPtr &addon, const TYPE &type/*=ADDON_UNKNOWN*/, bool enabledOnly /*= true*/)
 {
-  CSingleLock lock(m_critSection);
+  int64_t start;
+  RegistryPtr registry = GetRegistry(start);
+  map<string, const cp_plugin_info_t *>::const_iterator i = registry->plugins.find(str);
+  if (i == registry->plugins.end())
+  {
+    EndLookup(start);
+    return false;
+  }
 
-  CStdString xbmcPath = CSpecialProtocol::TranslatePath("special://xbmc/addons");
-  cp_status_t status;
-  cp_plugin_info_t *cpaddon = m_cpluff->get_plugin_info(m_cp_context, str.c_str(), &status);
-  if (status == CP_OK && cpaddon)
+  addon = GetAddonFromDescriptor(i->second);
+  EndLookup(start);
+
+  if (addon && addon.get())
   {
-    addon = GetAddonFromDescriptor(cpaddon);
-    m_cpluff->release_info(m_cp_context, cpaddon);
+    if (enabledOnly && registry->IsDisabled(addon->ID()))
+      return false;
 
-    if (addon && addon.get())
+    if (addon->Type() == ADDON_PVRDLL && g_PVRManager.IsStarted())
     {
-      if (enabledOnly && m_database.IsAddonDisabled(addon->ID()))
-        return false;
-
-      if (addon->Type() == ADDON_PVRDLL && g_PVRManager.IsStarted())
-      {
-        AddonPtr pvrAddon;
-        if (g_PVRClients->GetClient(addon->ID(), pvrAddon))
-          addon = pvrAddon;
-      }
+      AddonPtr pvrAddon;
+      if (g_PVRClients->GetClient(addon->ID(), pvrAddon))
+        addon = pvrAddon;
     }
-    return NULL != addon.get();
   }
-  if (cpaddon)
-    m_cpluff->release_info(m_cp_context, cpaddon);
+  return NULL != addon.get();
+}
 
-  return false;
+void CAddonMgr::InvalidateRegistry()
+{
+  CSingleLock lock(m_registrySection);
+  m_registry.reset();
+  m_registryVersion++;
+}
+
+CAddonMgr::RegistryPtr CAddonMgr::GetRegistry(int64_t &start)
+{
+  start = CurrentHostCounter();
+  unsigned int version;
+  {
+    CSingleLock lock(m_registrySection);
+    if (m_registry)
+      return m_registry;
+    version = m_registryVersion;
+  }
+
+  // cpluff and the database are only used under our lock
+  CSingleLock lock(m_critSection);
+  {
+    CSingleLock registryLock(m_registrySection);
+    if (m_registry) // someone else built it meanwhile
+      return m_registry;
+    version = m_registryVersion;
+  }
+
+  boost::shared_ptr<CRegistry> registry(new CRegistry(m_cpluff, m_cp_context));
+  if (m_cpluff && m_cp_context)
+  {
+    m_database.GetDisabled(registry->disabled);
+    int64_t end = CurrentHostCounter();
+
+    CSingleLock registryLock(m_registrySection);
+    CLog::Log(LOGDEBUG, "%s - %u addons found in %.1f ms, the previous list served %u lookups taking %.1f us on average, %.1f us at most",
+              __FUNCTION__, (unsigned int)registry->plugins.size(), (end - start) * 1000.0 / CurrentHostFrequency(),
+              m_lookups, m_lookups ? m_lookupTime * 1000000.0 / CurrentHostFrequency() / m_lookups : 0.0,
+              m_maxLookupTime * 1000000.0 / CurrentHostFrequency());
+    m_lookups = 0;
+    m_lookupTime = 0;
+    m_maxLookupTime = 0;
+
+    // publish it unless addons changed while we were building it
+    if (version == m_registryVersion)
+      m_registry = registry;
+  }
+  return registry;
+}
+
+void CAddonMgr::EndLookup(int64_t start)
+{
+  int64_t time = CurrentHostCounter() - start;
+  CSingleLock lock(m_registrySection);
+  m_lookups++;
+  m_lookupTime += time;
+  if (time > m_maxLookupTime)
+    m_maxLookupTime = time;
+}
+
+CAddonMgr::CRegistry::CRegistry(DllLibCPluff *cpluff, cp_context_t *context)
+{
+  m_cpluff  = cpluff;
+  m_context = context;
+  m_info    = NULL;
+  if (!m_cpluff || !m_context)
+    return;
+
+  cp_status_t status;
+  int num = 0;
+  m_info = m_cpluff->get_plugins_info(m_context, &status, &num);
+  for (int i = 0; m_info && i < num; i++)
+  {
+    const cp_plugin_info_t *plugin = m_info[i];
+    plugins[plugin->identifier] = plugin;
+    for (unsigned int j = 0; j < plugin->num_extensions; j++)
+      extensions[plugin->extensions[j].ext_point_id].push_back(&plugin->extensions[j]);
+  }
+}
+
+CAddonMgr::CRegistry::~CRegistry()
+{
+  // cpluff keeps the descriptors around until we release them
+  if (m_info && CAddonMgr::Get().m_cpluff == m_cpluff)
+    m_cpluff->release_info(m_context, m_info);
 }
 
 //TODO handle all 'default' cases here, not just scrapers & vizs
@@ -536,6 +626,7 @@ void CAddonMgr::FindAddons()
     if (m_cpluff && m_cp_context)
     {
       m_cpluff->scan_plugins(m_cp_context, CP_SP_UPGRADE);
+      InvalidateRegistry();
       SetChanged();
     }
   }
@@ -547,6 +638,7 @@ void CAddonMgr::RemoveAddon(const CStdString& ID)
   if (m_cpluff && m_cp_context)
   {
     m_cpluff->uninstall_plugin(m_cp_context,ID.c_str());
+    InvalidateRegistry();
     SetChanged();
     NotifyObservers("addons");
   }
@@ -777,6 +869,142 @@ bool CAddonMgr::AddonsFromRepoXML(const TiXmlElement *root, VECADDONS &addons)
   return true;
 }
 
+#define REPO_XML_CHUNK_SIZE 32768
+
+/*! \brief Find the next complete addon element of a repository XML
+ \param xml the part of the file read so far
+ \param pos [in/out] where to start looking, left at the first byte not handled yet
+ \param start [out] start of the element
+ \param end [out] end of the element
+ \param closed [out] set once the end of the root element is seen
+ \return true if a complete element is found, false if more of the file is needed
+ */
+static bool FindRepoXMLElement(const std::string &xml, size_t &pos, size_t &start, size_t &end, bool &closed)
+{
+  while ((pos = xml.find('<', pos)) != std::string::npos)
+  {
+    if (pos + 9 > xml.size())
+      return false;
+
+    if (xml.compare(pos, 4, "<!--") == 0)
+    {
+      size_t close = xml.find("-->", pos + 4);
+      if (close == std::string::npos)
+        return false;
+      pos = close + 3;
+      continue;
+    }
+
+    if (xml.compare(pos, 9, "</addons>") == 0)
+      closed = true;
+    else if (xml.compare(pos, 6, "<addon") == 0 &&
+            (isspace((unsigned char)xml[pos + 6]) || xml[pos + 6] == '>' || xml[pos + 6] == '/'))
+    {
+      // find the end of the start tag, attribute values may hold a '>'
+      char quote = 0;
+      size_t tag = pos + 6;
+      for (; tag < xml.size(); tag++)
+      {
+        if (quote)
+        {
+          if (xml[tag] == quote)
+            quote = 0;
+        }
+        else if (xml[tag] == '"' || xml[tag] == '\'')
+          quote = xml[tag];
+        else if (xml[tag] == '>')
+          break;
+      }
+      if (tag == xml.size())
+        return false;
+
+      // addon elements don't nest, the first closing tag is ours
+      size_t close = tag + 1;
+      if (xml[tag - 1] != '/')
+      {
+        close = xml.find("</addon>", tag);
+        if (close == std::string::npos)
+          return false;
+        close += 8;
+      }
+      start = pos;
+      end = close;
+      pos = close;
+      return true;
+    }
+    pos++;
+  }
+  pos = xml.size();
+  return false;
+}
+
+bool CAddonMgr::AddonsFromRepoXML(const CStdString &file, VECADDONS &addons)
+{
+  XFILE::CFile xml;
+  if (!xml.Open(file))
+    return false;
+
+  // create a context for these addons, c-pluff isn't called from more than one thread at a time
+  cp_status_t status;
+  cp_context_t *context;
+  {
+    CSingleLock lock(m_critSection);
+    context = m_cpluff->create_context(&status);
+  }
+  if (!context)
+    return false;
+
+  // each addon XML should have a UTF-8 declaration
+  std::string decl;
+  decl << TiXmlDeclaration("1.0", "UTF-8", "");
+
+  std::vector<char> chunk(REPO_XML_CHUNK_SIZE);
+  std::string buffer;
+  size_t pos = 0, start, end;
+  bool closed = false;
+  while (true)
+  {
+    if (!FindRepoXMLElement(buffer, pos, start, end, closed))
+    {
+      // drop what has been handled and read some more
+      buffer.erase(0, pos);
+      pos = 0;
+      int read = xml.Read(&chunk[0], chunk.size());
+      if (read <= 0)
+        break;
+      buffer.append(&chunk[0], read);
+      continue;
+    }
+
+    std::string element = decl;
+    element.append(buffer, start, end - start);
+
+    CSingleLock lock(m_critSection);
+    cp_plugin_info_t *info = m_cpluff->load_plugin_descriptor_from_memory(context, element.c_str(), element.size(), &status);
+    if (info)
+    {
+      AddonPtr addon = GetAddonFromDescriptor(info);
+      if (addon.get())
+        addons.push_back(addon);
+      m_cpluff->release_info(context, info);
+    }
+  }
+
+  {
+    CSingleLock lock(m_critSection);
+    m_cpluff->destroy_context(context);
+  }
+
+  // a listing that stops early would look like a repository that dropped addons
+  if (!closed)
+  {
+    CLog::Log(LOGERROR, "%s - %s ended before the end of its addon list", __FUNCTION__, file.c_str());
+    addons.clear();
+    return false;
+  }
+  return true;
+}
+
 bool CAddonMgr::LoadAddonDescriptionFromMemory(const TiXmlElement *root, AddonPtr &addon)
 {
   // create a context for these addons
@@ -26,7 +26,9 @@
 #include <vector>
 #include <map>
 #include <deque>
+#include <set>
 #include "AddonDatabase.h"
+#include "boost/shared_ptr.hpp"
 
 class DllLibCPluff;
 extern "C"
@@ -115,6 +117,11 @@ namespace ADDON
     void FindAddons();
     void RemoveAddon(const CStdString& ID);
 
+    /*! \brief Rebuild the list of installed addons on the next lookup
+     Needs to be called when addons are installed, removed, enabled or disabled.
+     */
+    void InvalidateRegistry();
+
     /* libcpluff */
     CStdString GetExtValue(cp_cfg_element_t *base, const char *path);
 
@@ -161,6 +168,15 @@ namespace ADDON
      */
     bool AddonsFromRepoXML(const TiXmlElement *root, VECADDONS &addons);
 
+    /*! \brief Read a repository XML file for addons and load their descriptors
+     The file is read a chunk at a time and each addon element is handed to c-pluff
+     as soon as it is complete, so the listing is never held in memory as a whole.
+     \param file path of the repository XML file.
+     \param addons [out] returned list of addons.
+     \return true if the whole repository XML file is read, false otherwise.
+     */
+    bool AddonsFromRepoXML(const CStdString &file, VECADDONS &addons);
+
     /*! \brief Start all services addons.
         \return True is all addons are started, false otherwise
     */
@@ -195,6 +211,38 @@ namespace ADDON
     AddonPtr Factory(const cp_extension_t *props);
     bool CheckUserDirs(const cp_cfg_element_t *element);
 
+    /*! \brief The installed addons and whether they are disabled, as of the last change to them
+     Lookups of addons are served from this rather than asking cpluff and the database
+     each time. The registry is never changed once built, it is replaced as a whole.
+     \sa GetRegistry, InvalidateRegistry
+     */
+    class CRegistry
+    {
+    public:
+      CRegistry(DllLibCPluff *cpluff, cp_context_t *context);
+      ~CRegistry();
+
+      bool IsDisabled(const std::string &id) const { return disabled.find(id) != disabled.end(); }
+
+      std::map<std::string, const cp_plugin_info_t *> plugins;                  ///< plugins by id
+      std::map<std::string, std::vector<const cp_extension_t *> > extensions;   ///< extensions by extension point
+      std::set<std::string> disabled;
+    private:
+      CRegistry(const CRegistry&);
+      CRegistry const& operator=(CRegistry const&);
+
+      DllLibCPluff      *m_cpluff;
+      cp_context_t      *m_context;
+      cp_plugin_info_t **m_info;
+    };
+    typedef boost::shared_ptr<const CRegistry> RegistryPtr;
+
+    /*! \brief Get the current registry, building it if addons changed since the last one
+     \param start time the lookup started, for the lookup statistics
+     */
+    RegistryPtr GetRegistry(int64_t &start);
+    void EndLookup(int64_t start);
+
     // private construction, and no assignements; use the provided singleton methods
     CAddonMgr();
     CAddonMgr(const CAddonMgr&);
@@ -204,6 +252,13 @@ namespace ADDON
     static std::map<TYPE, IAddonMgrCallback*> m_managers;
     CCriticalSection m_critSection;
     CAddonDatabase m_database;
+
+    CCriticalSection m_registrySection;  ///< guards the members below, never held while building the registry
+    RegistryPtr  m_registry;
+    unsigned int m_registryVersion;      ///< changed whenever the registry is invalidated
+    unsigned int m_lookups;              ///< lookups served by the current registry
+    int64_t      m_lookupTime;           ///< and the time they took
+    int64_t      m_maxLookupTime;
   };
 
 }; /* namespace ADDON */
@@ -46,6 +46,9 @@ CPluginSource::CPluginSource(const cp_extension_t *ext)
     provides = CAddonMgr::Get().GetExtValue(ext->configuration, "provides");
     if (!provides.IsEmpty())
       Props().extrainfo.insert(make_pair("provides", provides));
+    CStdString reuse = CAddonMgr::Get().GetExtValue(ext->configuration, "reuseinterpreter");
+    if (!reuse.IsEmpty())
+      Props().extrainfo.insert(make_pair("reuseinterpreter", reuse));
   }
   SetProvides(provides);
 }
@@ -67,6 +70,12 @@ void CPluginSource::SetProvides(const CStdString &content)
     m_providedContent.insert(EXECUTABLE);
 }
 
+bool CPluginSource::ReuseInterpreter() const
+{
+  InfoMap::const_iterator i = ExtraInfo().find("reuseinterpreter");
+  return i == ExtraInfo().end() || !i->second.Equals("false");
+}
+
 CPluginSource::Content CPluginSource::Translate(const CStdString &content)
 {
   if (content.Equals("audio"))
@@ -38,6 +38,12 @@ public:
   bool Provides(const Content& content) const {
     return content == UNKNOWN ? false : m_providedContent.count(content) > 0; }
 
+  /*! \brief Whether the python interpreter of this plugin may be kept around for its next run
+   Plugins that depend on their modules being loaded afresh each run opt out with
+   <reuseinterpreter>false</reuseinterpreter> in their extension point.
+   */
+  bool ReuseInterpreter() const;
+
   static Content Translate(const CStdString &content);
 private:
   /*! \brief Set the provided content for this plugin
@@ -20,7 +20,6 @@
  */
 
 #include "Repository.h"
-#include "utils/XBMCTinyXML.h"
 #include "filesystem/File.h"
 #include "AddonDatabase.h"
 #include "settings/Settings.h"
@@ -28,10 +27,12 @@
 #include "utils/JobManager.h"
 #include "addons/AddonInstaller.h"
 #include "utils/log.h"
+#include "utils/TimeUtils.h"
+#include "threads/Thread.h"
 #include "utils/URIUtils.h"
 #include "dialogs/GUIDialogYesNo.h"
 #include "dialogs/GUIDialogKaiToast.h"
-#include "TextureDatabase.h"
+#include "TextureCache.h"
 
 using namespace XFILE;
 using namespace ADDON;
@@ -131,7 +132,6 @@ VECADDONS CRepository::Parse()
   CSingleLock lock(m_critSection);
 
   VECADDONS result;
-  CXBMCTinyXML doc;
 
   CStdString file = m_info;
   if (m_compressed)
@@ -144,10 +144,8 @@ VECADDONS CRepository::Parse()
     file = url.Get();
   }
 
-  doc.LoadFile(file);
-  if (doc.RootElement())
+  if (CAddonMgr::Get().AddonsFromRepoXML(file, result))
   {
-    CAddonMgr::Get().AddonsFromRepoXML(doc.RootElement(), result);
     for (IVECADDONS i = result.begin(); i != result.end(); ++i)
     {
       AddonPtr addon = *i;
@@ -174,6 +172,35 @@ VECADDONS CRepository::Parse()
   return result;
 }
 
+/*! \brief Fetches the checksum and, if it changed, the addon listing of a repository
+ */
+class CRepositoryUpdateJob::CFetch : public IRunnable
+{
+public:
+  CFetch(const RepositoryPtr &repo, bool stored, const CStdString &checksum)
+    : m_repo(repo), m_stored(stored), m_storedChecksum(checksum), m_changed(false), m_time(0)
+  {
+  }
+
+  virtual void Run()
+  {
+    int64_t start = CurrentHostCounter();
+    m_checksum = m_repo->Checksum();
+    m_changed = !m_stored || !m_storedChecksum.Equals(m_checksum);
+    if (m_changed)
+      m_addons = m_repo->Parse();
+    m_time = CurrentHostCounter() - start;
+  }
+
+  RepositoryPtr m_repo;
+  bool          m_stored;
+  CStdString    m_storedChecksum;
+  CStdString    m_checksum;
+  bool          m_changed;
+  VECADDONS     m_addons;
+  int64_t       m_time;
+};
+
 CRepositoryUpdateJob::CRepositoryUpdateJob(const VECADDONS &repos)
   : m_repos(repos)
 {
@@ -181,22 +208,51 @@ CRepositoryUpdateJob::CRepositoryUpdateJob(const VECADDONS &repos)
 
 bool CRepositoryUpdateJob::DoWork()
 {
-  VECADDONS addons;
+  // what we know of each repository is read here, the database isn't shared with the fetching threads
+  CAddonDatabase database;
+  database.Open();
+
+  std::vector<CFetch*> fetches;
   for (VECADDONS::const_iterator i = m_repos.begin(); i != m_repos.end(); ++i)
   {
     RepositoryPtr repo = boost::dynamic_pointer_cast<CRepository>(*i);
-    VECADDONS newAddons = GrabAddons(repo);
+    if (!repo)
+      continue;
+    CStdString checksum;
+    int idRepo = database.GetRepoChecksum(repo->ID(), checksum);
+    fetches.push_back(new CFetch(repo, idRepo > -1, checksum));
+  }
+
+  // fetching is mostly waiting on the network, so do all repositories at once
+  if (fetches.size() == 1)
+    fetches[0]->Run();
+  else
+  {
+    std::vector<CThread*> threads;
+    for (unsigned int i = 0; i < fetches.size(); i++)
+    {
+      CThread *thread = new CThread(fetches[i], "RepositoryFetch");
+      thread->Create();
+      threads.push_back(thread);
+    }
+    for (unsigned int i = 0; i < threads.size(); i++)
+    {
+      threads[i]->StopThread();
+      delete threads[i];
+    }
+  }
+
+  VECADDONS addons;
+  for (unsigned int i = 0; i < fetches.size(); i++)
+  {
+    VECADDONS newAddons = GrabAddons(*fetches[i], database);
     addons.insert(addons.end(), newAddons.begin(), newAddons.end());
+    delete fetches[i];
   }
   if (addons.empty())
     return false;
 
   // check for updates
-  CAddonDatabase database;
-  database.Open();
-  
-  CTextureDatabase textureDB;
-  textureDB.Open();
   for (unsigned int i=0;i<addons.size();++i)
   {
     // manager told us to feck off
@@ -207,9 +263,9 @@ bool CRepositoryUpdateJob::DoWork()
 
     // invalidate the art associated with this item
     if (!addons[i]->Props().fanart.empty())
-      textureDB.InvalidateCachedTexture(addons[i]->Props().fanart);
+      CTextureCache::Get().InvalidateCachedImage(addons[i]->Props().fanart);
     if (!addons[i]->Props().icon.empty())
-      textureDB.InvalidateCachedTexture(addons[i]->Props().icon);
+      CTextureCache::Get().InvalidateCachedImage(addons[i]->Props().icon);
 
     AddonPtr addon;
     CAddonMgr::Get().GetAddon(addons[i]->ID(),addon);
@@ -248,26 +304,26 @@ bool CRepositoryUpdateJob::DoWork()
   return true;
 }
 
-VECADDONS CRepositoryUpdateJob::GrabAddons(RepositoryPtr& repo)
+VECADDONS CRepositoryUpdateJob::GrabAddons(CFetch& fetch, CAddonDatabase& database)
 {
-  CAddonDatabase database;
-  database.Open();
-  CStdString checksum;
-  int idRepo = database.GetRepoChecksum(repo->ID(),checksum);
-  CStdString reposum = repo->Checksum();
+  int64_t start = CurrentHostCounter();
   VECADDONS addons;
-  if (idRepo == -1 || !checksum.Equals(reposum))
+  if (fetch.m_changed)
   {
-    addons = repo->Parse();
+    addons = fetch.m_addons;
     if (!addons.empty())
-      database.AddRepository(repo->ID(),addons,reposum);
+      database.AddRepository(fetch.m_repo->ID(),addons,fetch.m_checksum);
     else
-      CLog::Log(LOGERROR,"Repository %s returned no add-ons, listing may have failed",repo->Name().c_str());
+      CLog::Log(LOGERROR,"Repository %s returned no add-ons, listing may have failed",fetch.m_repo->Name().c_str());
   }
   else
-    database.GetRepository(repo->ID(),addons);
-  database.SetRepoTimestamp(repo->ID(),CDateTime::GetCurrentDateTime().GetAsDBDateTime());
+    database.GetRepository(fetch.m_repo->ID(),addons);
+  database.SetRepoTimestamp(fetch.m_repo->ID(),CDateTime::GetCurrentDateTime().GetAsDBDateTime());
+
+  CLog::Log(LOGDEBUG, "%s - repository %s %s, %u addons, fetched in %.1f ms, database took %.1f ms", __FUNCTION__,
+            fetch.m_repo->ID().c_str(), fetch.m_changed ? "changed" : "unchanged", (unsigned int)addons.size(),
+            fetch.m_time * 1000.0 / CurrentHostFrequency(),
+            (CurrentHostCounter() - start) * 1000.0 / CurrentHostFrequency());
 
   return addons;
 }
-
@@ -28,6 +28,8 @@
 #include "threads/CriticalSection.h"
 #include "threads/SingleLock.h"
 
+class CAddonDatabase;
+
 namespace ADDON
 {
   class CRepository;
@@ -69,7 +71,8 @@ namespace ADDON
     virtual const char *GetType() const { return "repoupdate"; };
     virtual bool DoWork();
   private:
-    VECADDONS GrabAddons(RepositoryPtr& repo);
+    class CFetch;
+    VECADDONS GrabAddons(CFetch& fetch, CAddonDatabase& database);
 
     VECADDONS m_repos;
   };
@@ -20,6 +20,7 @@
  */
 
 #include "DVDClock.h"
+#include "DVDPlayerTelemetry.h"
 #include "video/VideoReferenceClock.h"
 #include <math.h>
 #include "utils/MathUtils.h"
@@ -138,7 +139,11 @@ void CDVDClock::SetSpeed(int iSpeed)
 void CDVDClock::Discontinuity(double currentPts)
 {
   CExclusiveLock lock(m_critSection);
-  m_startClock = g_VideoReferenceClock.GetTime();
+  int64_t current = g_VideoReferenceClock.GetTime();
+  if (!m_bReset)
+    g_dvdPlayerTelemetry.Add(CDVDPlayerTelemetry::STREAM_CLOCK, currentPts, currentPts - SystemToPlaying(current), 0,
+                             CDVDPlayerTelemetry::FLAG_DISCONTINUITY);
+  m_startClock = current;
   if(m_pauseClock)
     m_pauseClock = m_startClock;
   m_iDisc = currentPts;
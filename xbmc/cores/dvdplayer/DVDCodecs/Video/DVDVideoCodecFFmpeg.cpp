@@ -122,6 +122,25 @@ enum PixelFormat CDVDVideoCodecFFmpeg::GetFormat( struct AVCodecContext * avctx
   return ctx->m_dllAvCodec.avcodec_default_get_format(avctx, fmt);
 }
 
+/* true if GetFormat may switch the decoder over to a hardware *
+ * accelerator, which doesn't mix with frame threading         */
+static bool HardwareDecodeEnabled()
+{
+#ifdef HAVE_LIBVDPAU
+  if(g_guiSettings.GetBool("videoplayer.usevdpau"))
+    return true;
+#endif
+#ifdef HAS_DX
+  if(g_guiSettings.GetBool("videoplayer.usedxva2"))
+    return true;
+#endif
+#ifdef HAVE_LIBVA
+  if(g_guiSettings.GetBool("videoplayer.usevaapi"))
+    return true;
+#endif
+  return false;
+}
+
 CDVDVideoCodecFFmpeg::CDVDVideoCodecFFmpeg() : CDVDVideoCodec()
 {
   m_pCodecContext = NULL;
@@ -135,6 +154,8 @@ CDVDVideoCodecFFmpeg::CDVDVideoCodecFFmpeg() : CDVDVideoCodec()
   m_iPictureHeight = 0;
 
   m_uSurfacesCount = 0;
+  m_iThreads = 0;
+  m_iThreadType = 0;
 
   m_iScreenWidth = 0;
   m_iScreenHeight = 0;
@@ -246,7 +267,7 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
   m_pCodecContext->workaround_bugs = FF_BUG_AUTODETECT;
   m_pCodecContext->get_format = GetFormat;
   m_pCodecContext->codec_tag = hints.codec_tag;
-  /* Only allow slice threading, since frame threading is more
+  /* Only allow slice threading by default, since frame threading is more
    * sensitive to changes in frame sizes, and it causes crashes
    * during HW accell */
   m_pCodecContext->thread_type = FF_THREAD_SLICE;
@@ -287,15 +308,39 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
   {
     if (it->m_name == "surfaces")
       m_uSurfacesCount = std::atoi(it->m_value.c_str());
+    else if (it->m_name == "threads")
+      m_iThreads = std::atoi(it->m_value.c_str());
+    else if (it->m_name == "threadtype")
+      m_iThreadType = it->m_value == "frame" ? FF_THREAD_FRAME : FF_THREAD_SLICE;
     else
       m_dllAvUtil.av_opt_set(m_pCodecContext, it->m_name.c_str(), it->m_value.c_str(), 0);
   }
 
+  /* once we know we'll stay in software, frame threading scales a lot *
+   * better than slice threading on multi core cpu's, at the cost of   *
+   * a frame of latency per thread, so it's opt-in through             *
+   * <ffmpegframethreading> in advancedsettings.xml                    */
+  bool software_only = m_pHardware == NULL && (m_bSoftware || !HardwareDecodeEnabled());
+  bool frame_threads = software_only
+                    && g_advancedSettings.m_videoFFmpegFrameThreading
+                    && pCodec->capabilities & CODEC_CAP_FRAME_THREADS;
+
   int num_threads = std::min(8 /*MAX_THREADS*/, g_cpuInfo.getCPUCount());
-  if( num_threads > 1 && !hints.software && m_pHardware == NULL // thumbnail extraction fails when run threaded
+  if(m_iThreads > 0)
+  {
+    m_pCodecContext->thread_count = m_iThreads;
+    if(m_iThreadType)
+      m_pCodecContext->thread_type = m_iThreadType;
+  }
+  else if( num_threads > 1 && !hints.software && m_pHardware == NULL // thumbnail extraction fails when run threaded
   && ( pCodec->id == CODEC_ID_H264
-    || pCodec->id == CODEC_ID_MPEG4 ))
+    || pCodec->id == CODEC_ID_MPEG4
+    || (frame_threads && pCodec->id == CODEC_ID_VP8) ))
+  {
     m_pCodecContext->thread_count = num_threads;
+    if(frame_threads)
+      m_pCodecContext->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+  }
 
   if (m_dllAvCodec.avcodec_open2(m_pCodecContext, pCodec, NULL) < 0)
   {
@@ -306,6 +351,10 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
   m_pFrame = m_dllAvCodec.avcodec_alloc_frame();
   if (!m_pFrame) return false;
 
+  CLog::Log(LOGDEBUG,"CDVDVideoCodecFFmpeg::Open() Using %d %s thread(s)"
+           , m_pCodecContext->thread_count
+           , m_pCodecContext->active_thread_type & FF_THREAD_FRAME ? "frame" : "slice");
+
   UpdateName();
   return true;
 }
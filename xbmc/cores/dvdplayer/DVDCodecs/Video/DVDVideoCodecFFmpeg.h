@@ -107,6 +107,8 @@ protected:
   int m_iOrientation;// orientation of the video in degress counter clockwise
 
   unsigned int m_uSurfacesCount;
+  int          m_iThreads;     // forced thread count, 0 for auto
+  int          m_iThreadType;  // forced FF_THREAD_* type, 0 for auto
 
   DllAvCodec m_dllAvCodec;
   DllAvUtil  m_dllAvUtil;
@@ -37,6 +37,8 @@
 #endif
 #include "DVDInputStreams/DVDInputStreamPVRManager.h"
 #include "DVDDemuxUtils.h"
+#include "DVDDemuxProbeCache.h"
+#include "DVDPerformanceCounter.h"
 #include "DVDClock.h" // for DVD_TIME_BASE
 #include "utils/Win32Exception.h"
 #include "settings/AdvancedSettings.h"
@@ -211,6 +213,9 @@ CDVDDemuxFFmpeg::CDVDDemuxFFmpeg() : CDVDDemux()
   m_ioContext = NULL;
   for (int i = 0; i < MAX_STREAMS; i++) m_streams[i] = NULL;
   m_iCurrentPts = DVD_NOPTS_VALUE;
+  m_bKeyframeIndex = false;
+  m_keyframeStream = -1;
+  m_keyframesSeen = 0;
 }
 
 CDVDDemuxFFmpeg::~CDVDDemuxFFmpeg()
@@ -235,6 +240,9 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
   m_speed = DVD_PLAYSPEED_NORMAL;
   g_demuxer.set(this);
   m_program = UINT_MAX;
+  m_keyframes.Clear();
+  m_keyframeStream = -1;
+  m_keyframesSeen = 0;
   const AVIOInterruptCB int_cb = { interrupt_cb, NULL };
 
   if (!pInput) return false;
@@ -252,6 +260,14 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
 
   bool streaminfo = true; /* set to true if we want to look for streams before playback*/
 
+  // plain files that were opened before don't need to be probed again
+  int64_t openStart = CurrentHostCounter();
+  int64_t probeTime = 0, headerTime = 0, streamInfoTime = 0;
+  CDVDDemuxProbeCache::CEntry cached;
+  bool useCache = m_pInput->IsStreamType(DVDSTREAM_TYPE_FILE)
+               && m_pInput->GetContent() != "audio/x-spdif-compressed"
+               && CDVDDemuxProbeCache::Get(strFile, cached);
+
   if( m_pInput->GetContent().length() > 0 )
   {
     std::string content = m_pInput->GetContent();
@@ -305,6 +321,15 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
     if(m_pInput->Seek(0, SEEK_POSSIBLE) == 0)
       m_ioContext->seekable = 0;
 
+    if (iformat == NULL && useCache)
+    {
+      iformat = m_dllAvFormat.av_find_input_format(cached.format.c_str());
+      if (iformat)
+        CLog::Log(LOGDEBUG, "%s - using cached format [%s]", __FUNCTION__, iformat->name);
+      else
+        useCache = false;
+    }
+
     if( iformat == NULL )
     {
       // let ffmpeg decide which demuxer we have to open
@@ -408,6 +433,8 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
     }
 
 
+    probeTime = CurrentHostCounter() - openStart;
+
     // open the demuxer
     m_pFormatContext     = m_dllAvFormat.avformat_alloc_context();
     m_pFormatContext->pb = m_ioContext;
@@ -415,10 +442,13 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
     if (m_dllAvFormat.avformat_open_input(&m_pFormatContext, strFile.c_str(), iformat, NULL) < 0)
     {
       CLog::Log(LOGERROR, "%s - Error, could not open file %s", __FUNCTION__, strFile.c_str());
+      if (useCache)
+        CDVDDemuxProbeCache::Remove(strFile);
       Dispose();
       return false;
     }
   }
+  headerTime = CurrentHostCounter() - openStart - probeTime;
 
   // set the interrupt callback, appeared in libavformat 53.15.0
   m_pFormatContext->interrupt_callback = int_cb;
@@ -431,6 +461,20 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
   m_bMatroska = strncmp(m_pFormatContext->iformat->name, "matroska", 8) == 0;	// for "matroska.webm"
   m_bAVI = strcmp(m_pFormatContext->iformat->name, "avi") == 0;
 
+  if (streaminfo && useCache)
+  {
+    if (CDVDDemuxProbeCache::Apply(cached, m_pFormatContext, m_dllAvUtil))
+    {
+      CLog::Log(LOGDEBUG, "%s - using cached stream info", __FUNCTION__);
+      streaminfo = false;
+    }
+    else
+    {
+      CLog::Log(LOGDEBUG, "%s - cached stream info doesn't match %s", __FUNCTION__, strFile.c_str());
+      useCache = false;
+    }
+  }
+
   if (streaminfo)
   {
     /* too speed up dvd switches, only analyse very short */
@@ -454,13 +498,29 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       }
     }
     CLog::Log(LOGDEBUG, "%s - av_find_stream_info finished", __FUNCTION__);
+
+    if (iErr >= 0 && m_pInput->IsStreamType(DVDSTREAM_TYPE_FILE))
+      CDVDDemuxProbeCache::Set(strFile, m_pFormatContext);
   }
   // reset any timeout
   m_timeout.SetInfinite();
 
+  streamInfoTime = CurrentHostCounter() - openStart - probeTime - headerTime;
+  int64_t frequency = CurrentHostFrequency();
+  CLog::Log(LOGDEBUG, "%s - opened in %u ms: probe %u ms, header %u ms, stream info %u ms%s", __FUNCTION__,
+            (unsigned int)((probeTime + headerTime + streamInfoTime) * 1000 / frequency),
+            (unsigned int)(probeTime * 1000 / frequency), (unsigned int)(headerTime * 1000 / frequency),
+            (unsigned int)(streamInfoTime * 1000 / frequency), useCache ? " (cached)" : "");
+
   // if format can be nonblocking, let's use that
   m_pFormatContext->flags |= AVFMT_FLAG_NONBLOCK;
 
+  // formats without an index of their own are seeked by bisecting the file
+  // on timestamps, those can seek straight to a keyframe read before instead
+  m_bKeyframeIndex = m_pFormatContext->iformat->read_timestamp
+                  && !(m_pFormatContext->iformat->flags & AVFMT_NO_BYTE_SEEK)
+                  && !dynamic_cast<CDVDInputStream::ISeekTime*>(m_pInput);
+
   // print some extra information
   m_dllAvFormat.av_dump_format(m_pFormatContext, 0, strFile.c_str(), 0);
 
@@ -552,6 +612,7 @@ void CDVDDemuxFFmpeg::Flush()
     m_dllAvFormat.av_read_frame_flush(m_pFormatContext);
 
   m_iCurrentPts = DVD_NOPTS_VALUE;
+  m_keyframes.Break();
 }
 
 void CDVDDemuxFFmpeg::Abort()
@@ -683,23 +744,49 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
     {
       AVStream *stream = m_pFormatContext->streams[pkt.stream_index];
 
+      bool selected = true;
       if (m_program != UINT_MAX)
       {
         /* check so packet belongs to selected program */
+        selected = false;
         for (unsigned int i = 0; i < m_pFormatContext->programs[m_program]->nb_stream_indexes; i++)
         {
           if(pkt.stream_index == (int)m_pFormatContext->programs[m_program]->stream_index[i])
           {
-            pPacket = CDVDDemuxUtils::AllocateDemuxPacket(pkt.size);
+            selected = true;
             break;
           }
         }
 
-        if (!pPacket)
+        if (!selected)
           bReturnEmpty = true;
       }
-      else
-        pPacket = CDVDDemuxUtils::AllocateDemuxPacket(pkt.size);
+
+      // at the speeds where streams only keep keyframes, drop the video
+      // frames the format didn't discard itself. only once the format is
+      // known to flag keyframes, or nothing would be shown at all
+      if (selected && stream->discard == AVDISCARD_NONKEY
+      && pkt.stream_index == m_keyframeStream && m_keyframesSeen > 1)
+      {
+        if (pkt.flags & AV_PKT_FLAG_KEY)
+          AtomicIncrement(&g_dvdPerformanceCounter.m_trickplayFrames);
+        else
+        {
+          AtomicIncrement(&g_dvdPerformanceCounter.m_trickplayDropped);
+          selected = false;
+          bReturnEmpty = true;
+        }
+      }
+
+      if (selected)
+      {
+        // a packet owning its buffer can be handed on as is, without
+        // destruct it points into the demuxer's buffers and must be copied
+        if (pkt.data && pkt.destruct)
+          pPacket = CDVDDemuxUtils::AllocateDemuxPacket(&pkt);
+        else
+          pPacket = CDVDDemuxUtils::AllocateDemuxPacket(pkt.size);
+      }
 
       if (pPacket)
       {
@@ -735,17 +822,33 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
           pkt.pts = AV_NOPTS_VALUE;
         }
 
-        // copy contents into our own packet
+        // copy contents into our own packet, unless it took over the buffer
         pPacket->iSize = pkt.size;
 
-        // maybe we can avoid a memcpy here by detecting where pkt.destruct is pointing too?
-        if (pkt.data)
+        if (pkt.data && pPacket->pData != pkt.data)
+        {
           memcpy(pPacket->pData, pkt.data, pPacket->iSize);
+          AtomicIncrement(&g_dvdPerformanceCounter.m_packetCopies);
+        }
 
         pPacket->pts = ConvertTimestamp(pkt.pts, stream->time_base.den, stream->time_base.num);
         pPacket->dts = ConvertTimestamp(pkt.dts, stream->time_base.den, stream->time_base.num);
         pPacket->duration =  DVD_SEC_TO_TIME((double)pkt.duration * stream->time_base.num / stream->time_base.den);
 
+        if ((pkt.flags & AV_PKT_FLAG_KEY) && stream->codec && stream->codec->codec_type == AVMEDIA_TYPE_VIDEO)
+        {
+          if (m_keyframeStream < 0)
+            m_keyframeStream = pkt.stream_index;
+
+          if (pkt.stream_index == m_keyframeStream)
+          {
+            m_keyframesSeen++;
+            double keyTime = pPacket->pts != DVD_NOPTS_VALUE ? pPacket->pts : pPacket->dts;
+            if (m_bKeyframeIndex && keyTime != DVD_NOPTS_VALUE && pkt.pos >= 0)
+              m_keyframes.Add(DVD_TIME_TO_MSEC(keyTime), pkt.pos);
+          }
+        }
+
         // used to guess streamlength
         if (pPacket->dts != DVD_NOPTS_VALUE && (pPacket->dts > m_iCurrentPts || m_iCurrentPts == DVD_NOPTS_VALUE))
           m_iCurrentPts = pPacket->dts;
@@ -848,10 +951,24 @@ bool CDVDDemuxFFmpeg::SeekTime(int time, bool backwords, double *startpts)
   if (m_pFormatContext->start_time != (int64_t)AV_NOPTS_VALUE)
     seek_pts += m_pFormatContext->start_time;
 
-  int ret;
+  int ret = -1;
   {
     CSingleLock lock(m_critSection);
-    ret = m_dllAvFormat.av_seek_frame(m_pFormatContext, -1, seek_pts, backwords ? AVSEEK_FLAG_BACKWARD : 0);
+    m_keyframes.Break();
+
+    // a keyframe read before can be seeked to directly, the time is
+    // reached by skipping frames from there like after any other seek
+    int keyTime;
+    int64_t keyPos;
+    if (m_bKeyframeIndex && m_keyframes.Find(time, keyTime, keyPos))
+    {
+      ret = m_dllAvFormat.av_seek_frame(m_pFormatContext, -1, keyPos, AVSEEK_FLAG_BYTE);
+      if (ret >= 0)
+        CLog::Log(LOGDEBUG, "%s - seeking to keyframe at time %d, byte %"PRId64" from index", __FUNCTION__, keyTime, keyPos);
+    }
+
+    if (ret < 0)
+      ret = m_dllAvFormat.av_seek_frame(m_pFormatContext, -1, seek_pts, backwords ? AVSEEK_FLAG_BACKWARD : 0);
 
     if(ret >= 0)
       UpdateCurrentPTS();
@@ -878,6 +995,7 @@ bool CDVDDemuxFFmpeg::SeekByte(int64_t pos)
   g_demuxer.set(this);
 
   CSingleLock lock(m_critSection);
+  m_keyframes.Break();
   int ret = m_dllAvFormat.av_seek_frame(m_pFormatContext, -1, pos, AVSEEK_FLAG_BYTE);
 
   if(ret >= 0)
@@ -25,6 +25,7 @@
 #include "DllAvFormat.h"
 #include "DllAvCodec.h"
 #include "DllAvUtil.h"
+#include "DVDKeyframeIndex.h"
 
 #include "threads/CriticalSection.h"
 #include "threads/SystemClock.h"
@@ -111,6 +112,16 @@ public:
 
   bool Aborted();
 
+  /*!
+   \brief Whether the format seeks by bisecting the file, and is sped up by a keyframe index
+   */
+  bool UsesKeyframeIndex() const { return m_bKeyframeIndex; }
+
+  /*!
+   \brief The keyframes read so far, can be stored and loaded again when the file is next played
+   */
+  CDVDKeyframeIndex& GetKeyframeIndex() { return m_keyframes; }
+
   AVFormatContext* m_pFormatContext;
 
 protected:
@@ -141,6 +152,11 @@ protected:
   unsigned m_program;
   XbmcThreads::EndTime  m_timeout;
 
+  CDVDKeyframeIndex m_keyframes;
+  bool     m_bKeyframeIndex;
+  int      m_keyframeStream;   // the video stream keyframes are taken from
+  unsigned m_keyframesSeen;
+
   CDVDInputStream* m_pInput;
 };
 
@@ -0,0 +1,464 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "system.h"
+#ifndef __STDC_CONSTANT_MACROS
+#define __STDC_CONSTANT_MACROS
+#endif
+#ifndef __STDC_LIMIT_MACROS
+#define __STDC_LIMIT_MACROS
+#endif
+#ifdef _LINUX
+#include "stdint.h"
+#endif
+#include "DVDDemuxProbeCache.h"
+#include "DllAvFormat.h"
+#include "DllAvCodec.h"
+#include "DllAvUtil.h"
+#include "filesystem/File.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "utils/Archive.h"
+#include "utils/JobManager.h"
+#include "utils/log.h"
+
+using namespace std;
+using namespace XFILE;
+
+#define PROBE_CACHE_FILE     "special://temp/dvdprobecache.dat"
+#define PROBE_CACHE_VERSION  2
+#define PROBE_CACHE_ENTRIES  500
+
+map<CStdString, CDVDDemuxProbeCache::CEntry> CDVDDemuxProbeCache::m_entries;
+unsigned int CDVDDemuxProbeCache::m_stamp = 0;
+bool CDVDDemuxProbeCache::m_loaded = false;
+bool CDVDDemuxProbeCache::m_dirty = false;
+bool CDVDDemuxProbeCache::m_flushQueued = false;
+
+static CCriticalSection g_probeCacheSection;
+// held while writing, so an older snapshot can't overwrite a newer one
+static CCriticalSection g_probeCacheFileSection;
+
+// writing the cache isn't done while opening a file, that's what it's meant to speed up
+class CDVDDemuxProbeCacheFlushJob : public CJob
+{
+public:
+  virtual const char *GetType() const { return "probecacheflush"; }
+  virtual bool DoWork()
+  {
+    CDVDDemuxProbeCache::Flush();
+    return true;
+  }
+};
+
+// entries are only valid for the libraries that produced them
+static const unsigned int g_probeCacheLibraries = LIBAVFORMAT_VERSION_INT ^ (LIBAVCODEC_VERSION_INT << 8);
+
+static CStdString ToHex(const uint8_t *data, unsigned int size)
+{
+  static const char digits[] = "0123456789abcdef";
+  CStdString hex;
+  hex.reserve(size * 2);
+  for (unsigned int i = 0; i < size; i++)
+  {
+    hex += digits[data[i] >> 4];
+    hex += digits[data[i] & 0xf];
+  }
+  return hex;
+}
+
+static std::string FromHex(const CStdString &hex)
+{
+  std::string data;
+  data.reserve(hex.size() / 2);
+  for (unsigned int i = 0; i + 1 < hex.size(); i += 2)
+  {
+    char digits[3] = { hex[i], hex[i + 1], 0 };
+    data += (char)strtol(digits, NULL, 16);
+  }
+  return data;
+}
+
+bool CDVDDemuxProbeCache::GetKey(const CStdString &file, int64_t &size, int64_t &mtime)
+{
+  struct __stat64 buffer;
+  if (CFile::Stat(file, &buffer) != 0 || buffer.st_size <= 0)
+    return false;
+  size  = buffer.st_size;
+  mtime = buffer.st_mtime;
+  return true;
+}
+
+bool CDVDDemuxProbeCache::Get(const CStdString &file, CEntry &entry)
+{
+  int64_t size, mtime;
+  if (!GetKey(file, size, mtime))
+    return false;
+
+  CSingleLock lock(g_probeCacheSection);
+  Load();
+
+  map<CStdString, CEntry>::iterator it = m_entries.find(file);
+  if (it == m_entries.end())
+    return false;
+  if (it->second.size != size || it->second.mtime != mtime)
+  {
+    m_entries.erase(it);
+    return false;
+  }
+
+  it->second.stamp = ++m_stamp;
+  entry = it->second;
+  return true;
+}
+
+bool CDVDDemuxProbeCache::IsCacheable(const AVFormatContext *context)
+{
+  // streams that only show up while reading can't be told apart from a changed file
+  if (!context->iformat || !context->iformat->name || (context->ctx_flags & AVFMTCTX_NOHEADER))
+    return false;
+  if (context->nb_streams == 0)
+    return false;
+
+  // which of these is picked depends on settings
+  const char *name = context->iformat->name;
+  return strcmp(name, "wav") != 0 && strcmp(name, "spdif") != 0 && strcmp(name, "dts") != 0;
+}
+
+void CDVDDemuxProbeCache::Set(const CStdString &file, const AVFormatContext *context)
+{
+  CEntry entry;
+  if (!IsCacheable(context) || !GetKey(file, entry.size, entry.mtime))
+    return;
+
+  entry.format    = context->iformat->name;
+  entry.startTime = context->start_time;
+  entry.duration  = context->duration;
+  entry.bitRate   = context->bit_rate;
+  for (unsigned int i = 0; i < context->nb_streams; i++)
+  {
+    const AVStream       *stream = context->streams[i];
+    const AVCodecContext *codec  = stream->codec;
+
+    CEntry::CStream s;
+    s.codecType          = codec->codec_type;
+    s.codecId            = codec->codec_id;
+    s.codecTag           = codec->codec_tag;
+    s.width              = codec->width;
+    s.height             = codec->height;
+    s.pixFmt             = codec->pix_fmt;
+    s.sarNum             = stream->sample_aspect_ratio.num;
+    s.sarDen             = stream->sample_aspect_ratio.den;
+    s.codecSarNum        = codec->sample_aspect_ratio.num;
+    s.codecSarDen        = codec->sample_aspect_ratio.den;
+    s.bitsPerCodedSample = codec->bits_per_coded_sample;
+    s.channels           = codec->channels;
+    s.sampleRate         = codec->sample_rate;
+    s.sampleFmt          = codec->sample_fmt;
+    s.channelLayout      = codec->channel_layout;
+    s.blockAlign         = codec->block_align;
+    s.frameSize          = codec->frame_size;
+    s.bitRate            = codec->bit_rate;
+    s.profile            = codec->profile;
+    s.level              = codec->level;
+    s.hasBFrames         = codec->has_b_frames;
+    s.ticksPerFrame      = codec->ticks_per_frame;
+    s.timeBaseNum        = stream->time_base.num;
+    s.timeBaseDen        = stream->time_base.den;
+    s.rFrameRateNum      = stream->r_frame_rate.num;
+    s.rFrameRateDen      = stream->r_frame_rate.den;
+    s.avgFrameRateNum    = stream->avg_frame_rate.num;
+    s.avgFrameRateDen    = stream->avg_frame_rate.den;
+    s.startTime          = stream->start_time;
+    s.duration           = stream->duration;
+    if (codec->extradata && codec->extradata_size > 0)
+      s.extraData.assign((const char *)codec->extradata, codec->extradata_size);
+    entry.streams.push_back(s);
+  }
+
+  CSingleLock lock(g_probeCacheSection);
+  Load();
+
+  if (m_entries.size() >= PROBE_CACHE_ENTRIES && m_entries.find(file) == m_entries.end())
+  {
+    map<CStdString, CEntry>::iterator oldest = m_entries.begin();
+    for (map<CStdString, CEntry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+      if (it->second.stamp < oldest->second.stamp)
+        oldest = it;
+    }
+    m_entries.erase(oldest);
+  }
+
+  entry.stamp = ++m_stamp;
+  m_entries[file] = entry;
+  SetDirty();
+}
+
+void CDVDDemuxProbeCache::Remove(const CStdString &file)
+{
+  CSingleLock lock(g_probeCacheSection);
+  Load();
+  if (m_entries.erase(file))
+    SetDirty();
+}
+
+void CDVDDemuxProbeCache::SetDirty()
+{
+  m_dirty = true;
+  if (!m_flushQueued)
+  {
+    m_flushQueued = true;
+    CJobManager::GetInstance().AddJob(new CDVDDemuxProbeCacheFlushJob, NULL, CJob::PRIORITY_NORMAL);
+  }
+}
+
+bool CDVDDemuxProbeCache::Apply(const CEntry &entry, AVFormatContext *context, DllAvUtil &dllAvUtil)
+{
+  if (!IsCacheable(context) || entry.format != context->iformat->name || entry.streams.size() != context->nb_streams)
+    return false;
+
+  // everything the header tells must match before anything is touched
+  for (unsigned int i = 0; i < context->nb_streams; i++)
+  {
+    const CEntry::CStream &s = entry.streams[i];
+    const AVStream *stream = context->streams[i];
+    if (stream->codec->codec_type  != s.codecType
+    ||  stream->codec->codec_id    != s.codecId
+    ||  stream->time_base.num      != s.timeBaseNum
+    ||  stream->time_base.den      != s.timeBaseDen)
+      return false;
+    if (stream->codec->extradata_size > 0
+    && (stream->codec->extradata_size != (int)s.extraData.size()
+     || memcmp(stream->codec->extradata, s.extraData.c_str(), s.extraData.size()) != 0))
+      return false;
+  }
+
+  for (unsigned int i = 0; i < context->nb_streams; i++)
+  {
+    const CEntry::CStream &s = entry.streams[i];
+    AVStream       *stream = context->streams[i];
+    AVCodecContext *codec  = stream->codec;
+
+    codec->codec_tag             = s.codecTag;
+    codec->width                 = s.width;
+    codec->height                = s.height;
+    codec->pix_fmt               = (PixelFormat)s.pixFmt;
+    codec->bits_per_coded_sample = s.bitsPerCodedSample;
+    codec->channels              = s.channels;
+    codec->sample_rate           = s.sampleRate;
+    codec->sample_fmt            = (AVSampleFormat)s.sampleFmt;
+    codec->channel_layout        = s.channelLayout;
+    codec->block_align           = s.blockAlign;
+    codec->frame_size            = s.frameSize;
+    codec->bit_rate              = s.bitRate;
+    codec->profile               = s.profile;
+    codec->level                 = s.level;
+    codec->has_b_frames          = s.hasBFrames;
+    codec->ticks_per_frame       = s.ticksPerFrame;
+    stream->sample_aspect_ratio.num = s.sarNum;
+    stream->sample_aspect_ratio.den = s.sarDen;
+    codec->sample_aspect_ratio.num  = s.codecSarNum;
+    codec->sample_aspect_ratio.den  = s.codecSarDen;
+    stream->r_frame_rate.num     = s.rFrameRateNum;
+    stream->r_frame_rate.den     = s.rFrameRateDen;
+    stream->avg_frame_rate.num   = s.avgFrameRateNum;
+    stream->avg_frame_rate.den   = s.avgFrameRateDen;
+    stream->start_time           = s.startTime;
+    stream->duration             = s.duration;
+
+    if (codec->extradata_size == 0 && !s.extraData.empty())
+    {
+      codec->extradata = (uint8_t*)dllAvUtil.av_mallocz(s.extraData.size() + FF_INPUT_BUFFER_PADDING_SIZE);
+      if (!codec->extradata)
+        return false;
+      memcpy(codec->extradata, s.extraData.c_str(), s.extraData.size());
+      codec->extradata_size = s.extraData.size();
+    }
+  }
+
+  context->start_time = entry.startTime;
+  context->duration   = entry.duration;
+  context->bit_rate   = entry.bitRate;
+  return true;
+}
+
+void CDVDDemuxProbeCache::Load()
+{
+  if (m_loaded)
+    return;
+  m_loaded = true;
+
+  CFile file;
+  if (!file.Open(PROBE_CACHE_FILE))
+    return;
+
+  int64_t length = file.GetLength();
+  if (length <= 0 || length > 16 * 1024 * 1024)
+    return;
+  std::string data;
+  data.resize((size_t)length);
+  if (file.Read(&data[0], length) != length)
+    return;
+  file.Close();
+
+  CArchive ar((const uint8_t *)data.c_str(), data.size());
+  int version = 0, count = 0;
+  unsigned int libraries = 0;
+  ar >> version;
+  ar >> libraries;
+  if (version != PROBE_CACHE_VERSION || libraries != g_probeCacheLibraries)
+  {
+    CLog::Log(LOGDEBUG, "%s - ignoring cache of other version", __FUNCTION__);
+    return;
+  }
+
+  ar >> count;
+  for (int i = 0; i < count && i < PROBE_CACHE_ENTRIES; i++)
+  {
+    CStdString path, format;
+    CEntry entry;
+    int streams = 0;
+    ar >> path;
+    ar >> format;
+    entry.format = format;
+    ar >> entry.size;
+    ar >> entry.mtime;
+    ar >> entry.startTime;
+    ar >> entry.duration;
+    ar >> entry.bitRate;
+    ar >> streams;
+    if (path.IsEmpty() || streams <= 0 || streams > 100)
+      break;
+    for (int j = 0; j < streams; j++)
+    {
+      CEntry::CStream s;
+      CStdString extraData;
+      ar >> s.codecType;
+      ar >> s.codecId;
+      ar >> s.codecTag;
+      ar >> s.width;
+      ar >> s.height;
+      ar >> s.pixFmt;
+      ar >> s.sarNum;
+      ar >> s.sarDen;
+      ar >> s.codecSarNum;
+      ar >> s.codecSarDen;
+      ar >> s.bitsPerCodedSample;
+      ar >> s.channels;
+      ar >> s.sampleRate;
+      ar >> s.sampleFmt;
+      ar >> s.channelLayout;
+      ar >> s.blockAlign;
+      ar >> s.frameSize;
+      ar >> s.bitRate;
+      ar >> s.profile;
+      ar >> s.level;
+      ar >> s.hasBFrames;
+      ar >> s.ticksPerFrame;
+      ar >> s.timeBaseNum;
+      ar >> s.timeBaseDen;
+      ar >> s.rFrameRateNum;
+      ar >> s.rFrameRateDen;
+      ar >> s.avgFrameRateNum;
+      ar >> s.avgFrameRateDen;
+      ar >> s.startTime;
+      ar >> s.duration;
+      ar >> extraData;
+      s.extraData = FromHex(extraData);
+      entry.streams.push_back(s);
+    }
+    entry.stamp = ++m_stamp;
+    m_entries[path] = entry;
+  }
+  CLog::Log(LOGDEBUG, "%s - loaded %u entries", __FUNCTION__, (unsigned int)m_entries.size());
+}
+
+void CDVDDemuxProbeCache::Flush()
+{
+  CSingleLock fileLock(g_probeCacheFileSection);
+  CSingleLock lock(g_probeCacheSection);
+  m_flushQueued = false;
+  if (!m_dirty)
+    return;
+  m_dirty = false;
+
+  std::string data;
+  {
+    CArchive ar(data);
+    ar << (int)PROBE_CACHE_VERSION;
+    ar << g_probeCacheLibraries;
+    ar << (int)m_entries.size();
+    for (map<CStdString, CEntry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+      const CEntry &entry = it->second;
+      ar << it->first;
+      ar << CStdString(entry.format);
+      ar << entry.size;
+      ar << entry.mtime;
+      ar << entry.startTime;
+      ar << entry.duration;
+      ar << entry.bitRate;
+      ar << (int)entry.streams.size();
+      for (vector<CEntry::CStream>::const_iterator s = entry.streams.begin(); s != entry.streams.end(); ++s)
+      {
+        ar << s->codecType;
+        ar << s->codecId;
+        ar << s->codecTag;
+        ar << s->width;
+        ar << s->height;
+        ar << s->pixFmt;
+        ar << s->sarNum;
+        ar << s->sarDen;
+        ar << s->codecSarNum;
+        ar << s->codecSarDen;
+        ar << s->bitsPerCodedSample;
+        ar << s->channels;
+        ar << s->sampleRate;
+        ar << s->sampleFmt;
+        ar << s->channelLayout;
+        ar << s->blockAlign;
+        ar << s->frameSize;
+        ar << s->bitRate;
+        ar << s->profile;
+        ar << s->level;
+        ar << s->hasBFrames;
+        ar << s->ticksPerFrame;
+        ar << s->timeBaseNum;
+        ar << s->timeBaseDen;
+        ar << s->rFrameRateNum;
+        ar << s->rFrameRateDen;
+        ar << s->avgFrameRateNum;
+        ar << s->avgFrameRateDen;
+        ar << s->startTime;
+        ar << s->duration;
+        // strings are cut at the first 0 when loaded
+        ar << ToHex((const uint8_t *)s->extraData.c_str(), s->extraData.size());
+      }
+    }
+    ar.Close();
+  }
+  lock.Leave();
+
+  CFile file;
+  if (!file.OpenForWrite(PROBE_CACHE_FILE, true) || file.Write(data.c_str(), data.size()) != (int)data.size())
+    CLog::Log(LOGWARNING, "%s - unable to write %s", __FUNCTION__, PROBE_CACHE_FILE);
+}
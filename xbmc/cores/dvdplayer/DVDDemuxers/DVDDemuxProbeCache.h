@@ -0,0 +1,135 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/StdString.h"
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+struct AVFormatContext;
+class DllAvUtil;
+
+/*!
+ \brief What probing found out about a file, kept so the next open can skip it.
+
+ Entries are keyed on the path, size and modification time of the file, and
+ are written to disc by a job after they change, and kept across runs. An entry holds the name of the container
+ format, and the stream layout and codec parameters that
+ avformat_find_stream_info filled in. Applying an entry to a freshly opened
+ format context checks that its streams still match what the header says.
+ */
+class CDVDDemuxProbeCache
+{
+public:
+  class CEntry
+  {
+  public:
+    class CStream
+    {
+    public:
+      int      codecType;
+      int      codecId;
+      unsigned codecTag;
+      int      width;
+      int      height;
+      int      pixFmt;
+      int      sarNum, sarDen;                       ///< of the stream
+      int      codecSarNum, codecSarDen;             ///< of the codec, what the bitstream says
+      int      bitsPerCodedSample;
+      int      channels;
+      int      sampleRate;
+      int      sampleFmt;
+      uint64_t channelLayout;
+      int      blockAlign;
+      int      frameSize;
+      int      bitRate;
+      int      profile;
+      int      level;
+      int      hasBFrames;
+      int      ticksPerFrame;
+      int      timeBaseNum, timeBaseDen;             ///< of the stream, used to validate
+      int      rFrameRateNum, rFrameRateDen;
+      int      avgFrameRateNum, avgFrameRateDen;
+      int64_t  startTime;
+      int64_t  duration;
+      std::string extraData;
+    };
+
+    std::string          format;
+    int64_t              size;
+    int64_t              mtime;
+    int64_t              startTime;
+    int64_t              duration;
+    int                  bitRate;
+    std::vector<CStream> streams;
+    unsigned int         stamp; ///< for least recently used eviction
+  };
+
+  /*!
+   \brief Look up what's known about a file
+   \param file the file being opened
+   \param entry filled with what's known
+   \return true if the file is known and didn't change since
+   */
+  static bool Get(const CStdString &file, CEntry &entry);
+
+  /*!
+   \brief Remember the probing results of a file, after avformat_find_stream_info
+   */
+  static void Set(const CStdString &file, const AVFormatContext *context);
+
+  /*!
+   \brief Drop a file, when its cached results didn't work out
+   */
+  static void Remove(const CStdString &file);
+
+  /*!
+   \brief Fill in the codec parameters of a format context, instead of avformat_find_stream_info
+   \param entry what was found out about the file before
+   \param context the format context after avformat_open_input
+   \param dllAvUtil used to allocate extradata
+   \return true if the streams matched the entry and were filled in
+   */
+  static bool Apply(const CEntry &entry, AVFormatContext *context, DllAvUtil &dllAvUtil);
+
+  /*!
+   \brief Whether the probing results of a format context can be reused
+   */
+  static bool IsCacheable(const AVFormatContext *context);
+
+  /*!
+   \brief Write the entries to disc if they changed since they were last written
+   */
+  static void Flush();
+
+private:
+  static bool GetKey(const CStdString &file, int64_t &size, int64_t &mtime);
+  static void Load();
+  static void SetDirty();
+
+  static std::map<CStdString, CEntry> m_entries;
+  static unsigned int m_stamp;
+  static bool m_loaded;
+  static bool m_dirty;
+  static bool m_flushQueued;
+};
@@ -24,6 +24,8 @@
 #endif
 #include "DVDDemuxUtils.h"
 #include "DVDClock.h"
+#include "DVDPerformanceCounter.h"
+#include "threads/SingleLock.h"
 #include "utils/log.h"
 extern "C" {
 #if (defined USE_EXTERNAL_FFMPEG)
@@ -37,13 +39,119 @@ extern "C" {
 #endif
 }
 
+#include <vector>
+
+
+// buffers are pooled in power of two sizes from 4k to 2M, larger ones are
+// rare enough to go straight to the heap
+#define POOL_MIN_SHIFT   12
+#define POOL_CLASSES     10
+#define POOL_MAX_BYTES   (16 * 1024 * 1024)
+
+/*!
+ \brief A DemuxPacket with what's needed to recycle it.
+ The packet comes first so that the pointer handed out can be cast back.
+ */
+struct DemuxPacketEntry
+{
+  DemuxPacket packet;
+  int         sizeClass; ///< pool the buffer belongs to, -1 if none
+  bool        adopted;   ///< buffer is owned by avpacket
+  AVPacket    avpacket;
+};
+
+class CDemuxPacketPool
+{
+public:
+  CDemuxPacketPool() : m_bytes(0) {}
+
+  ~CDemuxPacketPool()
+  {
+    for (int i = 0; i <= POOL_CLASSES; i++)
+    {
+      for (std::vector<DemuxPacketEntry*>::iterator it = m_free[i].begin(); it != m_free[i].end(); ++it)
+      {
+        if ((*it)->packet.pData)
+          _aligned_free((*it)->packet.pData);
+        delete *it;
+      }
+    }
+  }
+
+  /*! \brief Get an entry, with a buffer of the given class unless it's -1 */
+  DemuxPacketEntry* Get(int sizeClass)
+  {
+    CSingleLock lock(m_section);
+    std::vector<DemuxPacketEntry*> &list = m_free[sizeClass + 1];
+    if (list.empty())
+      return NULL;
+    DemuxPacketEntry *entry = list.back();
+    list.pop_back();
+    if (sizeClass >= 0)
+      m_bytes -= ClassSize(sizeClass);
+    return entry;
+  }
+
+  /*! \brief Keep an entry for later, false if the pool is full */
+  bool Put(DemuxPacketEntry *entry)
+  {
+    CSingleLock lock(m_section);
+    if (entry->sizeClass >= 0)
+    {
+      if (m_bytes + ClassSize(entry->sizeClass) > POOL_MAX_BYTES)
+        return false;
+      m_bytes += ClassSize(entry->sizeClass);
+    }
+    else if (m_free[0].size() >= 256)
+      return false;
+    m_free[entry->sizeClass + 1].push_back(entry);
+    return true;
+  }
+
+  static unsigned int ClassSize(int sizeClass) { return 1 << (POOL_MIN_SHIFT + sizeClass); }
+
+  static int GetClass(int iDataSize)
+  {
+    for (int i = 0; i < POOL_CLASSES; i++)
+    {
+      if ((unsigned int)iDataSize + FF_INPUT_BUFFER_PADDING_SIZE <= ClassSize(i))
+        return i;
+    }
+    return -1;
+  }
+
+private:
+  CCriticalSection                m_section;
+  std::vector<DemuxPacketEntry*>  m_free[POOL_CLASSES + 1]; ///< entries without buffer first
+  unsigned int                    m_bytes;
+};
+
+static CDemuxPacketPool g_demuxPacketPool;
+
 void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 {
   if (pPacket)
   {
     try {
-      if (pPacket->pData) _aligned_free(pPacket->pData);
-      delete pPacket;
+      DemuxPacketEntry *entry = (DemuxPacketEntry*)pPacket;
+      if (entry->adopted)
+      {
+        if (entry->avpacket.destruct)
+          entry->avpacket.destruct(&entry->avpacket);
+        entry->adopted = false;
+        pPacket->pData = NULL;
+      }
+      else if (pPacket->pData && entry->sizeClass < 0)
+      {
+        _aligned_free(pPacket->pData);
+        pPacket->pData = NULL;
+      }
+
+      if (!g_demuxPacketPool.Put(entry))
+      {
+        if (pPacket->pData) _aligned_free(pPacket->pData);
+        delete entry;
+      }
     }
     catch(...) {
       CLog::Log(LOGERROR, "%s - Exception thrown while freeing packet", __FUNCTION__);
@@ -51,15 +159,37 @@ void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
   }
 }
 
+static DemuxPacketEntry* GetDemuxPacketEntry(int sizeClass)
+{
+  DemuxPacketEntry *entry = g_demuxPacketPool.Get(sizeClass);
+  if (entry)
+  {
+    AtomicIncrement(&g_dvdPerformanceCounter.m_packetReuses);
+    unsigned char *data = entry->packet.pData;
+    memset(entry, 0, sizeof(DemuxPacketEntry));
+    entry->packet.pData = data;
+  }
+  else
+  {
+    AtomicIncrement(&g_dvdPerformanceCounter.m_packetAllocs);
+    entry = new DemuxPacketEntry;
+    memset(entry, 0, sizeof(DemuxPacketEntry));
+  }
+  entry->sizeClass = sizeClass;
+
+  // setup defaults
+  entry->packet.dts       = DVD_NOPTS_VALUE;
+  entry->packet.pts       = DVD_NOPTS_VALUE;
+  entry->packet.iStreamId = -1;
+  return entry;
+}
+
 DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
 {
-  DemuxPacket* pPacket = new DemuxPacket;
-  if (!pPacket) return NULL;
+  DemuxPacketEntry* entry = NULL;
 
   try
   {
-    memset(pPacket, 0, sizeof(DemuxPacket));
-
     if (iDataSize > 0)
     {
       // need to allocate a few bytes more.
@@ -71,27 +201,57 @@ DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
         * Note, if the first 23 bits of the additional bytes are not 0 then damaged
         * MPEG bitstreams could cause overread and segfault
         */
-      pPacket->pData =(BYTE*)_aligned_malloc(iDataSize + FF_INPUT_BUFFER_PADDING_SIZE, 16);
-      if (!pPacket->pData)
+      int sizeClass = CDemuxPacketPool::GetClass(iDataSize);
+      entry = GetDemuxPacketEntry(sizeClass);
+      if (!entry->packet.pData)
       {
-        FreeDemuxPacket(pPacket);
-        return NULL;
+        unsigned int size = sizeClass >= 0 ? CDemuxPacketPool::ClassSize(sizeClass) : iDataSize + FF_INPUT_BUFFER_PADDING_SIZE;
+        entry->packet.pData = (BYTE*)_aligned_malloc(size, 16);
+        if (!entry->packet.pData)
+        {
+          FreeDemuxPacket(&entry->packet);
+          return NULL;
+        }
       }
 
       // reset the last 8 bytes to 0;
-      memset(pPacket->pData + iDataSize, 0, FF_INPUT_BUFFER_PADDING_SIZE);
+      memset(entry->packet.pData + iDataSize, 0, FF_INPUT_BUFFER_PADDING_SIZE);
     }
+    else
+      entry = GetDemuxPacketEntry(-1);
+  }
+  catch(...)
+  {
+    CLog::Log(LOGERROR, "%s - Exception thrown", __FUNCTION__);
+    if (entry)
+      FreeDemuxPacket(&entry->packet);
+    entry = NULL;
+  }
+  return entry ? &entry->packet : NULL;
+}
+
+DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(AVPacket* pkt)
+{
+  DemuxPacketEntry* entry = NULL;
+
+  try
+  {
+    entry = GetDemuxPacketEntry(-1);
+    entry->adopted  = true;
+    entry->avpacket = *pkt;
+    entry->packet.pData = pkt->data;
+    entry->packet.iSize = pkt->size;
 
-    // setup defaults
-    pPacket->dts       = DVD_NOPTS_VALUE;
-    pPacket->pts       = DVD_NOPTS_VALUE;
-    pPacket->iStreamId = -1;
+    // the buffer is ours now, pkt can still be read but no longer frees it
+    pkt->destruct        = NULL;
+    pkt->side_data       = NULL;
+    pkt->side_data_elems = 0;
+    AtomicIncrement(&g_dvdPerformanceCounter.m_packetAdopted);
   }
   catch(...)
   {
     CLog::Log(LOGERROR, "%s - Exception thrown", __FUNCTION__);
-    FreeDemuxPacket(pPacket);
-    pPacket = NULL;
+    entry = NULL;
   }
-  return pPacket;
+  return entry ? &entry->packet : NULL;
 }
@@ -23,10 +23,24 @@
 
 #include "DVDDemuxPacket.h"
 
+struct AVPacket;
+
+/*!
+ \brief Allocation of demux packets.
+ Freed packets are kept, together with their buffer, and handed out again.
+ Packets must be released with FreeDemuxPacket only.
+ */
 class CDVDDemuxUtils
 {
 public:
   static void FreeDemuxPacket(DemuxPacket* pPacket);
   static DemuxPacket* AllocateDemuxPacket(int iDataSize = 0);
+
+  /*!
+   \brief Allocate a packet that takes over the buffer of an ffmpeg packet instead of copying it.
+   The buffer must be owned by pkt (pkt->destruct set). pkt keeps pointing at the data
+   but no longer frees it, the buffer is released through pkt's destruct with the packet.
+   */
+  static DemuxPacket* AllocateDemuxPacket(AVPacket* pkt);
 };
 
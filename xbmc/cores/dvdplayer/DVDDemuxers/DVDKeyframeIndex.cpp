@@ -0,0 +1,206 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "system.h"
+#include "DVDKeyframeIndex.h"
+#include <algorithm>
+#include <stdlib.h>
+
+using namespace std;
+
+#define KEYFRAME_INDEX_VERSION 1
+
+// keyframes closer than this to the previous one aren't kept
+#define KEYFRAME_MIN_SPACING 2000
+// no keyframe for this long means the timestamps jumped, the span ends there
+#define KEYFRAME_MAX_GAP     60000
+// keeps the stored index below the 64k a text column holds on mysql
+#define KEYFRAME_MAX_COUNT   4000
+
+CDVDKeyframeIndex::CDVDKeyframeIndex()
+{
+  Clear();
+}
+
+void CDVDKeyframeIndex::Clear()
+{
+  m_keyframes.clear();
+  m_spans.clear();
+  m_current = -1;
+  m_changed = false;
+}
+
+void CDVDKeyframeIndex::Add(int time, int64_t pos)
+{
+  if (time < 0 || pos < 0)
+    return;
+
+  if (m_keyframes.size() >= KEYFRAME_MAX_COUNT)
+  {
+    Break();
+    return;
+  }
+
+  if (m_current >= 0 && (time < m_spans[m_current].end || time - m_spans[m_current].end > KEYFRAME_MAX_GAP))
+    Break();
+
+  if (m_current < 0)
+  {
+    CSpan span;
+    span.start = time;
+    span.end   = time;
+    m_spans.push_back(span);
+    m_current = m_spans.size() - 1;
+  }
+  else if (time > m_spans[m_current].end)
+  {
+    m_spans[m_current].end = time;
+    m_changed = true;
+  }
+
+  CKeyframe keyframe;
+  keyframe.time = time;
+  keyframe.pos  = pos;
+  vector<CKeyframe>::iterator it = upper_bound(m_keyframes.begin(), m_keyframes.end(), keyframe);
+  if (it != m_keyframes.begin() && time - (it - 1)->time < KEYFRAME_MIN_SPACING)
+    return;
+  m_keyframes.insert(it, keyframe);
+  m_changed = true;
+}
+
+void CDVDKeyframeIndex::Break()
+{
+  m_current = -1;
+  MergeSpans(m_spans);
+}
+
+bool CDVDKeyframeIndex::Find(int time, int &keyTime, int64_t &pos) const
+{
+  bool covered = false;
+  for (vector<CSpan>::const_iterator it = m_spans.begin(); it != m_spans.end() && !covered; ++it)
+    covered = time >= it->start && time <= it->end;
+  if (!covered)
+    return false;
+
+  CKeyframe keyframe;
+  keyframe.time = time;
+  vector<CKeyframe>::const_iterator it = upper_bound(m_keyframes.begin(), m_keyframes.end(), keyframe);
+  if (it == m_keyframes.begin())
+    return false;
+  --it;
+  keyTime = it->time;
+  pos     = it->pos;
+  return true;
+}
+
+CStdString CDVDKeyframeIndex::Serialize() const
+{
+  vector<CSpan> spans(m_spans);
+  MergeSpans(spans);
+
+  // version|start-end,...|time:pos,... with times and positions as deltas to the previous keyframe
+  CStdString text, item;
+  text.Format("%i|", KEYFRAME_INDEX_VERSION);
+  for (vector<CSpan>::const_iterator it = spans.begin(); it != spans.end(); ++it)
+  {
+    item.Format("%s%i-%i", it == spans.begin() ? "" : ",", it->start, it->end);
+    text += item;
+  }
+  text += "|";
+
+  int     time = 0;
+  int64_t pos  = 0;
+  for (vector<CKeyframe>::const_iterator it = m_keyframes.begin(); it != m_keyframes.end(); ++it)
+  {
+    item.Format("%s%i:%"PRId64, it == m_keyframes.begin() ? "" : ",", it->time - time, it->pos - pos);
+    text += item;
+    time = it->time;
+    pos  = it->pos;
+  }
+  return text;
+}
+
+bool CDVDKeyframeIndex::Deserialize(const CStdString &text)
+{
+  Clear();
+
+  const char *p = text.c_str();
+  char *end;
+  if (strtol(p, &end, 10) != KEYFRAME_INDEX_VERSION || *end != '|')
+    return false;
+  p = end + 1;
+
+  while (*p && *p != '|')
+  {
+    CSpan span;
+    span.start = strtol(p, &end, 10);
+    if (*end != '-')
+      break;
+    span.end = strtol(end + 1, &end, 10);
+    m_spans.push_back(span);
+    p = *end == ',' ? end + 1 : end;
+  }
+  if (*p != '|')
+  {
+    Clear();
+    return false;
+  }
+  p++;
+
+  CKeyframe keyframe;
+  keyframe.time = 0;
+  keyframe.pos  = 0;
+  while (*p)
+  {
+    keyframe.time += strtol(p, &end, 10);
+    if (*end != ':')
+      break;
+    keyframe.pos += strtoll(end + 1, &end, 10);
+    m_keyframes.push_back(keyframe);
+    p = *end == ',' ? end + 1 : end;
+  }
+  if (*p)
+  {
+    Clear();
+    return false;
+  }
+
+  MergeSpans(m_spans);
+  sort(m_keyframes.begin(), m_keyframes.end());
+  return true;
+}
+
+void CDVDKeyframeIndex::MergeSpans(vector<CSpan> &spans)
+{
+  if (spans.empty())
+    return;
+
+  sort(spans.begin(), spans.end());
+  vector<CSpan>::iterator last = spans.begin();
+  for (vector<CSpan>::iterator it = spans.begin() + 1; it != spans.end(); ++it)
+  {
+    if (it->start <= last->end)
+      last->end = max(last->end, it->end);
+    else
+      *(++last) = *it;
+  }
+  spans.erase(last + 1, spans.end());
+}
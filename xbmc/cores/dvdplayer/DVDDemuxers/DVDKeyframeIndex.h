@@ -0,0 +1,107 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/StdString.h"
+#include <stdint.h>
+#include <vector>
+
+/*!
+ \brief Times and byte positions of the video keyframes of a file.
+
+ Built while a file is played, from the keyframes the demuxer passes by.
+ The index also keeps the time spans it read through without a break, only
+ a time inside such a span is known to have no keyframe missing before it.
+ Keyframes closer than a second or two to the previous one are left out to
+ keep the index small, seeking to them lands a little early instead. A full
+ index stops growing, later parts of a very long file seek the usual way.
+ */
+class CDVDKeyframeIndex
+{
+public:
+  CDVDKeyframeIndex();
+
+  /*!
+   \brief Add a keyframe read right after the previous one, or after a Break
+   \param time the time of the keyframe in ms
+   \param pos the byte position of the packet
+   */
+  void Add(int time, int64_t pos);
+
+  /*!
+   \brief The demuxer seeked or lost track, the next keyframe doesn't follow the last one
+   */
+  void Break();
+
+  /*!
+   \brief Look up the last keyframe at or before a time
+   \param time the time to seek to in ms
+   \param keyTime set to the time of the keyframe
+   \param pos set to the byte position of the keyframe
+   \return true if the time is within a span read through, so the keyframe is known
+   */
+  bool Find(int time, int &keyTime, int64_t &pos) const;
+
+  void Clear();
+  bool IsEmpty() const { return m_keyframes.empty(); }
+  unsigned int Size() const { return m_keyframes.size(); }
+
+  /*!
+   \brief Whether keyframes were added since the index was loaded
+   */
+  bool IsChanged() const { return m_changed; }
+
+  /*!
+   \brief Store the index as delta encoded text, for the video database
+   */
+  CStdString Serialize() const;
+
+  /*!
+   \brief Load an index stored by Serialize
+   \return false if the text isn't a valid index, the index is left empty then
+   */
+  bool Deserialize(const CStdString &text);
+
+private:
+  class CKeyframe
+  {
+  public:
+    int     time;
+    int64_t pos;
+    bool operator<(const CKeyframe &right) const { return time < right.time; }
+  };
+
+  class CSpan
+  {
+  public:
+    int start;
+    int end;
+    bool operator<(const CSpan &right) const { return start < right.start; }
+  };
+
+  static void MergeSpans(std::vector<CSpan> &spans);
+
+  std::vector<CKeyframe> m_keyframes;
+  std::vector<CSpan>     m_spans;  ///< sorted and not overlapping, except for the current one
+  int                    m_current; ///< index into m_spans of the span being read, -1 after a break
+  bool                   m_changed;
+};
@@ -50,6 +50,7 @@
 #include "DllSwScale.h"
 #include "filesystem/File.h"
 #include "TextureCache.h"
+#include "threads/SingleLock.h"
 
 
 bool CDVDFileInfo::GetFileDuration(const CStdString &path, int& duration)
@@ -90,9 +91,103 @@ int DegreeToOrientation(int degrees)
   }
 }
 
-bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails)
+CDVDVideoCodecCache::CDVDVideoCodecCache(unsigned int size)
+{
+  m_size = size;
+}
+
+CDVDVideoCodecCache::~CDVDVideoCodecCache()
+{
+  Clear();
+}
+
+CDVDVideoCodec* CDVDVideoCodecCache::Acquire(CDVDStreamInfo &hint, CDVDCodecOptions &options)
+{
+  {
+    CSingleLock lock(m_section);
+    for (std::vector<CachedCodec>::iterator it = m_idle.begin(); it != m_idle.end(); ++it)
+    {
+      if (it->hint->Equal(hint, true))
+      {
+        CDVDVideoCodec *codec = it->codec;
+        delete it->hint;
+        m_idle.erase(it);
+        return codec;
+      }
+    }
+  }
+
+  return CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, options);
+}
+
+void CDVDVideoCodecCache::Release(CDVDVideoCodec *codec, const CDVDStreamInfo &hint, bool reusable)
+{
+  if (!codec)
+    return;
+
+  if (reusable)
+  {
+    // flush whatever is left of the previous file
+    codec->Reset();
+
+    CSingleLock lock(m_section);
+    if (m_idle.size() < m_size)
+    {
+      CachedCodec cached;
+      cached.hint  = new CDVDStreamInfo(hint, true);
+      cached.codec = codec;
+      m_idle.push_back(cached);
+      return;
+    }
+  }
+  delete codec;
+}
+
+void CDVDVideoCodecCache::Clear()
+{
+  CSingleLock lock(m_section);
+  for (std::vector<CachedCodec>::iterator it = m_idle.begin(); it != m_idle.end(); ++it)
+  {
+    delete it->hint;
+    delete it->codec;
+  }
+  m_idle.clear();
+}
+
+void CDVDVideoCodecCache::Close()
+{
+  CSingleLock lock(m_section);
+  m_size = 0;
+  Clear();
+}
+
+/* largest ffmpeg lowres factor that still leaves the decoded picture
+ * at least as wide as the thumb we are going to scale it down to */
+static int ThumbLowres(const CDVDStreamInfo &hint)
+{
+  DllAvCodec dllAvCodec;
+  if (!dllAvCodec.Load())
+    return 0;
+
+  int lowres = 0;
+  AVCodec *codec = dllAvCodec.avcodec_find_decoder(hint.codec);
+  if (codec && hint.width > 0)
+  {
+    while (lowres < codec->max_lowres
+        && (hint.width >> (lowres + 1)) >= g_advancedSettings.m_thumbSize)
+      lowres++;
+  }
+  dllAvCodec.Unload();
+  return lowres;
+}
+
+bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails,
+                                CDVDVideoCodecCache *pCodecs, DVDFileInfoTimings *pTimings)
 {
   unsigned int nTime = XbmcThreads::SystemClockMillis();
+  unsigned int nStage = nTime;
+  DVDFileInfoTimings timings;
+
   CDVDInputStream *pInputStream = CDVDFactoryInputStream::CreateInputStream(NULL, strPath, "");
   if (!pInputStream)
   {
@@ -136,9 +231,15 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
     return false;
   }
 
+  timings.open = XbmcThreads::SystemClockMillis() - nStage;
+  nStage += timings.open;
+
   if (pStreamDetails)
     DemuxerToStreamDetails(pInputStream, pDemuxer, *pStreamDetails, strPath);
 
+  timings.details = XbmcThreads::SystemClockMillis() - nStage;
+  nStage += timings.details;
+
   CDemuxStream* pStream = NULL;
   int nVideoStream = -1;
   for (int i = 0; i < pDemuxer->GetNrOfStreams(); i++)
@@ -161,16 +262,24 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
     CDVDStreamInfo hint(*pDemuxer->GetStream(nVideoStream), true);
     hint.software = true;
 
-    if (hint.codec == CODEC_ID_MPEG2VIDEO || hint.codec == CODEC_ID_MPEG1VIDEO)
+    // libmpeg2 is not thread safe so we always use ffmpeg for thumb extraction.
+    // only keyframes are decoded, and codecs that can downscale while decoding
+    // are asked to do so as we only need a picture of thumb size.
+    CDVDCodecOptions dvdOptions;
+    dvdOptions.m_keys.push_back(CDVDCodecOption("skip_frame", "nokey"));
+    int lowres = ThumbLowres(hint);
+    if (lowres > 0)
     {
-      // libmpeg2 is not thread safe so use ffmepg for mpeg2/mpeg1 thumb extraction
-      CDVDCodecOptions dvdOptions;
-      pVideoCodec = CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, dvdOptions);
+      CStdString value;
+      value.Format("%d", lowres);
+      dvdOptions.m_keys.push_back(CDVDCodecOption("lowres", value));
     }
+    dvdOptions.m_formats.push_back(RENDER_FMT_YUV420P);
+
+    if (pCodecs)
+      pVideoCodec = pCodecs->Acquire(hint, dvdOptions);
     else
-    {
-      pVideoCodec = CDVDFactoryCodec::CreateVideoCodec( hint );
-    }
+      pVideoCodec = CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, dvdOptions);
 
     if (pVideoCodec)
     {
@@ -178,7 +287,12 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
       int nSeekTo = nTotalLen / 3;
 
       CLog::Log(LOGDEBUG,"%s - seeking to pos %dms (total: %dms) in %s", __FUNCTION__, nSeekTo, nTotalLen, strPath.c_str());
-      if (pDemuxer->SeekTime(nSeekTo, true))
+      bool bSeeked = pDemuxer->SeekTime(nSeekTo, true);
+
+      timings.seek = XbmcThreads::SystemClockMillis() - nStage;
+      nStage += timings.seek;
+
+      if (bSeeked)
       {
         DemuxPacket* pPacket = NULL;
         int iDecoderState = VC_ERROR;
@@ -216,6 +330,9 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
 
         } while (abort_index--);
 
+        timings.decode = XbmcThreads::SystemClockMillis() - nStage;
+        nStage += timings.decode;
+
         if (iDecoderState & VC_PICTURE && !(picture.iFlags & DVP_FLAG_DROPPED))
         {
           {
@@ -251,13 +368,19 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
             dllSwScale.Unload();
             delete [] pOutBuf;
           }
+          timings.scale = XbmcThreads::SystemClockMillis() - nStage;
         }
         else
         {
           CLog::Log(LOGDEBUG,"%s - decode failed in %s", __FUNCTION__, strPath.c_str());
         }
       }
-      delete pVideoCodec;
+
+      // a decoder that errored out is not handed to the next file
+      if (pCodecs)
+        pCodecs->Release(pVideoCodec, hint, bOk);
+      else
+        delete pVideoCodec;
     }
   }
 
@@ -273,8 +396,119 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
       file.Close();
   }
 
+  if (pTimings)
+    *pTimings = timings;
+
   unsigned int nTotalTime = XbmcThreads::SystemClockMillis() - nTime;
-  CLog::Log(LOGDEBUG,"%s - measured %u ms to extract thumb from file <%s> ", __FUNCTION__, nTotalTime, strPath.c_str());
+  CLog::Log(LOGDEBUG,"%s - measured %u ms to extract thumb from file <%s> (open %u, details %u, seek %u, decode %u, scale %u)",
+            __FUNCTION__, nTotalTime, strPath.c_str(), timings.open, timings.details, timings.seek, timings.decode, timings.scale);
+  return bOk;
+}
+
+static bool DecodeBenchmarkPass(const CStdString &strPath, unsigned int threads, bool frameThreads, unsigned int frames, double &fps)
+{
+  std::auto_ptr<CDVDInputStream> input(CDVDFactoryInputStream::CreateInputStream(NULL, strPath, ""));
+  if (!input.get() || !input->Open(strPath.c_str(), ""))
+    return false;
+
+  std::auto_ptr<CDVDDemux> demux(CDVDFactoryDemuxer::CreateDemuxer(input.get()));
+  if (!demux.get())
+    return false;
+
+  int nVideoStream = -1;
+  for (int i = 0; i < demux->GetNrOfStreams(); i++)
+  {
+    CDemuxStream* pStream = demux->GetStream(i);
+    if (!pStream)
+      continue;
+    if (pStream->type == STREAM_VIDEO && nVideoStream < 0)
+      nVideoStream = i;
+    else
+      pStream->SetDiscard(AVDISCARD_ALL);
+  }
+  if (nVideoStream < 0)
+    return false;
+
+  // software so ffmpeg never hands over to a hardware decoder
+  CDVDStreamInfo hint(*demux->GetStream(nVideoStream), true);
+  hint.software = true;
+
+  CDVDCodecOptions options;
+  CStdString value;
+  value.Format("%u", threads);
+  options.m_keys.push_back(CDVDCodecOption("threads", value));
+  options.m_keys.push_back(CDVDCodecOption("threadtype", frameThreads ? "frame" : "slice"));
+  // what the renderers take, so the decoder doesn't add a scaler
+  options.m_formats.push_back(RENDER_FMT_YUV420P);
+  options.m_formats.push_back(RENDER_FMT_YUV420P10);
+  options.m_formats.push_back(RENDER_FMT_YUV420P16);
+
+  std::auto_ptr<CDVDVideoCodec> codec(CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, options));
+  if (!codec.get())
+    return false;
+
+  unsigned int decoded = 0;
+  int64_t      ticks   = 0;
+  DVDVideoPicture picture;
+  while (decoded < frames)
+  {
+    DemuxPacket* pPacket = demux->Read();
+    if (!pPacket)
+      break;
+
+    if (pPacket->iStreamId != nVideoStream)
+    {
+      CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+      continue;
+    }
+
+    // only time the decoder, not the demuxer or the input
+    int64_t start = CurrentHostCounter();
+    int state = codec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+    while (state & VC_PICTURE)
+    {
+      memset(&picture, 0, sizeof(DVDVideoPicture));
+      if (codec->GetPicture(&picture))
+        decoded++;
+      if (state & VC_BUFFER)
+        break;
+      state = codec->Decode(NULL, 0, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
+    }
+    ticks += CurrentHostCounter() - start;
+    CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+
+    if (state & VC_ERROR)
+      break;
+  }
+
+  if (decoded == 0 || ticks <= 0)
+    return false;
+
+  fps = (double)decoded * CurrentHostFrequency() / ticks;
+  return true;
+}
+
+bool CDVDFileInfo::DecodeBenchmark(const CStdString &strPath, unsigned int maxThreads, unsigned int frames)
+{
+  bool bOk = false;
+  for (unsigned int threads = 1; threads <= maxThreads; threads++)
+  {
+    for (int mode = 0; mode < 2; mode++)
+    {
+      // a single thread is the same whichever way it's split
+      if (threads == 1 && mode == 1)
+        continue;
+
+      double fps;
+      if (DecodeBenchmarkPass(strPath, threads, mode == 1, frames, fps))
+      {
+        CLog::Log(LOGNOTICE, "%s - %u %s thread(s): %.2f fps decoding %s", __FUNCTION__, threads, mode ? "frame" : "slice", fps, strPath.c_str());
+        bOk = true;
+      }
+      else
+        CLog::Log(LOGERROR, "%s - %u %s thread(s): failed to decode %s", __FUNCTION__, threads, mode ? "frame" : "slice", strPath.c_str());
+    }
+  }
   return bOk;
 }
 
@@ -282,7 +516,7 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
  * \brief Open the item pointed to by pItem and extact streamdetails
  * \return true if the stream details have changed
  */
-bool CDVDFileInfo::GetFileStreamDetails(CFileItem *pItem)
+bool CDVDFileInfo::GetFileStreamDetails(CFileItem *pItem, DVDFileInfoTimings *pTimings)
 {
   if (!pItem)
     return false;
@@ -293,6 +527,7 @@ bool CDVDFileInfo::GetFileStreamDetails(CFileItem *pItem)
   else
     return false;
 
+  unsigned int nTime = XbmcThreads::SystemClockMillis();
   CStdString playablePath = strFileNameAndPath;
   if (URIUtils::IsStack(playablePath))
     playablePath = XFILE::CStackDirectory::GetFirstStackedFile(playablePath);
@@ -308,9 +543,13 @@ bool CDVDFileInfo::GetFileStreamDetails(CFileItem *pItem)
   }
 
   CDVDDemux *pDemuxer = CDVDFactoryDemuxer::CreateDemuxer(pInputStream);
+  if (pTimings)
+    pTimings->open = XbmcThreads::SystemClockMillis() - nTime;
   if (pDemuxer)
   {
     bool retVal = DemuxerToStreamDetails(pInputStream, pDemuxer, pItem->GetVideoInfoTag()->m_streamDetails, strFileNameAndPath);
+    if (pTimings)
+      pTimings->details = XbmcThreads::SystemClockMillis() - nTime - pTimings->open;
     delete pDemuxer;
     delete pInputStream;
     return retVal;
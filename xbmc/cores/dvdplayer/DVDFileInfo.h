@@ -20,23 +20,68 @@
  */
 #pragma once
 
+#include <vector>
 #include "utils/StdString.h"
+#include "threads/CriticalSection.h"
 
 class CFileItem;
 class CDVDDemux;
 class CStreamDetails;
 class CDVDInputStream;
 class CTextureDetails;
+class CDVDVideoCodec;
+class CDVDCodecOptions;
+class CDVDStreamInfo;
+
+// time spent in each stage of a file info extraction, in ms
+struct DVDFileInfoTimings
+{
+  DVDFileInfoTimings() : open(0), details(0), seek(0), decode(0), scale(0) {}
+  unsigned int open;    // input stream and demuxer
+  unsigned int details; // stream details
+  unsigned int seek;
+  unsigned int decode;
+  unsigned int scale;   // scale and store the thumb
+};
+
+// Keeps opened software decoders around between files of the same format,
+// so batch extraction can skip setting up a codec for every file
+class CDVDVideoCodecCache
+{
+public:
+  CDVDVideoCodecCache(unsigned int size = 4);
+  ~CDVDVideoCodecCache();
+
+  CDVDVideoCodec* Acquire(CDVDStreamInfo &hint, CDVDCodecOptions &options);
+  void            Release(CDVDVideoCodec *codec, const CDVDStreamInfo &hint, bool reusable);
+  void            Clear();
+  /*! \brief Free the cached decoders and cache no more of them */
+  void            Close();
+
+private:
+  struct CachedCodec
+  {
+    CDVDStreamInfo *hint;
+    CDVDVideoCodec *codec;
+  };
+  std::vector<CachedCodec> m_idle;
+  unsigned int             m_size;
+  CCriticalSection         m_section;
+};
 
 class CDVDFileInfo
 {
 public:
   // Extract a thumbnail immage from the media at strPath, optionally populating a streamdetails class with the data
-  static bool ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails);
+  static bool ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails,
+                           CDVDVideoCodecCache *pCodecs = NULL, DVDFileInfoTimings *pTimings = NULL);
 
   // Probe the files streams and store the info in the VideoInfoTag
-  static bool GetFileStreamDetails(CFileItem *pItem);
+  static bool GetFileStreamDetails(CFileItem *pItem, DVDFileInfoTimings *pTimings = NULL);
   static bool DemuxerToStreamDetails(CDVDInputStream* pInputStream, CDVDDemux *pDemux, CStreamDetails &details, const CStdString &path = "");
 
   static bool GetFileDuration(const CStdString &path, int &duration);
+
+  // Decode the first frames of the video stream at strPath headless, once per thread count up to maxThreads, logging the fps reached
+  static bool DecodeBenchmark(const CStdString &strPath, unsigned int maxThreads, unsigned int frames);
 };
@@ -44,6 +44,7 @@ CDVDInputStreamPVRManager::CDVDInputStreamPVRManager(IDVDPlayer* pPlayer) : CDVD
   m_pLiveTV         = NULL;
   m_pOtherStream    = NULL;
   m_eof             = true;
+  m_otherStreamSwitched = false;
 }
 
 /************************************************************************
@@ -142,6 +143,46 @@ void CDVDInputStreamPVRManager::Close()
   m_eof             = true;
 }
 
+void CDVDInputStreamPVRManager::SetOtherStream(CDVDInputStream *stream)
+{
+  if (m_pOtherStream)
+  {
+    m_pOtherStream->Close();
+    delete m_pOtherStream;
+  }
+  m_pOtherStream = stream;
+  if (m_pOtherStream)
+    m_pOtherStream->SetFileItem(m_item);
+  m_otherStreamSwitched = m_pOtherStream != NULL;
+  m_eof = false;
+}
+
+bool CDVDInputStreamPVRManager::OpenOtherStream(const CPVRChannel &channel)
+{
+  std::string transFile = XFILE::CPVRFile::TranslatePVRFilename(channel.Path());
+  if (transFile.substr(0, 6) == "pvr://")
+  {
+    SetOtherStream(NULL);
+    return true;
+  }
+
+  CDVDInputStream *stream = CDVDFactoryInputStream::CreateInputStream(m_pPlayer, transFile, m_content);
+  if (!stream)
+  {
+    CLog::Log(LOGERROR, "CDVDInputStreamPVRManager::OpenOtherStream - unable to create input stream for [%s]", transFile.c_str());
+    return false;
+  }
+  stream->SetFileItem(m_item);
+  if (!stream->Open(transFile.c_str(), m_content))
+  {
+    CLog::Log(LOGERROR, "CDVDInputStreamPVRManager::OpenOtherStream - error opening [%s]", transFile.c_str());
+    delete stream;
+    return false;
+  }
+  SetOtherStream(stream);
+  return true;
+}
+
 int CDVDInputStreamPVRManager::Read(BYTE* buf, int buf_size)
 {
   if(!m_pFile) return -1;
@@ -253,7 +294,15 @@ CDVDInputStream::ENextStream CDVDInputStreamPVRManager::NextStream()
   if(!m_pFile) return NEXTSTREAM_NONE;
 
   if (m_pOtherStream)
+  {
+    // a channel switched to with a stream of its own
+    if (m_otherStreamSwitched)
+    {
+      m_otherStreamSwitched = false;
+      return NEXTSTREAM_OPEN;
+    }
     return m_pOtherStream->NextStream();
+  }
   else
   {
     if(m_pFile->SkipNext())
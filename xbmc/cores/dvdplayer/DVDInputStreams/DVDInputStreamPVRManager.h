@@ -82,6 +82,19 @@ public:
   /* returns m_pOtherStream */
   CDVDInputStream* GetOtherStream();
 
+  /*! \brief Read from a stream opened elsewhere, after switching to a channel with its own stream URL
+   The stream is owned and closed by this input stream after. The previous other stream is closed.
+   NULL reads from the client again.
+   */
+  void SetOtherStream(CDVDInputStream *stream);
+
+  /*! \brief Open the stream of the channel switched to
+   Channels with a stream URL of their own are read through another input stream, others
+   through the client.
+   \return false if the stream of the channel couldn't be opened
+   */
+  bool OpenOtherStream(const PVR::CPVRChannel &channel);
+
 protected:
   IDVDPlayer*               m_pPlayer;
   CDVDInputStream*          m_pOtherStream;
@@ -89,6 +102,7 @@ protected:
   XFILE::ILiveTVInterface*  m_pLiveTV;
   XFILE::IRecordable*       m_pRecordable;
   bool                      m_eof;
+  bool                      m_otherStreamSwitched; ///< the other stream was switched, the player opens a new demuxer on it
 };
 
 
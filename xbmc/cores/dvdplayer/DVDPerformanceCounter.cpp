@@ -22,6 +22,7 @@
 #include "DVDPerformanceCounter.h"
 #include "DVDMessageQueue.h"
 #include "utils/TimeUtils.h"
+#include "utils/log.h"
 
 #include "dvd_config.h"
 
@@ -123,6 +124,8 @@ CDVDPerformanceCounter::CDVDPerformanceCounter()
   memset(&m_audioDecodePerformance, 0, sizeof(m_audioDecodePerformance)); // audio decoding + output to audio device
   memset(&m_mainPerformance,        0, sizeof(m_mainPerformance));        // reading files, demuxing, decoding of subtitles + menu overlays
 
+  ResetPacketCounters();
+
   Initialize();
 }
 
@@ -153,3 +156,21 @@ void CDVDPerformanceCounter::DeInitialize()
 
 }
 
+void CDVDPerformanceCounter::ResetPacketCounters()
+{
+  m_packetAllocs  = 0;
+  m_packetReuses  = 0;
+  m_packetAdopted = 0;
+  m_packetCopies  = 0;
+  m_trickplayFrames  = 0;
+  m_trickplayDropped = 0;
+}
+
+void CDVDPerformanceCounter::LogPacketCounters()
+{
+  CLog::Log(LOGDEBUG, "%s - demux packets allocated: %ld, reused: %ld, adopted: %ld, copied: %ld",
+            __FUNCTION__, m_packetAllocs, m_packetReuses, m_packetAdopted, m_packetCopies);
+  if (m_trickplayFrames || m_trickplayDropped)
+    CLog::Log(LOGDEBUG, "%s - trick-play video frames decoded: %ld, dropped: %ld",
+              __FUNCTION__, m_trickplayFrames, m_trickplayDropped);
+}
@@ -26,6 +26,7 @@
 #include "system.h"
 #include "threads/Thread.h"
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
 
 class CDVDMessageQueue;
 
@@ -60,6 +61,9 @@ public:
   void EnableMainPerformance(CThread *thread)         { CSingleLock lock(m_critSection); m_mainPerformance.thread = thread;  }
   void DisableMainPerformance()                       { CSingleLock lock(m_critSection); m_mainPerformance.thread = NULL;  }
 
+  void ResetPacketCounters();
+  void LogPacketCounters();
+
   CDVDMessageQueue*         m_pAudioQueue;
   CDVDMessageQueue*         m_pVideoQueue;
 
@@ -67,6 +71,16 @@ public:
   ProcessPerformance        m_audioDecodePerformance;
   ProcessPerformance        m_mainPerformance;
 
+  // demux packets, see CDVDDemuxUtils
+  volatile long             m_packetAllocs;  // packets allocated from the heap
+  volatile long             m_packetReuses;  // packets taken from the pool
+  volatile long             m_packetAdopted; // packets that took over the demuxer's buffer
+  volatile long             m_packetCopies;  // packets the demuxer's buffer was copied into
+
+  // video frames at trick-play speeds, see CDVDDemuxFFmpeg::Read
+  volatile long             m_trickplayFrames;  // keyframes passed on to be decoded
+  volatile long             m_trickplayDropped; // other frames dropped by the demuxer
+
 private:
   CCriticalSection m_critSection;
 };
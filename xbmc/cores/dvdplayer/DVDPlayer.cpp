@@ -49,6 +49,7 @@
 #include "guilib/GUIWindowManager.h"
 #include "Application.h"
 #include "DVDPerformanceCounter.h"
+#include "DVDPlayerTelemetry.h"
 #include "filesystem/File.h"
 #include "pictures/Picture.h"
 #include "DllSwScale.h"
@@ -70,9 +71,11 @@
 #include "utils/StreamDetails.h"
 #include "pvr/PVRManager.h"
 #include "pvr/channels/PVRChannel.h"
+#include "pvr/channels/PVRChannelGroup.h"
 #include "pvr/windows/GUIWindowPVR.h"
 #include "filesystem/PVRFile.h"
 #include "video/dialogs/GUIDialogFullScreenInfo.h"
+#include "video/VideoDatabase.h"
 #include "utils/StreamUtils.h"
 #include "utils/Variant.h"
 #include "storage/MediaManager.h"
@@ -401,11 +404,17 @@ CDVDPlayer::CDVDPlayer(IPlayerCallback& callback)
       m_dvdPlayerAudio(&m_clock, m_messenger),
       m_dvdPlayerSubtitle(&m_overlayContainer),
       m_dvdPlayerTeletext(),
+      m_zapAccelerator(this),
       m_ready(true)
 {
   m_pDemuxer = NULL;
   m_pSubtitleDemuxer = NULL;
   m_pInputStream = NULL;
+  m_pZapDemuxer = NULL;
+  m_zapStart = 0;
+  m_zapWarm = false;
+  m_zapUpdate = 0;
+  m_seekStart = 0;
 
   m_dvd.Clear();
   m_State.Clear();
@@ -532,6 +541,8 @@ void CDVDPlayer::OnStartup()
   m_messenger.Init();
 
   g_dvdPerformanceCounter.EnableMainPerformance(this);
+  g_dvdPerformanceCounter.ResetPacketCounters();
+  g_dvdPlayerTelemetry.Reset();
   CUtil::ClearTempFonts();
 }
 
@@ -627,13 +638,20 @@ retry:
 bool CDVDPlayer::OpenDemuxStream()
 {
   if(m_pDemuxer)
+  {
+    SaveKeyframeIndex();
     SAFE_DELETE(m_pDemuxer);
+  }
 
   CLog::Log(LOGNOTICE, "Creating Demuxer");
 
   try
   {
-    int attempts = 10;
+    // a channel switched to may have been opened in advance
+    m_pDemuxer    = m_pZapDemuxer;
+    m_pZapDemuxer = NULL;
+
+    int attempts = m_pDemuxer ? 0 : 10;
     while(!m_bStop && attempts-- > 0)
     {
       m_pDemuxer = CDVDFactoryDemuxer::CreateDemuxer(m_pInputStream);
@@ -671,9 +689,43 @@ bool CDVDPlayer::OpenDemuxStream()
   if(len > 0 && tim > 0)
     m_pInputStream->SetReadRate(len * 1000 / tim);
 
+  LoadKeyframeIndex();
+
   return true;
 }
 
+void CDVDPlayer::LoadKeyframeIndex()
+{
+  CDVDDemuxFFmpeg *demuxer = dynamic_cast<CDVDDemuxFFmpeg*>(m_pDemuxer);
+  if (!demuxer || !demuxer->UsesKeyframeIndex() || !m_pInputStream->IsStreamType(DVDSTREAM_TYPE_FILE))
+    return;
+
+  CVideoDatabase db;
+  CStdString index;
+  if (!db.Open() || !db.GetKeyframeIndex(m_filename, index))
+    return;
+
+  if (demuxer->GetKeyframeIndex().Deserialize(index))
+    CLog::Log(LOGDEBUG, "%s - loaded %u keyframes", __FUNCTION__, demuxer->GetKeyframeIndex().Size());
+  else
+    CLog::Log(LOGWARNING, "%s - invalid keyframe index for %s", __FUNCTION__, m_filename.c_str());
+}
+
+void CDVDPlayer::SaveKeyframeIndex()
+{
+  CDVDDemuxFFmpeg *demuxer = dynamic_cast<CDVDDemuxFFmpeg*>(m_pDemuxer);
+  if (!demuxer || !demuxer->UsesKeyframeIndex() || !m_pInputStream || !m_pInputStream->IsStreamType(DVDSTREAM_TYPE_FILE))
+    return;
+
+  CDVDKeyframeIndex &index = demuxer->GetKeyframeIndex();
+  if (!index.IsChanged() || index.IsEmpty())
+    return;
+
+  CVideoDatabase db;
+  if (db.Open())
+    db.SetKeyframeIndex(m_filename, index.Serialize());
+}
+
 void CDVDPlayer::OpenDefaultStreams()
 {
   SelectionStreams streams;
@@ -924,11 +976,16 @@ bool CDVDPlayer::IsBetterStream(CCurrentStream& current, CDemuxStream* stream)
 
 void CDVDPlayer::Process()
 {
+  unsigned int openStart = XbmcThreads::SystemClockMillis();
+  unsigned int inputTime, demuxTime;
+  bool firstPacket = true;
+
   if (!OpenInputStream())
   {
     m_bAbortRequest = true;
     return;
   }
+  inputTime = XbmcThreads::SystemClockMillis() - openStart;
 
   if(m_pInputStream->IsStreamType(DVDSTREAM_TYPE_DVD))
   {
@@ -949,6 +1006,7 @@ void CDVDPlayer::Process()
     m_bAbortRequest = true;
     return;
   }
+  demuxTime = XbmcThreads::SystemClockMillis() - openStart - inputTime;
 
   // allow renderer to switch to fullscreen if requested
   m_dvdPlayerVideo.EnableFullscreen(m_PlayerOptions.fullscreen);
@@ -1078,8 +1136,13 @@ void CDVDPlayer::Process()
 
       UpdateApplication(0);
       UpdatePlayState(0);
+      m_zapUpdate = 0;
     }
 
+    // keep the neighbouring channels open
+    if (XbmcThreads::SystemClockMillis() - m_zapUpdate >= 10000)
+      UpdateZapAccelerator();
+
     // handle eventual seeks due to playspeed
     HandlePlaySpeed();
 
@@ -1108,6 +1171,18 @@ void CDVDPlayer::Process()
     DemuxPacket* pPacket = NULL;
     CDemuxStream *pStream = NULL;
     ReadPacket(pPacket, pStream);
+    if (pPacket && pStream && pStream->type == STREAM_VIDEO && m_seekStart)
+    {
+      CLog::Log(LOGDEBUG, "%s - first video packet %u ms after seek", __FUNCTION__, XbmcThreads::SystemClockMillis() - m_seekStart);
+      m_seekStart = 0;
+    }
+    if (pPacket && pStream && firstPacket)
+    {
+      unsigned int total = XbmcThreads::SystemClockMillis() - openStart;
+      CLog::Log(LOGDEBUG, "%s - first packet after %u ms: input %u ms, demuxer %u ms, streams and seek %u ms",
+                __FUNCTION__, total, inputTime, demuxTime, total - inputTime - demuxTime);
+      firstPacket = false;
+    }
     if (pPacket && !pStream)
     {
       /* probably a empty packet, just free it and move on */
@@ -1233,6 +1308,51 @@ void CDVDPlayer::Process()
   }
 }
 
+bool CDVDPlayer::OpenSwitchedChannel()
+{
+  SAFE_DELETE(m_pDemuxer);
+  SAFE_DELETE(m_pZapDemuxer);
+  m_zapWarm = false;
+
+  CDVDInputStreamPVRManager *input = dynamic_cast<CDVDInputStreamPVRManager*>(m_pInputStream);
+  CPVRChannel channel;
+  if (!input || !g_PVRManager.GetCurrentChannel(channel))
+    return true;
+
+  CStdString url;
+  CDVDInputStream *stream;
+  if (m_zapAccelerator.Take(channel.ChannelID(), url, stream, m_pZapDemuxer))
+  {
+    CLog::Log(LOGDEBUG, "%s - using %s opened in advance", __FUNCTION__, url.c_str());
+    input->SetOtherStream(stream);
+    m_zapWarm = true;
+    return true;
+  }
+  return input->OpenOtherStream(channel);
+}
+
+void CDVDPlayer::UpdateZapAccelerator()
+{
+  m_zapUpdate = XbmcThreads::SystemClockMillis();
+
+  CPVRChannel playing;
+  if (!dynamic_cast<CDVDInputStreamPVRManager*>(m_pInputStream) || !g_PVRManager.GetCurrentChannel(playing))
+    return;
+
+  // the channels next and previous to the playing one. pvr://stream/ urls are looked up
+  // through the client, which may tune to get them, so those aren't opened in advance
+  CDVDZapAccelerator::ChannelURLs wanted;
+  const CPVRChannelGroup *group = g_PVRManager.GetPlayingGroup(playing.IsRadio());
+  for (int i = 0; group && i < g_advancedSettings.m_iPVRZapPrefetch && i < 2; i++)
+  {
+    const CPVRChannel *channel = i == 0 ? group->GetByChannelUp(playing) : group->GetByChannelDown(playing);
+    if (channel && channel->ChannelID() != playing.ChannelID()
+    &&  !channel->StreamURL().IsEmpty() && channel->StreamURL().Left(6) != "pvr://")
+      wanted.push_back(make_pair(channel->ChannelID(), channel->StreamURL()));
+  }
+  m_zapAccelerator.Update(wanted);
+}
+
 bool CDVDPlayer::CheckDelayedChannelEntry(void)
 {
   bool bReturn(false);
@@ -1977,6 +2097,10 @@ void CDVDPlayer::SendPlayerMessage(CDVDMsg* pMsg, unsigned int target)
 void CDVDPlayer::OnExit()
 {
   g_dvdPerformanceCounter.DisableMainPerformance();
+  g_dvdPerformanceCounter.LogPacketCounters();
+  m_zapAccelerator.Clear();
+  SAFE_DELETE(m_pZapDemuxer);
+  CDVDZapAccelerator::LogZapTimes();
 
   try
   {
@@ -2010,6 +2134,7 @@ void CDVDPlayer::OnExit()
     // destroy the demuxer
     if (m_pDemuxer)
     {
+      SaveKeyframeIndex();
       CLog::Log(LOGNOTICE, "CDVDPlayer::OnExit() deleting demuxer");
       delete m_pDemuxer;
     }
@@ -2043,6 +2168,9 @@ void CDVDPlayer::OnExit()
     m_pDemuxer = NULL;
   }
 
+  if (g_advancedSettings.m_videoTelemetryCSV)
+    g_dvdPlayerTelemetry.DumpCSV("special://temp/dvdplayer-telemetry.csv");
+
   m_bStop = true;
   // if we didn't stop playing, advance to the next item in xbmc's playlist
   if(m_PlayerOptions.identify == false)
@@ -2083,9 +2211,12 @@ void CDVDPlayer::HandleMessages()
 
         int time = msg.GetRestore() ? (int)m_Edl.RestoreCutTime(msg.GetTime()) : msg.GetTime();
         CLog::Log(LOGDEBUG, "demuxer seek to: %d", time);
+        unsigned int seekStart = XbmcThreads::SystemClockMillis();
         if (m_pDemuxer && m_pDemuxer->SeekTime(time, msg.GetBackward(), &start))
         {
-          CLog::Log(LOGDEBUG, "demuxer seek to: %d, success", time);
+          CLog::Log(LOGDEBUG, "demuxer seek to: %d, success in %u ms", time, XbmcThreads::SystemClockMillis() - seekStart);
+          if(!msg.GetTrickPlay())
+            m_seekStart = seekStart;
           if(m_pSubtitleDemuxer)
           {
             if(!m_pSubtitleDemuxer->SeekTime(time, msg.GetBackward()))
@@ -2260,12 +2391,10 @@ void CDVDPlayer::HandleMessages()
       }
       else if (pMsg->IsType(CDVDMsg::PLAYER_CHANNEL_SELECT_NUMBER) && m_messenger.GetPacketCount(CDVDMsg::PLAYER_CHANNEL_SELECT_NUMBER) == 0)
       {
+        m_zapStart = XbmcThreads::SystemClockMillis();
         FlushBuffers(false);
         CDVDInputStream::IChannel* input = dynamic_cast<CDVDInputStream::IChannel*>(m_pInputStream);
-        if(input && input->SelectChannelByNumber(static_cast<CDVDMsgInt*>(pMsg)->m_value))
-        {
-          SAFE_DELETE(m_pDemuxer);
-        }else
+        if(!input || !input->SelectChannelByNumber(static_cast<CDVDMsgInt*>(pMsg)->m_value) || !OpenSwitchedChannel())
         {
           CLog::Log(LOGWARNING, "%s - failed to switch channel. playback stopped", __FUNCTION__);
           g_application.getApplicationMessenger().MediaStop(false);
@@ -2273,12 +2402,10 @@ void CDVDPlayer::HandleMessages()
       }
       else if (pMsg->IsType(CDVDMsg::PLAYER_CHANNEL_SELECT) && m_messenger.GetPacketCount(CDVDMsg::PLAYER_CHANNEL_SELECT) == 0)
       {
+        m_zapStart = XbmcThreads::SystemClockMillis();
         FlushBuffers(false);
         CDVDInputStream::IChannel* input = dynamic_cast<CDVDInputStream::IChannel*>(m_pInputStream);
-        if(input && input->SelectChannel(static_cast<CDVDMsgType <CPVRChannel> *>(pMsg)->m_value))
-        {
-          SAFE_DELETE(m_pDemuxer);
-        }else
+        if(!input || !input->SelectChannel(static_cast<CDVDMsgType <CPVRChannel> *>(pMsg)->m_value) || !OpenSwitchedChannel())
         {
           CLog::Log(LOGWARNING, "%s - failed to switch channel. playback stopped", __FUNCTION__);
           g_application.getApplicationMessenger().MediaStop(false);
@@ -2294,6 +2421,7 @@ void CDVDPlayer::HandleMessages()
 
           if (!bShowPreview)
           {
+            m_zapStart = XbmcThreads::SystemClockMillis();
             g_infoManager.SetDisplayAfterSeek(100000);
             FlushBuffers(false);
           }
@@ -2313,7 +2441,11 @@ void CDVDPlayer::HandleMessages()
             else
             {
               m_iChannelEntryTimeOut = 0;
-              SAFE_DELETE(m_pDemuxer);
+              if (!OpenSwitchedChannel())
+              {
+                CLog::Log(LOGWARNING, "%s - failed to open the channel switched to. playback stopped", __FUNCTION__);
+                g_application.getApplicationMessenger().MediaStop(false);
+              }
 
               g_infoManager.SetDisplayAfterSeek();
             }
@@ -2335,6 +2467,14 @@ void CDVDPlayer::HandleMessages()
         if(player == DVDPLAYER_VIDEO)
           m_CurrentVideo.started = true;
         CLog::Log(LOGDEBUG, "CDVDPlayer::HandleMessages - player started %d", player);
+
+        // a switched channel plays once its picture, or its sound for radio, is out
+        if (m_zapStart && m_pDemuxer
+        && (player == DVDPLAYER_VIDEO || (player == DVDPLAYER_AUDIO && m_CurrentVideo.id < 0)))
+        {
+          CDVDZapAccelerator::AddZapTime(XbmcThreads::SystemClockMillis() - m_zapStart, m_zapWarm);
+          m_zapStart = 0;
+        }
       }
     }
     catch (...)
@@ -32,6 +32,7 @@
 #include "DVDPlayerVideo.h"
 #include "DVDPlayerSubtitle.h"
 #include "DVDPlayerTeletext.h"
+#include "DVDZapStreamOpener.h"
 
 //#include "DVDChapterReader.h"
 #include "DVDSubtitles/DVDFactorySubtitle.h"
@@ -332,6 +333,10 @@ protected:
   bool IsValidStream(CCurrentStream& stream);
   bool IsBetterStream(CCurrentStream& current, CDemuxStream* stream);
   bool CheckDelayedChannelEntry(void);
+  bool OpenSwitchedChannel();
+  void UpdateZapAccelerator();
+  void LoadKeyframeIndex();
+  void SaveKeyframeIndex();
 
   bool OpenInputStream();
   bool OpenDemuxStream();
@@ -382,6 +387,14 @@ protected:
   CDVDDemux* m_pDemuxer;            // demuxer for current playing file
   CDVDDemux* m_pSubtitleDemuxer;
 
+  CDVDZapStreamAccelerator m_zapAccelerator; // opens neighbouring channels in advance
+  CDVDDemux*   m_pZapDemuxer;          // demuxer of a channel switched to that was opened in advance
+  unsigned int m_zapStart;             // when the last channel switch was requested, 0 once it plays
+  bool         m_zapWarm;              // whether the channel switched to was opened in advance
+  unsigned int m_zapUpdate;            // when the neighbouring channels were last checked
+
+  unsigned int m_seekStart;            // when the last seek was requested, 0 once video was read after it
+
   CStdString m_lastSub;
   
   struct SDVDInfo
@@ -26,6 +26,7 @@
 #include "DVDCodecs/DVDCodecs.h"
 #include "DVDCodecs/DVDFactoryCodec.h"
 #include "DVDPerformanceCounter.h"
+#include "DVDPlayerTelemetry.h"
 #include "settings/GUISettings.h"
 #include "video/VideoReferenceClock.h"
 #include "utils/log.h"
@@ -168,6 +169,7 @@ CDVDPlayerAudio::CDVDPlayerAudio(CDVDClock* pClock, CDVDMessageQueue& parent)
   m_started = false;
   m_duration = 0.0;
   m_resampleratio = 1.0;
+  m_decodeTime = 0.0;
 
   m_freq = CurrentHostFrequency();
 
@@ -308,7 +310,9 @@ int CDVDPlayerAudio::DecodeFrame(DVDAudioFrame &audioframe, bool bDropPacket)
       if (dts != DVD_NOPTS_VALUE)
         m_audioClock = dts;
 
+      int64_t decodeStart = CurrentHostCounter();
       int len = m_pAudioCodec->Decode(m_decode.data, m_decode.size);
+      m_decodeTime += (double)(CurrentHostCounter() - decodeStart) * DVD_TIME_BASE / m_freq;
       m_audioStats.AddSampleBytes(m_decode.size);
       if (len < 0)
       {
@@ -694,6 +698,15 @@ void CDVDPlayerAudio::HandleSyncError(double duration)
   double error = m_ptsOutput.Current() - clock;
   int64_t now;
 
+  unsigned int flags = 0;
+  if (m_synctype == SYNC_SKIPDUP && m_skipdupcount < 0)
+    flags |= CDVDPlayerTelemetry::FLAG_SKIPPED;
+  else if (m_synctype == SYNC_SKIPDUP && m_skipdupcount > 0)
+    flags |= CDVDPlayerTelemetry::FLAG_DUPLICATED;
+  g_dvdPlayerTelemetry.Add(CDVDPlayerTelemetry::STREAM_AUDIO, m_ptsOutput.Current(), error, m_decodeTime, flags,
+                           m_synctype == SYNC_RESAMPLE ? m_resampleratio : 1.0, m_messageQueue.GetLevel());
+  m_decodeTime = 0.0;
+
   if( fabs(error) > DVD_MSEC_TO_TIME(100) || m_syncclock )
   {
     m_pClock->Discontinuity(clock+error);
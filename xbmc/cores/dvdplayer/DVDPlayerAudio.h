@@ -209,5 +209,6 @@ protected:
   bool   m_prevskipped;
   double m_maxspeedadjust;
   double m_resampleratio; //resample ratio when using SYNC_RESAMPLE, used for the codec info
+  double m_decodeTime;    //time spent decoding since the last sync check, for CDVDPlayerTelemetry
 };
 
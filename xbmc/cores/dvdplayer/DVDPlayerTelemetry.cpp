@@ -0,0 +1,149 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DVDPlayerTelemetry.h"
+#include "DVDClock.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "utils/TimeUtils.h"
+#include "utils/log.h"
+#include <math.h>
+
+CDVDPlayerTelemetry g_dvdPlayerTelemetry;
+
+CDVDPlayerTelemetry::CDVDPlayerTelemetry()
+{
+  m_samples.resize(SAMPLES_MAX);
+  Reset();
+}
+
+void CDVDPlayerTelemetry::Reset()
+{
+  CSingleLock lock(m_critSection);
+  m_next = 0;
+  m_count = 0;
+  m_start = CurrentHostCounter();
+  memset(&m_totals, 0, sizeof(m_totals));
+}
+
+void CDVDPlayerTelemetry::Add(Stream stream, double pts, double error, double decode, unsigned int flags, double ratio, int level)
+{
+  double time = (double)(CurrentHostCounter() - m_start) * DVD_TIME_BASE / CurrentHostFrequency();
+
+  CSingleLock lock(m_critSection);
+  CSample &sample = m_samples[m_next];
+  sample.time   = time;
+  sample.stream = stream;
+  sample.pts    = pts;
+  sample.error  = error;
+  sample.decode = decode;
+  sample.flags  = flags;
+  sample.ratio  = ratio;
+  sample.level  = level;
+
+  m_next = (m_next + 1) % SAMPLES_MAX;
+  if (m_count < SAMPLES_MAX)
+    m_count++;
+
+  if (flags & FLAG_DISCONTINUITY)
+    m_totals.discontinuities++;
+  if (stream == STREAM_VIDEO)
+  {
+    m_totals.frames++;
+    if (flags & FLAG_DROPPED)
+      m_totals.dropped++;
+    if (flags & FLAG_LATE)
+      m_totals.late++;
+    if (fabs(error) > m_totals.maxError)
+      m_totals.maxError = fabs(error);
+    if (decode > m_totals.maxDecode)
+      m_totals.maxDecode = decode;
+  }
+  else if (stream == STREAM_AUDIO)
+  {
+    m_totals.packets++;
+    if (flags & (FLAG_SKIPPED | FLAG_DUPLICATED))
+      m_totals.corrections++;
+  }
+}
+
+void CDVDPlayerTelemetry::GetSamples(std::vector<CSample> &samples, unsigned int limit) const
+{
+  CSingleLock lock(m_critSection);
+  unsigned int count = m_count;
+  if (limit && limit < count)
+    count = limit;
+
+  samples.clear();
+  samples.reserve(count);
+  unsigned int first = (m_next + SAMPLES_MAX - count) % SAMPLES_MAX;
+  for (unsigned int i = 0; i < count; i++)
+    samples.push_back(m_samples[(first + i) % SAMPLES_MAX]);
+}
+
+CDVDPlayerTelemetry::CTotals CDVDPlayerTelemetry::GetTotals() const
+{
+  CSingleLock lock(m_critSection);
+  return m_totals;
+}
+
+bool CDVDPlayerTelemetry::DumpCSV(const CStdString &path) const
+{
+  std::vector<CSample> samples;
+  GetSamples(samples);
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(path, true))
+  {
+    CLog::Log(LOGERROR, "%s - unable to write %s", __FUNCTION__, path.c_str());
+    return false;
+  }
+
+  CStdString line("time,stream,pts,error,decode,ratio,level,dropped,late,repeated,skipped,duplicated,discontinuity\n");
+  file.Write(line.c_str(), line.size());
+  for (std::vector<CSample>::const_iterator i = samples.begin(); i != samples.end(); ++i)
+  {
+    line.Format("%.3f,%s,%.3f,%.3f,%.3f,%.6f,%d,%d,%d,%d,%d,%d,%d\n",
+                i->time / DVD_TIME_BASE * 1000.0, GetStreamName(i->stream),
+                i->pts == DVD_NOPTS_VALUE ? -1.0 : i->pts / DVD_TIME_BASE * 1000.0,
+                i->error / DVD_TIME_BASE * 1000.0, i->decode / DVD_TIME_BASE * 1000.0,
+                i->ratio, i->level,
+                (i->flags & FLAG_DROPPED) ? 1 : 0, (i->flags & FLAG_LATE) ? 1 : 0,
+                (i->flags & FLAG_REPEATED) ? 1 : 0, (i->flags & FLAG_SKIPPED) ? 1 : 0,
+                (i->flags & FLAG_DUPLICATED) ? 1 : 0, (i->flags & FLAG_DISCONTINUITY) ? 1 : 0);
+    file.Write(line.c_str(), line.size());
+  }
+  file.Close();
+
+  CLog::Log(LOGDEBUG, "%s - wrote %u samples to %s", __FUNCTION__, (unsigned int)samples.size(), path.c_str());
+  return true;
+}
+
+const char *CDVDPlayerTelemetry::GetStreamName(Stream stream)
+{
+  switch (stream)
+  {
+  case STREAM_VIDEO: return "video";
+  case STREAM_AUDIO: return "audio";
+  case STREAM_CLOCK: return "clock";
+  }
+  return "unknown";
+}
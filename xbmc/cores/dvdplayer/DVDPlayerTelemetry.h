@@ -0,0 +1,121 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "threads/CriticalSection.h"
+#include "utils/StdString.h"
+#include <stdint.h>
+#include <vector>
+
+/*!
+ \brief Timings of the last frames played, to tell how well audio and video keep in sync.
+
+ The video player adds a sample for every picture it outputs, the audio player one
+ for every packet it checks against the clock, and the clock one for every
+ discontinuity. The last SAMPLES_MAX samples are kept in a ring, together with
+ totals since playback started. They can be read over JSON-RPC (Player.GetTelemetry)
+ while playing, and are written to special://temp/dvdplayer-telemetry.csv when
+ playback ends if <telemetrycsv> is set in the video section of advancedsettings.xml,
+ which also works headless with the NULL audio sink.
+ */
+class CDVDPlayerTelemetry
+{
+public:
+  enum Stream
+  {
+    STREAM_VIDEO = 0,
+    STREAM_AUDIO,
+    STREAM_CLOCK
+  };
+
+  enum Flags
+  {
+    FLAG_DROPPED       = 0x01, ///< the picture wasn't shown
+    FLAG_LATE          = 0x02, ///< the picture was very late, the next one is dropped
+    FLAG_REPEATED      = 0x04, ///< the picture is shown for more than one frame
+    FLAG_SKIPPED       = 0x08, ///< audio packets are skipped to catch up
+    FLAG_DUPLICATED    = 0x10, ///< audio packets are duplicated to wait for the clock
+    FLAG_DISCONTINUITY = 0x20  ///< the clock was set to the pts
+  };
+
+  class CSample
+  {
+  public:
+    double       time;   ///< since playback started, in DVD_TIME_BASE
+    double       pts;
+    double       error;  ///< pts less the clock, positive when early, in DVD_TIME_BASE
+    double       decode; ///< time spent decoding, in DVD_TIME_BASE
+    double       ratio;  ///< resample ratio, 1.0 when not resampling
+    int          level;  ///< fill of the message queue of the stream in percent
+    unsigned int flags;
+    Stream       stream;
+  };
+
+  class CTotals
+  {
+  public:
+    unsigned int frames;        ///< video pictures output
+    unsigned int dropped;
+    unsigned int late;
+    unsigned int packets;       ///< audio packets checked against the clock
+    unsigned int discontinuities;
+    unsigned int corrections;   ///< audio packets skipped or duplicated
+    double       maxError;      ///< largest absolute video error, in DVD_TIME_BASE
+    double       maxDecode;     ///< longest video decode, in DVD_TIME_BASE
+  };
+
+  static const unsigned int SAMPLES_MAX = 4096;
+
+  CDVDPlayerTelemetry();
+
+  /*!
+   \brief Forget the samples and totals, playback starts over
+   */
+  void Reset();
+
+  void Add(Stream stream, double pts, double error, double decode, unsigned int flags, double ratio = 1.0, int level = 0);
+
+  /*!
+   \brief Get the last samples, oldest first
+   \param samples filled with the samples
+   \param limit the number of samples to get, 0 for all kept
+   */
+  void GetSamples(std::vector<CSample> &samples, unsigned int limit = 0) const;
+  CTotals GetTotals() const;
+
+  /*!
+   \brief Write the samples kept to a CSV file, times in ms
+   */
+  bool DumpCSV(const CStdString &path) const;
+
+  static const char *GetStreamName(Stream stream);
+
+private:
+  mutable CCriticalSection m_critSection;
+  std::vector<CSample>     m_samples;
+  unsigned int             m_next;  ///< where the next sample goes
+  unsigned int             m_count; ///< samples kept, up to SAMPLES_MAX
+  int64_t                  m_start; ///< host counter when playback started
+  CTotals                  m_totals;
+};
+
+extern CDVDPlayerTelemetry g_dvdPlayerTelemetry;
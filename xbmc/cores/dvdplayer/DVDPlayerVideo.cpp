@@ -38,6 +38,7 @@
 #include "../../Util.h"
 #include "DVDOverlayRenderer.h"
 #include "DVDPerformanceCounter.h"
+#include "DVDPlayerTelemetry.h"
 #include "DVDCodecs/DVDCodecs.h"
 #include "DVDCodecs/Overlay/DVDOverlayCodecCC.h"
 #include "DVDCodecs/Overlay/DVDOverlaySSA.h"
@@ -46,6 +47,7 @@
 #include <numeric>
 #include <iterator>
 #include "utils/log.h"
+#include "utils/TimeUtils.h"
 
 using namespace std;
 
@@ -230,6 +232,8 @@ void CDVDPlayerVideo::OpenStream(CDVDStreamInfo &hint, CDVDVideoCodec* codec)
   m_iDroppedRequest = 0;
   m_iLateFrames = 0;
   m_autosync = 1;
+  m_decodeTime = 0.0;
+  m_clockError = 0.0;
 
   if( m_fFrameRate > 100 || m_fFrameRate < 5 )
   {
@@ -524,7 +528,9 @@ void CDVDPlayerVideo::Process()
 
       mFilters = m_pVideoCodec->SetFilters(mFilters);
 
+      int64_t decodeStart = CurrentHostCounter();
       int iDecoderState = m_pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+      m_decodeTime = (double)(CurrentHostCounter() - decodeStart) * DVD_TIME_BASE / CurrentHostFrequency();
 
       // buffer packets so we can recover should decoder flush for some reason
       if(m_pVideoCodec->GetConvergeCount() > 0)
@@ -676,6 +682,17 @@ void CDVDPlayerVideo::Process()
             CDVDCodecUtils::FreePicture(pTempYUVPackedPicture);
 #endif
 
+            unsigned int flags = 0;
+            if (iResult & EOS_DROPPED)
+              flags |= CDVDPlayerTelemetry::FLAG_DROPPED;
+            if ((iResult & EOS_VERYLATE) == EOS_VERYLATE)
+              flags |= CDVDPlayerTelemetry::FLAG_LATE;
+            if (picture.iRepeatPicture)
+              flags |= CDVDPlayerTelemetry::FLAG_REPEATED;
+            if (!(iResult & EOS_ABORT))
+              g_dvdPlayerTelemetry.Add(CDVDPlayerTelemetry::STREAM_VIDEO, pts, m_clockError, m_decodeTime, flags, 1.0, m_messageQueue.GetLevel());
+            m_decodeTime = 0.0; // the other pictures of the packet took no decoding
+
             if(m_started == false)
             {
               m_codecname = m_pVideoCodec->GetName();
@@ -972,6 +989,10 @@ int CDVDPlayerVideo::OutputPicture(const DVDVideoPicture* src, double pts)
   DVDVideoPicture picture(*src);
   DVDVideoPicture* pPicture = &picture;
 
+  // known before anything may drop the picture, so dropped pictures carry their error too.
+  // It's refined below once the pts is corrected for pulldown and display latency.
+  m_clockError = pts + m_iVideoDelay - m_pClock->GetClock(false);
+
 #ifdef HAS_VIDEO_PLAYBACK
   double config_framerate = m_bFpsInvalid ? 0.0 : m_fFrameRate;
   /* check so that our format or aspect has changed. if it has, reconfigure renderer */
@@ -1173,6 +1194,7 @@ int CDVDPlayerVideo::OutputPicture(const DVDVideoPicture* src, double pts)
 
   iPlayingClock = m_pClock->GetClock(iCurrentClock, false); // snapshot current clock
   iClockSleep = pts - iPlayingClock; //sleep calculated by pts to clock comparison
+  m_clockError = iClockSleep;
   iFrameSleep = m_FlipTimeStamp - iCurrentClock; // sleep calculated by duration of frame
   iFrameDuration = pPicture->iDuration;
 
@@ -175,6 +175,9 @@ protected:
   double m_droptime;
   double m_dropbase;
 
+  double m_decodeTime; ///< time the last packet took to decode, for CDVDPlayerTelemetry
+  double m_clockError; ///< pts less the clock of the last picture output
+
   bool m_stalled;
   bool m_started;
   std::string m_codecname;
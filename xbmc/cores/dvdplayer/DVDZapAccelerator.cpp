@@ -0,0 +1,214 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DVDZapAccelerator.h"
+#include "DVDInputStreams/DVDInputStream.h"
+#include "DVDDemuxers/DVDDemux.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/JobManager.h"
+#include "utils/log.h"
+#include <algorithm>
+
+using namespace std;
+
+// streams that weren't read for this long are reopened, live servers tend to drop them
+#define ZAP_MAX_AGE 30000
+
+// upper bounds of the histogram buckets in ms, the last one takes the rest
+static const unsigned int g_zapBuckets[] = { 250, 500, 1000, 2000, 4000 };
+#define ZAP_BUCKETS (sizeof(g_zapBuckets) / sizeof(g_zapBuckets[0]) + 1)
+
+static CCriticalSection g_zapTimesSection;
+static unsigned int     g_zapTimes[2][ZAP_BUCKETS];
+
+CDVDZapOpenJob::CDVDZapOpenJob(const CStdString &url)
+  : m_url(url), m_input(NULL), m_demuxer(NULL)
+{
+}
+
+CDVDZapOpenJob::~CDVDZapOpenJob()
+{
+  delete m_demuxer;
+  delete m_input;
+}
+
+CDVDZapAccelerator::CDVDZapAccelerator()
+{
+}
+
+CDVDZapAccelerator::~CDVDZapAccelerator()
+{
+  Clear();
+}
+
+bool CDVDZapAccelerator::IsReady(const CPipeline &pipeline)
+{
+  return !pipeline.running && XbmcThreads::SystemClockMillis() - pipeline.opened < ZAP_MAX_AGE;
+}
+
+void CDVDZapAccelerator::Close(CPipeline &pipeline)
+{
+  if (pipeline.running)
+  {
+    // still opening, the job closes the streams itself
+    CJobManager::GetInstance().CancelJob(pipeline.jobID);
+    return;
+  }
+  delete pipeline.demuxer;
+  delete pipeline.input;
+  pipeline.demuxer = NULL;
+  pipeline.input   = NULL;
+}
+
+void CDVDZapAccelerator::Update(const ChannelURLs &wanted)
+{
+  CSingleLock lock(m_section);
+  for (vector<CPipeline>::iterator it = m_pipelines.begin(); it != m_pipelines.end(); )
+  {
+    bool keep = (it->running || IsReady(*it))
+             && find(wanted.begin(), wanted.end(), make_pair(it->channelId, it->url)) != wanted.end();
+    if (keep)
+    {
+      ++it;
+      continue;
+    }
+    Close(*it);
+    it = m_pipelines.erase(it);
+  }
+
+  for (ChannelURLs::const_iterator it = wanted.begin(); it != wanted.end(); ++it)
+  {
+    bool open = false;
+    for (vector<CPipeline>::iterator p = m_pipelines.begin(); p != m_pipelines.end() && !open; ++p)
+      open = p->channelId == it->first;
+    if (open)
+      continue;
+
+    CPipeline pipeline;
+    pipeline.channelId = it->first;
+    pipeline.url       = it->second;
+    pipeline.running   = true;
+    pipeline.opened    = 0;
+    pipeline.input     = NULL;
+    pipeline.demuxer   = NULL;
+    pipeline.jobID     = CJobManager::GetInstance().AddJob(CreateOpenJob(it->second), this, CJob::PRIORITY_NORMAL);
+    m_pipelines.push_back(pipeline);
+  }
+}
+
+bool CDVDZapAccelerator::Take(int channelId, CStdString &url, CDVDInputStream *&input, CDVDDemux *&demuxer)
+{
+  CSingleLock lock(m_section);
+  for (vector<CPipeline>::iterator it = m_pipelines.begin(); it != m_pipelines.end(); ++it)
+  {
+    if (it->channelId != channelId)
+      continue;
+
+    bool ready = IsReady(*it);
+    if (ready)
+    {
+      url     = it->url;
+      input   = it->input;
+      demuxer = it->demuxer;
+    }
+    else
+      Close(*it);
+    m_pipelines.erase(it);
+    return ready;
+  }
+  return false;
+}
+
+bool CDVDZapAccelerator::IsReady(int channelId)
+{
+  CSingleLock lock(m_section);
+  for (vector<CPipeline>::const_iterator it = m_pipelines.begin(); it != m_pipelines.end(); ++it)
+  {
+    if (it->channelId == channelId)
+      return IsReady(*it);
+  }
+  return false;
+}
+
+void CDVDZapAccelerator::Clear()
+{
+  CSingleLock lock(m_section);
+  for (vector<CPipeline>::iterator it = m_pipelines.begin(); it != m_pipelines.end(); ++it)
+    Close(*it);
+  m_pipelines.clear();
+}
+
+void CDVDZapAccelerator::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CSingleLock lock(m_section);
+  for (vector<CPipeline>::iterator it = m_pipelines.begin(); it != m_pipelines.end(); ++it)
+  {
+    if (it->jobID != jobID)
+      continue;
+
+    if (success)
+    {
+      CDVDZapOpenJob *open = (CDVDZapOpenJob *)job;
+      it->input   = open->m_input;
+      it->demuxer = open->m_demuxer;
+      it->running = false;
+      it->opened  = XbmcThreads::SystemClockMillis();
+      open->m_input   = NULL;
+      open->m_demuxer = NULL;
+    }
+    else // the next update tries again
+      m_pipelines.erase(it);
+    return;
+  }
+}
+
+void CDVDZapAccelerator::AddZapTime(unsigned int ms, bool warm)
+{
+  unsigned int bucket = 0;
+  while (bucket < ZAP_BUCKETS - 1 && ms >= g_zapBuckets[bucket])
+    bucket++;
+
+  CSingleLock lock(g_zapTimesSection);
+  g_zapTimes[warm ? 1 : 0][bucket]++;
+  CLog::Log(LOGDEBUG, "%s - switched channel in %u ms%s", __FUNCTION__, ms, warm ? " (opened in advance)" : "");
+}
+
+void CDVDZapAccelerator::LogZapTimes()
+{
+  CSingleLock lock(g_zapTimesSection);
+  for (int warm = 0; warm < 2; warm++)
+  {
+    CStdString line, bucket;
+    unsigned int total = 0;
+    for (unsigned int i = 0; i < ZAP_BUCKETS; i++)
+    {
+      if (i < ZAP_BUCKETS - 1)
+        bucket.Format(" <%ums: %u", g_zapBuckets[i], g_zapTimes[warm][i]);
+      else
+        bucket.Format(" more: %u", g_zapTimes[warm][i]);
+      line += bucket;
+      total += g_zapTimes[warm][i];
+    }
+    if (total)
+      CLog::Log(LOGDEBUG, "%s - %s channel switches:%s", __FUNCTION__, warm ? "warm" : "cold", line.c_str());
+  }
+}
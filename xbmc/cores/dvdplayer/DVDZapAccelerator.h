@@ -0,0 +1,134 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "threads/CriticalSection.h"
+#include "utils/Job.h"
+#include "utils/StdString.h"
+#include <utility>
+#include <vector>
+
+class CDVDInputStream;
+class CDVDDemux;
+
+/*!
+ \brief Opens the input stream and demuxer of a channel in the background
+
+ DoWork() fills in m_input and m_demuxer, see CDVDZapStreamOpenJob.
+ */
+class CDVDZapOpenJob : public CJob
+{
+public:
+  CDVDZapOpenJob(const CStdString &url);
+  virtual ~CDVDZapOpenJob();
+
+  virtual const char *GetType() const { return "zapopen"; }
+
+  CStdString       m_url;
+  CDVDInputStream *m_input;
+  CDVDDemux       *m_demuxer;
+};
+
+/*!
+ \brief Opens the channels next to the playing one in advance, to switch to them faster.
+
+ Only channels with a stream URL of their own are opened ahead. Channels that
+ stream through their PVR client share the single live stream of the client,
+ which can't be tuned to another channel while playing. The player reads the
+ channels with a stream URL itself, and takes the streams opened here when it
+ switches to one of them. The number of neighbours opened is set by
+ <pvr><zapprefetch> in advancedsettings.xml, none by default as each keeps a
+ stream of the backend open.
+
+ Also keeps the histogram of how long channel switches took. Opening the
+ streams is left to CreateOpenJob(), the player uses CDVDZapStreamAccelerator.
+ */
+class CDVDZapAccelerator : public IJobCallback
+{
+public:
+  typedef std::vector< std::pair<int, CStdString> > ChannelURLs; ///< channel ids and their stream URLs
+
+  CDVDZapAccelerator();
+  virtual ~CDVDZapAccelerator();
+
+  /*!
+   \brief Open the channels wanted, and drop the streams of any other channel
+   \param wanted the neighbours of the playing channel
+   */
+  void Update(const ChannelURLs &wanted);
+
+  /*!
+   \brief Take the streams opened for a channel
+   \param channelId the id of the channel switched to
+   \param url set to the stream URL of the channel
+   \param input set to the opened input stream, owned by the caller after
+   \param demuxer set to the demuxer opened on input, owned by the caller after
+   \return true if the channel was opened in advance and is ready
+   */
+  bool Take(int channelId, CStdString &url, CDVDInputStream *&input, CDVDDemux *&demuxer);
+
+  /*!
+   \brief Whether the streams of a channel are opened and ready to be taken
+   */
+  bool IsReady(int channelId);
+
+  /*!
+   \brief Close all streams opened in advance
+   */
+  void Clear();
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+  /*!
+   \brief Count a channel switch in the histogram
+   \param ms the time from the switch request until the new channel played
+   \param warm whether the channel was opened in advance
+   */
+  static void AddZapTime(unsigned int ms, bool warm);
+
+  /*!
+   \brief Log the histogram of channel switch times
+   */
+  static void LogZapTimes();
+
+protected:
+  virtual CDVDZapOpenJob *CreateOpenJob(const CStdString &url) = 0;
+
+private:
+  class CPipeline
+  {
+  public:
+    int              channelId;
+    CStdString       url;
+    unsigned int     jobID;
+    bool             running; ///< while the job opens the streams
+    unsigned int     opened;  ///< when the job completed
+    CDVDInputStream *input;
+    CDVDDemux       *demuxer;
+  };
+
+  static bool IsReady(const CPipeline &pipeline);
+  static void Close(CPipeline &pipeline);
+
+  CCriticalSection       m_section;
+  std::vector<CPipeline> m_pipelines;
+};
@@ -0,0 +1,64 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "DVDZapStreamOpener.h"
+#include "DVDInputStreams/DVDFactoryInputStream.h"
+#include "DVDInputStreams/DVDInputStream.h"
+#include "DVDDemuxers/DVDFactoryDemuxer.h"
+#include "DVDDemuxers/DVDDemux.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+CDVDZapStreamOpenJob::CDVDZapStreamOpenJob(IDVDPlayer *player, const CStdString &url)
+  : CDVDZapOpenJob(url), m_player(player)
+{
+}
+
+bool CDVDZapStreamOpenJob::DoWork()
+{
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  m_input = CDVDFactoryInputStream::CreateInputStream(m_player, m_url, "");
+  if (!m_input || !m_input->Open(m_url.c_str(), ""))
+  {
+    CLog::Log(LOGDEBUG, "%s - unable to open %s", __FUNCTION__, m_url.c_str());
+    return false;
+  }
+
+  m_demuxer = CDVDFactoryDemuxer::CreateDemuxer(m_input);
+  if (!m_demuxer)
+  {
+    CLog::Log(LOGDEBUG, "%s - unable to open demuxer for %s", __FUNCTION__, m_url.c_str());
+    return false;
+  }
+  CLog::Log(LOGDEBUG, "%s - opened %s in %u ms", __FUNCTION__, m_url.c_str(), XbmcThreads::SystemClockMillis() - start);
+  return true;
+}
+
+CDVDZapStreamAccelerator::CDVDZapStreamAccelerator(IDVDPlayer *player)
+{
+  m_player = player;
+}
+
+CDVDZapOpenJob *CDVDZapStreamAccelerator::CreateOpenJob(const CStdString &url)
+{
+  return new CDVDZapStreamOpenJob(m_player, url);
+}
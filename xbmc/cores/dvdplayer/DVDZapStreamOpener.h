@@ -0,0 +1,58 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DVDZapAccelerator.h"
+
+class IDVDPlayer;
+
+/*!
+ \brief Opens the input stream and demuxer of a channel through the factories
+ */
+class CDVDZapStreamOpenJob : public CDVDZapOpenJob
+{
+public:
+  CDVDZapStreamOpenJob(IDVDPlayer *player, const CStdString &url);
+
+  virtual bool DoWork();
+
+private:
+  IDVDPlayer *m_player;
+};
+
+/*!
+ \brief The zap accelerator of the player, opening channels with CDVDZapStreamOpenJob
+
+ Kept apart from CDVDZapAccelerator so that its bookkeeping builds without
+ every input stream and demuxer.
+ */
+class CDVDZapStreamAccelerator : public CDVDZapAccelerator
+{
+public:
+  CDVDZapStreamAccelerator(IDVDPlayer *player);
+
+protected:
+  virtual CDVDZapOpenJob *CreateOpenJob(const CStdString &url);
+
+private:
+  IDVDPlayer *m_player;
+};
@@ -0,0 +1,131 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DVDZapAccelerator.h"
+#include "DVDDemuxers/DVDDemux.h"
+#include "threads/Atomics.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "utils/log.h"
+#include "linux/XTimeUtils.h"
+
+#include <boost/test/unit_test.hpp>
+#include <stdarg.h>
+#include <sched.h>
+
+// only the bookkeeping of the accelerator and the job manager are linked into the test
+void CLog::Log(int loglevel, const char *format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  vprintf(format, va);
+  va_end(va);
+  printf("\n");
+}
+
+void WINAPI Sleep(DWORD dwMilliSeconds)
+{
+  if (dwMilliSeconds == 0)
+    sched_yield();
+  else
+    XbmcThreads::ThreadSleep(dwMilliSeconds);
+}
+
+namespace
+{
+  class TestDemux : public CDVDDemux
+  {
+  public:
+    virtual void Reset() {}
+    virtual void Abort() {}
+    virtual void Flush() {}
+    virtual DemuxPacket* Read() { return NULL; }
+    virtual bool SeekTime(int time, bool backwords = false, double* startpts = NULL) { return false; }
+    virtual void SetSpeed(int iSpeed) {}
+    virtual int GetStreamLength() { return 0; }
+    virtual CDemuxStream* GetStream(int iStreamId) { return NULL; }
+    virtual int GetNrOfStreams() { return 0; }
+    virtual std::string GetFileName() { return ""; }
+  };
+
+  // opens a demuxer without reading anything, the input stream stays NULL
+  class TestOpenJob : public CDVDZapOpenJob
+  {
+  public:
+    TestOpenJob(const CStdString &url) : CDVDZapOpenJob(url) {}
+    virtual bool DoWork()
+    {
+      m_demuxer = new TestDemux;
+      return true;
+    }
+  };
+
+  class TestAccelerator : public CDVDZapAccelerator
+  {
+  public:
+    TestAccelerator() : m_opened(0) {}
+    virtual CDVDZapOpenJob *CreateOpenJob(const CStdString &url)
+    {
+      AtomicIncrement(&m_opened);
+      return new TestOpenJob(url);
+    }
+    bool WaitReady(int channelId, unsigned int timeout)
+    {
+      unsigned int start = XbmcThreads::SystemClockMillis();
+      while (!IsReady(channelId) && XbmcThreads::SystemClockMillis() - start < timeout)
+        XbmcThreads::ThreadSleep(1);
+      return IsReady(channelId);
+    }
+    volatile long m_opened;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(TestZapWarmSwitch)
+{
+  TestAccelerator accelerator;
+  CDVDZapAccelerator::ChannelURLs wanted;
+  wanted.push_back(std::make_pair(2, CStdString("udp://239.0.0.2:1234")));
+  wanted.push_back(std::make_pair(3, CStdString("udp://239.0.0.3:1234")));
+  accelerator.Update(wanted);
+  BOOST_REQUIRE(accelerator.WaitReady(2, 5000));
+  BOOST_REQUIRE(accelerator.WaitReady(3, 5000));
+
+  // switching to a neighbour takes the demuxer opened in advance
+  CStdString url;
+  CDVDInputStream *input = NULL;
+  CDVDDemux *demuxer = NULL;
+  BOOST_REQUIRE(accelerator.Take(2, url, input, demuxer));
+  BOOST_CHECK(url == "udp://239.0.0.2:1234");
+  BOOST_CHECK(dynamic_cast<TestDemux*>(demuxer) != NULL);
+  delete demuxer;
+
+  // once taken it's gone, and a channel not opened in advance is switched to cold
+  demuxer = NULL;
+  BOOST_CHECK(!accelerator.Take(2, url, input, demuxer));
+  BOOST_CHECK(!accelerator.Take(4, url, input, demuxer));
+  BOOST_CHECK(demuxer == NULL);
+
+  // the neighbour still wanted stays open without being opened again
+  wanted.erase(wanted.begin());
+  accelerator.Update(wanted);
+  BOOST_CHECK(accelerator.IsReady(3));
+  BOOST_CHECK_EQUAL(accelerator.m_opened, 2);
+}
@@ -31,6 +31,8 @@
 #include "utils/URIUtils.h"
 #include "mysqldataset.h"
 #include "sqlitedataset.h"
+#include <set>
+#include <algorithm>
 
 
 using namespace AUTOPTR;
@@ -131,6 +133,31 @@ std::string CDatabase::GetSingleValue(const std::string &query, std::auto_ptr<Da
   return ret;
 }
 
+bool CDatabase::GetRandomIDs(const CStdString &strTable, const CStdString &strColumn, const CStdString &strWhereClause, unsigned int count, std::vector<int> &ids)
+{
+  CStdString query;
+  query.Format("SELECT COUNT(1) FROM %s %s", strTable.c_str(), strWhereClause.c_str());
+  std::string total = GetSingleValue(query, m_pDS);
+  if (total.empty())
+    return false;
+
+  // distinct offsets, built from two calls as RAND_MAX may be as low as 32767
+  unsigned int rows = (unsigned int)atoi(total.c_str());
+  std::set<unsigned int> offsets;
+  while (offsets.size() < std::min(count, rows))
+    offsets.insert(((unsigned int)rand() * ((unsigned int)RAND_MAX + 1) + (unsigned int)rand()) % rows);
+
+  for (std::set<unsigned int>::const_iterator it = offsets.begin(); it != offsets.end(); ++it)
+  {
+    query.Format("SELECT %s FROM %s %s ORDER BY %s LIMIT 1 OFFSET %u", strColumn.c_str(), strTable.c_str(),
+                 strWhereClause.c_str(), strColumn.c_str(), *it);
+    std::string id = GetSingleValue(query, m_pDS);
+    if (!id.empty())
+      ids.push_back(atoi(id.c_str()));
+  }
+  return true;
+}
+
 CStdString CDatabase::GetSingleValue(const CStdString &strTable, const CStdString &strColumn, const CStdString &strWhereClause /* = CStdString() */, const CStdString &strOrderBy /* = CStdString() */)
 {
   CStdString query = PrepareSQL("SELECT %s FROM %s", strColumn.c_str(), strTable.c_str());
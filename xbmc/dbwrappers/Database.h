@@ -29,6 +29,7 @@ namespace dbiplus {
 }
 
 #include <memory>
+#include <vector>
 
 class DatabaseSettings; // forward
 
@@ -70,6 +71,18 @@ public:
    */
   std::string GetSingleValue(const std::string &query, std::auto_ptr<dbiplus::Dataset> &ds);
 
+  /*! \brief Pick rows of a table or view at random.
+   Counts the matching rows once, then reads the id at a random offset for each pick,
+   so the database walks its index rather than handing every matching id to us.
+   \param strTable the table or view to pick from.
+   \param strColumn the id column, also used to order the rows.
+   \param strWhereClause where clause including the WHERE keyword, may be empty. Has to be FormatSQL'ed.
+   \param count the number of rows to pick.
+   \param ids [out] the ids picked, fewer than count if fewer rows match.
+   \return true if the rows could be counted, false otherwise.
+   */
+  bool GetRandomIDs(const CStdString &strTable, const CStdString &strColumn, const CStdString &strWhereClause, unsigned int count, std::vector<int> &ids);
+
   /*!
    * @brief Delete values from a table.
    * @remarks The value of the strWhereClause parameter has to be FormatSQL'ed when used.
@@ -25,67 +25,77 @@
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
+#include "music/tags/MusicInfoTag.h"
+#include "video/VideoInfoTag.h"
+#include "pictures/PictureInfoTag.h"
 #include "climits"
 
 using namespace std;
 using namespace XFILE;
 
+// memory the cached listings may use, except those that are always cached
+#define DIRECTORY_CACHE_BUDGET (16 * 1024 * 1024)
+
 CDirectoryCache::CDir::CDir(DIR_CACHE_TYPE cacheType)
 {
   m_cacheType = cacheType;
-  m_lastAccess = 0;
-  m_Items = new CFileItemList;
-  m_Items->SetFastLookup(true);
+  m_size = 0;
 }
 
 CDirectoryCache::CDir::~CDir()
 {
-  delete m_Items;
-}
-
-void CDirectoryCache::CDir::SetLastAccess(unsigned int &accessCounter)
-{
-  m_lastAccess = accessCounter++;
 }
 
 CDirectoryCache::CDirectoryCache(void)
 {
   m_iThumbCacheRefCount = 0;
   m_iMusicThumbCacheRefCount = 0;
-  m_accessCounter = 0;
-#ifdef _DEBUG
+  m_size = 0;
   m_cacheHits = 0;
   m_cacheMisses = 0;
-#endif
+  m_evictions = 0;
+  m_bytesCopied = 0;
 }
 
 CDirectoryCache::~CDirectoryCache(void)
 {
+  for (iCache i = m_cache.begin(); i != m_cache.end(); ++i)
+    delete i->second;
 }
 
 bool CDirectoryCache::GetDirectory(const CStdString& strPath, CFileItemList &items, bool retrieveAll)
 {
-  CSingleLock lock (m_cs);
+  boost::shared_ptr<const CFileItemList> cached;
+  {
+    CSingleLock lock (m_cs);
 
-  CStdString storedPath = URIUtils::SubstitutePath(strPath);
-  URIUtils::RemoveSlashAtEnd(storedPath);
+    CStdString storedPath = URIUtils::SubstitutePath(strPath);
+    URIUtils::RemoveSlashAtEnd(storedPath);
 
-  ciCache i = m_cache.find(storedPath);
-  if (i != m_cache.end())
-  {
-    CDir* dir = i->second;
-    if (dir->m_cacheType == XFILE::DIR_CACHE_ALWAYS ||
-       (dir->m_cacheType == XFILE::DIR_CACHE_ONCE && retrieveAll))
+    ciCache i = m_cache.find(storedPath);
+    if (i != m_cache.end())
     {
-      items.Copy(*dir->m_Items);
-      dir->SetLastAccess(m_accessCounter);
-#ifdef _DEBUG
-      m_cacheHits+=items.Size();
-#endif
-      return true;
+      CDir* dir = i->second;
+      if (dir->m_cacheType == XFILE::DIR_CACHE_ALWAYS ||
+         (dir->m_cacheType == XFILE::DIR_CACHE_ONCE && retrieveAll))
+      {
+        cached = dir->m_Items;
+        Touch(dir);
+        m_cacheHits++;
+        m_bytesCopied += dir->m_size;
+      }
+    }
+
+    if (!cached)
+    {
+      m_cacheMisses++;
+      return false;
     }
   }
-  return false;
+
+  // the listing won't change while we hold on to it, so others can go on using the cache
+  items.Copy(*cached);
+  return true;
 }
 
 void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType)
@@ -104,6 +114,13 @@ void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemLis
   // IDEALLY, any further processing on the item would actually create a new item
   // instead of altering it, but we can't really enforce that in an easy way, so
   // this is the best solution for now.
+  // The copy is made before taking the lock, and it's never altered once cached,
+  // so copies are only ever made from, never into, cached listings.
+  CFileItemList *copy = new CFileItemList;
+  copy->SetFastLookup(true);
+  copy->Copy(items);
+  unsigned int size = EstimateSize(*copy);
+
   CSingleLock lock (m_cs);
 
   CStdString storedPath = URIUtils::SubstitutePath(strPath);
@@ -111,11 +128,13 @@ void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemLis
 
   ClearDirectory(storedPath);
 
-  CheckIfFull();
+  CheckIfFull(size);
 
   CDir* dir = new CDir(cacheType);
-  dir->m_Items->Copy(items);
-  dir->SetLastAccess(m_accessCounter);
+  dir->m_Items.reset(copy);
+  dir->m_size = size;
+  dir->m_lru = m_lru.insert(m_lru.begin(), storedPath);
+  m_size += size;
   m_cache.insert(pair<CStdString, CDir*>(storedPath, dir));
 }
 
@@ -167,43 +186,55 @@ void CDirectoryCache::AddFile(const CStdString& strFile)
   ciCache i = m_cache.find(strPath);
   if (i != m_cache.end())
   {
+    // copy on write: readers may still be copying the old listing. The items
+    // themselves are never altered once cached, so the new listing can share them.
     CDir *dir = i->second;
+    CFileItemList *items = new CFileItemList;
+    items->SetFastLookup(true);
+    items->Assign(*dir->m_Items);
     CFileItemPtr item(new CFileItem(strFile, false));
-    dir->m_Items->Add(item);
-    dir->SetLastAccess(m_accessCounter);
+    items->Add(item);
+
+    unsigned int size = EstimateSize(*items);
+    m_size += size - dir->m_size;
+    dir->m_size = size;
+    dir->m_Items.reset(items);
+    Touch(dir);
   }
 }
 
 bool CDirectoryCache::FileExists(const CStdString& strFile, bool& bInCache)
 {
-  CSingleLock lock (m_cs);
+  boost::shared_ptr<const CFileItemList> cached;
   bInCache = false;
 
   CStdString strPath;
   URIUtils::GetDirectory(strFile, strPath);
   URIUtils::RemoveSlashAtEnd(strPath);
 
-  ciCache i = m_cache.find(strPath);
-  if (i != m_cache.end())
   {
-    bInCache = true;
+    CSingleLock lock (m_cs);
+    ciCache i = m_cache.find(strPath);
+    if (i == m_cache.end())
+    {
+      m_cacheMisses++;
+      return false;
+    }
+
     CDir *dir = i->second;
-    dir->SetLastAccess(m_accessCounter);
-#ifdef _DEBUG
+    cached = dir->m_Items;
+    Touch(dir);
     m_cacheHits++;
-#endif
-    return dir->m_Items->Contains(strFile);
   }
-#ifdef _DEBUG
-  m_cacheMisses++;
-#endif
-  return false;
-}
 
+  bInCache = true;
+  return cached->Contains(strFile);
+}
 void CDirectoryCache::Clear()
 {
   // this routine clears everything except things we always cache
   CSingleLock lock (m_cs);
+  PrintStats();
 
   iCache i = m_cache.begin();
   while (i != m_cache.end() )
@@ -331,42 +362,63 @@ void CDirectoryCache::ClearMusicThumbCache()
   ClearCache(m_musicThumbDirs);
 }
 
-void CDirectoryCache::CheckIfFull()
+void CDirectoryCache::Touch(CDir *dir)
+{
+  m_lru.splice(m_lru.begin(), m_lru, dir->m_lru);
+}
+
+unsigned int CDirectoryCache::EstimateSize(const CFileItemList &items)
+{
+  // a rough estimate, mostly concerned with the parts growing with the size of the listing
+  unsigned int size = sizeof(CFileItemList);
+  for (int i = 0; i < items.Size(); i++)
+  {
+    const CFileItemPtr item = items[i];
+    size += sizeof(CFileItem) + item->GetPath().size() + item->GetLabel().size() + item->GetLabel2().size();
+    if (item->HasVideoInfoTag())
+      size += sizeof(CVideoInfoTag) + item->GetVideoInfoTag()->m_strPlot.size();
+    if (item->HasMusicInfoTag())
+      size += sizeof(MUSIC_INFO::CMusicInfoTag);
+    if (item->HasPictureInfoTag())
+      size += sizeof(CPictureInfoTag);
+  }
+  return size;
+}
+
+void CDirectoryCache::CheckIfFull(unsigned int size)
 {
   CSingleLock lock (m_cs);
-  static const unsigned int max_cached_dirs = 10;
 
-  // find the last accessed folder, and remove if the number of cached folders is too many
-  iCache lastAccessed = m_cache.end();
-  unsigned int numCached = 0;
-  for (iCache i = m_cache.begin(); i != m_cache.end(); i++)
+  // drop the least recently used folders until the new one fits in
+  list<CStdString>::iterator it = m_lru.end();
+  while (m_size + size > DIRECTORY_CACHE_BUDGET && it != m_lru.begin())
   {
+    iCache i = m_cache.find(*--it);
     // ensure dirs that are always cached aren't cleared
-    if (!IsCacheDir(i->first) && i->second->m_cacheType != DIR_CACHE_ALWAYS)
-    {
-      if (lastAccessed == m_cache.end() || i->second->GetLastAccess() < lastAccessed->second->GetLastAccess())
-        lastAccessed = i;
-      numCached++;
-    }
+    if (i == m_cache.end() || IsCacheDir(i->first) || i->second->m_cacheType == DIR_CACHE_ALWAYS)
+      continue;
+
+    // Delete() removes the folder from the lru list, go on from the one after it
+    ++it;
+    Delete(i);
+    m_evictions++;
   }
-  if (lastAccessed != m_cache.end() && numCached >= max_cached_dirs)
-    Delete(lastAccessed);
 }
 
 void CDirectoryCache::Delete(iCache it)
 {
   CDir* dir = it->second;
+  m_size -= dir->m_size;
+  m_lru.erase(dir->m_lru);
   delete dir;
   m_cache.erase(it);
 }
 
-#ifdef _DEBUG
 void CDirectoryCache::PrintStats() const
 {
   CSingleLock lock (m_cs);
-  CLog::Log(LOGDEBUG, "%s - total of %u cache hits, and %u cache misses", __FUNCTION__, m_cacheHits, m_cacheMisses);
-  // run through and find the oldest and the number of items cached
-  unsigned int oldest = UINT_MAX;
+  CLog::Log(LOGDEBUG, "%s - total of %u cache hits, and %u cache misses, %"PRIu64" bytes copied out", __FUNCTION__, m_cacheHits, m_cacheMisses, m_bytesCopied);
+  // run through and find the number of items cached
   unsigned int numItems = 0;
   unsigned int numDirs = 0;
   for (ciCache i = m_cache.begin(); i != m_cache.end(); i++)
@@ -374,11 +426,9 @@ void CDirectoryCache::PrintStats() const
     if (!IsCacheDir(i->first))
     {
       CDir *dir = i->second;
-      oldest = min(oldest, dir->GetLastAccess());
       numItems += dir->m_Items->Size();
       numDirs++;
     }
   }
-  CLog::Log(LOGDEBUG, "%s - %u folders cached, with %u items total.  Oldest is %u, current is %u", __FUNCTION__, numDirs, numItems, oldest, m_accessCounter);
+  CLog::Log(LOGDEBUG, "%s - %u folders cached, with %u items total, using %u of %u bytes, %u folders evicted", __FUNCTION__, numDirs, numItems, m_size, DIRECTORY_CACHE_BUDGET, m_evictions);
 }
-#endif
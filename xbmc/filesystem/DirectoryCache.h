@@ -24,8 +24,10 @@
 #include "Directory.h"
 #include "threads/CriticalSection.h"
 
+#include <list>
 #include <map>
 #include <set>
+#include <boost/shared_ptr.hpp>
 
 class CFileItem;
 
@@ -39,13 +41,13 @@ namespace XFILE
       CDir(DIR_CACHE_TYPE cacheType);
       virtual ~CDir();
 
-      void SetLastAccess(unsigned int &accessCounter);
-      unsigned int GetLastAccess() const { return m_lastAccess; };
-
-      CFileItemList* m_Items;
+      /*! \brief listing as cached, never changed once set but replaced as a whole.
+       Readers hold on to it while copying it out of the cache, so this is done without the cache lock.
+       */
+      boost::shared_ptr<const CFileItemList> m_Items;
       DIR_CACHE_TYPE m_cacheType;
-    private:
-      unsigned int m_lastAccess;
+      unsigned int m_size;                     ///< estimated memory used by the listing
+      std::list<CStdString>::iterator m_lru;   ///< position in the lru list
     };
   public:
     CDirectoryCache(void);
@@ -55,6 +57,7 @@ namespace XFILE
     void ClearDirectory(const CStdString& strPath);
     void ClearFile(const CStdString& strFile);
     void ClearSubPaths(const CStdString& strPath);
+    /*! \brief Drop all listings but the always cached ones, logging the cache statistics first */
     void Clear();
     void AddFile(const CStdString& strFile);
     bool FileExists(const CStdString& strPath, bool& bInCache);
@@ -62,14 +65,14 @@ namespace XFILE
     void ClearThumbCache();
     void InitMusicThumbCache();
     void ClearMusicThumbCache();
-#ifdef _DEBUG
     void PrintStats() const;
-#endif
   protected:
     void InitCache(std::set<CStdString>& dirs);
     void ClearCache(std::set<CStdString>& dirs);
     bool IsCacheDir(const CStdString &strPath) const;
-    void CheckIfFull();
+    void CheckIfFull(unsigned int size);
+    void Touch(CDir *dir);
+    static unsigned int EstimateSize(const CFileItemList &items);
 
     std::map<CStdString, CDir*> m_cache;
     typedef std::map<CStdString, CDir*>::iterator iCache;
@@ -82,12 +85,13 @@ namespace XFILE
     int m_iThumbCacheRefCount;
     int m_iMusicThumbCacheRefCount;
 
-    unsigned int m_accessCounter;
+    std::list<CStdString> m_lru;    ///< cached paths, most recently used first
+    unsigned int m_size;            ///< estimated memory used by all cached listings
 
-#ifdef _DEBUG
     unsigned int m_cacheHits;
     unsigned int m_cacheMisses;
-#endif
+    unsigned int m_evictions;
+    uint64_t     m_bytesCopied;     ///< estimated bytes copied out of the cache
   };
 }
 extern XFILE::CDirectoryCache g_directoryCache;
@@ -39,6 +39,7 @@
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
 #include "Application.h"
+#include "settings/AdvancedSettings.h"
 
 using namespace XFILE;
 using namespace std;
@@ -46,6 +47,10 @@ using namespace ADDON;
 
 vector<CPluginDirectory *> CPluginDirectory::globalHandles;
 CCriticalSection CPluginDirectory::m_handleLock;
+map<CStdString, CPluginDirectory::CachedResult> CPluginDirectory::m_results;
+CCriticalSection CPluginDirectory::m_resultLock;
+
+#define MAX_CACHED_RESULTS 16
 
 CPluginDirectory::CPluginDirectory()
 {
@@ -394,14 +399,75 @@ bool CPluginDirectory::GetDirectory(const CStdString& strPath, CFileItemList& it
 {
   CURL url(strPath);
 
+  if (GetCachedResult(strPath, items))
+    return true;
+
   bool success = StartScript(strPath, true);
 
+  // the plugin tells us whether its listing may be cached
+  if (success && m_listItems->CacheToDiscIfSlow())
+    SetCachedResult(strPath, *m_listItems);
+
   // append the items to the list
   items.Assign(*m_listItems, true); // true to keep the current items
   m_listItems->Clear();
   return success;
 }
 
+bool CPluginDirectory::GetCachedResult(const CStdString &strPath, CFileItemList &items)
+{
+  boost::shared_ptr<CFileItemList> cached;
+  {
+    CSingleLock lock(m_resultLock);
+    map<CStdString, CachedResult>::iterator it = m_results.find(strPath);
+    if (it == m_results.end())
+      return false;
+    if ((int)(it->second.expires - XbmcThreads::SystemClockMillis()) <= 0)
+    {
+      m_results.erase(it);
+      return false;
+    }
+    cached = it->second.items;
+  }
+
+  CLog::Log(LOGDEBUG, "%s - using the kept listing of %s", __FUNCTION__, strPath.c_str());
+  CFileItemList copy;
+  copy.Copy(*cached);
+  items.Assign(copy, true); // true to keep the current items
+  return true;
+}
+
+void CPluginDirectory::SetCachedResult(const CStdString &strPath, const CFileItemList &items)
+{
+  if (g_advancedSettings.m_pluginResultCacheTime <= 0)
+    return;
+
+  boost::shared_ptr<CFileItemList> cached(new CFileItemList);
+  cached->Copy(items);
+
+  CSingleLock lock(m_resultLock);
+  if (m_results.size() >= MAX_CACHED_RESULTS && m_results.find(strPath) == m_results.end())
+  { // drop the listing that expires first
+    map<CStdString, CachedResult>::iterator first = m_results.begin();
+    for (map<CStdString, CachedResult>::iterator it = m_results.begin(); it != m_results.end(); ++it)
+    {
+      if ((int)(it->second.expires - first->second.expires) < 0)
+        first = it;
+    }
+    m_results.erase(first);
+  }
+
+  CachedResult &result = m_results[strPath];
+  result.items   = cached;
+  result.expires = XbmcThreads::SystemClockMillis() + g_advancedSettings.m_pluginResultCacheTime * 1000;
+}
+
+void CPluginDirectory::ClearCachedResult(const CStdString &strPath)
+{
+  CSingleLock lock(m_resultLock);
+  m_results.erase(strPath);
+}
+
 bool CPluginDirectory::RunScriptWithParams(const CStdString& strPath)
 {
   CURL url(strPath);
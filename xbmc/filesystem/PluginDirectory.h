@@ -32,6 +32,8 @@
 #include "PlatformDefs.h"
 
 #include "threads/Event.h"
+#include <map>
+#include "boost/shared_ptr.hpp"
 
 class CURL;
 class CFileItemList;
@@ -62,6 +64,11 @@ public:
   static void SetResolvedUrl(int handle, bool success, const CFileItem* resultItem);
   static void SetLabel2(int handle, const CStdString& ident);  
 
+  /*! \brief Forget the kept listing of a plugin path, so the plugin is run again for it
+   \sa GetDirectory
+   */
+  static void ClearCachedResult(const CStdString &strPath);
+
 private:
   ADDON::AddonPtr m_addon;
   bool StartScript(const CStdString& strPath, bool retrievingDir);
@@ -72,6 +79,17 @@ private:
   static void removeHandle(int handle);
   static CCriticalSection m_handleLock;
 
+  // listings the plugins allowed to cache, by path
+  struct CachedResult
+  {
+    boost::shared_ptr<CFileItemList> items;
+    unsigned int expires;
+  };
+  static bool GetCachedResult(const CStdString &strPath, CFileItemList &items);
+  static void SetCachedResult(const CStdString &strPath, const CFileItemList &items);
+  static std::map<CStdString, CachedResult> m_results;
+  static CCriticalSection m_resultLock;
+
   CFileItemList* m_listItems;
   CFileItem*     m_fileResult;
   CEvent         m_fetchComplete;
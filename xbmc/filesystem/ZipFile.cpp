@@ -22,6 +22,7 @@
 #include "ZipFile.h"
 #include "URL.h"
 #include "utils/URIUtils.h"
+#include "utils/TimeUtils.h"
 
 #include <sys/stat.h>
 
@@ -37,6 +38,9 @@ CZipFile::CZipFile()
   m_iDataInStringBuffer = 0;
   m_bCached = false;
   m_iRead = -1;
+  m_iSeeks = 0;
+  m_iSeekInflated = 0;
+  m_iSeekTime = 0;
 }
 
 CZipFile::~CZipFile()
@@ -83,6 +87,8 @@ bool CZipFile::Open(const CURL&url)
     CLog::Log(LOGERROR,"FileZip: unable to open zip file %s!",url.GetHostName().c_str());
     return false;
   }
+  m_strArchive = url.GetHostName();
+  m_seekIndex.reset();
   mFile.Seek(mZipItem.offset,SEEK_SET);
   return InitDecompress();
 }
@@ -165,77 +171,104 @@ int64_t CZipFile::Seek(int64_t iFilePosition, int iWhence)
 
     }
   }
-  // here goes the stupid part..
+  // deflated data can't be entered at an arbitrary position, inflate from
+  // the nearest saved inflate state before the target instead
   if (mZipItem.method == 8)
   {
-    char temp[131072];
     switch (iWhence)
     {
     case SEEK_SET:
-      if (iFilePosition == m_iFilePos)
-        return m_iFilePos; // mp3reader does this lots-of-times
-      if (iFilePosition > mZipItem.usize || iFilePosition < 0)
-        return -1;
-      // read until position in 128k blocks.. only way to do it due to format.
-      // can't start in the middle of data since then we'd have no clue where
-      // we are in uncompressed data..
-      if (iFilePosition < m_iFilePos)
-      {
-        m_iFilePos = 0;
-        m_iZipFilePos = 0;
-        inflateEnd(&m_ZStream);
-        inflateInit2(&m_ZStream,-MAX_WBITS); // simply restart zlib
-        mFile.Seek(mZipItem.offset,SEEK_SET);
-        m_ZStream.next_in = (Bytef*)m_szBuffer;
-        m_ZStream.avail_in = 0;
-        m_ZStream.total_out = 0;
-        while (m_iFilePos < iFilePosition)
-        {
-          unsigned int iToRead = (iFilePosition-m_iFilePos)>131072?131072:(int)(iFilePosition-m_iFilePos);
-          if (Read(temp,iToRead) != iToRead)
-            return -1;
-        }
-        return m_iFilePos;
-      }
-      else // seek forward
-        return Seek(iFilePosition-m_iFilePos,SEEK_CUR);
       break;
-
     case SEEK_CUR:
-      if (iFilePosition < 0)
-        return Seek(m_iFilePos+iFilePosition,SEEK_SET); // can't rewind stream
-      // read until requested position, drop data
-      if (m_iFilePos+iFilePosition > mZipItem.usize)
-        return -1;
       iFilePosition += m_iFilePos;
-      while (m_iFilePos < iFilePosition)
-      {
-        unsigned int iToRead = (iFilePosition-m_iFilePos)>131072?131072:(int)(iFilePosition-m_iFilePos);
-        if (Read(temp,iToRead) != iToRead)
-          return -1;
-      }
-      return m_iFilePos;
       break;
-
     case SEEK_END:
-      // now this is a nasty bastard, possibly takes lotsoftime
-      // uncompress, minding m_ZStream.total_out
-
-      while( (int)m_ZStream.total_out < mZipItem.usize+iFilePosition)
-      {
-        unsigned int iToRead = (mZipItem.usize+iFilePosition-m_ZStream.total_out > 131072)?131072:(int)(mZipItem.usize+iFilePosition-m_ZStream.total_out);
-        if (Read(temp,iToRead) != iToRead)
-          return -1;
-      }
-      return m_iFilePos;
+      iFilePosition += mZipItem.usize;
       break;
     default:
       return -1;
     }
+    if (iFilePosition == m_iFilePos)
+      return m_iFilePos; // mp3reader does this lots-of-times
+    if (iFilePosition > mZipItem.usize || iFilePosition < 0)
+      return -1;
+
+    int64_t start = CurrentHostCounter();
+    m_iSeeks++;
+
+    // short skips forward are cheaper than looking up the index
+    const CZipSeekIndex::Point *point = NULL;
+    if (iFilePosition < m_iFilePos || iFilePosition - m_iFilePos > ZIP_SEEK_MIN_INTERVAL)
+    {
+      if (!m_seekIndex)
+        m_seekIndex = g_ZipManager.GetSeekIndex(m_strArchive, mZipItem);
+      if (m_seekIndex)
+        point = m_seekIndex->Find(iFilePosition);
+      if (point && iFilePosition > m_iFilePos && point->uoffset <= m_iFilePos)
+        point = NULL;
+    }
+
+    if (point)
+    {
+      if (!RestorePoint(*point))
+        return -1;
+    }
+    else if (iFilePosition < m_iFilePos)
+    {
+      m_iFilePos = 0;
+      m_iZipFilePos = 0;
+      m_bFlush = false;
+      inflateEnd(&m_ZStream);
+      inflateInit2(&m_ZStream,-MAX_WBITS); // simply restart zlib
+      mFile.Seek(mZipItem.offset,SEEK_SET);
+      m_ZStream.next_in = (Bytef*)m_szBuffer;
+      m_ZStream.avail_in = 0;
+      m_ZStream.total_out = 0;
+    }
+
+    // read until position in 128k blocks and drop the data
+    char temp[131072];
+    m_iSeekInflated += iFilePosition - m_iFilePos;
+    while (m_iFilePos < iFilePosition)
+    {
+      unsigned int iToRead = (iFilePosition-m_iFilePos)>131072?131072:(int)(iFilePosition-m_iFilePos);
+      if (Read(temp,iToRead) != iToRead)
+        return -1;
+    }
+    m_iSeekTime += CurrentHostCounter() - start;
+    return m_iFilePos;
   }
   return -1;
 }
 
+bool CZipFile::RestorePoint(const CZipSeekIndex::Point& point)
+{
+  inflateEnd(&m_ZStream);
+  if (inflateInit2(&m_ZStream,-MAX_WBITS) != Z_OK)
+    return false;
+
+  // a point may start in the middle of a byte, feed zlib the bits it still needs
+  int64_t iZipFilePos = point.coffset - (point.bits ? 1 : 0);
+  if (mFile.Seek(mZipItem.offset+iZipFilePos,SEEK_SET) != mZipItem.offset+iZipFilePos)
+    return false;
+  m_ZStream.next_in = (Bytef*)m_szBuffer;
+  m_ZStream.avail_in = 0;
+  m_ZStream.total_out = 0;
+  m_iZipFilePos = iZipFilePos;
+  if (point.bits)
+  {
+    unsigned char partial;
+    if (mFile.Read(&partial,1) != 1)
+      return false;
+    m_iZipFilePos++;
+    inflatePrime(&m_ZStream,point.bits,partial >> (8-point.bits));
+  }
+  inflateSetDictionary(&m_ZStream,point.window,ZIP_SEEK_WINDOW);
+  m_iFilePos = point.uoffset;
+  m_bFlush = false;
+  return true;
+}
+
 bool CZipFile::Exists(const CURL& url)
 {
   SZipEntry item;
@@ -350,6 +383,13 @@ unsigned int CZipFile::Read(void* lpBuf, int64_t uiBufSize)
 
 void CZipFile::Close()
 {
+  if (m_iSeeks)
+    CLog::Log(LOGDEBUG,"FileZip: %u seeks in %s, inflated %"PRId64" kB to get there in %.1f ms",
+              m_iSeeks, mZipItem.name, m_iSeekInflated / 1024, m_iSeekTime * 1000.0 / CurrentHostFrequency());
+  m_iSeeks = 0;
+  m_iSeekInflated = 0;
+  m_iSeekTime = 0;
+
   if (mZipItem.method == 8 && !m_bCached && m_iRead != -1)
     inflateEnd(&m_ZStream);
 
@@ -50,6 +50,7 @@ namespace XFILE
     int UnpackFromMemory(std::string& strDest, const std::string& strInput, bool isGZ=false);
   private:
     bool InitDecompress();
+    bool RestorePoint(const CZipSeekIndex::Point& point);
     bool FillBuffer();
     void DestroyBuffer(void* lpBuffer, int iBufSize);
     CFile mFile;
@@ -65,6 +66,11 @@ namespace XFILE
     int m_iRead;
     bool m_bFlush;
     bool m_bCached;
+    CStdString m_strArchive;
+    CZipSeekIndexPtr m_seekIndex;
+    unsigned int m_iSeeks;      // seeks in deflated data since open
+    int64_t m_iSeekInflated;    // bytes inflated and dropped by those seeks
+    int64_t m_iSeekTime;
   };
 }
 
@@ -28,12 +28,20 @@
 #include "utils/EndianSwap.h"
 #include "utils/URIUtils.h"
 #include "SpecialProtocol.h"
+#include "threads/SingleLock.h"
+#include "utils/TimeUtils.h"
+#include <zlib.h>
+#include <algorithm>
 
 
 #ifndef min
 #define min(a,b)            (((a) < (b)) ? (a) : (b))
 #endif
 
+// at most 32 points per entry and 16MB of seek indexes overall
+#define ZIP_SEEK_MAX_POINTS 32
+#define ZIP_SEEK_INDEX_MEMORY 16*1024*1024
+
 using namespace XFILE;
 using namespace std;
 
@@ -41,6 +49,7 @@ CZipManager g_ZipManager;
 
 CZipManager::CZipManager()
 {
+  m_seekIndexMemory = 0;
 }
 
 CZipManager::~CZipManager()
@@ -76,6 +85,7 @@ bool CZipManager::GetZipList(const CStdString& strPath, vector<SZipEntry>& items
       }
       mZipMap.erase(it);
       mZipDate.erase(it2);
+      ReleaseSeekIndexes(strFile);
   }
 
   CFile mFile;
@@ -324,6 +334,156 @@ void CZipManager::release(const CStdString& strPath)
     mZipMap.erase(it);
     mZipDate.erase(it2);
   }
+  ReleaseSeekIndexes(url.GetHostName());
+}
+
+CZipSeekIndexPtr CZipManager::GetSeekIndex(const CStdString& strArchive, const SZipEntry& item)
+{
+  if (item.method != 8 || item.usize < 2 * ZIP_SEEK_MIN_INTERVAL)
+    return CZipSeekIndexPtr();
+
+  {
+    CSingleLock lock(m_seekIndexSection);
+    for (list<SeekIndexEntry>::iterator it = m_seekIndexes.begin(); it != m_seekIndexes.end(); ++it)
+    {
+      if (it->crc32 == item.crc32 && it->name == item.name && it->archive == strArchive)
+      {
+        m_seekIndexes.splice(m_seekIndexes.begin(), m_seekIndexes, it);
+        return it->index;
+      }
+    }
+  }
+
+  // build without holding the lock, it decompresses the whole entry
+  unsigned int interval = std::max((unsigned int)ZIP_SEEK_MIN_INTERVAL, item.usize / ZIP_SEEK_MAX_POINTS);
+  int64_t start = CurrentHostCounter();
+  CZipSeekIndexPtr index = CZipSeekIndex::Build(strArchive, item, interval);
+  if (!index)
+    return index;
+  CLog::Log(LOGDEBUG, "%s - indexed %s in %s, %u kB every %u kB, in %.1f ms", __FUNCTION__,
+            item.name, strArchive.c_str(), index->GetMemoryUsage() / 1024, interval / 1024,
+            (CurrentHostCounter() - start) * 1000.0 / CurrentHostFrequency());
+
+  CSingleLock lock(m_seekIndexSection);
+  SeekIndexEntry entry;
+  entry.archive = strArchive;
+  entry.name = item.name;
+  entry.crc32 = item.crc32;
+  entry.index = index;
+  m_seekIndexes.push_front(entry);
+  m_seekIndexMemory += index->GetMemoryUsage();
+
+  // drop the least recently used, files still reading from them keep their copy
+  while (m_seekIndexMemory > ZIP_SEEK_INDEX_MEMORY && m_seekIndexes.size() > 1)
+  {
+    m_seekIndexMemory -= m_seekIndexes.back().index->GetMemoryUsage();
+    m_seekIndexes.pop_back();
+  }
+  return index;
+}
+
+void CZipManager::ReleaseSeekIndexes(const CStdString& strArchive)
+{
+  CSingleLock lock(m_seekIndexSection);
+  for (list<SeekIndexEntry>::iterator it = m_seekIndexes.begin(); it != m_seekIndexes.end(); )
+  {
+    if (it->archive == strArchive)
+    {
+      m_seekIndexMemory -= it->index->GetMemoryUsage();
+      it = m_seekIndexes.erase(it);
+    }
+    else
+      ++it;
+  }
+}
+
+CZipSeekIndexPtr CZipSeekIndex::Build(const CStdString& archive, const SZipEntry& entry, unsigned int interval)
+{
+  CFile file;
+  if (entry.method != 8 || !file.Open(archive) || file.Seek(entry.offset, SEEK_SET) != entry.offset)
+    return CZipSeekIndexPtr();
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+    return CZipSeekIndexPtr();
+
+  CZipSeekIndexPtr index(new CZipSeekIndex);
+  index->m_interval = interval;
+  index->m_points.reserve(entry.usize / interval + 1);
+
+  // inflate a block at a time into a circular window, a point can only be
+  // placed where a deflate block starts
+  vector<unsigned char> input(65536);
+  vector<unsigned char> window(ZIP_SEEK_WINDOW);
+  int64_t fed = 0, totalIn = 0, totalOut = 0, last = 0;
+  int ret = Z_OK;
+  stream.avail_out = 0;
+  while (ret != Z_STREAM_END)
+  {
+    unsigned int toRead = (unsigned int)min((int64_t)input.size(), (int64_t)entry.csize - fed);
+    if (toRead == 0 || file.Read(&input[0], toRead) != toRead)
+      break;
+    fed += toRead;
+    stream.next_in = &input[0];
+    stream.avail_in = toRead;
+    do
+    {
+      if (stream.avail_out == 0)
+      {
+        stream.next_out = &window[0];
+        stream.avail_out = ZIP_SEEK_WINDOW;
+      }
+      totalIn += stream.avail_in;
+      totalOut += stream.avail_out;
+      ret = inflate(&stream, Z_BLOCK);
+      totalIn -= stream.avail_in;
+      totalOut -= stream.avail_out;
+      if (ret != Z_OK && ret != Z_BUF_ERROR && ret != Z_STREAM_END)
+        break;
+      if (ret == Z_STREAM_END)
+        break;
+
+      // end of a block header and not the last block
+      if ((stream.data_type & 128) && !(stream.data_type & 64) && totalOut - last >= interval)
+      {
+        index->m_points.resize(index->m_points.size() + 1);
+        Point &point = index->m_points.back();
+        point.uoffset = totalOut;
+        point.coffset = totalIn;
+        point.bits = stream.data_type & 7;
+        unsigned int left = stream.avail_out;
+        if (left)
+          memcpy(point.window, &window[ZIP_SEEK_WINDOW - left], left);
+        if (left < ZIP_SEEK_WINDOW)
+          memcpy(point.window + left, &window[0], ZIP_SEEK_WINDOW - left);
+        last = totalOut;
+      }
+    } while (stream.avail_in != 0);
+    if (ret != Z_OK && ret != Z_BUF_ERROR && ret != Z_STREAM_END)
+      break;
+  }
+  inflateEnd(&stream);
+
+  if (ret != Z_STREAM_END)
+  {
+    CLog::Log(LOGERROR, "%s - unable to inflate %s in %s", __FUNCTION__, entry.name, archive.c_str());
+    return CZipSeekIndexPtr();
+  }
+  return index;
+}
+
+static bool PointBefore(int64_t offset, const CZipSeekIndex::Point &point)
+{
+  return offset < point.uoffset;
+}
+
+const CZipSeekIndex::Point* CZipSeekIndex::Find(int64_t offset) const
+{
+  vector<Point>::const_iterator it = upper_bound(m_points.begin(), m_points.end(), offset, PointBefore);
+  if (it == m_points.begin())
+    return NULL;
+  return &*(--it);
 }
 
 
@@ -31,10 +31,16 @@
 #define ECDREC_SIZE 22
 
 #include  "utils/StdString.h"
+#include "threads/CriticalSection.h"
+#include "boost/shared_ptr.hpp"
 
 #include <memory.h>
 #include <vector>
 #include <map>
+#include <list>
+
+#define ZIP_SEEK_WINDOW 32768
+#define ZIP_SEEK_MIN_INTERVAL 262144
 
 struct SZipEntry {
   unsigned int header;
@@ -95,6 +101,49 @@ struct SZipEntry {
   }
 };
 
+/*!
+ \brief Inflate states saved at intervals of a deflated zip entry
+
+ Each point holds what zlib needs to resume inflating in the middle of the
+ entry: where it is in the compressed and uncompressed data, the bits of a
+ partly used byte and the last 32k of output. Seeking then only has to
+ decompress from the nearest point before the target.
+ */
+class CZipSeekIndex
+{
+public:
+  struct Point
+  {
+    int64_t uoffset; ///< offset in the uncompressed data
+    int64_t coffset; ///< offset in the compressed data of the first byte not fully used
+    int bits;        ///< bits of the byte before coffset that are still to be used
+    unsigned char window[ZIP_SEEK_WINDOW];
+  };
+
+  /*!
+   \brief Decompress an entry once and save the inflate state every interval bytes
+   \param archive path of the zip file
+   \param entry the deflated entry
+   \param interval bytes of uncompressed data between points
+   \return the index, empty on failure
+   */
+  static boost::shared_ptr<CZipSeekIndex> Build(const CStdString& archive, const SZipEntry& entry, unsigned int interval);
+
+  /*! \brief The last point at or before the given offset, NULL if there is none */
+  const Point* Find(int64_t offset) const;
+
+  unsigned int GetInterval() const { return m_interval; }
+  unsigned int GetMemoryUsage() const { return m_points.size() * sizeof(Point); }
+
+private:
+  CZipSeekIndex() : m_interval(0) {}
+
+  std::vector<Point> m_points;
+  unsigned int m_interval;
+};
+
+typedef boost::shared_ptr<CZipSeekIndex> CZipSeekIndexPtr;
+
 class CZipManager
 {
 public:
@@ -106,11 +155,32 @@ public:
   bool ExtractArchive(const CStdString& strArchive, const CStdString& strPath);
   void CleanUp(const CStdString& strArchive, const CStdString& strPath); // deletes extracted archive. use with care!
   void release(const CStdString& strPath); // release resources used by list zip
+
+  /*!
+   \brief Seek index of a deflated entry, built on first use and kept for later opens
+   \param strArchive path of the zip file
+   \param item the entry
+   \return the index, empty if the entry isn't worth indexing or it couldn't be built
+   */
+  CZipSeekIndexPtr GetSeekIndex(const CStdString& strArchive, const SZipEntry& item);
   static void readHeader(const char* buffer, SZipEntry& info);
   static void readCHeader(const char* buffer, SZipEntry& info);
 private:
   std::map<CStdString,std::vector<SZipEntry> > mZipMap;
   std::map<CStdString,int64_t> mZipDate;
+
+  void ReleaseSeekIndexes(const CStdString& strArchive);
+
+  struct SeekIndexEntry
+  {
+    CStdString archive;
+    CStdString name;
+    unsigned int crc32;
+    CZipSeekIndexPtr index;
+  };
+  std::list<SeekIndexEntry> m_seekIndexes; // most recently used first
+  unsigned int m_seekIndexMemory;
+  CCriticalSection m_seekIndexSection;
 };
 
 extern CZipManager g_ZipManager;
@@ -63,6 +63,8 @@ CGUIBaseContainer::CGUIBaseContainer(int parentID, int controlID, float posX, fl
 
 CGUIBaseContainer::~CGUIBaseContainer(void)
 {
+  m_layoutPool.Clear();
+  m_focusedLayoutPool.Clear();
 }
 
 void CGUIBaseContainer::DoProcess(unsigned int currentTime, CDirtyRegionList &dirtyregions)
@@ -83,6 +85,9 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
 
   if (!m_layout || !m_focusedLayout) return;
 
+  m_layoutPool.NewFrame();
+  m_focusedLayoutPool.NewFrame();
+
   UpdateScrollOffset(currentTime);
 
   int offset = (int)floorf(m_scroller.GetValue() / m_layout->Size(m_orientation));
@@ -145,7 +150,7 @@ void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItem *item,
   {
     if (!item->GetFocusedLayout())
     {
-      CGUIListItemLayout *layout = new CGUIListItemLayout(*m_focusedLayout);
+      CGUIListItemLayout *layout = m_focusedLayoutPool.Get(m_focusedLayout);
       item->SetFocusedLayout(layout);
     }
     if (item->GetFocusedLayout())
@@ -172,7 +177,7 @@ void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItem *item,
       item->GetFocusedLayout()->SetFocusedItem(0);  // focus is not set
     if (!item->GetLayout())
     {
-      CGUIListItemLayout *layout = new CGUIListItemLayout(*m_layout);
+      CGUIListItemLayout *layout = m_layoutPool.Get(m_layout);
       item->SetLayout(layout);
     }
     if (item->GetFocusedLayout())
@@ -771,6 +776,15 @@ void CGUIBaseContainer::AllocResources()
 void CGUIBaseContainer::FreeResources(bool immediately)
 {
   CGUIControl::FreeResources(immediately);
+  if (m_layoutPool.GetCopied() || m_focusedLayoutPool.GetCopied())
+    CLog::Log(LOGDEBUG, "%s - control %i: %u layouts copied, %u reused, at most %u copied in a frame", __FUNCTION__, GetID(),
+              m_layoutPool.GetCopied() + m_focusedLayoutPool.GetCopied(),
+              m_layoutPool.GetReused() + m_focusedLayoutPool.GetReused(),
+              std::max(m_layoutPool.GetPeakCopiedPerFrame(), m_focusedLayoutPool.GetPeakCopiedPerFrame()));
+  m_layoutPool.ResetStats();
+  m_focusedLayoutPool.ResetStats();
+  m_layoutPool.Clear();
+  m_focusedLayoutPool.Clear();
   if (m_staticContent)
   { // free any static content
     Reset();
@@ -784,6 +798,8 @@ void CGUIBaseContainer::UpdateLayout(bool updateAllItems)
   { // free memory of items
     for (iItems it = m_items.begin(); it != m_items.end(); it++)
       (*it)->FreeMemory();
+    m_layoutPool.Clear();
+    m_focusedLayoutPool.Clear();
   }
   // and recalculate the layout
   CalculateLayout();
@@ -1042,17 +1058,27 @@ void CGUIBaseContainer::FreeMemory(int keepStart, int keepEnd)
   if (keepStart < keepEnd)
   { // remove before keepStart and after keepEnd
     for (int i = 0; i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      RecycleLayouts(m_items[i].get());
     for (int i = std::max(keepEnd + 1, 0); i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      RecycleLayouts(m_items[i].get());
   }
   else
   { // wrapping
     for (int i = std::max(keepEnd + 1, 0); i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      RecycleLayouts(m_items[i].get());
   }
 }
 
+void CGUIBaseContainer::RecycleLayouts(CGUIListItem *item)
+{
+  // enough for the items scrolling in while a page scrolls out
+  unsigned int maxSize = 2 * std::max(m_itemsPerPage, 1) + 2;
+  if (item->GetLayout())
+    m_layoutPool.Put(item->ReleaseLayout(), m_layout, maxSize);
+  if (item->GetFocusedLayout())
+    m_focusedLayoutPool.Put(item->ReleaseFocusedLayout(), m_focusedLayout, 2);
+}
+
 bool CGUIBaseContainer::InsideLayout(const CGUIListItemLayout *layout, const CPoint &point) const
 {
   if (!layout) return false;
@@ -129,6 +129,7 @@ protected:
   inline float Size() const;
   void MoveToRow(int row);
   void FreeMemory(int keepStart, int keepEnd);
+  void RecycleLayouts(CGUIListItem *item);
   void GetCurrentLayouts();
   CGUIListItemLayout *GetFocusedLayout() const;
 
@@ -152,6 +153,9 @@ protected:
   CGUIListItemLayout *m_layout;
   CGUIListItemLayout *m_focusedLayout;
 
+  CGUIListItemLayoutPool m_layoutPool;        ///< layouts of items scrolled out of view
+  CGUIListItemLayoutPool m_focusedLayoutPool;
+
   void ScrollToOffset(int offset);
   void SetContainerMoving(int direction);
   void UpdateScrollOffset(unsigned int currentTime);
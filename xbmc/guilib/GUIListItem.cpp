@@ -24,6 +24,9 @@
 #include "utils/Archive.h"
 #include "utils/CharsetConverter.h"
 #include "utils/Variant.h"
+#include "utils/MemoryUsage.h"
+#include "utils/StringPool.h"
+#include <algorithm>
 
 using namespace std;
 
@@ -336,6 +339,20 @@ CGUIListItemLayout *CGUIListItem::GetFocusedLayout()
   return m_focusedLayout;
 }
 
+CGUIListItemLayout *CGUIListItem::ReleaseLayout()
+{
+  CGUIListItemLayout *layout = m_layout;
+  m_layout = NULL;
+  return layout;
+}
+
+CGUIListItemLayout *CGUIListItem::ReleaseFocusedLayout()
+{
+  CGUIListItemLayout *layout = m_focusedLayout;
+  m_focusedLayout = NULL;
+  return layout;
+}
+
 void CGUIListItem::SetInvalid()
 {
   if (m_layout) m_layout->SetInvalid();
@@ -396,3 +413,70 @@ void CGUIListItem::AppendProperties(const CGUIListItem &item)
   for (PropertyMap::const_iterator i = item.m_mapProperties.begin(); i != item.m_mapProperties.end(); ++i)
     SetProperty(i->first, i->second);
 }
+
+void CGUIListItem::GetMemoryUsage(CMemoryUsage &usage, size_t &propertyBytes) const
+{
+  usage.Add(m_strLabel);
+  usage.Add(m_strLabel2);
+  usage.Add(m_strThumbnailImage);
+  usage.Add(m_strIcon);
+  usage.Add((m_sortLabel.capacity() + 1) * sizeof(wchar_t));
+
+  size_t start = usage.GetBytes();
+  usage.Add(m_mapProperties.capacity() * sizeof(PropertyMap::value_type));
+  for (PropertyMap::const_iterator it = m_mapProperties.begin(); it != m_mapProperties.end(); ++it)
+  {
+    usage.Add(it->first);
+    if (it->second.isString())
+      usage.Add(it->second.asString().size() + 1);
+  }
+  propertyBytes += usage.GetBytes() - start;
+}
+
+namespace
+{
+  struct PropertyLess
+  {
+    bool operator()(const std::pair<CStdString, CVariant> &property, const CStdString &key) const
+    {
+      return property.first.CompareNoCase(key) < 0;
+    }
+  };
+}
+
+CGUIListItem::PropertyMap::iterator CGUIListItem::PropertyMap::find(const CStdString &key)
+{
+  iterator it = std::lower_bound(m_properties.begin(), m_properties.end(), key, PropertyLess());
+  if (it != m_properties.end() && it->first.CompareNoCase(key) == 0)
+    return it;
+  return m_properties.end();
+}
+
+CGUIListItem::PropertyMap::const_iterator CGUIListItem::PropertyMap::find(const CStdString &key) const
+{
+  const_iterator it = std::lower_bound(m_properties.begin(), m_properties.end(), key, PropertyLess());
+  if (it != m_properties.end() && it->first.CompareNoCase(key) == 0)
+    return it;
+  return m_properties.end();
+}
+
+CVariant &CGUIListItem::PropertyMap::operator[](const CStdString &key)
+{
+  iterator it = std::lower_bound(m_properties.begin(), m_properties.end(), key, PropertyLess());
+  if (it != m_properties.end() && it->first.CompareNoCase(key) == 0)
+    return it->second;
+
+  CStdString name(key);
+  CStringPool::Intern(name);
+  return m_properties.insert(it, value_type(name, CVariant()))->second;
+}
+
+void CGUIListItem::PropertyMap::erase(iterator it)
+{
+  m_properties.erase(it);
+}
+
+void CGUIListItem::PropertyMap::clear()
+{
+  m_properties.clear();
+}
@@ -33,11 +33,13 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 //  Forward
 class CGUIListItemLayout;
 class CArchive;
 class CVariant;
+class CMemoryUsage;
 
 /*!
  \ingroup controls
@@ -110,6 +112,10 @@ public:
   void SetFocusedLayout(CGUIListItemLayout *layout);
   CGUIListItemLayout *GetFocusedLayout();
 
+  /*! \brief Take the layouts away from the item, the caller is responsible for them */
+  CGUIListItemLayout *ReleaseLayout();
+  CGUIListItemLayout *ReleaseFocusedLayout();
+
   void FreeIcons();
   void FreeMemory(bool immediately = false);
   void SetInvalid();
@@ -139,6 +145,12 @@ public:
 
   CVariant   GetProperty(const CStdString &strKey) const;
 
+  /*! \brief Account for the heap memory used by the item
+   \param usage the memory used so far
+   \param propertyBytes increased by the part of it used by properties
+   */
+  void GetMemoryUsage(CMemoryUsage &usage, size_t &propertyBytes) const;
+
 protected:
   CStdString m_strLabel2;     // text of column2
   CStdString m_strThumbnailImage; // filename of thumbnail
@@ -157,7 +169,35 @@ protected:
     }
   };
 
-  typedef std::map<CStdString, CVariant, icompare> PropertyMap;
+  /*! \brief Properties kept sorted by name in a flat array.
+   Items rarely have more than a handful of properties, and large lists have
+   a lot of items, so this beats a map on both memory and lookup time.
+   Names are interned, as every item of a list uses the same ones.
+   */
+  class PropertyMap
+  {
+  public:
+    typedef std::pair<CStdString, CVariant> value_type;
+    typedef std::vector<value_type>::iterator iterator;
+    typedef std::vector<value_type>::const_iterator const_iterator;
+
+    iterator begin() { return m_properties.begin(); }
+    iterator end() { return m_properties.end(); }
+    const_iterator begin() const { return m_properties.begin(); }
+    const_iterator end() const { return m_properties.end(); }
+    size_t size() const { return m_properties.size(); }
+    size_t capacity() const { return m_properties.capacity(); }
+
+    iterator find(const CStdString &key);
+    const_iterator find(const CStdString &key) const;
+    CVariant &operator[](const CStdString &key);
+    void erase(iterator it);
+    void clear();
+
+  private:
+    std::vector<value_type> m_properties;
+  };
+
   PropertyMap m_mapProperties;
 private:
   CStdStringW m_sortLabel;    // text for sorting. Need to be UTF16 for proper sorting
@@ -26,6 +26,7 @@
 #include "GUIListLabel.h"
 #include "GUIImage.h"
 #include "utils/XBMCTinyXML.h"
+#include <algorithm>
 
 using namespace std;
 
@@ -37,6 +38,7 @@ CGUIListItemLayout::CGUIListItemLayout()
   m_condition = 0;
   m_focused = false;
   m_invalidated = true;
+  m_source = NULL;
   m_group.SetPushUpdates(true);
 }
 
@@ -48,6 +50,7 @@ CGUIListItemLayout::CGUIListItemLayout(const CGUIListItemLayout &from)
   m_focused = from.m_focused;
   m_condition = from.m_condition;
   m_invalidated = true;
+  m_source = &from;
 }
 
 CGUIListItemLayout::~CGUIListItemLayout()
@@ -220,6 +223,90 @@ void CGUIListItemLayout::FreeResources(bool immediately)
   m_group.FreeResources(immediately);
 }
 
+void CGUIListItemLayout::Recycle()
+{
+  // textures are released with a delay, so an item scrolling back in right away gets them back
+  m_group.FreeResources(false);
+  m_group.ResetAnimations();
+  m_group.SetFocusedItem(0);
+  m_invalidated = true;
+}
+
+CGUIListItemLayoutPool::CGUIListItemLayoutPool()
+{
+  ResetStats();
+}
+
+CGUIListItemLayoutPool::CGUIListItemLayoutPool(const CGUIListItemLayoutPool &from)
+{
+  // pooled layouts belong to a single container
+  ResetStats();
+}
+
+CGUIListItemLayoutPool::~CGUIListItemLayoutPool()
+{
+  Clear();
+}
+
+CGUIListItemLayout *CGUIListItemLayoutPool::Get(const CGUIListItemLayout *layout)
+{
+  while (!m_layouts.empty())
+  {
+    CGUIListItemLayout *pooled = m_layouts.back();
+    m_layouts.pop_back();
+    if (pooled->IsCopyOf(layout))
+    {
+      m_reused++;
+      return pooled;
+    }
+    delete pooled;
+  }
+
+  m_copied++;
+  m_frameCopied++;
+  return new CGUIListItemLayout(*layout);
+}
+
+void CGUIListItemLayoutPool::Put(CGUIListItemLayout *layout, const CGUIListItemLayout *current, unsigned int maxSize)
+{
+  if (!layout)
+    return;
+
+  if (m_layouts.size() < maxSize && layout->IsCopyOf(current))
+  {
+    layout->Recycle();
+    m_layouts.push_back(layout);
+    return;
+  }
+
+  layout->FreeResources();
+  delete layout;
+}
+
+void CGUIListItemLayoutPool::Clear()
+{
+  for (vector<CGUIListItemLayout *>::iterator it = m_layouts.begin(); it != m_layouts.end(); ++it)
+  {
+    (*it)->FreeResources();
+    delete *it;
+  }
+  m_layouts.clear();
+}
+
+void CGUIListItemLayoutPool::NewFrame()
+{
+  m_peakCopied = std::max(m_peakCopied, m_frameCopied);
+  m_frameCopied = 0;
+}
+
+void CGUIListItemLayoutPool::ResetStats()
+{
+  m_copied = 0;
+  m_reused = 0;
+  m_frameCopied = 0;
+  m_peakCopied = 0;
+}
+
 #ifdef _DEBUG
 void CGUIListItemLayout::DumpTextureUse()
 {
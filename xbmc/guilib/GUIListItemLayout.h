@@ -46,6 +46,12 @@ public:
   void SetInvalid() { m_invalidated = true; };
   void FreeResources(bool immediately = false);
 
+  /*! \brief Whether this layout was copied from the given one */
+  bool IsCopyOf(const CGUIListItemLayout *layout) const { return m_source == layout; };
+
+  /*! \brief Drop the state of the item this layout was used for, so it can be used for another one */
+  void Recycle();
+
 //#ifdef PRE_SKIN_VERSION_9_10_COMPATIBILITY
   void CreateListControlLayouts(float width, float height, bool focused, const CLabelInfo &labelInfo, const CLabelInfo &labelInfo2, const CTextureInfo &texture, const CTextureInfo &textureFocus, float texHeight, float iconWidth, float iconHeight, const CStdString &nofocusCondition, const CStdString &focusCondition);
 //#endif
@@ -73,5 +79,51 @@ protected:
 
   unsigned int m_condition;
   CGUIInfoBool m_isPlaying;
+
+  const CGUIListItemLayout *m_source; ///< the layout this one was copied from, if any
 };
 
+/*!
+ \brief Layouts of items that scrolled out of view, kept for the items that scroll in
+
+ Copying a layout copies its whole control tree, so containers hand the
+ layouts of items they no longer show to the pool, and take them from it
+ rather than copying the container's layout again while scrolling. Only
+ the state of the item a layout was last used for is reset.
+ */
+class CGUIListItemLayoutPool
+{
+public:
+  CGUIListItemLayoutPool();
+  CGUIListItemLayoutPool(const CGUIListItemLayoutPool &from);
+  ~CGUIListItemLayoutPool();
+
+  /*! \brief Get a copy of the given layout for an item, reusing a pooled one if there is one */
+  CGUIListItemLayout *Get(const CGUIListItemLayout *layout);
+
+  /*! \brief Hand back the layout of an item
+   \param layout the layout the item doesn't need anymore
+   \param current the layout the container currently uses, copies of other layouts are deleted
+   \param maxSize the number of layouts to keep at most
+   */
+  void Put(CGUIListItemLayout *layout, const CGUIListItemLayout *current, unsigned int maxSize);
+
+  void Clear();
+
+  /*! \brief Start counting the layouts copied for a new frame */
+  void NewFrame();
+
+  unsigned int GetCopied() const { return m_copied; };
+  unsigned int GetReused() const { return m_reused; };
+  unsigned int GetPeakCopiedPerFrame() const { return m_peakCopied; };
+  void ResetStats();
+
+private:
+  const CGUIListItemLayoutPool &operator=(const CGUIListItemLayoutPool &);
+
+  std::vector<CGUIListItemLayout *> m_layouts;
+  unsigned int m_copied;
+  unsigned int m_reused;
+  unsigned int m_frameCopied;
+  unsigned int m_peakCopied;
+};
@@ -83,6 +83,7 @@ CGUITextureBase::CGUITextureBase(float posX, float posY, float width, float heig
 
   m_allocateDynamically = false;
   m_isAllocated = NO;
+  m_largeWidth = m_largeHeight = 0;
   m_invalid = true;
 }
 
@@ -119,6 +120,7 @@ CGUITextureBase::CGUITextureBase(const CGUITextureBase &right)
   m_currentLoop = 0;
 
   m_isAllocated = NO;
+  m_largeWidth = m_largeHeight = 0;
   m_invalid = true;
 }
 
@@ -313,7 +315,16 @@ bool CGUITextureBase::AllocResources()
     if (m_isAllocated != NORMAL)
     { // use our large image background loader
       CTextureArray texture;
-      if (g_largeTextureManager.GetImage(m_info.filename, texture, !IsAllocated()))
+      if (!IsAllocated())
+      { // the size we're shown at, so a smaller version of the image can be loaded
+        m_largeWidth = m_largeHeight = 0;
+        if (m_width > 0 && m_height > 0)
+        {
+          m_largeWidth  = (unsigned int)(m_width / g_graphicsContext.GetGUIScaleX());
+          m_largeHeight = (unsigned int)(m_height / g_graphicsContext.GetGUIScaleY());
+        }
+      }
+      if (g_largeTextureManager.GetImage(m_info.filename, texture, !IsAllocated(), m_largeWidth, m_largeHeight))
       {
         m_isAllocated = IN_PROGRESS;
 
@@ -457,9 +468,9 @@ bool CGUITextureBase::CalculateSize()
 void CGUITextureBase::FreeResources(bool immediately /* = false */)
 {
   if (m_isAllocated == IN_PROGRESS)
-    g_largeTextureManager.ReleaseQueuedImage(m_info.filename);
+    g_largeTextureManager.ReleaseQueuedImage(m_info.filename, m_largeWidth, m_largeHeight);
   else if (m_isAllocated == LARGE || m_isAllocated == LARGE_FAILED)
-    g_largeTextureManager.ReleaseImage(m_info.filename, immediately || (m_isAllocated == LARGE_FAILED));
+    g_largeTextureManager.ReleaseImage(m_info.filename, immediately || (m_isAllocated == LARGE_FAILED), m_largeWidth, m_largeHeight);
   else if (m_isAllocated == NORMAL && m_texture.size())
     g_TextureManager.ReleaseTexture(m_info.filename);
 
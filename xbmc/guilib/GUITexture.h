@@ -163,6 +163,8 @@ protected:
   bool m_allocateDynamically;
   enum ALLOCATE_TYPE { NO = 0, NORMAL, IN_PROGRESS, LARGE, NORMAL_FAILED, LARGE_FAILED };
   ALLOCATE_TYPE m_isAllocated;
+  unsigned int m_largeWidth;  // size in pixels the large image was requested at, 0 for full size
+  unsigned int m_largeHeight;
 
   CTextureInfo m_info;
   CAspectRatio m_aspect;
@@ -21,6 +21,8 @@
 
 #include "AnnouncementManager.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
 #include <stdio.h>
 #include "utils/log.h"
 #include "utils/Variant.h"
@@ -32,12 +34,51 @@
 
 #define LOOKUP_PROPERTY "database-lookup"
 
+// how long library updates wait for more updates of the same item
+#define ANNOUNCEMENT_MERGE_WINDOW  50
+// beyond this many queued announcements, library announcements are replaced by a single OnChanged
+#define ANNOUNCEMENT_QUEUE_MAX     2000
+// announcers taking longer than this are logged
+#define ANNOUNCEMENT_SLOW_ANNOUNCER 100
+
 using namespace std;
 using namespace ANNOUNCEMENT;
 
 CCriticalSection CAnnouncementManager::m_critSection;
 vector<IAnnouncer *> CAnnouncementManager::m_announcers;
 
+CAnnouncementManager::CDispatcher *CAnnouncementManager::m_dispatcher = NULL;
+deque<CAnnouncementManager::CAnnouncement> CAnnouncementManager::m_queue;
+CCriticalSection CAnnouncementManager::m_queueSection;
+CEvent CAnnouncementManager::m_queueEvent;
+CEvent CAnnouncementManager::m_drainedEvent(true, true);
+bool CAnnouncementManager::m_dispatching = false;
+CAnnouncementManager::CAnnouncement *CAnnouncementManager::m_current = NULL;
+CAnnouncementStats CAnnouncementManager::m_stats;
+
+class CAnnouncementManager::CDispatcher : public CThread
+{
+public:
+  CDispatcher() : CThread("CAnnouncementManager") { }
+
+  void Stop()
+  {
+    m_bStop = true;
+    m_queueEvent.Set();
+    StopThread();
+  }
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      if (!DispatchNext(this))
+        m_queueEvent.WaitMSec(1000);
+    }
+  }
+};
+
 void CAnnouncementManager::AddAnnouncer(IAnnouncer *listener)
 {
   if (!listener)
@@ -58,9 +99,65 @@ void CAnnouncementManager::RemoveAnnouncer(IAnnouncer *listener)
     if (m_announcers[i] == listener)
     {
       m_announcers.erase(m_announcers.begin() + i);
-      return;
+      break;
     }
   }
+
+  CSingleLock queueLock(m_queueSection);
+  m_stats.announcers.erase(listener);
+}
+
+void CAnnouncementManager::Start()
+{
+  CSingleLock lock(m_queueSection);
+  if (m_dispatcher)
+    return;
+
+  m_dispatcher = new CDispatcher();
+  m_dispatcher->Create();
+}
+
+void CAnnouncementManager::Stop()
+{
+  CDispatcher *dispatcher;
+  {
+    CSingleLock lock(m_queueSection);
+    dispatcher = m_dispatcher;
+  }
+  if (!dispatcher)
+    return;
+
+  Flush(5000);
+  dispatcher->Stop();
+
+  // anything announced meanwhile is delivered right here
+  CSingleLock lock(m_queueSection);
+  m_dispatcher = NULL;
+  while (!m_queue.empty())
+  {
+    CAnnouncement announcement = m_queue.front();
+    m_queue.pop_front();
+    lock.Leave();
+    Dispatch(announcement);
+    lock.Enter();
+  }
+  delete dispatcher;
+}
+
+CAnnouncementStats CAnnouncementManager::GetStats()
+{
+  CSingleLock lock(m_queueSection);
+  CAnnouncementStats stats = m_stats;
+  stats.queued = m_queue.size();
+  return stats;
+}
+
+string *CAnnouncementManager::GetSerialized(const CVariant &data, const string &format)
+{
+  CSingleLock lock (m_critSection);
+  if (!m_current || &m_current->data != &data)
+    return NULL;
+  return &m_current->serialized[format];
 }
 
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message)
@@ -72,9 +169,173 @@ void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, c
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message, CVariant &data)
 {
   CLog::Log(LOGDEBUG, "CAnnouncementManager - Announcement: %s from %s", message, sender);
+
+  {
+    CSingleLock lock(m_queueSection);
+    if (m_dispatcher && !m_dispatcher->IsCurrentThread() && flag != System)
+    {
+      Queue(flag, sender, message, data);
+      return;
+    }
+  }
+
+  // keep the order with anything queued before
+  if (flag == System)
+    Flush(1000);
+
+  CAnnouncement announcement;
+  announcement.flag    = flag;
+  announcement.sender  = sender;
+  announcement.message = message;
+  announcement.data    = data;
+  announcement.queued  = XbmcThreads::SystemClockMillis();
+  Dispatch(announcement);
+}
+
+void CAnnouncementManager::Queue(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+{
+  bool library = flag == VideoLibrary || flag == AudioLibrary;
+
+  // updates carry the item, removals are the item
+  CStdString key;
+  const CVariant &item = data.isObject() && data.isMember("item") ? data["item"] : data;
+  if (library && item.isObject() && item.isMember("id") && item.isMember("type"))
+    key.Format("%d:%s:%s:%"PRId64, (int)flag, sender, item["type"].asString().c_str(), item["id"].asInteger());
+
+  // only the latest state of an item is of interest for library updates. They are merged into the
+  // newest announcement of the item only, so an update is never moved ahead of a removal.
+  if (!key.empty() && strcmp(message, "OnUpdate") == 0)
+  {
+    for (deque<CAnnouncement>::reverse_iterator it = m_queue.rbegin(); it != m_queue.rend(); ++it)
+    {
+      if (it->key != key)
+        continue;
+      if (it->message == "OnUpdate")
+      {
+        for (CVariant::const_iterator_map member = data.begin_map(); member != data.end_map(); ++member)
+          it->data[member->first] = member->second;
+        m_stats.merged++;
+        return;
+      }
+      break;
+    }
+  }
+
+  // once full, updates and removals are replaced by a single OnChanged of the library. Being
+  // delivered after the change was made, a queued OnChanged covers all changes until then.
+  bool changed = !key.empty() && m_queue.size() >= ANNOUNCEMENT_QUEUE_MAX;
+  if (changed)
+  {
+    if (m_stats.dropped++ == 0)
+      CLog::Log(LOGWARNING, "CAnnouncementManager - queue is full, announcing library changes at once");
+    for (deque<CAnnouncement>::reverse_iterator it = m_queue.rbegin(); it != m_queue.rend(); ++it)
+    {
+      if (it->flag != flag)
+        continue;
+      if (it->message == "OnChanged" && it->sender == "xbmc")
+        return;
+      break;
+    }
+    sender  = "xbmc";
+    message = "OnChanged";
+    key.clear();
+  }
+
+  m_queue.push_back(CAnnouncement());
+  CAnnouncement &announcement = m_queue.back();
+  announcement.flag    = flag;
+  announcement.sender  = sender;
+  announcement.message = message;
+  announcement.key     = key;
+  if (!changed)
+    announcement.data  = data;
+  announcement.queued  = XbmcThreads::SystemClockMillis();
+
+  if (m_queue.size() > m_stats.maxQueued)
+    m_stats.maxQueued = m_queue.size();
+
+  m_drainedEvent.Reset();
+  m_queueEvent.Set();
+}
+
+bool CAnnouncementManager::DispatchNext(CDispatcher *dispatcher)
+{
+  CSingleLock lock(m_queueSection);
+  if (m_queue.empty())
+  {
+    m_dispatching = false;
+    m_drainedEvent.Set();
+    return false;
+  }
+
+  // give library updates some time to be merged with following ones
+  unsigned int age = XbmcThreads::SystemClockMillis() - m_queue.front().queued;
+  if (m_queue.front().message == "OnUpdate" && !m_queue.front().key.empty() && age < ANNOUNCEMENT_MERGE_WINDOW)
+  {
+    lock.Leave();
+    dispatcher->Sleep(ANNOUNCEMENT_MERGE_WINDOW - age);
+    return true;
+  }
+
+  CAnnouncement announcement = m_queue.front();
+  m_queue.pop_front();
+  m_dispatching = true;
+  lock.Leave();
+
+  Dispatch(announcement);
+  return true;
+}
+
+bool CAnnouncementManager::Flush(unsigned int timeout)
+{
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  while (true)
+  {
+    {
+      CSingleLock lock(m_queueSection);
+      if (!m_dispatcher || m_dispatcher->IsCurrentThread() || (m_queue.empty() && !m_dispatching))
+        return true;
+    }
+
+    unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+    if (elapsed >= timeout)
+    {
+      CLog::Log(LOGWARNING, "CAnnouncementManager - gave up waiting for queued announcements");
+      return false;
+    }
+    m_drainedEvent.WaitMSec(timeout - elapsed);
+  }
+}
+
+void CAnnouncementManager::Dispatch(CAnnouncement &announcement)
+{
   CSingleLock lock (m_critSection);
+  CAnnouncement *previous = m_current;
+  m_current = &announcement;
+
+  unsigned int latency = XbmcThreads::SystemClockMillis() - announcement.queued;
   for (unsigned int i = 0; i < m_announcers.size(); i++)
-    m_announcers[i]->Announce(flag, sender, message, data);
+  {
+    IAnnouncer  *announcer = m_announcers[i];
+    unsigned int start     = XbmcThreads::SystemClockMillis();
+    announcer->Announce(announcement.flag, announcement.sender.c_str(), announcement.message.c_str(), announcement.data);
+    unsigned int time      = XbmcThreads::SystemClockMillis() - start;
+
+    if (time > ANNOUNCEMENT_SLOW_ANNOUNCER)
+      CLog::Log(LOGDEBUG, "CAnnouncementManager - announcer %p took %u ms for %s", (void*)announcer, time, announcement.message.c_str());
+
+    CSingleLock queueLock(m_queueSection);
+    CAnnouncerStats &stats = m_stats.announcers[announcer];
+    stats.delivered++;
+    stats.latency += latency;
+    stats.time    += time;
+    if (latency > stats.maxLatency)
+      stats.maxLatency = latency;
+    if (time > stats.maxTime)
+      stats.maxTime = time;
+  }
+
+  m_current = previous;
 }
 
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item)
@@ -23,10 +23,57 @@
 #include "IAnnouncer.h"
 #include "FileItem.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/Variant.h"
+#include <deque>
+#include <map>
+#include <string>
 #include <vector>
 
 namespace ANNOUNCEMENT
 {
+  /*!
+   \brief Delivery statistics of a single announcer
+   */
+  class CAnnouncerStats
+  {
+  public:
+    CAnnouncerStats() : delivered(0), latency(0), maxLatency(0), time(0), maxTime(0) { }
+
+    unsigned int delivered;   ///< announcements delivered
+    unsigned int latency;     ///< ms announcements waited in the queue, summed up
+    unsigned int maxLatency;  ///< longest ms an announcement waited in the queue
+    unsigned int time;        ///< ms spent in IAnnouncer::Announce, summed up
+    unsigned int maxTime;     ///< longest ms spent in a single IAnnouncer::Announce
+  };
+
+  /*!
+   \brief Statistics of the announcement queue
+   */
+  class CAnnouncementStats
+  {
+  public:
+    CAnnouncementStats() : queued(0), maxQueued(0), merged(0), dropped(0) { }
+
+    unsigned int queued;      ///< announcements waiting to be delivered
+    unsigned int maxQueued;   ///< most announcements waiting at once
+    unsigned int merged;      ///< announcements merged into one still waiting
+    unsigned int dropped;     ///< library announcements replaced by an OnChanged as the queue was full
+    std::map<const IAnnouncer*, CAnnouncerStats> announcers;
+  };
+
+  /*!
+   \brief Delivers announcements to all registered announcers
+
+   Once started, announcements are queued and delivered by a separate thread,
+   so announcing doesn't block on the announcers. A library update is merged
+   into an update of the same item still waiting, unless something else about
+   the item was announced since. While the queue is full, library updates and
+   removals are replaced by a single OnChanged of the library, telling announcers
+   to reload whatever they show of it. System announcements are
+   delivered synchronously, after everything queued before them, as their
+   callers may be about to shut down or suspend.
+   */
   class CAnnouncementManager
   {
   public:
@@ -36,8 +83,53 @@ namespace ANNOUNCEMENT
     static void Announce(AnnouncementFlag flag, const char *sender, const char *message, CVariant &data);
     static void Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item);
     static void Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item, CVariant &data);
+
+    /*! \brief Start delivering announcements from the dispatcher thread */
+    static void Start();
+    /*! \brief Deliver what is queued and go back to delivering on the caller's thread */
+    static void Stop();
+
+    static CAnnouncementStats GetStats();
+
+    /*!
+     \brief Get a serialized form of the announcement being delivered, shared by all announcers
+     Only valid during IAnnouncer::Announce, the first announcer asking for a format fills it in.
+     \param data the data passed to IAnnouncer::Announce
+     \param format name of the serialization
+     \return the shared string, or NULL if data isn't from an announcement being delivered
+     */
+    static std::string *GetSerialized(const CVariant &data, const std::string &format);
+
   private:
+    class CAnnouncement
+    {
+    public:
+      AnnouncementFlag flag;
+      std::string      sender;
+      std::string      message;
+      std::string      key;     ///< library item the announcement is about, if any
+      CVariant         data;
+      unsigned int     queued;  ///< time the announcement was queued
+      std::map<std::string, std::string> serialized;
+    };
+
+    class CDispatcher;
+
+    static void Queue(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+    static void Dispatch(CAnnouncement &announcement);
+    static bool Flush(unsigned int timeout);
+    static bool DispatchNext(CDispatcher *dispatcher);
+
     static std::vector<IAnnouncer *> m_announcers;
     static CCriticalSection m_critSection;
+
+    static CDispatcher *m_dispatcher;
+    static std::deque<CAnnouncement> m_queue;
+    static CCriticalSection m_queueSection;
+    static CEvent m_queueEvent;
+    static CEvent m_drainedEvent;
+    static bool m_dispatching;
+    static CAnnouncement *m_current;
+    static CAnnouncementStats m_stats;
   };
 }
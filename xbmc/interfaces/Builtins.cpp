@@ -43,7 +43,10 @@
 #include "addons/AddonInstaller.h"
 #include "addons/AddonManager.h"
 #include "addons/PluginSource.h"
+#include "cores/dvdplayer/DVDFileInfo.h"
 #include "music/LastFmManager.h"
+#include "utils/CPUInfo.h"
+#include "utils/JobManager.h"
 #include "utils/LCD.h"
 #include "utils/log.h"
 #include "storage/MediaManager.h"
@@ -209,6 +212,29 @@ const BUILT_IN commands[] = {
   { "LCD.Resume",                 false,  "Resumes LCDproc" },
 #endif
   { "VideoLibrary.Search",        false,  "Brings up a search dialog which will search the library" },
+  { "DecodeBenchmark",            true,   "Decodes the given video headless per thread count and logs the fps reached" },
+};
+
+// decoding takes a while, so it's done off the thread executing the builtin
+class CDecodeBenchmarkJob : public CJob
+{
+public:
+  CDecodeBenchmarkJob(const CStdString &path, unsigned int threads, unsigned int frames)
+    : m_path(path), m_threads(threads), m_frames(frames) {}
+  virtual const char *GetType() const { return "decodebenchmark"; }
+
+  virtual bool DoWork()
+  {
+    bool success = CDVDFileInfo::DecodeBenchmark(m_path, m_threads, m_frames);
+    CLog::Log(success ? LOGNOTICE : LOGERROR, "DecodeBenchmark of %s with up to %u threads, %u frames %s",
+              m_path.c_str(), m_threads, m_frames, success ? "done" : "failed");
+    return success;
+  }
+
+private:
+  CStdString   m_path;
+  unsigned int m_threads;
+  unsigned int m_frames;
 };
 
 bool CBuiltins::HasCommand(const CStdString& execString)
@@ -472,6 +498,17 @@ int CBuiltins::Execute(const CStdString& execString)
     else
       CLog::Log(LOGERROR, "XBMC.Extract, No archive given");
   }
+  else if (execute.Equals("decodebenchmark") && params.size())
+  {
+    unsigned int threads = g_cpuInfo.getCPUCount();
+    unsigned int frames  = 500;
+    if (params.size() > 1)
+      threads = std::max(atoi(params[1].c_str()), 1);
+    if (params.size() > 2)
+      frames  = std::max(atoi(params[2].c_str()), 1);
+
+    CJobManager::GetInstance().AddJob(new CDecodeBenchmarkJob(params[0], threads, frames), NULL);
+  }
   else if (execute.Equals("runplugin"))
   {
     if (params.size())
@@ -21,6 +21,7 @@
  */
 
 #include "interfaces/IAnnouncer.h"
+#include "interfaces/AnnouncementManager.h"
 #include "utils/JSONVariantWriter.h"
 
 namespace JSONRPC
@@ -33,6 +34,11 @@ namespace JSONRPC
   protected:
     static std::string AnnouncementToJSONRPC(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *method, const CVariant &data, bool compactOutput)
     {
+      // all transports share the serialized announcement
+      std::string *shared = ANNOUNCEMENT::CAnnouncementManager::GetSerialized(data, compactOutput ? "jsonrpc-compact" : "jsonrpc");
+      if (shared && !shared->empty())
+        return *shared;
+
       CVariant root;
       root["jsonrpc"] = "2.0";
 
@@ -44,7 +50,10 @@ namespace JSONRPC
       root["params"]["data"] = data;
       root["params"]["sender"] = sender;
 
-      return CJSONVariantWriter::Write(root, compactOutput);
+      std::string str = CJSONVariantWriter::Write(root, compactOutput);
+      if (shared)
+        *shared = str;
+      return str;
     }
   };
 }
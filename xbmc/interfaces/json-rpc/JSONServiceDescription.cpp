@@ -85,6 +85,7 @@ JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
   
   { "Player.SetAudioStream",                        CPlayerOperations::SetAudioStream },
   { "Player.SetSubtitle",                           CPlayerOperations::SetSubtitle },
+  { "Player.GetTelemetry",                          CPlayerOperations::GetTelemetry },
 
 // Playlist
   { "Playlist.GetPlaylists",                        CPlaylistOperations::GetPlaylists },
@@ -35,6 +35,8 @@
 #include "video/VideoDatabase.h"
 #include "AudioLibrary.h"
 #include "GUIInfoManager.h"
+#include "cores/dvdplayer/DVDClock.h"
+#include "cores/dvdplayer/DVDPlayerTelemetry.h"
 
 using namespace JSONRPC;
 using namespace PLAYLIST;
@@ -778,6 +780,58 @@ JSONRPC_STATUS CPlayerOperations::SetSubtitle(const CStdString &method, ITranspo
   return ACK;
 }
 
+JSONRPC_STATUS CPlayerOperations::GetTelemetry(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  switch (GetPlayer(parameterObject["playerid"]))
+  {
+    case Video:
+    case Audio:
+      if (!g_application.m_pPlayer || g_application.GetCurrentPlayer() != EPC_DVDPLAYER)
+        return FailedToExecute;
+      break;
+
+    case Picture:
+    default:
+      return FailedToExecute;
+  }
+
+  CDVDPlayerTelemetry::CTotals totals = g_dvdPlayerTelemetry.GetTotals();
+  result["totals"]["frames"] = totals.frames;
+  result["totals"]["dropped"] = totals.dropped;
+  result["totals"]["late"] = totals.late;
+  result["totals"]["packets"] = totals.packets;
+  result["totals"]["discontinuities"] = totals.discontinuities;
+  result["totals"]["corrections"] = totals.corrections;
+  result["totals"]["maxerror"] = totals.maxError / DVD_TIME_BASE * 1000.0;
+  result["totals"]["maxdecode"] = totals.maxDecode / DVD_TIME_BASE * 1000.0;
+
+  std::vector<CDVDPlayerTelemetry::CSample> samples;
+  g_dvdPlayerTelemetry.GetSamples(samples, (unsigned int)parameterObject["limit"].asUnsignedInteger());
+
+  static const char *flagNames[] = { "dropped", "late", "repeated", "skipped", "duplicated", "discontinuity" };
+  result["samples"] = CVariant(CVariant::VariantTypeArray);
+  for (std::vector<CDVDPlayerTelemetry::CSample>::const_iterator i = samples.begin(); i != samples.end(); ++i)
+  {
+    CVariant sample(CVariant::VariantTypeObject);
+    sample["time"] = i->time / DVD_TIME_BASE * 1000.0;
+    sample["stream"] = CDVDPlayerTelemetry::GetStreamName(i->stream);
+    sample["pts"] = i->pts == DVD_NOPTS_VALUE ? -1.0 : i->pts / DVD_TIME_BASE * 1000.0;
+    sample["error"] = i->error / DVD_TIME_BASE * 1000.0;
+    sample["decode"] = i->decode / DVD_TIME_BASE * 1000.0;
+    sample["ratio"] = i->ratio;
+    sample["level"] = i->level;
+    sample["flags"] = CVariant(CVariant::VariantTypeArray);
+    for (unsigned int flag = 0; flag < sizeof(flagNames) / sizeof(flagNames[0]); flag++)
+    {
+      if (i->flags & (1 << flag))
+        sample["flags"].push_back(flagNames[flag]);
+    }
+    result["samples"].push_back(sample);
+  }
+
+  return OK;
+}
+
 int CPlayerOperations::GetActivePlayers()
 {
   int activePlayers = 0;
@@ -23,7 +23,7 @@
 namespace JSONRPC
 {
   const char* const JSONRPC_SERVICE_ID          = "http://www.xbmc.org/jsonrpc/ServiceDescription.json";
-  const int         JSONRPC_SERVICE_VERSION     = 5;
+  const int         JSONRPC_SERVICE_VERSION     = 6;
   const char* const JSONRPC_SERVICE_DESCRIPTION = "JSON-RPC API of XBMC";
 
   const char* const JSONRPC_SERVICE_TYPES[] = {  
@@ -1277,6 +1277,49 @@ namespace JSONRPC
       "],"
       "\"returns\": \"string\""
     "}",
+    "\"Player.GetTelemetry\": {"
+      "\"type\": \"method\","
+      "\"description\": \"Retrieves the timings of the last frames played, to check audio and video keep in sync. Times are in ms\","
+      "\"transport\": \"Response\","
+      "\"permission\": \"ReadData\","
+      "\"params\": ["
+        "{ \"name\": \"playerid\", \"$ref\": \"Player.Id\", \"required\": true },"
+        "{ \"name\": \"limit\", \"type\": \"integer\", \"minimum\": 0, \"default\": 100, \"description\": \"Number of the last samples to retrieve, 0 for all kept\" }"
+      "],"
+      "\"returns\": {"
+        "\"type\": \"object\","
+        "\"properties\": {"
+          "\"totals\": { \"type\": \"object\", \"required\": true,"
+            "\"properties\": {"
+              "\"frames\": { \"type\": \"integer\", \"required\": true },"
+              "\"dropped\": { \"type\": \"integer\", \"required\": true },"
+              "\"late\": { \"type\": \"integer\", \"required\": true },"
+              "\"packets\": { \"type\": \"integer\", \"required\": true },"
+              "\"discontinuities\": { \"type\": \"integer\", \"required\": true },"
+              "\"corrections\": { \"type\": \"integer\", \"required\": true },"
+              "\"maxerror\": { \"type\": \"number\", \"required\": true },"
+              "\"maxdecode\": { \"type\": \"number\", \"required\": true }"
+            "}"
+          "},"
+          "\"samples\": { \"type\": \"array\", \"required\": true,"
+            "\"items\": { \"type\": \"object\","
+              "\"properties\": {"
+                "\"time\": { \"type\": \"number\", \"required\": true },"
+                "\"stream\": { \"type\": \"string\", \"enum\": [ \"video\", \"audio\", \"clock\" ], \"required\": true },"
+                "\"pts\": { \"type\": \"number\", \"required\": true },"
+                "\"error\": { \"type\": \"number\", \"required\": true },"
+                "\"decode\": { \"type\": \"number\", \"required\": true },"
+                "\"ratio\": { \"type\": \"number\", \"required\": true },"
+                "\"level\": { \"type\": \"integer\", \"required\": true },"
+                "\"flags\": { \"type\": \"array\", \"required\": true,"
+                  "\"items\": { \"type\": \"string\", \"enum\": [ \"dropped\", \"late\", \"repeated\", \"skipped\", \"duplicated\", \"discontinuity\" ] }"
+                "}"
+              "}"
+            "}"
+          "}"
+        "}"
+      "}"
+    "}",
     "\"Playlist.GetPlaylists\": {"
       "\"type\": \"method\","
       "\"description\": \"Returns all existing playlists\","
@@ -2621,6 +2664,15 @@ namespace JSONRPC
       "],"
       "\"returns\": null"
     "}",
+    "\"AudioLibrary.OnChanged\": {"
+      "\"type\": \"notification\","
+      "\"description\": \"Too many audio items changed at once to be announced one by one.\","
+      "\"params\": ["
+        "{ \"name\": \"sender\", \"type\": \"string\", \"required\": true },"
+        "{ \"name\": \"data\", \"type\": \"null\", \"required\": true }"
+      "],"
+      "\"returns\": null"
+    "}",
     "\"AudioLibrary.OnScanFinished\": {"
       "\"type\": \"notification\","
       "\"description\": \"Scanning the audio library has been finished.\","
@@ -2659,6 +2711,15 @@ namespace JSONRPC
       "],"
       "\"returns\": null"
     "}",
+    "\"VideoLibrary.OnChanged\": {"
+      "\"type\": \"notification\","
+      "\"description\": \"Too many video items changed at once to be announced one by one.\","
+      "\"params\": ["
+        "{ \"name\": \"sender\", \"type\": \"string\", \"required\": true },"
+        "{ \"name\": \"data\", \"type\": \"null\", \"required\": true }"
+      "],"
+      "\"returns\": null"
+    "}",
     "\"VideoLibrary.OnScanFinished\": {"
       "\"type\": \"notification\","
       "\"description\": \"Scanning the video library has been finished.\","
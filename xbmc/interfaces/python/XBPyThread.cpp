@@ -26,6 +26,7 @@
 // python.h should always be included first before any other includes
 #include <Python.h>
 #include <osdefs.h>
+#include <pythread.h>
 
 #include "system.h"
 #include "filesystem/SpecialProtocol.h"
@@ -37,6 +38,9 @@
 #include "utils/URIUtils.h"
 #include "addons/AddonManager.h"
 #include "addons/Addon.h"
+#include "addons/PluginSource.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/TimeUtils.h"
 
 #include "XBPyThread.h"
 #include "XBPython.h"
@@ -60,6 +64,109 @@ extern "C"
   char* dll_getenv(const char* szKey);
 }
 
+namespace
+{
+  // time spent in imports, measured by wrapping __builtin__.__import__
+  struct CImportTimer
+  {
+    PyObject *import;
+    int       depth;
+    int64_t   ticks;
+  };
+
+  PyObject *TimedImport(PyObject *self, PyObject *args, PyObject *kwds)
+  {
+    CImportTimer *timer = (CImportTimer *)PyCObject_AsVoidPtr(self);
+    // nested imports are part of the outer one
+    int64_t start = timer->depth++ ? 0 : CurrentHostCounter();
+    PyObject *result = PyObject_Call(timer->import, args, kwds);
+    if (--timer->depth == 0)
+      timer->ticks += CurrentHostCounter() - start;
+    return result;
+  }
+
+  PyMethodDef TimedImportMethod = { (char *)"__import__", (PyCFunction)TimedImport, METH_VARARGS | METH_KEYWORDS, NULL };
+
+  void FreeImportTimer(void *ptr)
+  {
+    CImportTimer *timer = (CImportTimer *)ptr;
+    Py_XDECREF(timer->import);
+    delete timer;
+  }
+
+  // the timer lives as long as the interpreter it is installed in
+  CImportTimer *InstallImportTimer()
+  {
+    PyObject *builtins = PyImport_ImportModule((char *)"__builtin__");
+    if (!builtins)
+    {
+      PyErr_Clear();
+      return NULL;
+    }
+
+    CImportTimer *timer = new CImportTimer;
+    timer->import = PyObject_GetAttrString(builtins, (char *)"__import__");
+    timer->depth  = 0;
+    timer->ticks  = 0;
+
+    PyObject *self = PyCObject_FromVoidPtr(timer, FreeImportTimer);
+    PyObject *import = PyCFunction_NewEx(&TimedImportMethod, self, NULL);
+    if (!timer->import || !import || PyObject_SetAttrString(builtins, (char *)"__import__", import) == -1)
+    {
+      PyErr_Clear();
+      timer = NULL;
+    }
+    Py_XDECREF(import);
+    Py_XDECREF(self);
+    Py_DECREF(builtins);
+    return timer;
+  }
+
+  // prepare an interpreter kept from a previous run of a plugin for the next one
+  void ResetInterpreter(const CStdString &scriptDir)
+  {
+    CStdString dir(scriptDir);
+    URIUtils::AddSlashAtEnd(dir);
+
+    // the modules of the plugin itself are loaded afresh, the libraries it uses stay loaded
+    PyObject *modules = PyImport_GetModuleDict(); // borrowed ref, no need to delete
+    PyObject *names = PyDict_Keys(modules);
+    for (int i = 0; names && i < PyList_Size(names); i++)
+    {
+      PyObject *name = PyList_GetItem(names, i); // borrowed ref, no need to delete
+      PyObject *module = PyDict_GetItem(modules, name); // borrowed ref, no need to delete
+      if (!module || !PyModule_Check(module))
+        continue;
+      const char *file = PyModule_GetFilename(module);
+      if (!file)
+        PyErr_Clear();
+      else if (strncmp(file, dir.c_str(), dir.size()) == 0)
+        PyDict_DelItem(modules, name);
+    }
+    Py_XDECREF(names);
+
+    // and so is __main__
+    PyDict_DelItemString(modules, "__main__");
+    PyObject *moduleDict = PyModule_GetDict(PyImport_AddModule((char*)"__main__"));
+    PyObject *builtins = PyImport_ImportModule((char *)"__builtin__");
+    if (builtins)
+    {
+      PyDict_SetItemString(moduleDict, "__builtins__", builtins);
+      Py_DECREF(builtins);
+    }
+
+    PyObject *m = PyImport_AddModule((char*)"xbmc");
+    if(!m || PyObject_SetAttrString(m, (char*)"abortRequested", Py_False))
+      CLog::Log(LOGERROR, "%s - failed to reset abortRequested", __FUNCTION__);
+    PyErr_Clear();
+  }
+
+  double TicksToMs(int64_t ticks)
+  {
+    return ticks * 1000.0 / CurrentHostFrequency();
+  }
+}
+
 XBPyThread::XBPyThread(XBPython *pExecuter, int id) : CThread("XBPyThread")
 {
   CLog::Log(LOGDEBUG,"new python thread created. id=%d", id);
@@ -134,22 +241,19 @@ void XBPyThread::Process()
   CLog::Log(LOGDEBUG,"Python thread: start processing");
 
   int m_Py_file_input = Py_file_input;
+  int64_t startTime = CurrentHostCounter();
 
-  // get the global lock
-  PyEval_AcquireLock();
-  PyThreadState* state = Py_NewInterpreter();
-  if (!state)
+  // plugins get the interpreter of their previous run if it was kept
+  bool plugin = addon.get() != NULL && addon->Type() == ADDON::ADDON_PLUGIN;
+  std::string pluginKey;
+  if (plugin && m_type == 'F' && g_advancedSettings.m_pythonIdleInterpreters > 0)
   {
-    PyEval_ReleaseLock();
-    CLog::Log(LOGERROR,"Python thread: FAILED to get thread state!");
-    return;
+    boost::shared_ptr<ADDON::CPluginSource> source = boost::dynamic_pointer_cast<ADDON::CPluginSource>(addon);
+    if (source && source->ReuseInterpreter())
+      pluginKey = addon->ID() + "-" + addon->Version().c_str();
   }
-  // swap in my thread state
-  PyThreadState_Swap(state);
-
-  m_pExecuter->InitializeInterpreter(addon);
-
-  CLog::Log(LOGDEBUG, "%s - The source file to load is %s", __FUNCTION__, m_source);
+  PyIdleInterpreter idle;
+  bool reused = !pluginKey.empty() && m_pExecuter->GetIdleInterpreter(pluginKey, idle);
 
   // get path from script file name and add python path's
   // this is used for python so it will search modules from script path first
@@ -157,47 +261,83 @@ void XBPyThread::Process()
   URIUtils::GetDirectory(CSpecialProtocol::TranslatePath(m_source), scriptDir);
   URIUtils::RemoveSlashAtEnd(scriptDir);
   CStdString path = scriptDir;
+  CImportTimer *importTimer = NULL;
 
-  // add on any addon modules the user has installed
-  ADDON::VECADDONS addons;
-  ADDON::CAddonMgr::Get().GetAddons(ADDON::ADDON_SCRIPT_MODULE, addons);
-  for (unsigned int i = 0; i < addons.size(); ++i)
-#ifdef TARGET_WINDOWS
+  // get the global lock
+  PyEval_AcquireLock();
+  PyThreadState* state;
+  if (reused)
   {
-    CStdString strTmp(CSpecialProtocol::TranslatePath(addons[i]->LibPath()));
-    g_charsetConverter.utf8ToSystem(strTmp);
-    path += PY_PATH_SEP + strTmp;
+    state = (PyThreadState*)idle.threadState;
+    importTimer = (CImportTimer*)idle.importTimer;
+    path = idle.path;
+    PyThreadState_Swap(state);
+    state->thread_id = PyThread_get_thread_ident();
+    ResetInterpreter(scriptDir);
   }
+  else
+  {
+    state = Py_NewInterpreter();
+    if (!state)
+    {
+      PyEval_ReleaseLock();
+      CLog::Log(LOGERROR,"Python thread: FAILED to get thread state!");
+      return;
+    }
+    // swap in my thread state
+    PyThreadState_Swap(state);
+
+    m_pExecuter->InitializeInterpreter(addon);
+    if (plugin)
+      importTimer = InstallImportTimer();
+  }
+
+  CLog::Log(LOGDEBUG, "%s - The source file to load is %s", __FUNCTION__, m_source);
+
+  if (!reused)
+  {
+
+    // add on any addon modules the user has installed
+    ADDON::VECADDONS addons;
+    ADDON::CAddonMgr::Get().GetAddons(ADDON::ADDON_SCRIPT_MODULE, addons);
+    for (unsigned int i = 0; i < addons.size(); ++i)
+#ifdef TARGET_WINDOWS
+    {
+      CStdString strTmp(CSpecialProtocol::TranslatePath(addons[i]->LibPath()));
+      g_charsetConverter.utf8ToSystem(strTmp);
+      path += PY_PATH_SEP + strTmp;
+    }
 #else
-    path += PY_PATH_SEP + CSpecialProtocol::TranslatePath(addons[i]->LibPath());
+      path += PY_PATH_SEP + CSpecialProtocol::TranslatePath(addons[i]->LibPath());
 #endif
 
-  // and add on whatever our default path is
-  path += PY_PATH_SEP;
+    // and add on whatever our default path is
+    path += PY_PATH_SEP;
 
-  // we want to use sys.path so it includes site-packages
-  // if this fails, default to using Py_GetPath
-  PyObject *sysMod(PyImport_ImportModule((char*)"sys")); // must call Py_DECREF when finished
-  PyObject *sysModDict(PyModule_GetDict(sysMod)); // borrowed ref, no need to delete
-  PyObject *pathObj(PyDict_GetItemString(sysModDict, "path")); // borrowed ref, no need to delete
+    // we want to use sys.path so it includes site-packages
+    // if this fails, default to using Py_GetPath
+    PyObject *sysMod(PyImport_ImportModule((char*)"sys")); // must call Py_DECREF when finished
+    PyObject *sysModDict(PyModule_GetDict(sysMod)); // borrowed ref, no need to delete
+    PyObject *pathObj(PyDict_GetItemString(sysModDict, "path")); // borrowed ref, no need to delete
 
-  if( pathObj && PyList_Check(pathObj) )
-  {
-    for( int i = 0; i < PyList_Size(pathObj); i++ )
+    if( pathObj && PyList_Check(pathObj) )
     {
-      PyObject *e = PyList_GetItem(pathObj, i); // borrowed ref, no need to delete
-      if( e && PyString_Check(e) )
+      for( int i = 0; i < PyList_Size(pathObj); i++ )
       {
-          path += PyString_AsString(e); // returns internal data, don't delete or modify
-          path += PY_PATH_SEP;
+        PyObject *e = PyList_GetItem(pathObj, i); // borrowed ref, no need to delete
+        if( e && PyString_Check(e) )
+        {
+            path += PyString_AsString(e); // returns internal data, don't delete or modify
+            path += PY_PATH_SEP;
+        }
       }
     }
+    else
+    {
+      path += Py_GetPath();
+    }
+    Py_DECREF(sysMod); // release ref to sysMod
   }
-  else
-  {
-    path += Py_GetPath();
-  }
-  Py_DECREF(sysMod); // release ref to sysMod
 
   // set current directory and python's path.
   if (m_argv != NULL)
@@ -226,6 +366,9 @@ void XBPyThread::Process()
   PyEval_AcquireLock();
   PyThreadState_Swap(state);
 
+  int64_t runTime = CurrentHostCounter();
+  int64_t importTicks = importTimer ? importTimer->ticks : 0;
+
   if (!stopping)
   {
     if (m_type == 'F')
@@ -265,6 +408,13 @@ void XBPyThread::Process()
     }
   }
 
+  int64_t endTime = CurrentHostCounter();
+  if (importTimer)
+    importTicks = importTimer->ticks - importTicks;
+
+  // only interpreters of plugins that ran to completion are kept
+  bool keep = !pluginKey.empty() && !stopping && !PyErr_Occurred();
+
   if (!PyErr_Occurred())
     CLog::Log(LOGINFO, "Scriptresult: Success");
   else if (PyErr_ExceptionMatches(PyExc_SystemExit))
@@ -384,6 +534,23 @@ void XBPyThread::Process()
 
   { CSingleLock lock(m_pExecuter->m_critSection);
     m_threadState = NULL;
+    if (m_stopping)
+      keep = false;
+  }
+
+  if (importTimer)
+    CLog::Log(LOGDEBUG, "%s - %s: startup %.1f ms (%s interpreter), import %.1f ms, run %.1f ms", __FUNCTION__,
+              addon->ID().c_str(), TicksToMs(runTime - startTime), reused ? "reused" : "new",
+              TicksToMs(importTicks), TicksToMs(endTime - runTime - importTicks));
+
+  if (keep)
+  {
+    idle.addon       = pluginKey;
+    idle.threadState = state;
+    idle.importTimer = importTimer;
+    idle.path        = path;
+    if (m_pExecuter->AddIdleInterpreter(idle))
+      return;
   }
 
   PyEval_AcquireLock();
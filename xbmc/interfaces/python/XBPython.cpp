@@ -32,6 +32,7 @@
 
 #include "XBPython.h"
 #include "settings/Settings.h"
+#include "settings/AdvancedSettings.h"
 #include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
 #include "utils/log.h"
@@ -409,6 +410,77 @@ void XBPython::DeInitializeInterpreter()
   DeinitVFSModule();
 }
 
+// idle interpreters of plugins not run again in this time are ended
+#define PYTHON_IDLE_INTERPRETER_TIME 60000
+
+bool XBPython::GetIdleInterpreter(const std::string &addon, PyIdleInterpreter &interpreter)
+{
+  CSingleLock lock(m_critSection);
+  // most recently used first, the others may expire
+  for (PyIdleList::reverse_iterator it = m_idleInterpreters.rbegin(); it != m_idleInterpreters.rend(); ++it)
+  {
+    if (it->addon == addon)
+    {
+      interpreter = *it;
+      m_idleInterpreters.erase(--it.base());
+      return true;
+    }
+  }
+  return false;
+}
+
+bool XBPython::AddIdleInterpreter(const PyIdleInterpreter &interpreter)
+{
+  CSingleLock lock(m_critSection);
+  if (!m_bInitialized)
+    return false;
+
+  int count = 0;
+  for (PyIdleList::const_iterator it = m_idleInterpreters.begin(); it != m_idleInterpreters.end(); ++it)
+  {
+    if (it->addon == interpreter.addon)
+      count++;
+  }
+  if (count >= g_advancedSettings.m_pythonIdleInterpreters)
+    return false;
+
+  m_idleInterpreters.push_back(interpreter);
+  m_idleInterpreters.back().idleSince = XbmcThreads::SystemClockMillis();
+  return true;
+}
+
+void XBPython::EndIdleInterpreters(bool expiredOnly)
+{
+  PyIdleList expired;
+  {
+    CSingleLock lock(m_critSection);
+    unsigned int now = XbmcThreads::SystemClockMillis();
+    PyIdleList::iterator it = m_idleInterpreters.begin();
+    while (it != m_idleInterpreters.end())
+    {
+      if (!expiredOnly || now - it->idleSince > PYTHON_IDLE_INTERPRETER_TIME)
+      {
+        expired.push_back(*it);
+        it = m_idleInterpreters.erase(it);
+      }
+      else
+        ++it;
+    }
+  }
+
+  for (PyIdleList::iterator it = expired.begin(); it != expired.end(); ++it)
+  {
+    CLog::Log(LOGDEBUG, "%s - ending idle interpreter of %s", __FUNCTION__, it->addon.c_str());
+    PyThreadState *state = (PyThreadState *)it->threadState;
+    PyEval_AcquireLock();
+    PyThreadState_Swap(state);
+    DeInitializeInterpreter();
+    Py_EndInterpreter(state);
+    PyThreadState_Swap(NULL);
+    PyEval_ReleaseLock();
+  }
+}
+
 /**
 * Should be called before executing a script
 */
@@ -516,6 +588,8 @@ void XBPython::Finalize()
 {
   if (m_bInitialized)
   {
+    EndIdleInterpreters(false);
+
     CLog::Log(LOGINFO, "Python, unloading python shared library because no scripts are running anymore");
 
     PyEval_AcquireLock();
@@ -559,6 +633,8 @@ void XBPython::FreeResources()
       it = m_vecPyList.erase(it);
       FinalizeScript();
     }
+    lock.Leave();
+    EndIdleInterpreters(false);
   }
 }
 
@@ -594,7 +670,9 @@ void XBPython::Process()
       else ++it;
     }
 
-    if(m_iDllScriptCounter == 0 && (XbmcThreads::SystemClockMillis() - m_endtime) > 10000 )
+    EndIdleInterpreters(true);
+
+    if(m_iDllScriptCounter == 0 && m_idleInterpreters.empty() && (XbmcThreads::SystemClockMillis() - m_endtime) > 10000 )
       Finalize();
   }
 }
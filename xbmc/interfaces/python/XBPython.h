@@ -36,10 +36,20 @@ typedef struct {
   XBPyThread *pyThread;
 }PyElem;
 
+// an interpreter that finished a plugin run, kept for the next run of the same plugin
+typedef struct {
+  std::string addon;       // id and version of the plugin
+  void *threadState;
+  void *importTimer;
+  std::string path;        // python path set up when the interpreter was created
+  unsigned int idleSince;
+}PyIdleInterpreter;
+
 class LibraryLoader;
 class CPythonMonitor;
 
 typedef std::vector<PyElem> PyList;
+typedef std::vector<PyIdleInterpreter> PyIdleList;
 typedef std::vector<PVOID> PlayerCallbackList;
 typedef std::vector<PVOID> MonitorCallbackList;
 typedef std::vector<LibraryLoader*> PythonExtensionLibraries;
@@ -98,6 +108,18 @@ public:
   // remove modules and references when interpreter done
   void DeInitializeInterpreter();
 
+  /*! \brief Take a kept interpreter of a plugin
+   \param addon id and version of the plugin
+   \param interpreter the interpreter, if there is one
+   \return true if an interpreter was kept for the plugin
+   */
+  bool GetIdleInterpreter(const std::string &addon, PyIdleInterpreter &interpreter);
+
+  /*! \brief Keep an interpreter for the next run of its plugin
+   \return false if enough interpreters are kept for the plugin, the caller should end the interpreter
+   */
+  bool AddIdleInterpreter(const PyIdleInterpreter &interpreter);
+
   void RegisterExtensionLib(LibraryLoader *pLib);
   void UnregisterExtensionLib(LibraryLoader *pLib);
   void UnloadExtensionLibs();
@@ -117,6 +139,7 @@ public:
   CCriticalSection    m_critSection;
 private:
   bool              FileExist(const char* strFile);
+  void              EndIdleInterpreters(bool expiredOnly);
 
   int               m_nextid;
   void*             m_mainThreadState;
@@ -128,6 +151,7 @@ private:
 
   //Vector with list of threads used for running scripts
   PyList              m_vecPyList;
+  PyIdleList          m_idleInterpreters;
   PlayerCallbackList  m_vecPlayerCallbackList;
   MonitorCallbackList m_vecMonitorCallbackList;
   LibraryLoader*      m_pDll;
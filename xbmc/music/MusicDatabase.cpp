@@ -71,6 +71,12 @@ using ADDON::AddonPtr;
 #define RECENTLY_PLAYED_LIMIT 25
 #define MIN_FULL_SEARCH_LENGTH 3
 
+// kinds of items in the searchtoken table
+#define SEARCH_SONG   1
+#define SEARCH_ALBUM  2
+#define SEARCH_ARTIST 3
+#define SEARCH_TOKEN_LENGTH 64
+
 #ifdef HAS_DVD_DRIVE
 using namespace CDDB;
 #endif
@@ -132,6 +138,10 @@ bool CMusicDatabase::CreateTables()
     m_pDS->exec("CREATE TABLE karaokedata ( iKaraNumber integer, idSong integer, iKaraDelay integer, strKaraEncoding text, "
                 "strKaralyrics text, strKaraLyrFileCRC text )\n");
 
+    CLog::Log(LOGINFO, "create partymodehistory table");
+    m_pDS->exec("CREATE TABLE partymodehistory ( client varchar(64), idSong integer )\n");
+    m_pDS->exec("CREATE UNIQUE INDEX idxPartyModeHistory ON partymodehistory(client, idSong)");
+
     // Indexes
     CLog::Log(LOGINFO, "create exartistsong index");
     m_pDS->exec("CREATE INDEX idxExtraArtistSong ON exartistsong(idSong)");
@@ -189,6 +199,14 @@ bool CMusicDatabase::CreateTables()
     CLog::Log(LOGINFO, "create albuminfo trigger");
     m_pDS->exec("CREATE TRIGGER tgrAlbumInfo AFTER delete ON albuminfo FOR EACH ROW BEGIN delete from albuminfosong where albuminfosong.idAlbumInfo=old.idAlbumInfo; END");
 
+    CLog::Log(LOGINFO, "create searchtoken table");
+    m_pDS->exec("CREATE TABLE searchtoken ( media integer, idMedia integer, token varchar(64) )\n");
+    m_pDS->exec("CREATE INDEX idxSearchToken ON searchtoken(media, token)");
+    m_pDS->exec("CREATE INDEX idxSearchToken2 ON searchtoken(media, idMedia)");
+    m_pDS->exec("CREATE TRIGGER tgrSongSearch AFTER delete ON song FOR EACH ROW BEGIN delete from searchtoken where media=1 and idMedia=old.idSong; END");
+    m_pDS->exec("CREATE TRIGGER tgrAlbumSearch AFTER delete ON album FOR EACH ROW BEGIN delete from searchtoken where media=2 and idMedia=old.idAlbum; END");
+    m_pDS->exec("CREATE TRIGGER tgrArtistSearch AFTER delete ON artist FOR EACH ROW BEGIN delete from searchtoken where media=3 and idMedia=old.idArtist; END");
+
     // we create views last to ensure all indexes are rolled in
     CreateViews();
 
@@ -372,6 +390,9 @@ void CMusicDatabase::AddSong(CSong& song, bool bCheck)
         idSong = (int)m_pDS->lastinsertid();
       else
         idSong = song.idSong;
+
+      // replace doesn't run the delete trigger, so this drops the tokens of a replaced song itself
+      SetSearchTokens(SEARCH_SONG, idSong, song.strTitle);
     }
 
     // add extra artists and genres
@@ -463,6 +484,7 @@ int CMusicDatabase::AddAlbum(const CStdString& strAlbum1, int idArtist, const CS
 
       CAlbumCache album;
       album.idAlbum = (int)m_pDS->lastinsertid();
+      SetSearchTokens(SEARCH_ALBUM, album.idAlbum, strAlbum);
       album.strAlbum = strAlbum;
       album.idArtist = idArtist;
       album.artist = StringUtils::Split(strArtist, g_advancedSettings.m_musicItemSeparator);
@@ -579,6 +601,7 @@ int CMusicDatabase::AddArtist(const CStdString& strArtist1)
       strSQL=PrepareSQL("insert into artist (idArtist, strArtist) values( NULL, '%s' )", strArtist.c_str());
       m_pDS->exec(strSQL.c_str());
       int idArtist = (int)m_pDS->lastinsertid();
+      SetSearchTokens(SEARCH_ARTIST, idArtist, strArtist);
       m_artistCache.insert(pair<CStdString, int>(strArtist1, idArtist));
       return idArtist;
     }
@@ -1109,8 +1132,13 @@ bool CMusicDatabase::SearchArtists(const CStdString& search, CFileItemList &arti
       strSQL=PrepareSQL("select * from artist "
                                 "where strArtist like '%s%%' and idArtist <> %i "
                                 , search.c_str(), idVariousArtist );
+    CStdString filter = GetSearchTokenFilter(SEARCH_ARTIST, "idArtist", search);
+    strSQL += filter;
 
+    unsigned int time = XbmcThreads::SystemClockMillis();
     if (!m_pDS->query(strSQL.c_str())) return false;
+    CLog::Log(LOGDEBUG, "%s - %u artists for '%s' in %u ms%s", __FUNCTION__, (unsigned int)m_pDS->num_rows(), search.c_str(),
+              XbmcThreads::SystemClockMillis() - time, filter.IsEmpty() ? ", not narrowed by search tokens" : "");
     if (m_pDS->num_rows() == 0)
     {
       m_pDS->close();
@@ -1758,11 +1786,16 @@ bool CMusicDatabase::SearchSongs(const CStdString& search, CFileItemList &items)
 
     CStdString strSQL;
     if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
-      strSQL=PrepareSQL("select * from songview where strTitle like '%s%%' or strTitle like '%% %s%%' limit 1000", search.c_str(), search.c_str());
+      strSQL=PrepareSQL("select * from songview where (strTitle like '%s%%' or strTitle like '%% %s%%')", search.c_str(), search.c_str());
     else
-      strSQL=PrepareSQL("select * from songview where strTitle like '%s%%' limit 1000", search.c_str());
+      strSQL=PrepareSQL("select * from songview where strTitle like '%s%%'", search.c_str());
+    CStdString filter = GetSearchTokenFilter(SEARCH_SONG, "idSong", search);
+    strSQL += filter + " limit 1000";
 
+    unsigned int time = XbmcThreads::SystemClockMillis();
     if (!m_pDS->query(strSQL.c_str())) return false;
+    CLog::Log(LOGDEBUG, "%s - %u songs for '%s' in %u ms%s", __FUNCTION__, (unsigned int)m_pDS->num_rows(), search.c_str(),
+              XbmcThreads::SystemClockMillis() - time, filter.IsEmpty() ? ", not narrowed by search tokens" : "");
     if (m_pDS->num_rows() == 0) return false;
 
     CStdString songLabel = g_localizeStrings.Get(179); // Song
@@ -1794,11 +1827,16 @@ bool CMusicDatabase::SearchAlbums(const CStdString& search, CFileItemList &album
 
     CStdString strSQL;
     if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
-      strSQL=PrepareSQL("select * from albumview where strAlbum like '%s%%' or strAlbum like '%% %s%%'", search.c_str(), search.c_str());
+      strSQL=PrepareSQL("select * from albumview where (strAlbum like '%s%%' or strAlbum like '%% %s%%')", search.c_str(), search.c_str());
     else
       strSQL=PrepareSQL("select * from albumview where strAlbum like '%s%%'", search.c_str());
+    CStdString filter = GetSearchTokenFilter(SEARCH_ALBUM, "idAlbum", search);
+    strSQL += filter;
 
+    unsigned int time = XbmcThreads::SystemClockMillis();
     if (!m_pDS->query(strSQL.c_str())) return false;
+    CLog::Log(LOGDEBUG, "%s - %u albums for '%s' in %u ms%s", __FUNCTION__, (unsigned int)m_pDS->num_rows(), search.c_str(),
+              XbmcThreads::SystemClockMillis() - time, filter.IsEmpty() ? ", not narrowed by search tokens" : "");
 
     CStdString albumLabel(g_localizeStrings.Get(558)); // Album
     while (!m_pDS->eof())
@@ -1825,6 +1863,110 @@ bool CMusicDatabase::SearchAlbums(const CStdString& search, CFileItemList &album
   return false;
 }
 
+/*! \brief Lower case ASCII letters the same way SQL's like does, other bytes are left alone */
+static CStdString SearchTokenCase(const CStdString &text)
+{
+  CStdString result(text);
+  for (unsigned int i = 0; i < result.size(); i++)
+  {
+    if (result[i] >= 'A' && result[i] <= 'Z')
+      result[i] += 'a' - 'A';
+  }
+  return result;
+}
+
+/*! \brief Cut a token to the column width without splitting a UTF-8 sequence */
+static CStdString SearchTokenTruncate(const CStdString &token)
+{
+  if (token.size() <= SEARCH_TOKEN_LENGTH)
+    return token;
+  unsigned int length = SEARCH_TOKEN_LENGTH;
+  while (length > 0 && ((unsigned char)token[length] & 0xC0) == 0x80)
+    length--;
+  return token.Left(length);
+}
+
+void CMusicDatabase::SetSearchTokens(int media, int id, const CStdString &text)
+{
+  CStdString sql = PrepareSQL("delete from searchtoken where media=%i and idMedia=%i", media, id);
+  m_pDS->exec(sql.c_str());
+
+  // a search matches the start of the title or anything following a space
+  set<CStdString> tokens;
+  CStdString lower = SearchTokenCase(text);
+  size_t start = 0;
+  while (start < lower.size())
+  {
+    size_t end = lower.find(' ', start);
+    if (end == string::npos)
+      end = lower.size();
+    if (end > start)
+      tokens.insert(SearchTokenTruncate(lower.substr(start, end - start)));
+    start = end + 1;
+  }
+
+  for (set<CStdString>::const_iterator it = tokens.begin(); it != tokens.end(); ++it)
+  {
+    sql = PrepareSQL("insert into searchtoken (media, idMedia, token) values (%i, %i, '%s')", media, id, it->c_str());
+    m_pDS->exec(sql.c_str());
+  }
+}
+
+CStdString CMusicDatabase::GetSearchTokenFilter(int media, const CStdString &column, const CStdString &search)
+{
+  // the first word of the search starts one of the indexed words, the like
+  // clauses of the search sort out the rest
+  CStdString word = SearchTokenCase(search);
+  word.TrimLeft(" ");
+  size_t end = word.find(' ');
+  if (end != string::npos)
+    word = word.Left(end);
+  // the like clauses take % and _ in the search as wildcards, so only the part before them
+  // can be looked up. Without this the ranges below would compare them literally.
+  end = word.find_first_of("%_");
+  if (end != string::npos)
+    word = word.Left(end);
+  word = SearchTokenTruncate(word);
+  if (word.IsEmpty())
+    return "";
+
+  if (!m_sqlite)
+    return PrepareSQL(" and %s in (select idMedia from searchtoken where media=%i and token like '%s%%')", column.c_str(), media, word.c_str());
+
+  // sqlite only uses an index for like on case insensitive columns, ask for the range instead
+  CStdString next = word;
+  while (!next.IsEmpty() && (unsigned char)next[next.size() - 1] == 0xFF)
+    next.Delete(next.size() - 1);
+  if (next.IsEmpty())
+    return PrepareSQL(" and %s in (select idMedia from searchtoken where media=%i and token >= '%s')", column.c_str(), media, word.c_str());
+  next[next.size() - 1]++;
+  return PrepareSQL(" and %s in (select idMedia from searchtoken where media=%i and token >= '%s' and token < '%s')",
+                    column.c_str(), media, word.c_str(), next.c_str());
+}
+
+void CMusicDatabase::RebuildSearchTokens()
+{
+  unsigned int time = XbmcThreads::SystemClockMillis();
+  m_pDS->exec("delete from searchtoken");
+
+  const struct { int media; const char *query; } sources[] = {
+    { SEARCH_SONG,   "select idSong, strTitle from song" },
+    { SEARCH_ALBUM,  "select idAlbum, strAlbum from album" },
+    { SEARCH_ARTIST, "select idArtist, strArtist from artist" } };
+
+  for (unsigned int i = 0; i < sizeof(sources) / sizeof(sources[0]); i++)
+  {
+    m_pDS2->query(sources[i].query);
+    while (!m_pDS2->eof())
+    {
+      SetSearchTokens(sources[i].media, m_pDS2->fv(0).get_asInt(), m_pDS2->fv(1).get_asString());
+      m_pDS2->next();
+    }
+    m_pDS2->close();
+  }
+  CLog::Log(LOGDEBUG, "%s - indexed the library in %u ms", __FUNCTION__, XbmcThreads::SystemClockMillis() - time);
+}
+
 int CMusicDatabase::SetAlbumInfo(int idAlbum, const CAlbum& album, const VECSONGS& songs, bool bTransaction)
 {
   CStdString strSQL;
@@ -3377,6 +3519,26 @@ bool CMusicDatabase::UpdateOldVersion(int version)
       sql = PrepareSQL("UPDATE album SET strExtraArtists=SUBSTR(strExtraArtists,%i), strExtraGenres=SUBSTR(strExtraGenres,%i)", len, len);
       m_pDS->exec(sql.c_str());
     }
+    if (version < 21)
+    {
+      m_pDS->exec("CREATE TABLE partymodehistory ( idSong integer primary key )\n");
+    }
+    if (version < 22)
+    {
+      m_pDS->exec("CREATE TABLE searchtoken ( media integer, idMedia integer, token varchar(64) )\n");
+      m_pDS->exec("CREATE INDEX idxSearchToken ON searchtoken(media, token)");
+      m_pDS->exec("CREATE INDEX idxSearchToken2 ON searchtoken(media, idMedia)");
+      m_pDS->exec("CREATE TRIGGER tgrSongSearch AFTER delete ON song FOR EACH ROW BEGIN delete from searchtoken where media=1 and idMedia=old.idSong; END");
+      m_pDS->exec("CREATE TRIGGER tgrAlbumSearch AFTER delete ON album FOR EACH ROW BEGIN delete from searchtoken where media=2 and idMedia=old.idAlbum; END");
+      m_pDS->exec("CREATE TRIGGER tgrArtistSearch AFTER delete ON artist FOR EACH ROW BEGIN delete from searchtoken where media=3 and idMedia=old.idArtist; END");
+      RebuildSearchTokens();
+    }
+    if (version < 23)
+    {
+      m_pDS->exec("DROP TABLE partymodehistory");
+      m_pDS->exec("CREATE TABLE partymodehistory ( client varchar(64), idSong integer )\n");
+      m_pDS->exec("CREATE UNIQUE INDEX idxPartyModeHistory ON partymodehistory(client, idSong)");
+    }
 
     // always recreate the views after any table change
     CreateViews();
@@ -3391,6 +3553,30 @@ bool CMusicDatabase::UpdateOldVersion(int version)
   return true;
 }
 
+bool CMusicDatabase::GetThumbURLs(int afterId, vector< pair<int, string> > &urls)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    CStdString sql = PrepareSQL("select idThumb, strThumb from thumb where idThumb>%i and strThumb<>'NONE' order by idThumb", afterId);
+    m_pDS->query(sql.c_str());
+    while (!m_pDS->eof())
+    {
+      urls.push_back(make_pair(m_pDS->fv(0).get_asInt(), m_pDS->fv(1).get_asString()));
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s(%d) failed", __FUNCTION__, afterId);
+  }
+  return false;
+}
+
 int CMusicDatabase::AddThumb(const CStdString& strThumb1)
 {
   CStdString strSQL;
@@ -3469,6 +3655,57 @@ unsigned int CMusicDatabase::GetSongIDs(const CStdString& strWhere, vector<pair<
   return 0;
 }
 
+bool CMusicDatabase::GetRandomSongIDs(const CStdString& strWhere, unsigned int count, vector<pair<int,int> > &songIDs)
+{
+  vector<int> ids;
+  if (!GetRandomIDs("songview", "songview.idSong", strWhere, count, ids))
+    return false;
+  for (vector<int>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+    songIDs.push_back(make_pair<int,int>(1, *it));
+  return true;
+}
+
+bool CMusicDatabase::UpdatePartyModeHistory(const CStdString &client, const vector<int> &added, const vector<int> &removed)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    CStdString ids;
+    for (vector<int>::const_iterator it = removed.begin(); it != removed.end(); ++it)
+      ids.AppendFormat("%i,", *it);
+    for (vector<int>::const_iterator it = added.begin(); it != added.end(); ++it)
+      ids.AppendFormat("%i,", *it);
+    if (ids.IsEmpty())
+      return true;
+    ids.TrimRight(",");
+
+    BeginTransaction();
+    CStdString sql;
+    sql = PrepareSQL("delete from partymodehistory where client='%s' and idSong in (", client.c_str()) + ids + ")";
+    m_pDS->exec(sql.c_str());
+    for (vector<int>::const_iterator it = added.begin(); it != added.end(); ++it)
+    {
+      sql = PrepareSQL("insert into partymodehistory (client, idSong) values ('%s', %i)", client.c_str(), *it);
+      m_pDS->exec(sql.c_str());
+    }
+    CommitTransaction();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+    RollbackTransaction();
+  }
+  return false;
+}
+
+bool CMusicDatabase::ClearPartyModeHistory(const CStdString &client)
+{
+  return ExecuteQuery(PrepareSQL("delete from partymodehistory where client='%s'", client.c_str()));
+}
+
 int CMusicDatabase::GetSongsCount(const CStdString& strWhere)
 {
   try
@@ -3741,46 +3978,6 @@ int CMusicDatabase::GetGenreByName(const CStdString& strGenre)
   return -1;
 }
 
-bool CMusicDatabase::GetRandomSong(CFileItem* item, int& idSong, const CStdString& strWhere)
-{
-  try
-  {
-    idSong = -1;
-
-    int iCount = GetSongsCount(strWhere);
-    if (iCount <= 0)
-      return false;
-    int iRandom = rand() % iCount;
-
-    if (NULL == m_pDB.get()) return false;
-    if (NULL == m_pDS.get()) return false;
-
-    // We don't use PrepareSQL here, as the WHERE clause is already formatted
-    CStdString strSQL;
-    strSQL.Format("select * from songview %s order by idSong limit 1 offset %i", strWhere.c_str(), iRandom);
-
-    CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
-    // run query
-    if (!m_pDS->query(strSQL.c_str()))
-      return false;
-    int iRowsFound = m_pDS->num_rows();
-    if (iRowsFound != 1)
-    {
-      m_pDS->close();
-      return false;
-    }
-    GetFileItemFromDataset(item, "");
-    idSong = m_pDS->fv("songview.idSong").get_asInt();
-    m_pDS->close();
-    return true;
-  }
-  catch(...)
-  {
-    CLog::Log(LOGERROR, "%s(%s) failed", __FUNCTION__, strWhere.c_str());
-  }
-  return false;
-}
-
 bool CMusicDatabase::GetVariousArtistsAlbums(const CStdString& strBaseDir, CFileItemList& items)
 {
   try
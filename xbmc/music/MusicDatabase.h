@@ -166,14 +166,30 @@ public:
   bool GetSongsByWhere(const CStdString &baseDir, const CStdString &whereClause, CFileItemList& items);
   bool GetAlbumsByWhere(const CStdString &baseDir, const CStdString &where, const CStdString &order, CFileItemList &items);
   bool GetArtistsByWhere(const CStdString& strBaseDir, const CStdString &where, CFileItemList& items);
-  bool GetRandomSong(CFileItem* item, int& idSong, const CStdString& strWhere);
   int GetKaraokeSongsCount();
   int GetSongsCount(const CStdString& strWhere = "");
   unsigned int GetSongIDs(const CStdString& strWhere, std::vector<std::pair<int,int> > &songIDs);
 
+  // partymode
+  bool GetRandomSongIDs(const CStdString& strWhere, unsigned int count, std::vector<std::pair<int,int> > &songIDs);
+  /*! \brief Keep the party mode history in the partymodehistory table so where clauses can refer to it
+   The database may be shared by several clients, so each keeps its own rows.
+   \param client the client the history is of, see CPartyModeManager
+   \param added songs to add to the history
+   \param removed songs to drop from the history */
+  bool UpdatePartyModeHistory(const CStdString &client, const std::vector<int> &added, const std::vector<int> &removed);
+  bool ClearPartyModeHistory(const CStdString &client);
+
   bool GetAlbumPath(int idAlbum, CStdString &path);
   bool SaveAlbumThumb(int idAlbum, const CStdString &thumb);
   bool GetAlbumThumb(int idAlbum, CStdString &thumb);
+
+  /*! \brief Get the thumbs added after the given thumb, to cache them ahead of being shown
+   \param afterId the idThumb of the last thumb already seen
+   \param urls idThumb and url of each thumb added since, in the order added
+   \return true if the query succeeded
+   */
+  bool GetThumbURLs(int afterId, std::vector< std::pair<int, std::string> > &urls);
   bool GetArtistPath(int idArtist, CStdString &path);
 
   CStdString GetGenreById(int id);
@@ -217,7 +233,7 @@ protected:
   std::map<CStdString, CAlbumCache> m_albumCache;
 
   virtual bool CreateTables();
-  virtual int GetMinVersion() const { return 20; };
+  virtual int GetMinVersion() const { return 23; };
   const char *GetBaseDBName() const { return "MyMusic"; };
 
   int AddAlbum(const CStdString& strAlbum1, int idArtist, const CStdString &extraArtists, const CStdString &strArtist1, int idThumb, int idGenre, const CStdString &extraGenres, int year);
@@ -252,6 +268,28 @@ private:
   bool SearchArtists(const CStdString& search, CFileItemList &artists);
   bool SearchAlbums(const CStdString& search, CFileItemList &albums);
   bool SearchSongs(const CStdString& strSearch, CFileItemList &songs);
+
+  /*! \brief Index the words of a title so that searching for their start can use an index
+   Searches match the start of the title or of a word in it, see SearchSongs. Each word,
+   lower cased, is a row in the searchtoken table. Rows go with their item through triggers.
+   \param media the kind of item, SEARCH_SONG, SEARCH_ALBUM or SEARCH_ARTIST
+   \param id the id of the item
+   \param text the title to index
+   */
+  void SetSearchTokens(int media, int id, const CStdString &text);
+
+  /*! \brief Condition on an id column that narrows it to items with a word starting like the search
+   Only the first word up to any % or _ is looked up, as the like clauses of the search take those
+   as wildcards, so the condition never drops items the like clauses alone would find.
+   \param media the kind of item
+   \param column the id column of the item
+   \param search the search string
+   \return the condition, empty if the search has no word to look up
+   */
+  CStdString GetSearchTokenFilter(int media, const CStdString &column, const CStdString &search);
+
+  /*! \brief Index the titles of all songs, albums and artists */
+  void RebuildSearchTokens();
   int GetSongIDFromPath(const CStdString &filePath);
 
   // Fields should be ordered as they
@@ -23,8 +23,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
+#include <algorithm>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <errno.h>
+#endif
+#if defined(TARGET_LINUX)
+#include <sys/epoll.h>
+#define HAS_EPOLL
+#endif
 
 #include "settings/AdvancedSettings.h"
 #include "interfaces/json-rpc/JSONRPC.h"
@@ -55,7 +64,34 @@ using namespace JSONRPC;
 using namespace ANNOUNCEMENT;
 //using namespace std; On VS2010, bind conflicts with std::bind
 
-#define RECEIVEBUFFER 1024
+#define RECEIVEBUFFER 4096
+// drop clients that don't read their responses and notifications
+#define SENDBUFFER_MAX (1024 * 1024)
+#define EPOLL_EVENTS 64
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static bool SocketWouldBlock()
+{
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+static bool SetNonBlocking(SOCKET fd)
+{
+#ifdef _WIN32
+  u_long nonblocking = 1;
+  return ioctlsocket(fd, FIONBIO, &nonblocking) == 0;
+#else
+  int flags = fcntl(fd, F_GETFL, 0);
+  return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+#endif
+}
 
 CTCPServer *CTCPServer::ServerInstance = NULL;
 
@@ -91,18 +127,31 @@ CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("CTCPServer")
   m_port = port;
   m_nonlocal = nonlocal;
   m_sdpd = NULL;
+  m_epoll = -1;
 }
 
 void CTCPServer::Process()
 {
   m_bStop = false;
 
+#ifdef HAS_EPOLL
+  ProcessEpoll();
+#else
+  ProcessSelect();
+#endif
+
+  Deinitialize();
+}
+
+void CTCPServer::ProcessSelect()
+{
   while (!m_bStop)
   {
     SOCKET          max_fd = 0;
-    fd_set          rfds;
+    fd_set          rfds, wfds;
     struct timeval  to     = {1, 0};
     FD_ZERO(&rfds);
+    FD_ZERO(&wfds);
 
     for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
     {
@@ -114,11 +163,13 @@ void CTCPServer::Process()
     for (unsigned int i = 0; i < m_connections.size(); i++)
     {
       FD_SET(m_connections[i]->m_socket, &rfds);
+      if (m_connections[i]->HasPendingData())
+        FD_SET(m_connections[i]->m_socket, &wfds);
       if ((intptr_t)m_connections[i]->m_socket > (intptr_t)max_fd)
         max_fd = m_connections[i]->m_socket;
     }
 
-    int res = select((intptr_t)max_fd+1, &rfds, NULL, NULL, &to);
+    int res = select((intptr_t)max_fd+1, &rfds, &wfds, NULL, &to);
     if (res < 0)
     {
       CLog::Log(LOGERROR, "JSONRPC Server: Select failed");
@@ -129,67 +180,172 @@ void CTCPServer::Process()
     {
       for (int i = m_connections.size() - 1; i >= 0; i--)
       {
-        int socket = m_connections[i]->m_socket;
-        if (FD_ISSET(socket, &rfds))
-        {
-          char buffer[RECEIVEBUFFER] = {};
-          int  nread = 0;
-          nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
-          if (nread > 0)
-          {
-            std::string response;
-            if (m_connections[i]->IsNew())
-            {
-              CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
-
-              if (response.size() > 0)
-                m_connections[i]->Send(response.c_str(), response.size());
-
-              if (websocket != NULL)
-              {
-                // Replace the CTCPClient with a CWebSocketClient
-                CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
-                delete m_connections[i];
-                m_connections.erase(m_connections.begin() + i);
-                m_connections.insert(m_connections.begin() + i, websocketClient);
-              }
-            }
-
-            if (response.size() <= 0)
-              m_connections[i]->PushBuffer(this, buffer, nread);
-
-          }
-          if (nread <= 0)
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
-            m_connections[i]->Disconnect();
-            delete m_connections[i];
-            m_connections.erase(m_connections.begin() + i);
-          }
-        }
+        SOCKET socket = m_connections[i]->m_socket;
+        bool   alive  = true;
+        if (FD_ISSET(socket, &wfds))
+          alive = m_connections[i]->SendPending();
+        if (alive && FD_ISSET(socket, &rfds))
+          alive = ReadConnection(m_connections[i]);
+        if (!alive)
+          RemoveConnection(m_connections[i]);
       }
 
       for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
       {
         if (FD_ISSET(*it, &rfds))
-        {
-          CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
-          CTCPClient *newconnection = new CTCPClient();
-          newconnection->m_socket = accept(*it, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
-
-          if (newconnection->m_socket == INVALID_SOCKET)
-            CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed");
-          else
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
-            m_connections.push_back(newconnection);
-          }
-        }
+          AcceptConnection(*it);
       }
     }
   }
+}
 
-  Deinitialize();
+#ifdef HAS_EPOLL
+void CTCPServer::ProcessEpoll()
+{
+  struct epoll_event events[EPOLL_EVENTS];
+
+  while (!m_bStop)
+  {
+    int res = epoll_wait(m_epoll, events, EPOLL_EVENTS, 1000);
+    if (res < 0)
+    {
+      if (errno == EINTR)
+        continue;
+
+      CLog::Log(LOGERROR, "JSONRPC Server: epoll_wait failed (%d)", errno);
+      Sleep(1000);
+      Initialize();
+      continue;
+    }
+
+    for (int e = 0; e < res; e++)
+    {
+      // listening sockets are registered with their fd and are level triggered, so one accept per wakeup is enough
+      std::vector<SOCKET>::iterator server = m_servers.begin();
+      while (server != m_servers.end() && events[e].data.u64 != (uint64_t)*server)
+        server++;
+      if (server != m_servers.end())
+      {
+        AcceptConnection(*server);
+        continue;
+      }
+
+      // clients are registered with their CTCPClient, whose address never equals a small fd number.
+      // They are edge triggered, ReadConnection() and SendPending() go on until the socket would block
+      CTCPClient *connection = (CTCPClient *)events[e].data.ptr;
+      bool alive = true;
+      if (events[e].events & EPOLLOUT)
+        alive = connection->SendPending();
+      if (alive && (events[e].events & (EPOLLIN | EPOLLERR | EPOLLHUP)))
+        alive = ReadConnection(connection);
+      if (!alive)
+        RemoveConnection(connection);
+    }
+  }
+}
+#endif
+
+void CTCPServer::AcceptConnection(SOCKET server)
+{
+  CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
+  CTCPClient *newconnection = new CTCPClient();
+  newconnection->m_socket = accept(server, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
+
+  if (newconnection->m_socket == INVALID_SOCKET)
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed");
+    delete newconnection;
+    return;
+  }
+
+  if (!SetNonBlocking(newconnection->m_socket))
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to set new connection non-blocking");
+    newconnection->Disconnect();
+    delete newconnection;
+    return;
+  }
+
+#ifdef HAS_EPOLL
+  struct epoll_event event = {};
+  event.events  = EPOLLIN | EPOLLOUT | EPOLLET;
+  event.data.ptr = newconnection;
+  if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, newconnection->m_socket, &event) < 0)
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to watch new connection (%d)", errno);
+    newconnection->Disconnect();
+    delete newconnection;
+    return;
+  }
+#endif
+
+  CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
+  CSingleLock lock(m_connectionLock);
+  m_connections.push_back(newconnection);
+}
+
+bool CTCPServer::ReadConnection(CTCPClient *&connection)
+{
+  char buffer[RECEIVEBUFFER];
+
+  // sockets are non-blocking, read everything there is so edge triggered polling doesn't miss data
+  while (connection->m_socket != INVALID_SOCKET)
+  {
+    int nread = recv(connection->m_socket, buffer, RECEIVEBUFFER, 0);
+    if (nread < 0 && SocketWouldBlock())
+      return true;
+
+    if (nread <= 0)
+    {
+      CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
+      return false;
+    }
+
+    std::string response;
+    if (connection->IsNew())
+    {
+      CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
+
+      if (response.size() > 0)
+        connection->Send(response.c_str(), response.size());
+
+      if (websocket != NULL)
+      {
+        // Replace the CTCPClient with a CWebSocketClient
+        CTCPClient *oldConnection = connection;
+        CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *oldConnection);
+#ifdef HAS_EPOLL
+        struct epoll_event event = {};
+        event.events   = EPOLLIN | EPOLLOUT | EPOLLET;
+        event.data.ptr = websocketClient;
+        epoll_ctl(m_epoll, EPOLL_CTL_MOD, websocketClient->m_socket, &event);
+#endif
+        CSingleLock lock(m_connectionLock);
+        std::replace(m_connections.begin(), m_connections.end(), oldConnection, (CTCPClient *)websocketClient);
+        connection = websocketClient;
+        delete oldConnection;
+      }
+    }
+
+    if (response.size() <= 0)
+      connection->PushBuffer(this, buffer, nread);
+  }
+
+  // closed from our side, e.g. websocket close handshake
+  return false;
+}
+
+void CTCPServer::RemoveConnection(CTCPClient *connection)
+{
+#ifdef HAS_EPOLL
+  if (connection->m_socket != INVALID_SOCKET)
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, connection->m_socket, NULL);
+#endif
+
+  CSingleLock lock(m_connectionLock);
+  m_connections.erase(std::find(m_connections.begin(), m_connections.end(), connection));
+  connection->Disconnect();
+  delete connection;
 }
 
 bool CTCPServer::PrepareDownload(const char *path, CVariant &details, std::string &protocol)
@@ -211,6 +367,8 @@ void CTCPServer::Announce(AnnouncementFlag flag, const char *sender, const char
 {
   std::string str = IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, g_advancedSettings.m_jsonOutputCompact);
 
+  // sending only queues the data for slow clients, so this doesn't block on any of them
+  CSingleLock connectionLock(m_connectionLock);
   for (unsigned int i = 0; i < m_connections.size(); i++)
   {
     {
@@ -232,6 +390,33 @@ bool CTCPServer::Initialize()
   started |= InitializeBlue();
   started |= InitializeTCP();
 
+#ifdef HAS_EPOLL
+  if (started)
+  {
+    m_epoll = epoll_create(32);
+    if (m_epoll < 0)
+    {
+      CLog::Log(LOGERROR, "JSONRPC Server: Failed to create epoll instance (%d)", errno);
+      started = false;
+    }
+
+    for (unsigned int i = 0; started && i < m_servers.size(); i++)
+    {
+      struct epoll_event event = {};
+      event.events  = EPOLLIN;
+      event.data.u64 = m_servers[i];
+      if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_servers[i], &event) < 0)
+      {
+        CLog::Log(LOGERROR, "JSONRPC Server: Failed to watch serversocket (%d)", errno);
+        started = false;
+      }
+    }
+
+    if (!started)
+      Deinitialize();
+  }
+#endif
+
   if(started)
   {
     CAnnouncementManager::AddAnnouncer(this);
@@ -463,19 +648,28 @@ bool CTCPServer::InitializeTCP()
 
 void CTCPServer::Deinitialize()
 {
-  for (unsigned int i = 0; i < m_connections.size(); i++)
   {
-    m_connections[i]->Disconnect();
-    delete m_connections[i];
-  }
+    CSingleLock lock(m_connectionLock);
+    for (unsigned int i = 0; i < m_connections.size(); i++)
+    {
+      m_connections[i]->Disconnect();
+      delete m_connections[i];
+    }
 
-  m_connections.clear();
+    m_connections.clear();
+  }
 
   for (unsigned int i = 0; i < m_servers.size(); i++)
     closesocket(m_servers[i]);
 
   m_servers.clear();
 
+#ifdef HAS_EPOLL
+  if (m_epoll >= 0)
+    close(m_epoll);
+  m_epoll = -1;
+#endif
+
 #ifdef HAVE_LIBBLUETOOTH
   if(m_sdpd)
     sdp_close( (sdp_session_t*)m_sdpd );
@@ -527,12 +721,57 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
 
 void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
 {
-  unsigned int sent = 0;
-  do
+  CSingleLock lock (m_critSection);
+  if (m_socket == INVALID_SOCKET)
+    return;
+
+  // anything new has to go behind what is still queued
+  if (m_sendBuffer.empty())
   {
-    CSingleLock lock (m_critSection);
-    sent += send(m_socket, data, size - sent, 0);
-  } while (sent < size);
+    int sent = send(m_socket, data, size, MSG_NOSIGNAL);
+    if (sent < 0)
+    {
+      // a broken connection is noticed and dropped by the server loop
+      if (!SocketWouldBlock())
+        return;
+      sent = 0;
+    }
+
+    data += sent;
+    size -= sent;
+    if (size == 0)
+      return;
+  }
+
+  if (m_sendBuffer.size() + size > SENDBUFFER_MAX)
+  {
+    CLog::Log(LOGWARNING, "JSONRPC Server: Client isn't reading, dropping connection");
+    m_sendBuffer.clear();
+    // wakes up the server loop, which removes the connection
+    shutdown(m_socket, SHUT_RDWR);
+    return;
+  }
+
+  m_sendBuffer.append(data, size);
+}
+
+bool CTCPServer::CTCPClient::SendPending()
+{
+  CSingleLock lock (m_critSection);
+  while (!m_sendBuffer.empty() && m_socket != INVALID_SOCKET)
+  {
+    int sent = send(m_socket, m_sendBuffer.c_str(), m_sendBuffer.size(), MSG_NOSIGNAL);
+    if (sent < 0)
+      return SocketWouldBlock();
+    m_sendBuffer.erase(0, sent);
+  }
+  return true;
+}
+
+bool CTCPServer::CTCPClient::HasPendingData()
+{
+  CSingleLock lock (m_critSection);
+  return !m_sendBuffer.empty();
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -595,6 +834,7 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
   m_beginChar         = client.m_beginChar;
   m_endChar           = client.m_endChar;
   m_buffer            = client.m_buffer;
+  m_sendBuffer        = client.m_sendBuffer;
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
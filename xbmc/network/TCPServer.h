@@ -52,6 +52,14 @@ namespace JSONRPC
     bool InitializeTCP();
     void Deinitialize();
 
+    void ProcessSelect();
+    void ProcessEpoll();
+
+    void AcceptConnection(SOCKET server);
+    class CTCPClient;
+    bool ReadConnection(CTCPClient *&connection);
+    void RemoveConnection(CTCPClient *connection);
+
     class CTCPClient : public IClient
     {
     public:
@@ -72,6 +80,13 @@ namespace JSONRPC
 
       virtual bool IsNew() const { return m_new; }
 
+      /*!
+       \brief Write out data queued while the socket was full
+       \return false if the connection failed
+       */
+      bool SendPending();
+      bool HasPendingData();
+
       SOCKET           m_socket;
       sockaddr_storage m_cliaddr;
       socklen_t        m_addrlen;
@@ -85,6 +100,7 @@ namespace JSONRPC
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+      std::string m_sendBuffer;
     };
 
     class CWebSocketClient : public CTCPClient
@@ -107,7 +123,9 @@ namespace JSONRPC
     };
 
     std::vector<CTCPClient*> m_connections;
+    CCriticalSection m_connectionLock;
     std::vector<SOCKET> m_servers;
+    int m_epoll;
     int m_port;
     bool m_nonlocal;
     void* m_sdpd;
@@ -22,6 +22,7 @@
 
 #include "threads/SystemClock.h"
 #include "UPnP.h"
+#include "UPnPBrowseCache.h"
 #include "utils/URIUtils.h"
 #include "Application.h"
 
@@ -59,6 +60,7 @@
 #include "utils/md5.h"
 #include "guilib/Key.h"
 #include "ThumbLoader.h"
+#include "threads/SingleLock.h"
 
 using namespace std;
 using namespace MUSIC_INFO;
@@ -306,7 +308,8 @@ private:
                                    NPT_UInt32                    requested_count,
                                    const NPT_List<NPT_String>&   sort_criteria,
                                    const PLT_HttpRequestContext& context,
-                                   const char*                   parent_id /* = NULL */);
+                                   const char*                   parent_id = NULL,
+                                   bool                          use_cache = false);
 
     // class methods
     static NPT_String GetParentFolder(NPT_String file_path) {
@@ -322,6 +325,8 @@ private:
     NPT_Mutex                       m_FileMutex;
     NPT_Map<NPT_String, NPT_String> m_FileMap;
 
+    CUPnPBrowseCache                m_BrowseCache;
+
 public:
     // class members
     static NPT_UInt32 m_MaxReturnedItems;
@@ -1073,13 +1078,25 @@ CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action,
                                     const NPT_List<NPT_String>&   sort_criteria,
                                     const PLT_HttpRequestContext& context)
 {
-    CFileItemList items;
-    NPT_String    parent_id = TranslateWMPObjectId(object_id);
+    NPT_String         parent_id = TranslateWMPObjectId(object_id);
+    unsigned int       start = XbmcThreads::SystemClockMillis();
+    bool               cacheable = CUPnPBrowseCache::IsCacheable((const char*)parent_id);
+    CUPnPBrowseListPtr list;
 
     CLog::Log(LOGINFO, "Received UPnP Browse DirectChildren request for object '%s'", (const char*)object_id);
 
-    items.SetPath(CStdString(parent_id));
-    if (!items.Load()) {
+    // clients page through containers, only list and sort them once
+    if (cacheable)
+        list = m_BrowseCache.GetChildren((const char*)parent_id);
+
+    bool cached = (list.get() != NULL);
+    if (!cached)
+        list.reset(new CUPnPBrowseList);
+
+    CFileItemList& items = list->items;
+    if (!cached)
+        items.SetPath(CStdString(parent_id));
+    if (!cached && !items.Load()) {
         // cache anything that takes more than a second to retrieve
       unsigned int time = XbmcThreads::SystemClockMillis();
 
@@ -1110,11 +1127,17 @@ CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action,
     // Always sort by label
     items.Sort(SORT_METHOD_LABEL, SORT_ORDER_ASC);
 
+    if (!cached && cacheable)
+        m_BrowseCache.SetChildren((const char*)parent_id, list);
+
     // Don't pass parent_id if action is Search not BrowseDirectChildren, as
     // we want the engine to determine the best parent id, not necessarily the one
     // passed
     NPT_String action_name = action->GetActionDesc().GetName();
-    return BuildResponse(
+
+    // building objects updates the items, which may be shared with other requests
+    CSingleLock lock(list->lock);
+    NPT_Result result = BuildResponse(
         action,
         items,
         filter,
@@ -1122,7 +1145,16 @@ CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action,
         requested_count,
         sort_criteria,
         context,
-        (action_name.Compare("Search", true)==0)?NULL:parent_id.GetChars());
+        (action_name.Compare("Search", true)==0)?NULL:parent_id.GetChars(),
+        cacheable);
+
+    CLog::Log(LOGDEBUG, "UPnP Browse DirectChildren of '%s' @ %d out of %d %s took %u ms",
+        (const char*)parent_id,
+        starting_index,
+        items.Size(),
+        cached?"cached children":"listed children",
+        XbmcThreads::SystemClockMillis() - start);
+    return result;
 }
 
 /*----------------------------------------------------------------------
@@ -1136,7 +1168,8 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
                            NPT_UInt32                    requested_count,
                            const NPT_List<NPT_String>&   sort_criteria,
                            const PLT_HttpRequestContext& context,
-                           const char*                   parent_id /* = NULL */)
+                           const char*                   parent_id /* = NULL */,
+                           bool                          use_cache /* = false */)
 {
     NPT_COMPILER_UNUSED(sort_criteria);
 
@@ -1150,17 +1183,41 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
     NPT_UInt32 max_count  = (requested_count == 0)?m_MaxReturnedItems:min((unsigned long)requested_count, (unsigned long)m_MaxReturnedItems);
     NPT_UInt32 stop_index = min((unsigned long)(starting_index + max_count), (unsigned long)items.Size()); // don't return more than we can
 
+    // the didl of an item depends on the request as well, see BuildObject
+    CStdString flavour;
+    if (use_cache) {
+        flavour.Format("|%s|%s|%s|%d",
+            parent_id?parent_id:"",
+            filter?filter:"",
+            (const char*)context.GetLocalAddress().GetIpAddress().ToString(),
+            (int)GetClientQuirks(&context));
+    }
+
     NPT_Cardinal count = 0;
+    NPT_Cardinal built = 0;
     NPT_String didl = didl_header;
     PLT_MediaObjectReference object;
     for (unsigned long i=starting_index; i<stop_index; ++i) {
-        object = Build(items[i], true, context, parent_id);
-        if (object.IsNull()) {
-            continue;
+        NPT_String  tmp;
+        std::string key, fragment;
+        if (use_cache) {
+            // keyed below the container, so invalidating the library reaches items with a file path too
+            key = items.GetPath() + "|" + items[i]->GetPath() + flavour;
+            if (m_BrowseCache.GetFragment(key, fragment))
+                tmp.Assign(fragment.c_str(), fragment.size());
         }
 
-        NPT_String tmp;
-        NPT_CHECK(PLT_Didl::ToDidl(*object.AsPointer(), filter, tmp));
+        if (tmp.IsEmpty()) {
+            object = Build(items[i], true, context, parent_id);
+            if (object.IsNull()) {
+                continue;
+            }
+
+            NPT_CHECK(PLT_Didl::ToDidl(*object.AsPointer(), filter, tmp));
+            if (use_cache)
+                m_BrowseCache.SetFragment(key, std::string(tmp.GetChars(), tmp.GetLength()));
+            ++built;
+        }
 
         // Neptunes string growing is dead slow for small additions
         if (didl.GetCapacity() < tmp.GetLength() + didl.GetLength()) {
@@ -1172,8 +1229,9 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
 
     didl += didl_footer;
 
-    CLog::Log(LOGDEBUG, "Returning UPnP response with %d items out of %d total matches",
+    CLog::Log(LOGDEBUG, "Returning UPnP response with %d items (%d built) out of %d total matches",
         count,
+        built,
         items.Size());
 
     NPT_CHECK(action->SetArgumentValue("Result", didl));
@@ -0,0 +1,193 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "UPnPBrowseCache.h"
+#include "interfaces/AnnouncementManager.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include <vector>
+
+using namespace std;
+using namespace ANNOUNCEMENT;
+
+// per shard limits, giving at most 128 containers and 24k items overall
+#define MAX_LISTS_PER_SHARD     8
+#define MAX_FRAGMENTS_PER_SHARD 1536
+
+CUPnPBrowseCache::CUPnPBrowseCache()
+{
+  for (unsigned int i = 0; i < NUM_SHARDS; i++)
+    m_shards[i].m_stamp = 0;
+  CAnnouncementManager::AddAnnouncer(this);
+}
+
+CUPnPBrowseCache::~CUPnPBrowseCache()
+{
+  CAnnouncementManager::RemoveAnnouncer(this);
+}
+
+bool CUPnPBrowseCache::IsCacheable(const string &id)
+{
+  // only the library is told about changes, plain shares may change behind our back
+  return id.compare(0, 10, "musicdb://") == 0
+      || id.compare(0, 10, "videodb://") == 0
+      || id.compare(0, 22, "virtualpath://upnproot") == 0;
+}
+
+CUPnPBrowseCache::CShard &CUPnPBrowseCache::GetShard(const string &key)
+{
+  // fnv-1a
+  unsigned int hash = 2166136261U;
+  for (string::const_iterator it = key.begin(); it != key.end(); ++it)
+    hash = (hash ^ (unsigned char)*it) * 16777619U;
+  return m_shards[hash % NUM_SHARDS];
+}
+
+CUPnPBrowseListPtr CUPnPBrowseCache::GetChildren(const string &id)
+{
+  CShard &shard = GetShard(id);
+  CSingleLock lock(shard.m_section);
+  map<string, CachedList>::iterator it = shard.m_lists.find(id);
+  if (it == shard.m_lists.end())
+    return CUPnPBrowseListPtr();
+
+  it->second.stamp = ++shard.m_stamp;
+  return it->second.list;
+}
+
+void CUPnPBrowseCache::SetChildren(const string &id, const CUPnPBrowseListPtr &list)
+{
+  CShard &shard = GetShard(id);
+  CSingleLock lock(shard.m_section);
+
+  if (shard.m_lists.size() >= MAX_LISTS_PER_SHARD && shard.m_lists.find(id) == shard.m_lists.end())
+  {
+    // evict the least recently browsed container
+    map<string, CachedList>::iterator oldest = shard.m_lists.begin();
+    for (map<string, CachedList>::iterator it = shard.m_lists.begin(); it != shard.m_lists.end(); ++it)
+    {
+      if (it->second.stamp < oldest->second.stamp)
+        oldest = it;
+    }
+    shard.m_lists.erase(oldest);
+  }
+
+  CachedList &entry = shard.m_lists[id];
+  entry.list  = list;
+  entry.stamp = ++shard.m_stamp;
+}
+
+bool CUPnPBrowseCache::GetFragment(const string &key, string &didl)
+{
+  CShard &shard = GetShard(key);
+  CSingleLock lock(shard.m_section);
+  map<string, CachedFragment>::iterator it = shard.m_fragments.find(key);
+  if (it == shard.m_fragments.end())
+    return false;
+
+  shard.m_fragmentsByStamp.erase(it->second.stamp);
+  it->second.stamp = ++shard.m_stamp;
+  shard.m_fragmentsByStamp[it->second.stamp] = key;
+  didl = it->second.didl;
+  return true;
+}
+
+void CUPnPBrowseCache::SetFragment(const string &key, const string &didl)
+{
+  CShard &shard = GetShard(key);
+  CSingleLock lock(shard.m_section);
+
+  map<string, CachedFragment>::iterator it = shard.m_fragments.find(key);
+  if (it != shard.m_fragments.end())
+    shard.m_fragmentsByStamp.erase(it->second.stamp);
+  else if (shard.m_fragments.size() >= MAX_FRAGMENTS_PER_SHARD)
+  {
+    // evict the least recently used fragment
+    map<unsigned int, string>::iterator oldest = shard.m_fragmentsByStamp.begin();
+    shard.m_fragments.erase(oldest->second);
+    shard.m_fragmentsByStamp.erase(oldest);
+  }
+
+  CachedFragment &entry = shard.m_fragments[key];
+  entry.didl  = didl;
+  entry.stamp = ++shard.m_stamp;
+  shard.m_fragmentsByStamp[entry.stamp] = key;
+}
+
+void CUPnPBrowseCache::Invalidate(const string &prefix)
+{
+  vector<CUPnPBrowseListPtr> dropped;
+
+  for (unsigned int i = 0; i < NUM_SHARDS; i++)
+  {
+    CShard &shard = m_shards[i];
+    CSingleLock lock(shard.m_section);
+
+    for (map<string, CachedList>::iterator it = shard.m_lists.lower_bound(prefix);
+         it != shard.m_lists.end() && it->first.compare(0, prefix.size(), prefix) == 0; )
+    {
+      dropped.push_back(it->second.list);
+      shard.m_lists.erase(it++);
+    }
+
+    for (map<string, CachedFragment>::iterator it = shard.m_fragments.lower_bound(prefix);
+         it != shard.m_fragments.end() && it->first.compare(0, prefix.size(), prefix) == 0; )
+    {
+      shard.m_fragmentsByStamp.erase(it->second.stamp);
+      shard.m_fragments.erase(it++);
+    }
+  }
+
+  // slow listings are also kept on disc, don't let them come back from there
+  for (vector<CUPnPBrowseListPtr>::iterator it = dropped.begin(); it != dropped.end(); ++it)
+    (*it)->items.RemoveDiscCache();
+
+  if (!dropped.empty())
+    CLog::Log(LOGDEBUG, "%s - dropped %u containers below %s", __FUNCTION__, (unsigned int)dropped.size(), prefix.c_str());
+}
+
+void CUPnPBrowseCache::Clear()
+{
+  for (unsigned int i = 0; i < NUM_SHARDS; i++)
+  {
+    CSingleLock lock(m_shards[i].m_section);
+    m_shards[i].m_lists.clear();
+    m_shards[i].m_fragments.clear();
+    m_shards[i].m_fragmentsByStamp.clear();
+  }
+}
+
+void CUPnPBrowseCache::Announce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+{
+  if (strcmp(sender, "xbmc") != 0)
+    return;
+
+  if (strcmp(message, "OnUpdate") != 0 &&
+      strcmp(message, "OnRemove") != 0 &&
+      strcmp(message, "OnScanFinished") != 0 &&
+      strcmp(message, "OnChanged") != 0)
+    return;
+
+  if (flag == AudioLibrary)
+    Invalidate("musicdb://");
+  else if (flag == VideoLibrary)
+    Invalidate("videodb://");
+}
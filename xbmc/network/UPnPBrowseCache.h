@@ -0,0 +1,123 @@
+#pragma once
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <map>
+#include <string>
+#include "FileItem.h"
+#include "interfaces/IAnnouncer.h"
+#include "threads/CriticalSection.h"
+
+/*!
+ \brief Sorted children of a container, shared between browse requests
+
+ Building DIDL for an item updates the item (labels, tags, thumbs), so users
+ of the list must hold the lock while they access its items.
+ */
+class CUPnPBrowseList
+{
+public:
+  CFileItemList    items;
+  CCriticalSection lock;
+};
+
+typedef boost::shared_ptr<CUPnPBrowseList> CUPnPBrowseListPtr;
+
+/*!
+ \brief Cache of library containers and their serialized DIDL, for the UPnP server
+
+ Holds the label sorted children of library containers by object id, and the
+ DIDL fragment of each item built for a given request flavour, so paging
+ through a large container only costs building the requested page once.
+ Entries are spread over a number of shards with their own lock so that
+ concurrent browse requests don't serialize on a single lock.
+
+ Fragments are keyed below the object id of their container, so library
+ entries, containers and fragments alike, are dropped when the audio or video
+ library announces an update, removal or finished scan. When a shard is full
+ the least recently used entry makes room.
+ */
+class CUPnPBrowseCache : public ANNOUNCEMENT::IAnnouncer
+{
+public:
+  CUPnPBrowseCache();
+  virtual ~CUPnPBrowseCache();
+
+  /*! \brief Whether listings of the given container are cached */
+  static bool IsCacheable(const std::string &id);
+
+  /*!
+   \brief Get the cached children of a container
+   \param id object id of the container
+   \return the cached list, or an empty pointer if it isn't cached
+   */
+  CUPnPBrowseListPtr GetChildren(const std::string &id);
+
+  /*!
+   \brief Cache the sorted children of a container
+   \param id object id of the container
+   \param list the sorted children
+   */
+  void SetChildren(const std::string &id, const CUPnPBrowseListPtr &list);
+
+  /*!
+   \brief Look up the DIDL of an item
+   \param key object id of the container, then the item path and whatever else the DIDL depends on
+   \param didl the cached DIDL fragment
+   \return true if the fragment was cached
+   */
+  bool GetFragment(const std::string &key, std::string &didl);
+  void SetFragment(const std::string &key, const std::string &didl);
+
+  /*! \brief Drop all entries of containers and items below the given path */
+  void Invalidate(const std::string &prefix);
+  void Clear();
+
+  virtual void Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+
+private:
+  struct CachedList
+  {
+    CUPnPBrowseListPtr list;
+    unsigned int       stamp;
+  };
+
+  struct CachedFragment
+  {
+    std::string  didl;
+    unsigned int stamp;
+  };
+
+  class CShard
+  {
+  public:
+    CCriticalSection                   m_section;
+    std::map<std::string, CachedList>  m_lists;
+    std::map<std::string, CachedFragment> m_fragments;
+    std::map<unsigned int, std::string>   m_fragmentsByStamp; ///< keys of m_fragments, least recently used first
+    unsigned int                          m_stamp;
+  };
+
+  CShard &GetShard(const std::string &key);
+
+  enum { NUM_SHARDS = 16 };
+  CShard m_shards[NUM_SHARDS];
+};
@@ -33,11 +33,12 @@
 #include "utils/URIUtils.h"
 #include "settings/Settings.h"
 #include "settings/AdvancedSettings.h"
+#include "ThumbExtractorService.h"
 
 using namespace XFILE;
 using namespace std;
 
-CPictureThumbLoader::CPictureThumbLoader() : CThumbLoader(1), CJobQueue(true)
+CPictureThumbLoader::CPictureThumbLoader() : CThumbLoader(1)
 {
   m_regenerateThumbs = false;
 }
@@ -45,6 +46,7 @@ CPictureThumbLoader::CPictureThumbLoader() : CThumbLoader(1), CJobQueue(true)
 CPictureThumbLoader::~CPictureThumbLoader()
 {
   StopThread();
+  CThumbExtractorService::Get().Detach(this);
 }
 
 bool CPictureThumbLoader::LoadItem(CFileItem* pItem)
@@ -79,7 +81,7 @@ bool CPictureThumbLoader::LoadItem(CFileItem* pItem)
       {
         CFileItem item(*pItem);
         CThumbExtractor* extract = new CThumbExtractor(item, pItem->GetPath(), true, thumbURL);
-        AddJob(extract);
+        CThumbExtractorService::Get().AddJob(extract, this);
         thumb.clear();
       }
     }
@@ -107,7 +109,6 @@ void CPictureThumbLoader::OnJobComplete(unsigned int jobID, bool success, CJob*
     CGUIMessage msg(GUI_MSG_NOTIFY_ALL, 0, 0, GUI_MSG_UPDATE_ITEM, 0, pItem);
     g_windowManager.SendThreadMessage(msg);
   }
-  CJobQueue::OnJobComplete(jobID, success, job);
 }
 
 
@@ -23,7 +23,7 @@
 #include "utils/StdString.h"
 #include "ThumbLoader.h"
 
-class CPictureThumbLoader : public CThumbLoader, public CJobQueue
+class CPictureThumbLoader : public CThumbLoader, public IJobCallback
 {
 public:
   CPictureThumbLoader();
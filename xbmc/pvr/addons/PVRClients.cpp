@@ -494,7 +494,6 @@ CStdString CPVRClients::GetStreamURL(const CPVRChannel &tag)
 bool CPVRClients::SwitchChannel(const CPVRChannel &channel)
 {
   bool bSwitchSuccessful(false);
-  bool bNewStreamOpened(false);
 
   {
     CSingleLock lock(m_critSection);
@@ -522,11 +521,14 @@ bool CPVRClients::SwitchChannel(const CPVRChannel &channel)
       }
       else if (!channel.StreamURL().IsEmpty() || !currentChannel.StreamURL().IsEmpty())
       {
-        // StreamURL should always be opened as a new file
-        CFileItem m_currentFile(channel);
-        g_application.getApplicationMessenger().PlayFile(m_currentFile, false);
-        bSwitchSuccessful = true;
-        bNewStreamOpened = true;
+        // the player reads channels with a StreamURL through an input stream of its own, which
+        // it opens after the switch or took open from the channels it opened in advance. the
+        // live stream of the client is only kept open for channels read through the client
+        CloseLiveStream();
+        if (channel.StreamURL().IsEmpty())
+          bSwitchSuccessful = OpenLiveStream(channel);
+        else
+          bSwitchSuccessful = true;
       }
       else
       {
@@ -544,7 +546,7 @@ bool CPVRClients::SwitchChannel(const CPVRChannel &channel)
   {
     CSingleLock lock(m_critSection);
     m_bIsSwitchingChannels = false;
-    if (bSwitchSuccessful && !bNewStreamOpened)
+    if (bSwitchSuccessful)
     {
       m_currentChannel = channel;
       m_bIsPlayingLiveTV = true;
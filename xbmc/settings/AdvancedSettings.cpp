@@ -100,7 +100,10 @@ void CAdvancedSettings::Initialize()
   m_videoAutoScaleMaxFps = 30.0f;
   m_videoAllowMpeg4VDPAU = false;
   m_videoAllowMpeg4VAAPI = false;  
+  m_videoFFmpegFrameThreading = false;
+  m_videoExtractionThreads = 0; // auto
   m_videoDisableBackgroundDeinterlace = false;
+  m_videoTelemetryCSV = false;
   m_videoCaptureUseOcclusionQuery = -1; //-1 is auto detect
   m_DXVACheckCompatibility = false;
   m_DXVACheckCompatibilityPresent = false;
@@ -184,6 +187,7 @@ void CAdvancedSettings::Initialize()
   m_thumbSize = DEFAULT_THUMB_SIZE;
   m_fanartHeight = DEFAULT_FANART_HEIGHT;
   m_useDDSFanart = false;
+  m_precacheMaxCPU = 50;
 
   m_sambaclienttimeout = 10;
   m_sambadoscodepage = "";
@@ -267,6 +271,9 @@ void CAdvancedSettings::Initialize()
   m_RestrictCapsMask = 0;
   m_sleepBeforeFlip = 0;
   m_bVirtualShares = true;
+  m_compactFileItemCache = true;
+  m_pythonIdleInterpreters = 1;
+  m_pluginResultCacheTime = 120;
 
 //caused lots of jerks
 //#ifdef _WIN32
@@ -293,6 +300,7 @@ void CAdvancedSettings::Initialize()
   m_iPVRMinVideoCacheLevel         = 5;
   m_iPVRMinAudioCacheLevel         = 5;
   m_bPVRCacheInDvdPlayer           = true;
+  m_iPVRZapPrefetch                = 0;
 
   m_measureRefreshrate = false;
 
@@ -479,7 +487,10 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetFloat(pElement,"autoscalemaxfps",m_videoAutoScaleMaxFps, 0.0f, 1000.0f);
     XMLUtils::GetBoolean(pElement,"allowmpeg4vdpau",m_videoAllowMpeg4VDPAU);
     XMLUtils::GetBoolean(pElement,"allowmpeg4vaapi",m_videoAllowMpeg4VAAPI);    
+    XMLUtils::GetBoolean(pElement,"ffmpegframethreading",m_videoFFmpegFrameThreading);
+    XMLUtils::GetInt(pElement, "extractionthreads", m_videoExtractionThreads, 0, 8);
     XMLUtils::GetBoolean(pElement, "disablebackgrounddeinterlace", m_videoDisableBackgroundDeinterlace);
+    XMLUtils::GetBoolean(pElement, "telemetrycsv", m_videoTelemetryCSV);
     XMLUtils::GetInt(pElement, "useocclusionquery", m_videoCaptureUseOcclusionQuery, -1, 1);
 
     TiXmlElement* pAdjustRefreshrate = pElement->FirstChildElement("adjustrefreshrate");
@@ -747,6 +758,9 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   XMLUtils::GetUInt(pRootElement,"restrictcapsmask", m_RestrictCapsMask);
   XMLUtils::GetFloat(pRootElement,"sleepbeforeflip", m_sleepBeforeFlip, 0.0f, 1.0f);
   XMLUtils::GetBoolean(pRootElement,"virtualshares", m_bVirtualShares);
+  XMLUtils::GetBoolean(pRootElement,"compactfileitemcache", m_compactFileItemCache);
+  XMLUtils::GetInt(pRootElement, "pythonidleinterpreters", m_pythonIdleInterpreters, 0, 8);
+  XMLUtils::GetInt(pRootElement, "pluginresultcachetime", m_pluginResultCacheTime, 0, 3600);
 
   //Tuxbox
   pElement = pRootElement->FirstChildElement("tuxbox");
@@ -904,6 +918,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   XMLUtils::GetInt(pRootElement, "thumbsize", m_thumbSize, 0, 1024);
   XMLUtils::GetInt(pRootElement, "fanartheight", m_fanartHeight, 0, 1080);
   XMLUtils::GetBoolean(pRootElement, "useddsfanart", m_useDDSFanart);
+  XMLUtils::GetInt(pRootElement, "precachemaxcpu", m_precacheMaxCPU, 0, 100);
 
   XMLUtils::GetBoolean(pRootElement, "playlistasfolders", m_playlistAsFolders);
   XMLUtils::GetBoolean(pRootElement, "detectasudf", m_detectAsUdf);
@@ -970,6 +985,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetInt(pPVR, "minvideocachelevel", m_iPVRMinVideoCacheLevel, 0, 100);
     XMLUtils::GetInt(pPVR, "minaudiocachelevel", m_iPVRMinAudioCacheLevel, 0, 100);
     XMLUtils::GetBoolean(pPVR, "cacheindvdplayer", m_bPVRCacheInDvdPlayer);
+    XMLUtils::GetInt(pPVR, "zapprefetch", m_iPVRZapPrefetch, 0, 2);
   }
 
   XMLUtils::GetBoolean(pRootElement, "measurerefreshrate", m_measureRefreshrate);
@@ -141,10 +141,13 @@ class CAdvancedSettings
     float m_videoAutoScaleMaxFps;
     bool  m_videoAllowMpeg4VDPAU;
     bool  m_videoAllowMpeg4VAAPI;
+    bool  m_videoFFmpegFrameThreading;
+    int   m_videoExtractionThreads;
     std::vector<RefreshOverride> m_videoAdjustRefreshOverrides;
     std::vector<RefreshVideoLatency> m_videoRefreshLatency;
     float m_videoDefaultLatency;
     bool m_videoDisableBackgroundDeinterlace;
+    bool m_videoTelemetryCSV; ///< \brief write the timings of the last frames played to special://temp/dvdplayer-telemetry.csv
     int  m_videoCaptureUseOcclusionQuery;
     bool m_DXVACheckCompatibility;
     bool m_DXVACheckCompatibilityPresent;
@@ -206,6 +209,7 @@ class CAdvancedSettings
     int m_thumbSize;
     int m_fanartHeight;
     bool m_useDDSFanart;
+    int m_precacheMaxCPU; ///< \brief cpu usage in percent above which library art isn't cached ahead, 0 to not cache it ahead
 
     int m_sambaclienttimeout;
     CStdString m_sambadoscodepage;
@@ -298,6 +302,9 @@ class CAdvancedSettings
     unsigned int m_RestrictCapsMask;
     float m_sleepBeforeFlip; ///< if greather than zero, XBMC waits for raster to be this amount through the frame prior to calling the flip
     bool m_bVirtualShares;
+    bool m_compactFileItemCache; ///< store directory listings on disc in the memory mappable format rather than through CArchive
+    int m_pythonIdleInterpreters; ///< python interpreters kept per plugin for its next directory listing, 0 to start a new one each time
+    int m_pluginResultCacheTime;  ///< seconds listings of plugins that allow caching them are kept in memory, 0 to disable
 
     float m_karaokeSyncDelayCDG; // seems like different delay is needed for CDG and MP3s
     float m_karaokeSyncDelayLRC;
@@ -320,6 +327,7 @@ class CAdvancedSettings
     int m_iPVRMinVideoCacheLevel;      /*!< @brief cache up to this level in the video buffer buffer before resuming playback if the buffers run dry */
     int m_iPVRMinAudioCacheLevel;      /*!< @brief cache up to this level in the audio buffer before resuming playback if the buffers run dry */
     bool m_bPVRCacheInDvdPlayer; /*!< @brief true to use "CACHESTATE_PVR" in CDVDPlayer (default) */
+    int m_iPVRZapPrefetch;       /*!< @brief number of channels next to the playing one, next and previous, to open in advance. only channels with their own stream url are. defaults to 0. */
 
     bool m_measureRefreshrate; //when true the videoreferenceclock will measure the refreshrate when direct3d is used
                                //otherwise it will use the windows refreshrate
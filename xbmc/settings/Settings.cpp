@@ -56,6 +56,7 @@
 #include "input/MouseStat.h"
 #include "filesystem/File.h"
 #include "filesystem/DirectoryCache.h"
+#include "TexturePrecacher.h"
 
 using namespace std;
 using namespace XFILE;
@@ -974,6 +975,8 @@ bool CSettings::LoadProfile(unsigned int index)
     CUtil::DeleteDirectoryCache();
     g_directoryCache.Clear();
 
+    CTexturePrecacher::Get().Restart();
+
     return true;
   }
 
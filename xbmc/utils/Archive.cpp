@@ -31,6 +31,29 @@ CArchive::CArchive(CFile* pFile, int mode)
 {
   m_pFile = pFile;
   m_iMode = mode;
+  m_pMemory = NULL;
+  m_pData = NULL;
+  m_DataSize = 0;
+  m_DataPos = 0;
+
+  m_pBuffer = NULL;
+  if (m_iMode == store)
+  {
+    m_pBuffer = new BYTE[BUFFER_MAX];
+    memset(m_pBuffer, 0, BUFFER_MAX);
+  }
+
+  m_BufferPos = 0;
+}
+
+CArchive::CArchive(std::string &buffer)
+{
+  m_pFile = NULL;
+  m_iMode = store;
+  m_pMemory = &buffer;
+  m_pData = NULL;
+  m_DataSize = 0;
+  m_DataPos = 0;
 
   m_pBuffer = new BYTE[BUFFER_MAX];
   memset(m_pBuffer, 0, BUFFER_MAX);
@@ -38,6 +61,18 @@ CArchive::CArchive(CFile* pFile, int mode)
   m_BufferPos = 0;
 }
 
+CArchive::CArchive(const uint8_t *data, unsigned int size)
+{
+  m_pFile = NULL;
+  m_iMode = load;
+  m_pMemory = NULL;
+  m_pData = data;
+  m_DataSize = size;
+  m_DataPos = 0;
+  m_pBuffer = NULL;
+  m_BufferPos = 0;
+}
+
 CArchive::~CArchive()
 {
   FlushBuffer();
@@ -285,56 +320,56 @@ CArchive& CArchive::operator<<(const std::vector<int>& iArray)
 
 CArchive& CArchive::operator>>(float& f)
 {
-  m_pFile->Read((void*)&f, sizeof(float));
+  Read((void*)&f, sizeof(float));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(double& d)
 {
-  m_pFile->Read((void*)&d, sizeof(double));
+  Read((void*)&d, sizeof(double));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(int& i)
 {
-  m_pFile->Read((void*)&i, sizeof(int));
+  Read((void*)&i, sizeof(int));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(unsigned int& i)
 {
-  m_pFile->Read((void*)&i, sizeof(unsigned int));
+  Read((void*)&i, sizeof(unsigned int));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(int64_t& i64)
 {
-  m_pFile->Read((void*)&i64, sizeof(int64_t));
+  Read((void*)&i64, sizeof(int64_t));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(uint64_t& ui64)
 {
-  m_pFile->Read((void*)&ui64, sizeof(uint64_t));
+  Read((void*)&ui64, sizeof(uint64_t));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(bool& b)
 {
-  m_pFile->Read((void*)&b, sizeof(bool));
+  Read((void*)&b, sizeof(bool));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(char& c)
 {
-  m_pFile->Read((void*)&c, sizeof(char));
+  Read((void*)&c, sizeof(char));
 
   return *this;
 }
@@ -344,7 +379,9 @@ CArchive& CArchive::operator>>(CStdString& str)
   int iLength = 0;
   *this >> iLength;
 
-  m_pFile->Read((void*)str.GetBufferSetLength(iLength), iLength);
+  if (!CanRead(iLength))
+    iLength = 0;
+  Read((void*)str.GetBufferSetLength(iLength), iLength);
   str.ReleaseBuffer();
 
 
@@ -356,7 +393,9 @@ CArchive& CArchive::operator>>(CStdStringW& str)
   int iLength = 0;
   *this >> iLength;
 
-  m_pFile->Read((void*)str.GetBufferSetLength(iLength), iLength);
+  if (!CanRead(iLength))
+    iLength = 0;
+  Read((void*)str.GetBufferSetLength(iLength), iLength);
   str.ReleaseBuffer();
 
 
@@ -365,7 +404,7 @@ CArchive& CArchive::operator>>(CStdStringW& str)
 
 CArchive& CArchive::operator>>(SYSTEMTIME& time)
 {
-  m_pFile->Read((void*)&time, sizeof(SYSTEMTIME));
+  Read((void*)&time, sizeof(SYSTEMTIME));
 
   return *this;
 }
@@ -489,7 +528,35 @@ void CArchive::FlushBuffer()
 {
   if (m_BufferPos > 0)
   {
-    m_pFile->Write(m_pBuffer, m_BufferPos);
+    if (m_pMemory)
+      m_pMemory->append((const char *)m_pBuffer, m_BufferPos);
+    else
+      m_pFile->Write(m_pBuffer, m_BufferPos);
     m_BufferPos = 0;
   }
 }
+
+void CArchive::Read(void *data, unsigned int size)
+{
+  if (m_pFile)
+  {
+    m_pFile->Read(data, size);
+    return;
+  }
+
+  // reads past the end of a memory buffer give zeroes, same as a short file read leaves the value alone
+  unsigned int available = std::min(size, m_DataSize - m_DataPos);
+  memcpy(data, m_pData + m_DataPos, available);
+  if (available < size)
+    memset((uint8_t *)data + available, 0, size - available);
+  m_DataPos += available;
+}
+
+bool CArchive::CanRead(int64_t size) const
+{
+  if (size < 0)
+    return false;
+  if (m_pFile)
+    return true;
+  return size <= (int64_t)(m_DataSize - m_DataPos);
+}
@@ -21,6 +21,7 @@
  *
  */
 
+#include <string>
 #include "StdString.h"
 #include "system.h" // for SYSTEMTIME
 
@@ -43,6 +44,10 @@ class CArchive
 {
 public:
   CArchive(XFILE::CFile* pFile, int mode);
+  /*! \brief Store into the given buffer, which is appended to on Close() */
+  CArchive(std::string &buffer);
+  /*! \brief Load from a buffer in memory, which must outlive the archive */
+  CArchive(const uint8_t *data, unsigned int size);
   ~CArchive();
   // storing
   CArchive& operator<<(float f);
@@ -87,9 +92,15 @@ public:
 
 protected:
   void FlushBuffer();
+  void Read(void *data, unsigned int size);
+  bool CanRead(int64_t size) const;
   XFILE::CFile* m_pFile;
   int m_iMode;
   uint8_t *m_pBuffer;
   int m_BufferPos;
+  std::string *m_pMemory;
+  const uint8_t *m_pData;
+  unsigned int m_DataSize;
+  unsigned int m_DataPos;
 };
 
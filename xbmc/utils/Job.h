@@ -20,6 +20,8 @@
  *
  */
 
+#include <string>
+
 class CJob;
 
 /*!
@@ -145,6 +147,18 @@ public:
     return false;
   }
 
+  /*!
+   \brief Function that returns a key identifying equal jobs.
+
+   CJob subclasses that implement operator== may also implement this function, returning a key
+   that is the same exactly when the jobs compare equal.  CJobQueue then finds duplicate jobs by
+   their key instead of comparing the job with every queued job.
+
+   \return the key of the job, or an empty string to compare jobs with operator==.
+   \sa CJobQueue
+   */
+  virtual std::string GetKey() const { return ""; };
+
   /*!
    \brief Function for longer jobs to report progress and check whether they have been cancelled.
    
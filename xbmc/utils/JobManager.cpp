@@ -97,7 +97,10 @@ void CJobQueue::OnJobComplete(unsigned int jobID, bool success, CJob *job)
   // check if this job is in our processing list
   Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
   if (i != m_processing.end())
+  {
+    m_keys.erase(i->m_key);
     m_processing.erase(i);
+  }
   // request a new job be queued
   QueueNextJob();
 }
@@ -108,6 +111,7 @@ void CJobQueue::CancelJob(const CJob *job)
   Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
   if (i != m_processing.end())
   {
+    m_keys.erase(i->m_key);
     i->CancelJob();
     m_processing.erase(i);
     return;
@@ -115,6 +119,7 @@ void CJobQueue::CancelJob(const CJob *job)
   Queue::iterator j = find(m_jobQueue.begin(), m_jobQueue.end(), job);
   if (j != m_jobQueue.end())
   {
+    m_keys.erase(j->m_key);
     j->FreeJob();
     m_jobQueue.erase(j);
   }
@@ -124,17 +129,19 @@ void CJobQueue::AddJob(CJob *job)
 {
   CSingleLock lock(m_section);
   // check if we have this job already.  If so, we're done.
-  if (find(m_jobQueue.begin(), m_jobQueue.end(), job) != m_jobQueue.end() ||
-      find(m_processing.begin(), m_processing.end(), job) != m_processing.end())
+  std::string key = job->GetKey();
+  if (!key.empty() ? !m_keys.insert(key).second :
+      (find(m_jobQueue.begin(), m_jobQueue.end(), job) != m_jobQueue.end() ||
+       find(m_processing.begin(), m_processing.end(), job) != m_processing.end()))
   {
     delete job;
     return;
   }
 
   if (m_lifo)
-    m_jobQueue.push_back(CJobPointer(job));
+    m_jobQueue.push_back(CJobPointer(job, key));
   else
-    m_jobQueue.push_front(CJobPointer(job));
+    m_jobQueue.push_front(CJobPointer(job, key));
   QueueNextJob();
 }
 
@@ -157,6 +164,7 @@ void CJobQueue::CancelJobs()
   for_each(m_jobQueue.begin(), m_jobQueue.end(), mem_fun_ref(&CJobPointer::FreeJob));
   m_jobQueue.clear();
   m_processing.clear();
+  m_keys.clear();
 }
 
 CJobManager &CJobManager::GetInstance()
@@ -169,6 +177,7 @@ CJobManager::CJobManager()
 {
   m_jobCounter = 0;
   m_running = true;
+  m_statsTime = XbmcThreads::SystemClockMillis();
 }
 
 void CJobManager::CancelJobs()
@@ -207,6 +216,7 @@ unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORI
   // create a work item for this job
   CWorkItem work(job, m_jobCounter++, callback);
   m_jobQueue[priority].push_back(work);
+  m_stats[priority].maxDepth = std::max(m_stats[priority].maxDepth, (unsigned int)m_jobQueue[priority].size());
 
   StartWorkers(priority);
   return work.m_id;
@@ -254,29 +264,75 @@ void CJobManager::StartWorkers(CJob::PRIORITY priority)
 
 CJob *CJobManager::PopJob()
 {
+  // jobs waiting for longer than this are picked as if they had the next higher priority,
+  // but are still limited to the workers of their own priority
+  static const unsigned int age_time = 10000;
+
   CSingleLock lock(m_section);
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  int best = -1;
+  int bestPriority = -1;
   for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW; --priority)
   {
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
+    if (m_jobQueue[priority].empty())
+      continue;
+    const CWorkItem &job = m_jobQueue[priority].front();
+
+    // skip adding any paused types
+    if (priority <= CJob::PRIORITY_LOW)
     {
-      CWorkItem job = m_jobQueue[priority].front();
-
-      // skip adding any paused types
-      if (priority <= CJob::PRIORITY_LOW)
-      {
-        std::vector<std::string>::iterator i = find(m_pausedTypes.begin(), m_pausedTypes.end(), job.m_job->GetType());
-        if (i != m_pausedTypes.end())
-          return NULL;
-      }
-
-      m_jobQueue[priority].pop_front();
-      // add to the processing vector
-      m_processing.push_back(job);
-      job.m_job->m_callback = this;
-      return job.m_job;
+      std::vector<std::string>::iterator i = find(m_pausedTypes.begin(), m_pausedTypes.end(), job.m_job->GetType());
+      if (i != m_pausedTypes.end())
+        continue;
+    }
+
+    int effective = priority;
+    if (priority < CJob::PRIORITY_HIGH && now - job.m_queued > age_time)
+      effective++;
+    // on a tie the job of the higher priority, which comes first, is kept
+    if (effective > bestPriority && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
+    {
+      best = priority;
+      bestPriority = effective;
     }
   }
-  return NULL;
+  if (best < 0)
+    return NULL;
+
+  CWorkItem job = m_jobQueue[best].front();
+  m_jobQueue[best].pop_front();
+
+  CQueueStats &stats = m_stats[best];
+  unsigned int waited = now - job.m_queued;
+  stats.jobs++;
+  stats.waited += waited;
+  stats.maxWaited = std::max(stats.maxWaited, waited);
+  if (bestPriority > best)
+    stats.aged++;
+  LogStats(now);
+
+  // add to the processing vector
+  m_processing.push_back(job);
+  job.m_job->m_callback = this;
+  return job.m_job;
+}
+
+void CJobManager::LogStats(unsigned int now)
+{
+  static const char *names[] = { "low", "normal", "high" };
+
+  if (now - m_statsTime < 60000)
+    return;
+
+  for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+  {
+    CQueueStats &stats = m_stats[priority];
+    if (stats.jobs)
+      CLog::Log(LOGDEBUG, "%s - %s priority: %u jobs (%u of them aged), waited %u ms on average and at most %u ms, at most %u queued",
+                __FUNCTION__, names[priority], stats.jobs, stats.aged, stats.waited / stats.jobs, stats.maxWaited, stats.maxDepth);
+    stats.Reset();
+  }
+  m_statsTime = now;
 }
 
 void CJobManager::Pause(const std::string &pausedType)
@@ -24,8 +24,10 @@
 #include <vector>
 #include <string>
 #include "threads/CriticalSection.h"
+#include "threads/SystemClock.h"
 #include "threads/Thread.h"
 #include "Job.h"
+#include <boost/unordered_set.hpp>
 
 class CJobManager;
 
@@ -46,7 +48,8 @@ private:
 
  Holds a queue of jobs to be processed sequentially, either first in,first out
  or last in, first out.  Jobs are unique, so queueing multiple copies of the same job
- (based on the CJob::operator==) will not add additional jobs.
+ (based on the CJob::operator==) will not add additional jobs.  Jobs that have a key
+ (CJob::GetKey) are looked up by it instead of being compared with every queued job.
 
  Classes should subclass this class and override OnJobCallback should they require
  information from the job.
@@ -58,10 +61,11 @@ class CJobQueue: public IJobCallback
   class CJobPointer
   {
   public:
-    CJobPointer(CJob *job)
+    CJobPointer(CJob *job, const std::string &key)
     {
       m_job = job;
       m_id = 0;
+      m_key = key;
     };
     void CancelJob();
     void FreeJob()
@@ -77,6 +81,7 @@ class CJobQueue: public IJobCallback
     };
     CJob *m_job;
     unsigned int m_id;
+    std::string m_key;
   };
 public:
   /*!
@@ -143,6 +148,7 @@ private:
   typedef std::vector<CJobPointer> Processing;
   Queue m_jobQueue;
   Processing m_processing;
+  boost::unordered_set<std::string> m_keys; ///< keys of the queued and processing jobs
 
   unsigned int m_jobsAtOnce;
   CJob::PRIORITY m_priority;
@@ -158,6 +164,9 @@ private:
  Should be accessed via CJobManager::GetInstance().  Jobs are allocated based on
  priority levels.  Lower priority jobs are executed only if there are sufficient
  spare worker threads free to allow for higher priority jobs that may arise.
+ Jobs that have been waiting for a while are picked as if they had the next higher
+ priority, so that a steady stream of higher priority jobs doesn't hold them back forever.
+ They still only get the workers of their own priority.
 
  \sa CJob and IJobCallback
  */
@@ -171,6 +180,7 @@ class CJobManager
       m_job = job;
       m_id = id;
       m_callback = callback;
+      m_queued = XbmcThreads::SystemClockMillis();
     }
     bool operator==(unsigned int jobID) const
     {
@@ -192,6 +202,19 @@ class CJobManager
     CJob         *m_job;
     unsigned int  m_id;
     IJobCallback *m_callback;
+    unsigned int  m_queued; ///< when the job was added
+  };
+
+  class CQueueStats
+  {
+  public:
+    CQueueStats() { Reset(); };
+    void Reset() { jobs = aged = waited = maxWaited = maxDepth = 0; };
+    unsigned int jobs;      ///< jobs started
+    unsigned int aged;      ///< jobs started ahead of their priority, after waiting for long
+    unsigned int waited;    ///< total time the jobs waited in the queue
+    unsigned int maxWaited;
+    unsigned int maxDepth;  ///< most jobs queued at once
   };
 
 public:
@@ -305,6 +328,10 @@ private:
   void RemoveWorker(const CJobWorker *worker);
   unsigned int GetMaxWorkers(CJob::PRIORITY priority) const;
 
+  /*! \brief Log how many jobs of each priority were started and how long they waited, every so often
+   */
+  void LogStats(unsigned int now);
+
   unsigned int m_jobCounter;
 
   typedef std::deque<CWorkItem>    JobQueue;
@@ -319,4 +346,7 @@ private:
   CEvent           m_jobEvent;
   bool             m_running;
   std::vector<std::string>  m_pausedTypes;
+
+  CQueueStats  m_stats[CJob::PRIORITY_HIGH+1];
+  unsigned int m_statsTime;
 };
@@ -0,0 +1,66 @@
+#pragma once
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <set>
+#include <string>
+#include <vector>
+
+/*!
+ \brief Rough count of the heap memory used by a set of objects
+
+ Strings that share their buffer are only counted once, the bytes they
+ would have taken otherwise are counted as shared.
+ */
+class CMemoryUsage
+{
+public:
+  CMemoryUsage() : m_bytes(0), m_shared(0) {}
+
+  void Add(size_t bytes) { m_bytes += bytes; }
+
+  void Add(const std::string &str)
+  {
+    const char *data = str.data();
+    // nothing on the heap for empty or short strings stored in place
+    if (str.capacity() == 0 || (data >= (const char *)&str && data < (const char *)(&str + 1)))
+      return;
+    if (m_buffers.insert(data).second)
+      m_bytes += str.capacity() + 1;
+    else
+      m_shared += str.capacity() + 1;
+  }
+
+  void Add(const std::vector<std::string> &strings)
+  {
+    m_bytes += strings.capacity() * sizeof(std::string);
+    for (std::vector<std::string>::const_iterator it = strings.begin(); it != strings.end(); ++it)
+      Add(*it);
+  }
+
+  size_t GetBytes() const { return m_bytes; }
+  size_t GetSharedBytes() const { return m_shared; }
+
+private:
+  size_t m_bytes;
+  size_t m_shared;
+  std::set<const char *> m_buffers;
+};
@@ -0,0 +1,104 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "StringPool.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include <set>
+
+using namespace std;
+
+// strings kept by each generation, the pool holds up to twice this
+#define MAX_GENERATION_STRINGS 32768
+
+static CCriticalSection &GetSection()
+{
+  static CCriticalSection section;
+  return section;
+}
+
+// strings interned since the generation started, and those of the generation before
+static set<string> &GetPool()
+{
+  static set<string> pool;
+  return pool;
+}
+
+static set<string> &GetPreviousPool()
+{
+  static set<string> pool;
+  return pool;
+}
+
+void CStringPool::Intern(string &str)
+{
+  if (str.empty())
+    return;
+
+  CSingleLock lock(GetSection());
+  set<string> &pool = GetPool();
+  set<string>::const_iterator it = pool.find(str);
+  if (it != pool.end())
+  {
+    str = *it;
+    return;
+  }
+
+  // strings still in use move on to the current generation, so only those
+  // not interned for a whole generation are dropped when it is full
+  set<string> &previous = GetPreviousPool();
+  if (pool.size() >= MAX_GENERATION_STRINGS)
+  {
+    CLog::Log(LOGDEBUG, "%s - generation is full, dropping %u strings not used since the last one",
+              __FUNCTION__, (unsigned int)previous.size());
+    previous.swap(pool);
+    pool.clear();
+  }
+
+  it = previous.find(str);
+  if (it != previous.end())
+  {
+    str = *pool.insert(*it).first;
+    previous.erase(it);
+  }
+  else
+    str = *pool.insert(str).first;
+}
+
+void CStringPool::Intern(vector<string> &strings)
+{
+  for (vector<string>::iterator it = strings.begin(); it != strings.end(); ++it)
+    Intern(*it);
+}
+
+unsigned int CStringPool::Size()
+{
+  CSingleLock lock(GetSection());
+  return GetPool().size() + GetPreviousPool().size();
+}
+
+void CStringPool::Clear()
+{
+  CSingleLock lock(GetSection());
+  GetPool().clear();
+  GetPreviousPool().clear();
+}
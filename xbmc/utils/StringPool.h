@@ -0,0 +1,47 @@
+#pragma once
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string>
+#include <vector>
+
+/*!
+ \brief Pool of string values that repeat a lot over a library
+
+ Genres, studios, countries, directory paths and property names are the same
+ for thousands of items. Interning such a string replaces it by a copy of
+ the pooled value, which shares its buffer with every other interned copy
+ where std::string is reference counted.
+
+ The pool is kept in two generations. A string interned again is moved to the
+ current one, and when the current generation is full it becomes the previous
+ one, dropping the strings that weren't interned during a whole generation.
+ Strings interned before keep sharing their buffers.
+ */
+class CStringPool
+{
+public:
+  static void Intern(std::string &str);
+  static void Intern(std::vector<std::string> &strings);
+
+  static unsigned int Size();
+  static void Clear();
+};
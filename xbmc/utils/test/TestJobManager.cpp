@@ -0,0 +1,130 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/JobManager.h"
+#include "utils/log.h"
+#include "linux/XTimeUtils.h"
+#include "threads/Atomics.h"
+#include "threads/SystemClock.h"
+
+#include <boost/test/unit_test.hpp>
+#include <stdarg.h>
+#include <sched.h>
+
+// the job manager logs and sleeps, neither utils nor linux is linked into the test
+void CLog::Log(int loglevel, const char *format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  vprintf(format, va);
+  va_end(va);
+  printf("\n");
+}
+
+void WINAPI Sleep(DWORD dwMilliSeconds)
+{
+  if (dwMilliSeconds == 0)
+    sched_yield();
+  else
+    XbmcThreads::ThreadSleep(dwMilliSeconds);
+}
+
+namespace
+{
+  class TestJob : public CJob
+  {
+  public:
+    TestJob(const std::string &key = "", unsigned int sleep = 0) : m_key(key), m_sleep(sleep) {}
+    virtual bool DoWork()
+    {
+      if (m_sleep)
+        XbmcThreads::ThreadSleep(m_sleep);
+      return true;
+    }
+    virtual const char *GetType() const { return "test"; }
+    // CJobQueue finds its jobs again with operator==, which the key has to agree with
+    virtual bool operator==(const CJob *job) const
+    {
+      const TestJob *other = dynamic_cast<const TestJob*>(job);
+      return other && other->m_key == m_key;
+    }
+    virtual std::string GetKey() const { return m_key; }
+    std::string  m_key;
+    unsigned int m_sleep;
+  };
+
+  class TestCallback : public IJobCallback
+  {
+  public:
+    TestCallback() : m_completed(0) {}
+    virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job) { AtomicIncrement(&m_completed); }
+    bool WaitFor(long jobs, unsigned int timeout)
+    {
+      unsigned int start = XbmcThreads::SystemClockMillis();
+      while (m_completed < jobs && XbmcThreads::SystemClockMillis() - start < timeout)
+        XbmcThreads::ThreadSleep(1);
+      return m_completed >= jobs;
+    }
+    volatile long m_completed;
+  };
+
+  class TestQueue : public CJobQueue
+  {
+  public:
+    TestQueue() : CJobQueue(false, 1, CJob::PRIORITY_NORMAL), m_completed(0) {}
+    virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job)
+    {
+      AtomicIncrement(&m_completed);
+      CJobQueue::OnJobComplete(jobID, success, job);
+    }
+    volatile long m_completed;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(TestJobThroughput)
+{
+  static const long jobs = 20000;
+  TestCallback callback;
+
+  // spread the jobs over the priorities, as the thumb and texture loaders do
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (long i = 0; i < jobs; i++)
+    CJobManager::GetInstance().AddJob(new TestJob, &callback, CJob::PRIORITY(i % (CJob::PRIORITY_HIGH + 1)));
+  BOOST_REQUIRE(callback.WaitFor(jobs, 60000));
+
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+  BOOST_TEST_MESSAGE("ran " << jobs << " jobs in " << elapsed << " ms");
+}
+
+BOOST_AUTO_TEST_CASE(TestJobQueueDuplicates)
+{
+  // the first job is still running while its copies are added
+  TestQueue queue;
+  for (int i = 0; i < 100; i++)
+    queue.AddJob(new TestJob("same", 500));
+  queue.AddJob(new TestJob("other"));
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  while (queue.m_completed < 2 && XbmcThreads::SystemClockMillis() - start < 5000)
+    XbmcThreads::ThreadSleep(1);
+  XbmcThreads::ThreadSleep(100);
+  BOOST_CHECK_EQUAL(queue.m_completed, 2);
+}
@@ -110,6 +110,10 @@ bool CVideoDatabase::CreateTables()
     m_pDS->exec("CREATE TABLE stacktimes (idFile integer, times text)\n");
     m_pDS->exec("CREATE UNIQUE INDEX ix_stacktimes ON stacktimes ( idFile )\n");
 
+    CLog::Log(LOGINFO, "create keyframes table");
+    m_pDS->exec("CREATE TABLE keyframes (idFile integer, keyframeIndex text)\n");
+    m_pDS->exec("CREATE UNIQUE INDEX ix_keyframes ON keyframes ( idFile )\n");
+
     CLog::Log(LOGINFO, "create genre table");
     m_pDS->exec("CREATE TABLE genre ( idGenre integer primary key, strGenre text)\n");
 
@@ -311,6 +315,10 @@ bool CVideoDatabase::CreateTables()
     m_pDS->exec("CREATE TABLE seasons ( idSeason integer primary key, idShow integer, season integer)");
     m_pDS->exec("CREATE INDEX ix_seasons ON seasons (idShow, season)");
 
+    CLog::Log(LOGINFO, "create partymodehistory table");
+    m_pDS->exec("CREATE TABLE partymodehistory ( client varchar(64), idMVideo integer )");
+    m_pDS->exec("CREATE UNIQUE INDEX ix_partymodehistory ON partymodehistory ( client, idMVideo )");
+
     CLog::Log(LOGINFO, "create art table and triggers");
     m_pDS->exec("CREATE TABLE art(art_id INTEGER PRIMARY KEY, media_id INTEGER, media_type TEXT, type TEXT, url TEXT)");
     m_pDS->exec("CREATE INDEX ix_art ON art(media_id, media_type(20), type(20))");
@@ -2984,6 +2992,7 @@ CVideoInfoTag CVideoDatabase::GetDetailsForMovie(auto_ptr<Dataset> &pDS, bool ne
     }
     m_pDS2->close();
   }
+  details.InternStrings();
   return details;
 }
 
@@ -3014,6 +3023,7 @@ CVideoInfoTag CVideoDatabase::GetDetailsForTvShow(auto_ptr<Dataset> &pDS, bool n
     castTime += XbmcThreads::SystemClockMillis() - time; time = XbmcThreads::SystemClockMillis();
     details.m_strPictureURL.Parse();
   }
+  details.InternStrings();
   return details;
 }
 
@@ -3060,6 +3070,7 @@ CVideoInfoTag CVideoDatabase::GetDetailsForEpisode(auto_ptr<Dataset> &pDS, bool
       details.m_fEpBookmark = m_pDS2->fv("bookmark.timeInSeconds").get_asFloat();
     m_pDS2->close();
   }
+  details.InternStrings();
   return details;
 }
 
@@ -3081,6 +3092,7 @@ CVideoInfoTag CVideoDatabase::GetDetailsForMusicVideo(auto_ptr<Dataset> &pDS)
   GetResumePoint(details);
 
   details.m_strPictureURL.Parse();
+  details.InternStrings();
   return details;
 }
 
@@ -3278,21 +3290,22 @@ void CVideoDatabase::SetArtForItem(int mediaId, const string &mediaType, const s
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
-    CStdString sql = PrepareSQL("SELECT art_id FROM art WHERE media_id=%i AND media_type='%s' AND type='%s'", mediaId, mediaType.c_str(), artType.c_str());
+    CStdString sql = PrepareSQL("SELECT art_id,url FROM art WHERE media_id=%i AND media_type='%s' AND type='%s'", mediaId, mediaType.c_str(), artType.c_str());
     m_pDS->query(sql.c_str());
     if (!m_pDS->eof())
-    { // update
+    { // replace, so changed art gets a new art_id and is picked up by CTexturePrecacher
       int artId = m_pDS->fv(0).get_asInt();
+      CStdString oldUrl = m_pDS->fv(1).get_asString();
       m_pDS->close();
-      sql = PrepareSQL("UPDATE art SET url='%s' where art_id=%d", url.c_str(), artId);
+      if (oldUrl == url)
+        return;
+      sql = PrepareSQL("DELETE FROM art WHERE art_id=%d", artId);
       m_pDS->exec(sql.c_str());
     }
     else
-    { // insert
       m_pDS->close();
-      sql = PrepareSQL("INSERT INTO art(media_id, media_type, type, url) VALUES (%d, '%s', '%s', '%s')", mediaId, mediaType.c_str(), artType.c_str(), url.c_str());
-      m_pDS->exec(sql.c_str());
-    }
+    sql = PrepareSQL("INSERT INTO art(media_id, media_type, type, url) VALUES (%d, '%s', '%s', '%s')", mediaId, mediaType.c_str(), artType.c_str(), url.c_str());
+    m_pDS->exec(sql.c_str());
   }
   catch (...)
   {
@@ -3359,6 +3372,30 @@ bool CVideoDatabase::GetTvShowSeasonArt(int showId, map<int, string> &seasonArt)
   return false;
 }
 
+bool CVideoDatabase::GetArtURLs(int afterId, vector< pair<int, string> > &urls)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    CStdString sql = PrepareSQL("SELECT art_id,url FROM art WHERE art_id>%i ORDER BY art_id", afterId);
+    m_pDS->query(sql.c_str());
+    while (!m_pDS->eof())
+    {
+      urls.push_back(make_pair(m_pDS->fv(0).get_asInt(), m_pDS->fv(1).get_asString()));
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s(%d) failed", __FUNCTION__, afterId);
+  }
+  return false;
+}
+
 /// \brief GetStackTimes() obtains any saved video times for the stacked file
 /// \retval Returns true if the stack times exist, false otherwise.
 bool CVideoDatabase::GetStackTimes(const CStdString &filePath, vector<int> &times)
@@ -3427,6 +3464,51 @@ void CVideoDatabase::SetStackTimes(const CStdString& filePath, vector<int> &time
   }
 }
 
+/// \brief Gets the keyframe index stored by the player for a video file
+bool CVideoDatabase::GetKeyframeIndex(const CStdString &filePath, CStdString &index)
+{
+  try
+  {
+    int idFile = GetFileId(filePath);
+    if (idFile < 0) return false;
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    CStdString strSQL=PrepareSQL("select keyframeIndex from keyframes where idFile=%i", idFile);
+    m_pDS->query( strSQL.c_str() );
+    bool found = m_pDS->num_rows() > 0;
+    if (found)
+      index = m_pDS->fv("keyframeIndex").get_asString();
+    m_pDS->close();
+    return found;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, filePath.c_str());
+  }
+  return false;
+}
+
+/// \brief Sets the keyframe index of a video file, replacing any stored before
+void CVideoDatabase::SetKeyframeIndex(const CStdString &filePath, const CStdString &index)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return ;
+    if (NULL == m_pDS.get()) return ;
+    int idFile = AddFile(filePath);
+    if (idFile < 0)
+      return;
+
+    m_pDS->exec( PrepareSQL("delete from keyframes where idFile=%i", idFile) );
+    m_pDS->exec( PrepareSQL("insert into keyframes (idFile,keyframeIndex) values (%i,'%s')", idFile, index.c_str()) );
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, filePath.c_str());
+  }
+}
+
 void CVideoDatabase::RemoveContentForPath(const CStdString& strPath, CGUIDialogProgress *progress /* = NULL */)
 {
   if(URIUtils::IsMultiPath(strPath))
@@ -3789,6 +3871,21 @@ bool CVideoDatabase::UpdateOldVersion(int iVersion)
       m_pDS->exec("CREATE INDEX ix_episode_show1 on episode(idEpisode,idShow)");
       m_pDS->exec("CREATE INDEX ix_episode_show2 on episode(idShow,idEpisode)");
     }
+    if (iVersion < 65)
+    {
+      m_pDS->exec("CREATE TABLE partymodehistory ( idMVideo integer primary key )");
+    }
+    if (iVersion < 66)
+    {
+      m_pDS->exec("CREATE TABLE keyframes (idFile integer, keyframeIndex text)");
+      m_pDS->exec("CREATE UNIQUE INDEX ix_keyframes ON keyframes ( idFile )");
+    }
+    if (iVersion < 67)
+    {
+      m_pDS->exec("DROP TABLE partymodehistory");
+      m_pDS->exec("CREATE TABLE partymodehistory ( client varchar(64), idMVideo integer )");
+      m_pDS->exec("CREATE UNIQUE INDEX ix_partymodehistory ON partymodehistory ( client, idMVideo )");
+    }
     // always recreate the view after any table change
     CreateViews();
   }
@@ -5669,6 +5766,57 @@ bool CVideoDatabase::HasContent(VIDEODB_CONTENT_TYPE type)
   return result;
 }
 
+bool CVideoDatabase::GetRandomMusicVideoIDs(const CStdString& strWhere, unsigned int count, vector<pair<int,int> > &songIDs)
+{
+  vector<int> ids;
+  if (!GetRandomIDs("musicvideoview", "idMVideo", strWhere, count, ids))
+    return false;
+  for (vector<int>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+    songIDs.push_back(make_pair<int,int>(2, *it));
+  return true;
+}
+
+bool CVideoDatabase::UpdatePartyModeHistory(const CStdString &client, const vector<int> &added, const vector<int> &removed)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    CStdString ids;
+    for (vector<int>::const_iterator it = removed.begin(); it != removed.end(); ++it)
+      ids.AppendFormat("%i,", *it);
+    for (vector<int>::const_iterator it = added.begin(); it != added.end(); ++it)
+      ids.AppendFormat("%i,", *it);
+    if (ids.IsEmpty())
+      return true;
+    ids.TrimRight(",");
+
+    BeginTransaction();
+    CStdString sql;
+    sql = PrepareSQL("delete from partymodehistory where client='%s' and idMVideo in (", client.c_str()) + ids + ")";
+    m_pDS->exec(sql.c_str());
+    for (vector<int>::const_iterator it = added.begin(); it != added.end(); ++it)
+    {
+      sql = PrepareSQL("insert into partymodehistory (client, idMVideo) values ('%s', %i)", client.c_str(), *it);
+      m_pDS->exec(sql.c_str());
+    }
+    CommitTransaction();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+    RollbackTransaction();
+  }
+  return false;
+}
+
+bool CVideoDatabase::ClearPartyModeHistory(const CStdString &client)
+{
+  return ExecuteQuery(PrepareSQL("delete from partymodehistory where client='%s'", client.c_str()));
+}
+
 int CVideoDatabase::GetMusicVideoCount(const CStdString& strWhere)
 {
   try
@@ -6353,48 +6501,6 @@ unsigned int CVideoDatabase::GetMusicVideoIDs(const CStdString& strWhere, vector
   return 0;
 }
 
-bool CVideoDatabase::GetRandomMusicVideo(CFileItem* item, int& idSong, const CStdString& strWhere)
-{
-  try
-  {
-    idSong = -1;
-
-    int iCount = GetMusicVideoCount(strWhere);
-    if (iCount <= 0)
-      return false;
-    int iRandom = rand() % iCount;
-
-    if (NULL == m_pDB.get()) return false;
-    if (NULL == m_pDS.get()) return false;
-
-    // We don't use PrepareSQL here, as the WHERE clause is already formatted.
-    CStdString strSQL;
-    strSQL.Format("select * from musicvideoview %s order by idMVideo limit 1 offset %i",strWhere.c_str(),iRandom);
-    CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
-    // run query
-    if (!m_pDS->query(strSQL.c_str()))
-      return false;
-    int iRowsFound = m_pDS->num_rows();
-    if (iRowsFound != 1)
-    {
-      m_pDS->close();
-      return false;
-    }
-    *item->GetVideoInfoTag() = GetDetailsForMusicVideo(m_pDS);
-    CStdString path; path.Format("videodb://3/2/%ld",item->GetVideoInfoTag()->m_iDbId);
-    item->SetPath(path);
-    idSong = m_pDS->fv("idMVideo").get_asInt();
-    item->SetLabel(item->GetVideoInfoTag()->m_strTitle);
-    m_pDS->close();
-    return true;
-  }
-  catch(...)
-  {
-    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, strWhere.c_str());
-  }
-  return false;
-}
-
 int CVideoDatabase::GetMatchingMusicVideo(const CStdString& strArtist, const CStdString& strAlbum, const CStdString& strTitle)
 {
   try
@@ -7019,6 +7125,10 @@ void CVideoDatabase::CleanDatabase(IVideoInfoScannerObserver* pObserver, const s
       CLog::Log(LOGDEBUG, "%s: Cleaning stacktimes table", __FUNCTION__);
       sql = "delete from stacktimes where idFile in " + filesToDelete;
       m_pDS->exec(sql.c_str());
+
+      CLog::Log(LOGDEBUG, "%s: Cleaning keyframes table", __FUNCTION__);
+      sql = "delete from keyframes where idFile in " + filesToDelete;
+      m_pDS->exec(sql.c_str());
     }
 
     if ( ! moviesToDelete.IsEmpty() )
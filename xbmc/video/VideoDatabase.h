@@ -452,6 +452,9 @@ public:
   bool GetStackTimes(const CStdString &filePath, std::vector<int> &times);
   void SetStackTimes(const CStdString &filePath, std::vector<int> &times);
 
+  bool GetKeyframeIndex(const CStdString &filePath, CStdString &index);
+  void SetKeyframeIndex(const CStdString &filePath, const CStdString &index);
+
   void GetBookMarksForFile(const CStdString& strFilenameAndPath, VECBOOKMARKS& bookmarks, CBookmark::EType type = CBookmark::STANDARD, bool bAppend=false);
   void AddBookMarkToFile(const CStdString& strFilenameAndPath, const CBookmark &bookmark, CBookmark::EType type = CBookmark::STANDARD);
   bool GetResumeBookMark(const CStdString& strFilenameAndPath, CBookmark &bookmark);
@@ -630,7 +633,14 @@ public:
   // partymode
   int GetMusicVideoCount(const CStdString& strWhere);
   unsigned int GetMusicVideoIDs(const CStdString& strWhere, std::vector<std::pair<int,int> > &songIDs);
-  bool GetRandomMusicVideo(CFileItem* item, int& idSong, const CStdString& strWhere);
+  bool GetRandomMusicVideoIDs(const CStdString& strWhere, unsigned int count, std::vector<std::pair<int,int> > &songIDs);
+  /*! \brief Keep the party mode history in the partymodehistory table so where clauses can refer to it
+   The database may be shared by several clients, so each keeps its own rows.
+   \param client the client the history is of, see CPartyModeManager
+   \param added music videos to add to the history
+   \param removed music videos to drop from the history */
+  bool UpdatePartyModeHistory(const CStdString &client, const std::vector<int> &added, const std::vector<int> &removed);
+  bool ClearPartyModeHistory(const CStdString &client);
 
   static void VideoContentTypeToString(VIDEODB_CONTENT_TYPE type, CStdString& out)
   {
@@ -659,6 +669,13 @@ public:
   std::string GetArtForItem(int mediaId, const std::string &mediaType, const std::string &artType);
   bool GetTvShowSeasonArt(int mediaId, std::map<int, std::string> &seasonArt);
 
+  /*! \brief Get the art added after the given art, to cache it ahead of being shown
+   \param afterId the art_id of the last art already seen
+   \param urls art_id and url of each art added since, in the order added
+   \return true if the query succeeded
+   */
+  bool GetArtURLs(int afterId, std::vector< std::pair<int, std::string> > &urls);
+
 protected:
   int GetMovieId(const CStdString& strFilenameAndPath);
   int GetMusicVideoId(const CStdString& strFilenameAndPath);
@@ -773,7 +790,7 @@ private:
    */
   bool LookupByFolders(const CStdString &path, bool shows = false);
 
-  virtual int GetMinVersion() const { return 64; };
+  virtual int GetMinVersion() const { return 67; };
   virtual int GetExportVersion() const { return 1; };
   const char *GetBaseDBName() const { return "MyVideos"; };
 
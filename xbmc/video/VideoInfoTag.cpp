@@ -28,6 +28,8 @@
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
 #include "utils/CharsetConverter.h"
+#include "utils/MemoryUsage.h"
+#include "utils/StringPool.h"
 #include "TextureCache.h"
 #include "filesystem/File.h"
 
@@ -407,6 +409,87 @@ void CVideoInfoTag::Archive(CArchive& ar)
     ar >> dateAdded;
     m_dateAdded.SetFromDBDateTime(dateAdded);
     ar >> m_type;
+
+    InternStrings();
+  }
+}
+
+void CVideoInfoTag::InternStrings()
+{
+  CStringPool::Intern(m_director);
+  CStringPool::Intern(m_writingCredits);
+  CStringPool::Intern(m_genre);
+  CStringPool::Intern(m_country);
+  CStringPool::Intern(m_studio);
+  CStringPool::Intern(m_artist);
+  CStringPool::Intern(m_set);
+  CStringPool::Intern(m_showLink);
+  CStringPool::Intern(m_basePath);
+  CStringPool::Intern(m_strPath);
+  CStringPool::Intern(m_strShowPath);
+  CStringPool::Intern(m_strShowTitle);
+  CStringPool::Intern(m_strAlbum);
+  CStringPool::Intern(m_strMPAARating);
+  CStringPool::Intern(m_strStatus);
+  CStringPool::Intern(m_type);
+  for (std::vector<SActorInfo>::iterator it = m_cast.begin(); it != m_cast.end(); ++it)
+  {
+    CStringPool::Intern(it->strName);
+    CStringPool::Intern(it->thumb);
+  }
+}
+
+void CVideoInfoTag::GetMemoryUsage(CMemoryUsage &usage) const
+{
+  usage.Add(sizeof(CVideoInfoTag));
+  usage.Add(m_director);
+  usage.Add(m_writingCredits);
+  usage.Add(m_genre);
+  usage.Add(m_country);
+  usage.Add(m_studio);
+  usage.Add(m_artist);
+  usage.Add(m_set);
+  usage.Add(m_showLink);
+  usage.Add(m_setId.capacity() * sizeof(int));
+  usage.Add(m_basePath);
+  usage.Add(m_strTagLine);
+  usage.Add(m_strPlotOutline);
+  usage.Add(m_strTrailer);
+  usage.Add(m_strPlot);
+  usage.Add(m_strPictureURL.m_xml);
+  usage.Add(m_strPictureURL.m_spoof);
+  usage.Add(m_strPictureURL.m_url.capacity() * sizeof(CScraperUrl::SUrlEntry));
+  for (std::vector<CScraperUrl::SUrlEntry>::const_iterator it = m_strPictureURL.m_url.begin(); it != m_strPictureURL.m_url.end(); ++it)
+  {
+    usage.Add(it->m_url);
+    usage.Add(it->m_spoof);
+    usage.Add(it->m_cache);
+  }
+  usage.Add(m_strTitle);
+  usage.Add(m_strSortTitle);
+  usage.Add(m_strVotes);
+  usage.Add(m_strRuntime);
+  usage.Add(m_strFile);
+  usage.Add(m_strPath);
+  usage.Add(m_strIMDBNumber);
+  usage.Add(m_strMPAARating);
+  usage.Add(m_strFileNameAndPath);
+  usage.Add(m_strOriginalTitle);
+  usage.Add(m_strEpisodeGuide);
+  usage.Add(m_strStatus);
+  usage.Add(m_strProductionCode);
+  usage.Add(m_strShowTitle);
+  usage.Add(m_strAlbum);
+  usage.Add(m_strShowPath);
+  usage.Add(m_fanart.m_xml);
+  usage.Add(m_type);
+  usage.Add(m_cast.capacity() * sizeof(SActorInfo));
+  for (std::vector<SActorInfo>::const_iterator it = m_cast.begin(); it != m_cast.end(); ++it)
+  {
+    usage.Add(it->strName);
+    usage.Add(it->strRole);
+    usage.Add(it->thumb);
+    usage.Add(it->thumbUrl.m_xml);
   }
 }
 
@@ -30,6 +30,7 @@
 #include "XBDateTime.h"
 
 class CArchive;
+class CMemoryUsage;
 class TiXmlNode;
 class TiXmlElement;
 
@@ -69,6 +70,14 @@ public:
   bool HasStreamDetails() const;
   bool IsEmpty() const;
 
+  /*! \brief Share the buffers of values that repeat across a library, such as genres, studios and paths
+   \sa CStringPool
+   */
+  void InternStrings();
+
+  /*! \brief Account for the heap memory used by the tag */
+  void GetMemoryUsage(CMemoryUsage &usage) const;
+
   const CStdString& GetPath() const
   {
     if (m_strFileNameAndPath.IsEmpty())
@@ -692,6 +692,9 @@ bool CGUIMediaWindow::GetDirectory(const CStdString &strDirectory, CFileItemList
     }
   }
 
+  if (g_advancedSettings.m_logLevel >= LOG_LEVEL_DEBUG)
+    items.LogMemoryUsage();
+
   // clear the filter
   SetProperty("filter", "");
   return true;
@@ -70,7 +70,7 @@ void CGUIWindowHome::Announce(AnnouncementFlag flag, const char *sender, const c
       if (data.isMember("playcount"))
         ra_flag |= Totals;
     }
-    else if (strcmp(message, "OnScanFinished") == 0)
+    else if (strcmp(message, "OnScanFinished") == 0 || strcmp(message, "OnChanged") == 0)
     {
       ra_flag |= (Video | Totals);
     }
@@ -83,7 +83,7 @@ void CGUIWindowHome::Announce(AnnouncementFlag flag, const char *sender, const c
       if (data.isMember("playcount"))
         ra_flag |= Totals;
     }
-    else if (strcmp(message, "OnScanFinished") == 0)
+    else if (strcmp(message, "OnScanFinished") == 0 || strcmp(message, "OnChanged") == 0)
     {
       ra_flag |= ( Audio | Totals );
     }